@@ -1611,3 +1611,718 @@ void SpvReflectToYaml::Write(std::ostream& os)
 
   os << "..." << std::endl;
 }
+
+//////////////////////////////////
+
+void WriteRegisterPressure(const std::vector<SpvReflectRegisterPressure>& reports, bool output_as_yaml, std::ostream& os)
+{
+  if (output_as_yaml) {
+    os << "%YAML 1.0" << std::endl;
+    os << "---" << std::endl;
+    os << "register_pressure:" << std::endl;
+    for (const auto& rp : reports) {
+      os << "  - entry_point_name: \"" << rp.entry_point_name << "\"" << std::endl;
+      os << "    shader_stage: " << AsHexString(rp.shader_stage) << " # " << ToStringShaderStage(rp.shader_stage) << std::endl;
+      os << "    local_size: [" << rp.local_size[0] << ", " << rp.local_size[1] << ", " << rp.local_size[2] << "]" << std::endl;
+      os << "    shared_memory_size: " << rp.shared_memory_size << std::endl;
+      os << "    max_live_values: " << rp.max_live_values << std::endl;
+      os << "    max_live_registers: " << rp.max_live_registers << std::endl;
+      os << "    allocated_registers: " << rp.allocated_registers << std::endl;
+      os << "    spilled_registers: " << rp.spilled_registers << std::endl;
+      os << "    waves_by_registers: " << rp.waves_by_registers << std::endl;
+      os << "    waves_by_shared_memory: " << rp.waves_by_shared_memory << std::endl;
+      os << "    occupancy: " << rp.occupancy << std::endl;
+      os << "    functions:" << std::endl;
+      for (uint32_t i = 0; i < rp.function_count; ++i) {
+        const SpvReflectFunctionPressure& fp = rp.functions[i];
+        os << "      - function_id: " << fp.function_id << std::endl;
+        os << "        name: \"" << (fp.name != nullptr ? fp.name : "") << "\"" << std::endl;
+        os << "        max_live_values: " << fp.max_live_values << std::endl;
+        os << "        max_live_registers: " << fp.max_live_registers << std::endl;
+        os << "        blocks:" << std::endl;
+        for (uint32_t j = 0; j < fp.block_count; ++j) {
+          const SpvReflectBlockPressure& bp = fp.blocks[j];
+          os << "          - { label_id: " << bp.label_id
+             << ", max_live_values: " << bp.max_live_values
+             << ", max_live_registers: " << bp.max_live_registers << " }" << std::endl;
+        }
+      }
+    }
+    os << "..." << std::endl;
+    return;
+  }
+
+  const char* t  = "  ";
+  const char* tt = "    ";
+  for (size_t r = 0; r < reports.size(); ++r) {
+    const SpvReflectRegisterPressure& rp = reports[r];
+    if (r > 0) {
+      os << "\n\n";
+    }
+    os << "entry point     : " << rp.entry_point_name << "\n";
+    os << "shader stage    : " << ToStringShaderStage(rp.shader_stage) << "\n";
+    if (rp.shader_stage == SPV_REFLECT_SHADER_STAGE_COMPUTE_BIT) {
+      os << "local size      : " << rp.local_size[0] << " x " << rp.local_size[1] << " x " << rp.local_size[2] << "\n";
+      os << "shared memory   : " << rp.shared_memory_size << " bytes" << "\n";
+    }
+    os << "max live values : " << rp.max_live_values << "\n";
+    os << "max live regs   : " << rp.max_live_registers
+       << " (allocated " << rp.allocated_registers << ", spilled " << rp.spilled_registers << ")" << "\n";
+    os << "occupancy       : " << rp.occupancy << " waves/SIMD"
+       << " (registers " << rp.waves_by_registers << ", shared memory " << rp.waves_by_shared_memory << ")" << "\n";
+    os << "\n";
+    os << t << "Functions: " << rp.function_count << "\n";
+    for (uint32_t i = 0; i < rp.function_count; ++i) {
+      const SpvReflectFunctionPressure& fp = rp.functions[i];
+      os << "\n";
+      os << tt << (fp.name != nullptr ? fp.name : "") << " (id " << fp.function_id << ")" << ": "
+         << fp.max_live_values << " values, " << fp.max_live_registers << " registers" << "\n";
+      for (uint32_t j = 0; j < fp.block_count; ++j) {
+        const SpvReflectBlockPressure& bp = fp.blocks[j];
+        os << tt << t << "%" << std::left << std::setw(6) << bp.label_id << std::right << ": "
+           << bp.max_live_values << " values, " << bp.max_live_registers << " registers" << "\n";
+      }
+    }
+  }
+}
+
+//////////////////////////////////
+
+// Writes a YAML flow mapping, or a JSON object if keys need quotes
+static void WriteInstructionCostFields(const SpvReflectInstructionCost& cost, bool quote_keys, std::ostream& os)
+{
+  const char* q = quote_keys ? "\"" : "";
+  os << "{ "
+     << q << "instruction_count" << q << ": " << cost.instruction_count << ", "
+     << q << "alu_8" << q << ": " << cost.alu_count[0] << ", "
+     << q << "alu_16" << q << ": " << cost.alu_count[1] << ", "
+     << q << "alu_32" << q << ": " << cost.alu_count[2] << ", "
+     << q << "alu_64" << q << ": " << cost.alu_count[3] << ", "
+     << q << "transcendental" << q << ": " << cost.transcendental_count << ", "
+     << q << "sample" << q << ": " << cost.sample_count << ", "
+     << q << "fetch" << q << ": " << cost.fetch_count << ", "
+     << q << "gather" << q << ": " << cost.gather_count << ", "
+     << q << "image_write" << q << ": " << cost.image_write_count << ", "
+     << q << "atomic" << q << ": " << cost.atomic_count << ", "
+     << q << "barrier" << q << ": " << cost.barrier_count << ", "
+     << q << "call" << q << ": " << cost.call_count;
+  const uint64_t* counts[2] = { cost.load_count, cost.store_count };
+  const char* names[2] = { "loads", "stores" };
+  for (int k = 0; k < 2; ++k) {
+    os << ", " << q << names[k] << q << ": {";
+    const char* separator = " ";
+    for (uint32_t i = 0; i < SPV_REFLECT_MAX_STORAGE_CLASSES; ++i) {
+      if (counts[k][i] > 0) {
+        os << separator << q << ToStringSpvStorageClass((SpvStorageClass)i) << q << ": " << counts[k][i];
+        separator = ", ";
+      }
+    }
+    os << " }";
+  }
+  os << " }";
+}
+
+static std::string ToStringStorageClassCounts(const uint64_t* counts)
+{
+  std::stringstream ss;
+  for (uint32_t i = 0; i < SPV_REFLECT_MAX_STORAGE_CLASSES; ++i) {
+    if (counts[i] > 0) {
+      ss << (ss.tellp() > 0 ? ", " : "") << ToStringSpvStorageClass((SpvStorageClass)i) << " " << counts[i];
+    }
+  }
+  return ss.tellp() > 0 ? ss.str() : "0";
+}
+
+void WriteInstructionCost(const std::vector<SpvReflectInstructionCostReport>& reports, OutputFormat format, std::ostream& os)
+{
+  if (format == OUTPUT_FORMAT_YAML) {
+    os << "%YAML 1.0" << std::endl;
+    os << "---" << std::endl;
+    os << "instruction_cost:" << std::endl;
+    for (const auto& report : reports) {
+      os << "  - entry_point_name: \"" << report.entry_point_name << "\"" << std::endl;
+      os << "    shader_stage: " << AsHexString(report.shader_stage) << " # " << ToStringShaderStage(report.shader_stage) << std::endl;
+      os << "    total: ";
+      WriteInstructionCostFields(report.total, false, os);
+      os << std::endl;
+      os << "    functions:" << std::endl;
+      for (uint32_t i = 0; i < report.function_count; ++i) {
+        const SpvReflectFunctionCost& fc = report.functions[i];
+        os << "      - function_id: " << fc.function_id << std::endl;
+        os << "        name: \"" << (fc.name != nullptr ? fc.name : "") << "\"" << std::endl;
+        os << "        loop_count: " << fc.loop_count << std::endl;
+        os << "        unknown_trip_count_loop_count: " << fc.unknown_trip_count_loop_count << std::endl;
+        os << "        self: ";
+        WriteInstructionCostFields(fc.self, false, os);
+        os << std::endl;
+        os << "        total: ";
+        WriteInstructionCostFields(fc.total, false, os);
+        os << std::endl;
+      }
+    }
+    os << "..." << std::endl;
+    return;
+  }
+
+  if (format == OUTPUT_FORMAT_JSON) {
+    os << "{" << std::endl;
+    os << "  \"instruction_cost\": [" << std::endl;
+    for (size_t r = 0; r < reports.size(); ++r) {
+      const SpvReflectInstructionCostReport& report = reports[r];
+      os << "    {" << std::endl;
+      os << "      \"entry_point_name\": \"" << report.entry_point_name << "\"," << std::endl;
+      os << "      \"shader_stage\": \"" << ToStringShaderStage(report.shader_stage) << "\"," << std::endl;
+      os << "      \"total\": ";
+      WriteInstructionCostFields(report.total, true, os);
+      os << "," << std::endl;
+      os << "      \"functions\": [" << std::endl;
+      for (uint32_t i = 0; i < report.function_count; ++i) {
+        const SpvReflectFunctionCost& fc = report.functions[i];
+        os << "        {" << std::endl;
+        os << "          \"function_id\": " << fc.function_id << "," << std::endl;
+        os << "          \"name\": \"" << (fc.name != nullptr ? fc.name : "") << "\"," << std::endl;
+        os << "          \"loop_count\": " << fc.loop_count << "," << std::endl;
+        os << "          \"unknown_trip_count_loop_count\": " << fc.unknown_trip_count_loop_count << "," << std::endl;
+        os << "          \"self\": ";
+        WriteInstructionCostFields(fc.self, true, os);
+        os << "," << std::endl;
+        os << "          \"total\": ";
+        WriteInstructionCostFields(fc.total, true, os);
+        os << std::endl;
+        os << "        }" << ((i + 1) < report.function_count ? "," : "") << std::endl;
+      }
+      os << "      ]" << std::endl;
+      os << "    }" << ((r + 1) < reports.size() ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+    return;
+  }
+
+  const char* t  = "  ";
+  const char* tt = "    ";
+  for (size_t r = 0; r < reports.size(); ++r) {
+    const SpvReflectInstructionCostReport& report = reports[r];
+    const SpvReflectInstructionCost& cost = report.total;
+    if (r > 0) {
+      os << "\n\n";
+    }
+    os << "entry point     : " << report.entry_point_name << "\n";
+    os << "shader stage    : " << ToStringShaderStage(report.shader_stage) << "\n";
+    os << "instructions    : " << cost.instruction_count << "\n";
+    os << "alu 8/16/32/64  : " << cost.alu_count[0] << " / " << cost.alu_count[1] << " / "
+                               << cost.alu_count[2] << " / " << cost.alu_count[3] << "\n";
+    os << "transcendental  : " << cost.transcendental_count << "\n";
+    os << "texture         : " << cost.sample_count << " sample, " << cost.fetch_count << " fetch, "
+                               << cost.gather_count << " gather, " << cost.image_write_count << " write" << "\n";
+    os << "atomics         : " << cost.atomic_count << "\n";
+    os << "barriers        : " << cost.barrier_count << "\n";
+    os << "calls           : " << cost.call_count << "\n";
+    os << "loads           : " << ToStringStorageClassCounts(cost.load_count) << "\n";
+    os << "stores          : " << ToStringStorageClassCounts(cost.store_count) << "\n";
+    os << "\n";
+    os << t << "Functions: " << report.function_count << "\n";
+    for (uint32_t i = 0; i < report.function_count; ++i) {
+      const SpvReflectFunctionCost& fc = report.functions[i];
+      os << "\n";
+      os << tt << (fc.name != nullptr ? fc.name : "") << " (id " << fc.function_id << ")" << ": "
+         << fc.total.instruction_count << " instructions (self " << fc.self.instruction_count << ")";
+      if (fc.loop_count > 0) {
+        os << ", " << fc.loop_count << " loops (" << fc.unknown_trip_count_loop_count << " with unknown trip count)";
+      }
+      os << "\n";
+    }
+  }
+}
+
+//////////////////////////////////
+
+static const char* ToStringHalfPrecisionKind(SpvReflectHalfPrecisionKind kind)
+{
+  switch (kind) {
+    case SPV_REFLECT_HALF_PRECISION_KIND_INPUT    : return "input";
+    case SPV_REFLECT_HALF_PRECISION_KIND_OUTPUT   : return "output";
+    case SPV_REFLECT_HALF_PRECISION_KIND_VARIABLE : return "variable";
+    case SPV_REFLECT_HALF_PRECISION_KIND_CHAIN    : return "chain";
+  }
+  return "???";
+}
+
+static std::string ToStringPrecisionFlags(SpvReflectPrecisionFlags flags)
+{
+  std::stringstream ss;
+  if (flags & SPV_REFLECT_PRECISION_LOW_SOURCES) {
+    ss << "LOW_SOURCES";
+  }
+  if (flags & SPV_REFLECT_PRECISION_LOW_SINKS) {
+    ss << (ss.tellp() > 0 ? " | " : "") << "LOW_SINKS";
+  }
+  return ss.tellp() > 0 ? ss.str() : "NONE";
+}
+
+void WriteHalfPrecision(const std::vector<SpvReflectHalfPrecisionReport>& reports, OutputFormat format, std::ostream& os)
+{
+  if (format == OUTPUT_FORMAT_YAML) {
+    os << "%YAML 1.0" << std::endl;
+    os << "---" << std::endl;
+    os << "half_precision:" << std::endl;
+    for (const auto& report : reports) {
+      os << "  - entry_point_name: \"" << report.entry_point_name << "\"" << std::endl;
+      os << "    shader_stage: " << AsHexString(report.shader_stage) << " # " << ToStringShaderStage(report.shader_stage) << std::endl;
+      os << "    float_value_count: " << report.float_value_count << std::endl;
+      os << "    relaxed_value_count: " << report.relaxed_value_count << std::endl;
+      os << "    candidate_value_count: " << report.candidate_value_count << std::endl;
+      os << "    alu_instruction_count: " << report.alu_instruction_count << std::endl;
+      os << "    candidate_alu_instruction_count: " << report.candidate_alu_instruction_count << std::endl;
+      os << "    register_savings: " << report.register_savings << std::endl;
+      os << "    interface_bytes_saved: " << report.interface_bytes_saved << std::endl;
+      os << "    candidates:" << std::endl;
+      for (uint32_t i = 0; i < report.candidate_count; ++i) {
+        const SpvReflectHalfPrecisionCandidate& c = report.candidates[i];
+        os << "      - { kind: " << ToStringHalfPrecisionKind(c.kind)
+           << ", spirv_id: " << c.spirv_id
+           << ", name: \"" << (c.name != nullptr ? c.name : "") << "\""
+           << ", location: " << static_cast<int32_t>(c.location)
+           << ", flags: " << AsHexString(c.flags)
+           << ", instruction_count: " << c.instruction_count
+           << ", component_count: " << c.component_count << " }" << std::endl;
+      }
+    }
+    os << "..." << std::endl;
+    return;
+  }
+
+  if (format == OUTPUT_FORMAT_JSON) {
+    os << "{" << std::endl;
+    os << "  \"half_precision\": [" << std::endl;
+    for (size_t r = 0; r < reports.size(); ++r) {
+      const SpvReflectHalfPrecisionReport& report = reports[r];
+      os << "    {" << std::endl;
+      os << "      \"entry_point_name\": \"" << report.entry_point_name << "\"," << std::endl;
+      os << "      \"shader_stage\": \"" << ToStringShaderStage(report.shader_stage) << "\"," << std::endl;
+      os << "      \"float_value_count\": " << report.float_value_count << "," << std::endl;
+      os << "      \"relaxed_value_count\": " << report.relaxed_value_count << "," << std::endl;
+      os << "      \"candidate_value_count\": " << report.candidate_value_count << "," << std::endl;
+      os << "      \"alu_instruction_count\": " << report.alu_instruction_count << "," << std::endl;
+      os << "      \"candidate_alu_instruction_count\": " << report.candidate_alu_instruction_count << "," << std::endl;
+      os << "      \"register_savings\": " << report.register_savings << "," << std::endl;
+      os << "      \"interface_bytes_saved\": " << report.interface_bytes_saved << "," << std::endl;
+      os << "      \"candidates\": [" << std::endl;
+      for (uint32_t i = 0; i < report.candidate_count; ++i) {
+        const SpvReflectHalfPrecisionCandidate& c = report.candidates[i];
+        os << "        { \"kind\": \"" << ToStringHalfPrecisionKind(c.kind) << "\""
+           << ", \"spirv_id\": " << c.spirv_id
+           << ", \"name\": \"" << (c.name != nullptr ? c.name : "") << "\""
+           << ", \"location\": " << static_cast<int32_t>(c.location)
+           << ", \"flags\": \"" << ToStringPrecisionFlags(c.flags) << "\""
+           << ", \"instruction_count\": " << c.instruction_count
+           << ", \"component_count\": " << c.component_count << " }"
+           << ((i + 1) < report.candidate_count ? "," : "") << std::endl;
+      }
+      os << "      ]" << std::endl;
+      os << "    }" << ((r + 1) < reports.size() ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+    return;
+  }
+
+  const char* t  = "  ";
+  const char* tt = "    ";
+  for (size_t r = 0; r < reports.size(); ++r) {
+    const SpvReflectHalfPrecisionReport& report = reports[r];
+    if (r > 0) {
+      os << "\n\n";
+    }
+    os << "entry point     : " << report.entry_point_name << "\n";
+    os << "shader stage    : " << ToStringShaderStage(report.shader_stage) << "\n";
+    os << "float values    : " << report.float_value_count << " (" << report.relaxed_value_count << " relaxed, "
+                               << report.candidate_value_count << " candidates)" << "\n";
+    os << "float alu       : " << report.alu_instruction_count << " (" << report.candidate_alu_instruction_count
+                               << " candidates)" << "\n";
+    os << "register savings: " << report.register_savings << "\n";
+    os << "interface bytes : " << report.interface_bytes_saved << " saved" << "\n";
+    os << "\n";
+    os << t << "Candidates: " << report.candidate_count << "\n";
+    for (uint32_t i = 0; i < report.candidate_count; ++i) {
+      const SpvReflectHalfPrecisionCandidate& c = report.candidates[i];
+      os << "\n";
+      os << tt << std::left << std::setw(9) << ToStringHalfPrecisionKind(c.kind) << std::right
+         << (c.name != nullptr ? c.name : "") << " (id " << c.spirv_id << ")";
+      if (c.location != static_cast<uint32_t>(-1)) {
+        os << ", location " << c.location;
+      }
+      if (c.kind == SPV_REFLECT_HALF_PRECISION_KIND_CHAIN) {
+        os << ", " << c.instruction_count << " instructions";
+      }
+      os << ", " << c.component_count << " components, " << ToStringPrecisionFlags(c.flags) << "\n";
+    }
+  }
+}
+
+//////////////////////////////////
+
+static uint64_t MemoryOpCount(const SpvReflectInstructionCost& cost)
+{
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < SPV_REFLECT_MAX_STORAGE_CLASSES; ++i) {
+    count += cost.load_count[i] + cost.store_count[i];
+  }
+  return count;
+}
+
+void WriteSourceLineCost(const SpvReflectShaderModule& shader_module, const std::vector<SpvReflectSourceLineCostReport>& reports,
+                         uint32_t max_line_count, OutputFormat format, std::ostream& os)
+{
+  if (format == OUTPUT_FORMAT_YAML) {
+    os << "%YAML 1.0" << std::endl;
+    os << "---" << std::endl;
+    os << "source_line_cost:" << std::endl;
+    for (const auto& report : reports) {
+      uint32_t line_count = (max_line_count > 0) ? std::min(max_line_count, report.line_count) : report.line_count;
+      os << "  - entry_point_name: \"" << report.entry_point_name << "\"" << std::endl;
+      os << "    shader_stage: " << AsHexString(report.shader_stage) << " # " << ToStringShaderStage(report.shader_stage) << std::endl;
+      os << "    total: ";
+      WriteInstructionCostFields(report.total, false, os);
+      os << std::endl;
+      os << "    unattributed: ";
+      WriteInstructionCostFields(report.unattributed, false, os);
+      os << std::endl;
+      os << "    lines:" << std::endl;
+      for (uint32_t i = 0; i < line_count; ++i) {
+        const SpvReflectSourceLineCost& lc = report.lines[i];
+        os << "      - file: \"" << (lc.file != nullptr ? lc.file : "") << "\"" << std::endl;
+        os << "        line: " << lc.line << std::endl;
+        os << "        cost: ";
+        WriteInstructionCostFields(lc.cost, false, os);
+        os << std::endl;
+      }
+    }
+    os << "..." << std::endl;
+    return;
+  }
+
+  if (format == OUTPUT_FORMAT_JSON) {
+    os << "{" << std::endl;
+    os << "  \"source_line_cost\": [" << std::endl;
+    for (size_t r = 0; r < reports.size(); ++r) {
+      const SpvReflectSourceLineCostReport& report = reports[r];
+      uint32_t line_count = (max_line_count > 0) ? std::min(max_line_count, report.line_count) : report.line_count;
+      os << "    {" << std::endl;
+      os << "      \"entry_point_name\": \"" << report.entry_point_name << "\"," << std::endl;
+      os << "      \"shader_stage\": \"" << ToStringShaderStage(report.shader_stage) << "\"," << std::endl;
+      os << "      \"total\": ";
+      WriteInstructionCostFields(report.total, true, os);
+      os << "," << std::endl;
+      os << "      \"unattributed\": ";
+      WriteInstructionCostFields(report.unattributed, true, os);
+      os << "," << std::endl;
+      os << "      \"lines\": [" << std::endl;
+      for (uint32_t i = 0; i < line_count; ++i) {
+        const SpvReflectSourceLineCost& lc = report.lines[i];
+        os << "        { \"file\": \"" << (lc.file != nullptr ? lc.file : "") << "\", \"line\": " << lc.line << ", \"cost\": ";
+        WriteInstructionCostFields(lc.cost, true, os);
+        os << " }" << ((i + 1) < line_count ? "," : "") << std::endl;
+      }
+      os << "      ]" << std::endl;
+      os << "    }" << ((r + 1) < reports.size() ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+    return;
+  }
+
+  // Source text embedded with OpSource, if any
+  std::vector<std::string> source_lines;
+  if (shader_module.source_source != nullptr) {
+    std::stringstream ss(shader_module.source_source);
+    std::string text;
+    while (std::getline(ss, text)) {
+      source_lines.push_back(text);
+    }
+  }
+  std::string source_file = (shader_module.source_file != nullptr) ? shader_module.source_file : "";
+
+  for (size_t r = 0; r < reports.size(); ++r) {
+    const SpvReflectSourceLineCostReport& report = reports[r];
+    uint32_t line_count = (max_line_count > 0) ? std::min(max_line_count, report.line_count) : report.line_count;
+    if (r > 0) {
+      os << "\n\n";
+    }
+    os << "entry point     : " << report.entry_point_name << "\n";
+    os << "shader stage    : " << ToStringShaderStage(report.shader_stage) << "\n";
+    os << "instructions    : " << report.total.instruction_count
+       << " (" << report.unattributed.instruction_count << " without line info)" << "\n";
+    os << "\n";
+    if (report.line_count == 0) {
+      os << "  No OpLine debug info, compile with -g to attribute costs to source lines." << "\n";
+      continue;
+    }
+
+    // Hottest lines first, like a static perf annotate
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << "       %   instrs  texture   ld/st      alu  location" << "\n";
+    for (uint32_t i = 0; i < line_count; ++i) {
+      const SpvReflectSourceLineCost& lc = report.lines[i];
+      double percent = 0.0;
+      if (report.total.instruction_count > 0) {
+        percent = 100.0 * static_cast<double>(lc.cost.instruction_count) / static_cast<double>(report.total.instruction_count);
+      }
+      uint64_t texture_count = lc.cost.sample_count + lc.cost.fetch_count + lc.cost.gather_count + lc.cost.image_write_count;
+      uint64_t alu_count = lc.cost.alu_count[0] + lc.cost.alu_count[1] + lc.cost.alu_count[2] + lc.cost.alu_count[3];
+      std::stringstream location;
+      location << (lc.file != nullptr ? lc.file : "") << ":" << lc.line;
+      os << "  " << std::fixed << std::setprecision(1) << std::setw(6) << percent << "%"
+         << std::setw(9) << lc.cost.instruction_count
+         << std::setw(9) << texture_count
+         << std::setw(8) << MemoryOpCount(lc.cost)
+         << std::setw(9) << alu_count
+         << "  " << std::left << std::setw(20) << location.str() << std::right;
+      if ((lc.file != nullptr) && (source_file == lc.file) && (lc.line > 0) && (lc.line <= source_lines.size())) {
+        std::string text = source_lines[lc.line - 1];
+        text.erase(0, text.find_first_not_of(" \t"));
+        os << "  " << text;
+      }
+      os << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+    if (line_count < report.line_count) {
+      os << "  ... " << (report.line_count - line_count) << " more lines" << "\n";
+    }
+  }
+}
+
+//////////////////////////////////
+
+static std::string ToStringFingerprint(const SpvReflectFingerprint& fingerprint)
+{
+  std::stringstream ss;
+  ss << std::hex << std::setfill('0')
+     << std::setw(16) << fingerprint.value[0]
+     << std::setw(16) << fingerprint.value[1];
+  return ss.str();
+}
+
+void WriteFingerprints(const SpvReflectShaderModule& shader_module, const std::vector<SpvReflectFingerprints>& fingerprints,
+                       OutputFormat format, std::ostream& os)
+{
+  if (fingerprints.empty()) {
+    return;
+  }
+
+  if (format == OUTPUT_FORMAT_YAML) {
+    os << "%YAML 1.0" << std::endl;
+    os << "---" << std::endl;
+    os << "fingerprints:" << std::endl;
+    os << "  module: \"" << ToStringFingerprint(fingerprints[0].module) << "\"" << std::endl;
+    os << "  entry_points:" << std::endl;
+    for (size_t i = 0; i < fingerprints.size(); ++i) {
+      const SpvReflectEntryPoint& ep = shader_module.entry_points[i];
+      const SpvReflectFingerprints& fp = fingerprints[i];
+      os << "    - entry_point_name: \"" << ep.name << "\"" << std::endl;
+      os << "      shader_stage: " << AsHexString(ep.shader_stage) << " # " << ToStringShaderStage(ep.shader_stage) << std::endl;
+      os << "      push_constants: \"" << ToStringFingerprint(fp.push_constants) << "\"" << std::endl;
+      os << "      vertex_inputs: \"" << ToStringFingerprint(fp.vertex_inputs) << "\"" << std::endl;
+      os << "      descriptor_sets:" << std::endl;
+      for (uint32_t j = 0; j < fp.descriptor_set_count; ++j) {
+        os << "        - { set: " << fp.descriptor_sets[j].set
+           << ", fingerprint: \"" << ToStringFingerprint(fp.descriptor_sets[j].fingerprint) << "\" }" << std::endl;
+      }
+    }
+    os << "..." << std::endl;
+    return;
+  }
+
+  if (format == OUTPUT_FORMAT_JSON) {
+    os << "{" << std::endl;
+    os << "  \"fingerprints\": {" << std::endl;
+    os << "    \"module\": \"" << ToStringFingerprint(fingerprints[0].module) << "\"," << std::endl;
+    os << "    \"entry_points\": [" << std::endl;
+    for (size_t i = 0; i < fingerprints.size(); ++i) {
+      const SpvReflectEntryPoint& ep = shader_module.entry_points[i];
+      const SpvReflectFingerprints& fp = fingerprints[i];
+      os << "      {" << std::endl;
+      os << "        \"entry_point_name\": \"" << ep.name << "\"," << std::endl;
+      os << "        \"shader_stage\": \"" << ToStringShaderStage(ep.shader_stage) << "\"," << std::endl;
+      os << "        \"push_constants\": \"" << ToStringFingerprint(fp.push_constants) << "\"," << std::endl;
+      os << "        \"vertex_inputs\": \"" << ToStringFingerprint(fp.vertex_inputs) << "\"," << std::endl;
+      os << "        \"descriptor_sets\": [" << std::endl;
+      for (uint32_t j = 0; j < fp.descriptor_set_count; ++j) {
+        os << "          { \"set\": " << fp.descriptor_sets[j].set
+           << ", \"fingerprint\": \"" << ToStringFingerprint(fp.descriptor_sets[j].fingerprint) << "\" }"
+           << ((j + 1) < fp.descriptor_set_count ? "," : "") << std::endl;
+      }
+      os << "        ]" << std::endl;
+      os << "      }" << ((i + 1) < fingerprints.size() ? "," : "") << std::endl;
+    }
+    os << "    ]" << std::endl;
+    os << "  }" << std::endl;
+    os << "}" << std::endl;
+    return;
+  }
+
+  os << "module          : " << ToStringFingerprint(fingerprints[0].module) << "\n";
+  for (size_t i = 0; i < fingerprints.size(); ++i) {
+    const SpvReflectEntryPoint& ep = shader_module.entry_points[i];
+    const SpvReflectFingerprints& fp = fingerprints[i];
+    os << "\n";
+    os << "entry point     : " << ep.name << "\n";
+    os << "shader stage    : " << ToStringShaderStage(ep.shader_stage) << "\n";
+    os << "push constants  : " << ToStringFingerprint(fp.push_constants) << "\n";
+    if (ep.shader_stage == SPV_REFLECT_SHADER_STAGE_VERTEX_BIT) {
+      os << "vertex inputs   : " << ToStringFingerprint(fp.vertex_inputs) << "\n";
+    }
+    for (uint32_t j = 0; j < fp.descriptor_set_count; ++j) {
+      std::stringstream label;
+      label << "set " << fp.descriptor_sets[j].set;
+      os << std::left << std::setw(16) << label.str() << std::right << ": "
+         << ToStringFingerprint(fp.descriptor_sets[j].fingerprint) << "\n";
+    }
+  }
+}
+
+void WriteDescriptorPoolPlan(const SpvReflectDescriptorPoolPlan& plan, OutputFormat format, std::ostream& os)
+{
+  if (format == OUTPUT_FORMAT_YAML) {
+    os << "%YAML 1.0" << std::endl;
+    os << "---" << std::endl;
+    os << "descriptor_pool:" << std::endl;
+    os << "  max_sets: " << plan.max_sets << std::endl;
+    os << "  chunk_max_sets: " << plan.chunk_max_sets << std::endl;
+    os << "  chunk_count: " << plan.chunk_count << std::endl;
+    os << "  pool_sizes:" << std::endl;
+    for (uint32_t i = 0; i < plan.pool_size_count; ++i) {
+      const SpvReflectDescriptorPoolSize& size = plan.pool_sizes[i];
+      os << "    - { descriptor_type: " << size.descriptor_type
+         << ", descriptor_count: " << size.descriptor_count
+         << ", chunk_descriptor_count: " << size.chunk_descriptor_count
+         << ", max_set_count: " << size.max_set_count
+         << " } # " << ToStringDescriptorType(size.descriptor_type) << std::endl;
+    }
+    os << "..." << std::endl;
+    return;
+  }
+
+  if (format == OUTPUT_FORMAT_JSON) {
+    os << "{" << std::endl;
+    os << "  \"descriptor_pool\": {" << std::endl;
+    os << "    \"max_sets\": " << plan.max_sets << "," << std::endl;
+    os << "    \"chunk_max_sets\": " << plan.chunk_max_sets << "," << std::endl;
+    os << "    \"chunk_count\": " << plan.chunk_count << "," << std::endl;
+    os << "    \"pool_sizes\": [" << std::endl;
+    for (uint32_t i = 0; i < plan.pool_size_count; ++i) {
+      const SpvReflectDescriptorPoolSize& size = plan.pool_sizes[i];
+      os << "      { \"descriptor_type\": \"" << ToStringDescriptorType(size.descriptor_type) << "\""
+         << ", \"descriptor_count\": " << size.descriptor_count
+         << ", \"chunk_descriptor_count\": " << size.chunk_descriptor_count
+         << ", \"max_set_count\": " << size.max_set_count << " }"
+         << ((i + 1) < plan.pool_size_count ? "," : "") << std::endl;
+    }
+    os << "    ]" << std::endl;
+    os << "  }" << std::endl;
+    os << "}" << std::endl;
+    return;
+  }
+
+  os << "max sets        : " << plan.max_sets << "\n";
+  os << "chunk max sets  : " << plan.chunk_max_sets << "\n";
+  os << "chunk count     : " << plan.chunk_count << "\n";
+  os << "\n";
+  os << std::left << std::setw(44) << "descriptor type" << std::right
+     << std::setw(10) << "total" << std::setw(10) << "chunk" << std::setw(10) << "per set" << "\n";
+  for (uint32_t i = 0; i < plan.pool_size_count; ++i) {
+    const SpvReflectDescriptorPoolSize& size = plan.pool_sizes[i];
+    os << std::left << std::setw(44) << ToStringDescriptorType(size.descriptor_type) << std::right
+       << std::setw(10) << size.descriptor_count
+       << std::setw(10) << size.chunk_descriptor_count
+       << std::setw(10) << size.max_set_count << "\n";
+  }
+}
+
+void WriteSharedBlockReport(const SpvReflectSharedBlockReport& report, const std::vector<std::string>& module_names,
+                            OutputFormat format, std::ostream& os)
+{
+  auto module_name = [&module_names](uint32_t module_index) -> std::string {
+    return (module_index < module_names.size()) ? module_names[module_index] : std::to_string(module_index);
+  };
+  auto type_name = [](const SpvReflectSharedBlock& block) -> std::string {
+    return (block.type_name != nullptr) ? block.type_name : "";
+  };
+  auto binding_name = [](const SpvReflectSharedBlockBinding& binding) -> std::string {
+    return (binding.name != nullptr) ? binding.name : "";
+  };
+
+  if (format == OUTPUT_FORMAT_YAML) {
+    os << "%YAML 1.0" << std::endl;
+    os << "---" << std::endl;
+    os << "shared_blocks:" << std::endl;
+    for (uint32_t i = 0; i < report.block_count; ++i) {
+      const SpvReflectSharedBlock& block = report.blocks[i];
+      os << "  - type_name: \"" << type_name(block) << "\"" << std::endl;
+      os << "    layout: \"" << ToStringFingerprint(block.layout) << "\"" << std::endl;
+      os << "    descriptor_type: " << block.descriptor_type << " # " << ToStringDescriptorType(block.descriptor_type) << std::endl;
+      os << "    count: " << block.count << std::endl;
+      os << "    size: " << block.size << std::endl;
+      os << "    set: " << block.set << std::endl;
+      os << "    binding: " << block.binding << std::endl;
+      os << "    module_count: " << block.module_count << std::endl;
+      os << "    bindings:" << std::endl;
+      for (uint32_t j = 0; j < block.binding_count; ++j) {
+        const SpvReflectSharedBlockBinding& binding = block.bindings[j];
+        os << "      - { module: \"" << module_name(binding.module_index) << "\""
+           << ", set: " << binding.set << ", binding: " << binding.binding
+           << ", name: \"" << binding_name(binding) << "\" }" << std::endl;
+      }
+    }
+    os << "..." << std::endl;
+    return;
+  }
+
+  if (format == OUTPUT_FORMAT_JSON) {
+    os << "{" << std::endl;
+    os << "  \"shared_blocks\": [" << std::endl;
+    for (uint32_t i = 0; i < report.block_count; ++i) {
+      const SpvReflectSharedBlock& block = report.blocks[i];
+      os << "    {" << std::endl;
+      os << "      \"type_name\": \"" << type_name(block) << "\"," << std::endl;
+      os << "      \"layout\": \"" << ToStringFingerprint(block.layout) << "\"," << std::endl;
+      os << "      \"descriptor_type\": \"" << ToStringDescriptorType(block.descriptor_type) << "\"," << std::endl;
+      os << "      \"count\": " << block.count << "," << std::endl;
+      os << "      \"size\": " << block.size << "," << std::endl;
+      os << "      \"set\": " << block.set << "," << std::endl;
+      os << "      \"binding\": " << block.binding << "," << std::endl;
+      os << "      \"module_count\": " << block.module_count << "," << std::endl;
+      os << "      \"bindings\": [" << std::endl;
+      for (uint32_t j = 0; j < block.binding_count; ++j) {
+        const SpvReflectSharedBlockBinding& binding = block.bindings[j];
+        os << "        { \"module\": \"" << module_name(binding.module_index) << "\""
+           << ", \"set\": " << binding.set << ", \"binding\": " << binding.binding
+           << ", \"name\": \"" << binding_name(binding) << "\" }"
+           << ((j + 1) < block.binding_count ? "," : "") << std::endl;
+      }
+      os << "      ]" << std::endl;
+      os << "    }" << ((i + 1) < report.block_count ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+    return;
+  }
+
+  os << "shared blocks   : " << report.block_count << "\n";
+  for (uint32_t i = 0; i < report.block_count; ++i) {
+    const SpvReflectSharedBlock& block = report.blocks[i];
+    os << "\n";
+    os << "  " << (type_name(block).empty() ? "<unnamed>" : type_name(block))
+       << " (" << ToStringDescriptorType(block.descriptor_type) << ", " << block.size << " bytes)\n";
+    os << "    layout   : " << ToStringFingerprint(block.layout) << "\n";
+    os << "    modules  : " << block.module_count << "\n";
+    os << "    shared at: set " << block.set << ", binding " << block.binding << "\n";
+    for (uint32_t j = 0; j < block.binding_count; ++j) {
+      const SpvReflectSharedBlockBinding& binding = block.bindings[j];
+      os << "    " << binding.set << "." << binding.binding << " " << binding_name(binding)
+         << " in " << module_name(binding.module_index) << "\n";
+    }
+  }
+}
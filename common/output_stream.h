@@ -5,6 +5,7 @@
 #include <map>
 #include <ostream>
 #include <string>
+#include <vector>
 
 std::string ToStringSpvSourceLanguage(SpvSourceLanguage lang);
 std::string ToStringSpvExecutionModel(SpvExecutionModel model);
@@ -24,8 +25,27 @@ std::string ToStringFormat(SpvReflectFormat fmt);
 std::string ToStringComponentType(const SpvReflectTypeDescription& type, uint32_t member_decoration_flags);
 std::string ToStringType(SpvSourceLanguage src_lang, const SpvReflectTypeDescription& type);
 
+enum OutputFormat {
+  OUTPUT_FORMAT_TEXT,
+  OUTPUT_FORMAT_YAML,
+  OUTPUT_FORMAT_JSON,
+};
+
 //std::ostream& operator<<(std::ostream& os, const spv_reflect::ShaderModule& obj);
 void WriteReflection(const spv_reflect::ShaderModule& obj, bool flatten_cbuffers, std::ostream& os);
+void WriteRegisterPressure(const std::vector<SpvReflectRegisterPressure>& reports, bool output_as_yaml, std::ostream& os);
+void WriteInstructionCost(const std::vector<SpvReflectInstructionCostReport>& reports, OutputFormat format, std::ostream& os);
+void WriteHalfPrecision(const std::vector<SpvReflectHalfPrecisionReport>& reports, OutputFormat format, std::ostream& os);
+// max_line_count = 0 writes every line
+void WriteSourceLineCost(const SpvReflectShaderModule& shader_module, const std::vector<SpvReflectSourceLineCostReport>& reports,
+                         uint32_t max_line_count, OutputFormat format, std::ostream& os);
+// fingerprints holds one entry per entry point of shader_module
+void WriteFingerprints(const SpvReflectShaderModule& shader_module, const std::vector<SpvReflectFingerprints>& fingerprints,
+                       OutputFormat format, std::ostream& os);
+void WriteDescriptorPoolPlan(const SpvReflectDescriptorPoolPlan& plan, OutputFormat format, std::ostream& os);
+// module_names holds one entry per module the report was built from
+void WriteSharedBlockReport(const SpvReflectSharedBlockReport& report, const std::vector<std::string>& module_names,
+                            OutputFormat format, std::ostream& os);
 
 class SpvReflectToYaml {
 public:
@@ -20,10 +20,13 @@
   #include <crtdbg.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <memory>
 
 #include "spirv_reflect.h"
 #include "examples/arg_parser.h"
@@ -51,7 +54,75 @@ void PrintUsage()
             << "-e,--entrypoint           Prints the entry point found in shader module." << std::endl
             << "-s,--stage                Prints the Vulkan shader stage found in shader module." << std::endl
             << "-f,--file                 Prints the source file found in shader module." << std::endl
-            << "-fcb,--flatten_cbuffers   Flatten constant buffers on non-YAML output." << std::endl;
+            << "-fcb,--flatten_cbuffers   Flatten constant buffers on non-YAML output." << std::endl
+            << "-ep,--entry_points NAMES  Reflect only the comma separated entry points, and the" << std::endl
+            << "                          resources they use. [default: all entry points]" << std::endl
+            << "-rp,--register_pressure   Prints a register pressure and occupancy estimate for" << std::endl
+            << "                          each entry point. Honors -y." << std::endl
+            << " -rpl REGISTERS           Registers per lane for the occupancy estimate. [default: 256]" << std::endl
+            << " -mw WAVES                Max waves per SIMD for the occupancy estimate. [default: 10]" << std::endl
+            << " -ws LANES                Lanes per wave for the occupancy estimate. [default: 64]" << std::endl
+            << " -sm BYTES                Shared memory per compute unit for the occupancy" << std::endl
+            << "                          estimate. [default: 65536]" << std::endl
+            << "-ic,--instruction_cost    Prints a static instruction cost profile for each entry" << std::endl
+            << "                          point. Honors -y and -j." << std::endl
+            << " -j,--json                Format instruction cost output as JSON. [default: disabled]" << std::endl
+            << " -dtc COUNT               Trip count of loops whose bounds are not constant." << std::endl
+            << "                          [default: 16]" << std::endl
+            << " -cb,--cost_budget COUNT  Fail if an entry point's weighted instruction count" << std::endl
+            << "                          exceeds COUNT." << std::endl
+            << "-hl,--hot_lines           Prints the source lines with the highest instruction" << std::endl
+            << "                          cost for each entry point, using OpLine debug info." << std::endl
+            << "                          Honors -y, -j and -dtc." << std::endl
+            << " -n LINES                 Number of hot lines to print, 0 prints all. [default: 20]" << std::endl
+            << "-hp,--half_precision      Prints the 32-bit float inputs, outputs, variables and" << std::endl
+            << "                          arithmetic chains of each entry point that could be" << std::endl
+            << "                          RelaxedPrecision. Honors -y and -j." << std::endl
+            << " -uo MASK                 Bit mask of output locations written to 8-bit UNORM" << std::endl
+            << "                          attachments. [default: 0]" << std::endl
+            << "-fp,--fingerprint         Prints stable 128-bit fingerprints of the module and of each" << std::endl
+            << "                          entry point's descriptor set, push constant and vertex input" << std::endl
+            << "                          layouts, for use as cache keys. Honors -y and -j." << std::endl
+            << "-dp,--descriptor_pool     Prints descriptor pool capacities for every descriptor set of" << std::endl
+            << "                          all the given modules. Honors -y and -j." << std::endl
+            << " -ipf COUNT               Instances of each set allocated per frame. [default: 1]" << std::endl
+            << " -fif FRAMES              Frames in flight. [default: 2]" << std::endl
+            << " -spc SETS                Sets per pool chunk. [default: one chunk per frame]" << std::endl
+            << " -ras COUNT               Descriptors for each runtime array binding. [default: 1024]" << std::endl
+            << "-sb,--shared_blocks       Prints the uniform and storage buffer blocks that several of" << std::endl
+            << "                          the given modules declare with the same layout, and the" << std::endl
+            << "                          set and binding they could share. Honors -y and -j." << std::endl;
+}
+
+// =================================================================================================
+// LoadShaderModules()
+// =================================================================================================
+bool LoadShaderModules(const std::vector<std::string>& paths, const SpvReflectShaderModuleOptions& options,
+                       std::vector<std::unique_ptr<spv_reflect::ShaderModule>>* p_modules)
+{
+    if (paths.empty()) {
+        std::cerr << "ERROR: no SPIR-V file specified" << std::endl;
+        return false;
+    }
+    for (const std::string& path : paths) {
+        std::ifstream ifs(path.c_str(), std::ios::binary);
+        if (!ifs.is_open()) {
+            std::cerr << "ERROR: could not open '" << path << "' for reading" << std::endl;
+            return false;
+        }
+        std::vector<char> spv_data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        p_modules->emplace_back(new spv_reflect::ShaderModule(spv_data.size(), spv_data.data(), options));
+        if (p_modules->back()->GetResult() == SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND) {
+            std::cerr << "ERROR: '" << path << "' lacks a requested entry point" << std::endl;
+            return false;
+        }
+        if (p_modules->back()->GetResult() != SPV_REFLECT_RESULT_SUCCESS) {
+            std::cerr << "ERROR: could not process '" << path
+                      << "' (is it a valid SPIR-V bytecode?)" << std::endl;
+            return false;
+        }
+    }
+    return true;
 }
 
 // =================================================================================================
@@ -67,6 +138,27 @@ int main(int argn, char** argv)
     arg_parser.AddFlag("s", "stage", "");
     arg_parser.AddFlag("f", "file", "");
     arg_parser.AddFlag("fcb", "flatten_cbuffers", "");
+    arg_parser.AddOptionString("ep", "entry_points", "");
+    arg_parser.AddFlag("rp", "register_pressure", "");
+    arg_parser.AddOptionInt("rpl", "registers_per_lane", "", 0);
+    arg_parser.AddOptionInt("mw", "max_waves", "", 0);
+    arg_parser.AddOptionInt("ws", "wave_size", "", 0);
+    arg_parser.AddOptionInt("sm", "shared_memory", "", 0);
+    arg_parser.AddFlag("ic", "instruction_cost", "");
+    arg_parser.AddFlag("j", "json", "");
+    arg_parser.AddOptionInt("dtc", "default_trip_count", "", 0);
+    arg_parser.AddOptionInt("cb", "cost_budget", "", 0);
+    arg_parser.AddFlag("hl", "hot_lines", "");
+    arg_parser.AddOptionInt("n", "line_count", "", 20);
+    arg_parser.AddFlag("hp", "half_precision", "");
+    arg_parser.AddOptionInt("uo", "unorm_outputs", "", 0);
+    arg_parser.AddFlag("fp", "fingerprint", "");
+    arg_parser.AddFlag("dp", "descriptor_pool", "");
+    arg_parser.AddOptionInt("ipf", "instances_per_frame", "", 1);
+    arg_parser.AddOptionInt("fif", "frames_in_flight", "", 0);
+    arg_parser.AddOptionInt("spc", "sets_per_chunk", "", 0);
+    arg_parser.AddOptionInt("ras", "runtime_array_size", "", 0);
+    arg_parser.AddFlag("sb", "shared_blocks", "");
     if (!arg_parser.Parse(argn, argv, std::cerr)) {
         PrintUsage();
         return EXIT_FAILURE;
@@ -87,6 +179,128 @@ int main(int argn, char** argv)
     bool print_source_file = arg_parser.GetFlag("f", "file");
     bool flatten_cbuffers = arg_parser.GetFlag("fcb", "flatten_cbuffers");
 
+    std::vector<std::string> entry_point_names;
+    std::string entry_points_arg;
+    if (arg_parser.GetString("ep", "entry_points", &entry_points_arg)) {
+        size_t begin = 0;
+        while (begin <= entry_points_arg.size()) {
+            size_t end = std::min(entry_points_arg.find(',', begin), entry_points_arg.size());
+            if (end > begin) {
+                entry_point_names.push_back(entry_points_arg.substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+    }
+    std::vector<const char*> p_entry_point_names;
+    for (const std::string& name : entry_point_names) {
+        p_entry_point_names.push_back(name.c_str());
+    }
+    SpvReflectShaderModuleOptions module_options = {};
+    module_options.entry_point_count = static_cast<uint32_t>(p_entry_point_names.size());
+    module_options.entry_point_names = p_entry_point_names.data();
+    bool print_register_pressure = arg_parser.GetFlag("rp", "register_pressure");
+    bool print_instruction_cost = arg_parser.GetFlag("ic", "instruction_cost");
+    bool output_as_json = arg_parser.GetFlag("j", "json");
+
+    int default_trip_count = 0;
+    arg_parser.GetInt("dtc", "default_trip_count", &default_trip_count);
+    int cost_budget = 0;
+    bool has_cost_budget = arg_parser.GetInt("cb", "cost_budget", &cost_budget);
+    bool print_hot_lines = arg_parser.GetFlag("hl", "hot_lines");
+    int hot_line_count = 20;
+    arg_parser.GetInt("n", "line_count", &hot_line_count);
+    bool print_half_precision = arg_parser.GetFlag("hp", "half_precision");
+    int unorm_output_mask = 0;
+    arg_parser.GetInt("uo", "unorm_outputs", &unorm_output_mask);
+    bool print_fingerprints = arg_parser.GetFlag("fp", "fingerprint");
+    bool print_descriptor_pool = arg_parser.GetFlag("dp", "descriptor_pool");
+    bool print_shared_blocks = arg_parser.GetFlag("sb", "shared_blocks");
+
+    SpvReflectOccupancyBudget occupancy_budget = {};
+    int budget_value = 0;
+    if (arg_parser.GetInt("rpl", "registers_per_lane", &budget_value)) {
+        occupancy_budget.registers_per_lane = static_cast<uint32_t>(budget_value);
+    }
+    if (arg_parser.GetInt("mw", "max_waves", &budget_value)) {
+        occupancy_budget.max_waves_per_simd = static_cast<uint32_t>(budget_value);
+    }
+    if (arg_parser.GetInt("ws", "wave_size", &budget_value)) {
+        occupancy_budget.wave_size = static_cast<uint32_t>(budget_value);
+    }
+    if (arg_parser.GetInt("sm", "shared_memory", &budget_value)) {
+        occupancy_budget.shared_memory_size = static_cast<uint32_t>(budget_value);
+    }
+
+    if (print_descriptor_pool) {
+        int instances_per_frame = 1;
+        arg_parser.GetInt("ipf", "instances_per_frame", &instances_per_frame);
+        SpvReflectDescriptorPoolOptions pool_options = {};
+        int option_value = 0;
+        if (arg_parser.GetInt("fif", "frames_in_flight", &option_value)) {
+            pool_options.frames_in_flight = static_cast<uint32_t>(option_value);
+        }
+        if (arg_parser.GetInt("spc", "sets_per_chunk", &option_value)) {
+            pool_options.sets_per_chunk = static_cast<uint32_t>(option_value);
+        }
+        if (arg_parser.GetInt("ras", "runtime_array_size", &option_value)) {
+            pool_options.runtime_array_size = static_cast<uint32_t>(option_value);
+        }
+
+        std::vector<std::unique_ptr<spv_reflect::ShaderModule>> modules;
+        if (!LoadShaderModules(arg_parser.GetArgs(), module_options, &modules)) {
+            return EXIT_FAILURE;
+        }
+        std::vector<SpvReflectDescriptorSetDemand> demands;
+        for (const std::unique_ptr<spv_reflect::ShaderModule>& shader_module : modules) {
+            const SpvReflectShaderModule& module = shader_module->GetShaderModule();
+            for (uint32_t i = 0; i < module.descriptor_set_count; ++i) {
+                SpvReflectDescriptorSetDemand demand = {};
+                demand.p_module = &module;
+                demand.set = module.descriptor_sets[i].set;
+                demand.instances_per_frame = static_cast<uint32_t>(std::max(instances_per_frame, 0));
+                demands.push_back(demand);
+            }
+        }
+
+        SpvReflectDescriptorPoolPlan plan = {};
+        SpvReflectResult result = spvReflectPlanDescriptorPools(static_cast<uint32_t>(demands.size()),
+                                                                demands.data(), &pool_options, &plan);
+        if (result != SPV_REFLECT_RESULT_SUCCESS) {
+            std::cerr << "ERROR: could not plan descriptor pools" << std::endl;
+            return EXIT_FAILURE;
+        }
+        OutputFormat format = output_as_json ? OUTPUT_FORMAT_JSON
+                                             : (output_as_yaml ? OUTPUT_FORMAT_YAML : OUTPUT_FORMAT_TEXT);
+        WriteDescriptorPoolPlan(plan, format, std::cout);
+        std::cout << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    if (print_shared_blocks) {
+        std::vector<std::unique_ptr<spv_reflect::ShaderModule>> modules;
+        if (!LoadShaderModules(arg_parser.GetArgs(), module_options, &modules)) {
+            return EXIT_FAILURE;
+        }
+        std::vector<const SpvReflectShaderModule*> p_modules;
+        for (const std::unique_ptr<spv_reflect::ShaderModule>& shader_module : modules) {
+            p_modules.push_back(&shader_module->GetShaderModule());
+        }
+
+        SpvReflectSharedBlockReport report = {};
+        SpvReflectResult result = spvReflectFindSharedBlocks(static_cast<uint32_t>(p_modules.size()),
+                                                             p_modules.data(), &report);
+        if (result != SPV_REFLECT_RESULT_SUCCESS) {
+            std::cerr << "ERROR: could not find shared blocks" << std::endl;
+            return EXIT_FAILURE;
+        }
+        OutputFormat format = output_as_json ? OUTPUT_FORMAT_JSON
+                                             : (output_as_yaml ? OUTPUT_FORMAT_YAML : OUTPUT_FORMAT_TEXT);
+        WriteSharedBlockReport(report, arg_parser.GetArgs(), format, std::cout);
+        std::cout << std::endl;
+        spvReflectDestroySharedBlockReport(&report);
+        return EXIT_SUCCESS;
+    }
+
     std::string input_spv_path;
     if (!arg_parser.GetArg(0, &input_spv_path)) {
         std::cerr << "ERROR: no SPIR-V file specified" << std::endl;
@@ -107,14 +321,134 @@ int main(int argn, char** argv)
         std::vector<char> spv_data(size);
         spv_ifstream.read(spv_data.data(), size);
 
-        spv_reflect::ShaderModule reflection(spv_data.size(), spv_data.data());
+        spv_reflect::ShaderModule reflection(spv_data.size(), spv_data.data(), module_options);
+        if (reflection.GetResult() == SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND) {
+            std::cerr << "ERROR: '" << input_spv_path << "' lacks a requested entry point" << std::endl;
+            return EXIT_FAILURE;
+        }
         if (reflection.GetResult() != SPV_REFLECT_RESULT_SUCCESS) {
             std::cerr << "ERROR: could not process '" << input_spv_path
                       << "' (is it a valid SPIR-V bytecode?)" << std::endl;
             return EXIT_FAILURE;
         }
 
-        if (print_entry_point || print_shader_stage || print_source_file) {
+        if (print_register_pressure) {
+            std::vector<SpvReflectRegisterPressure> reports(reflection.GetEntryPointCount());
+            for (uint32_t i = 0; i < reflection.GetEntryPointCount(); ++i) {
+                SpvReflectResult result = reflection.GetEntryPointRegisterPressure(
+                    reflection.GetEntryPointName(i), &occupancy_budget, &reports[i]);
+                if (result != SPV_REFLECT_RESULT_SUCCESS) {
+                    std::cerr << "ERROR: could not estimate register pressure for entry point '"
+                              << reflection.GetEntryPointName(i) << "'" << std::endl;
+                    for (auto& report : reports) {
+                        spvReflectDestroyRegisterPressure(&report);
+                    }
+                    return EXIT_FAILURE;
+                }
+            }
+            WriteRegisterPressure(reports, output_as_yaml, std::cout);
+            std::cout << std::endl;
+            for (auto& report : reports) {
+                spvReflectDestroyRegisterPressure(&report);
+            }
+        }
+        else if (print_instruction_cost) {
+            std::vector<SpvReflectInstructionCostReport> reports(reflection.GetEntryPointCount());
+            for (uint32_t i = 0; i < reflection.GetEntryPointCount(); ++i) {
+                SpvReflectResult result = reflection.GetEntryPointInstructionCost(
+                    reflection.GetEntryPointName(i), static_cast<uint32_t>(default_trip_count), &reports[i]);
+                if (result != SPV_REFLECT_RESULT_SUCCESS) {
+                    std::cerr << "ERROR: could not profile instruction cost for entry point '"
+                              << reflection.GetEntryPointName(i) << "'" << std::endl;
+                    for (auto& report : reports) {
+                        spvReflectDestroyInstructionCostReport(&report);
+                    }
+                    return EXIT_FAILURE;
+                }
+            }
+            OutputFormat format = output_as_json ? OUTPUT_FORMAT_JSON
+                                                 : (output_as_yaml ? OUTPUT_FORMAT_YAML : OUTPUT_FORMAT_TEXT);
+            WriteInstructionCost(reports, format, std::cout);
+            std::cout << std::endl;
+
+            bool over_budget = false;
+            for (auto& report : reports) {
+                if (has_cost_budget && (report.total.instruction_count > static_cast<uint64_t>(cost_budget))) {
+                    std::cerr << "ERROR: entry point '" << report.entry_point_name << "' costs "
+                              << report.total.instruction_count << " instructions, budget is "
+                              << cost_budget << std::endl;
+                    over_budget = true;
+                }
+                spvReflectDestroyInstructionCostReport(&report);
+            }
+            if (over_budget) {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (print_hot_lines) {
+            std::vector<SpvReflectSourceLineCostReport> reports(reflection.GetEntryPointCount());
+            for (uint32_t i = 0; i < reflection.GetEntryPointCount(); ++i) {
+                SpvReflectResult result = reflection.GetEntryPointSourceLineCost(
+                    reflection.GetEntryPointName(i), static_cast<uint32_t>(default_trip_count), &reports[i]);
+                if (result != SPV_REFLECT_RESULT_SUCCESS) {
+                    std::cerr << "ERROR: could not attribute instruction cost to source lines for entry point '"
+                              << reflection.GetEntryPointName(i) << "'" << std::endl;
+                    for (auto& report : reports) {
+                        spvReflectDestroySourceLineCostReport(&report);
+                    }
+                    return EXIT_FAILURE;
+                }
+            }
+            OutputFormat format = output_as_json ? OUTPUT_FORMAT_JSON
+                                                 : (output_as_yaml ? OUTPUT_FORMAT_YAML : OUTPUT_FORMAT_TEXT);
+            WriteSourceLineCost(reflection.GetShaderModule(), reports,
+                                static_cast<uint32_t>(std::max(hot_line_count, 0)), format, std::cout);
+            std::cout << std::endl;
+            for (auto& report : reports) {
+                spvReflectDestroySourceLineCostReport(&report);
+            }
+        }
+        else if (print_half_precision) {
+            SpvReflectHalfPrecisionOptions precision_options = {};
+            precision_options.unorm_output_mask = static_cast<uint32_t>(unorm_output_mask);
+            std::vector<SpvReflectHalfPrecisionReport> reports(reflection.GetEntryPointCount());
+            for (uint32_t i = 0; i < reflection.GetEntryPointCount(); ++i) {
+                SpvReflectResult result = reflection.GetEntryPointHalfPrecision(
+                    reflection.GetEntryPointName(i), &precision_options, &reports[i]);
+                if (result != SPV_REFLECT_RESULT_SUCCESS) {
+                    std::cerr << "ERROR: could not analyze half precision for entry point '"
+                              << reflection.GetEntryPointName(i) << "'" << std::endl;
+                    for (auto& report : reports) {
+                        spvReflectDestroyHalfPrecisionReport(&report);
+                    }
+                    return EXIT_FAILURE;
+                }
+            }
+            OutputFormat format = output_as_json ? OUTPUT_FORMAT_JSON
+                                                 : (output_as_yaml ? OUTPUT_FORMAT_YAML : OUTPUT_FORMAT_TEXT);
+            WriteHalfPrecision(reports, format, std::cout);
+            std::cout << std::endl;
+            for (auto& report : reports) {
+                spvReflectDestroyHalfPrecisionReport(&report);
+            }
+        }
+        else if (print_fingerprints) {
+            std::vector<SpvReflectFingerprints> fingerprints(reflection.GetEntryPointCount());
+            for (uint32_t i = 0; i < reflection.GetEntryPointCount(); ++i) {
+                SpvReflectResult result = reflection.GetEntryPointFingerprints(
+                    reflection.GetEntryPointName(i), &fingerprints[i]);
+                if (result != SPV_REFLECT_RESULT_SUCCESS) {
+                    std::cerr << "ERROR: could not fingerprint entry point '"
+                              << reflection.GetEntryPointName(i) << "'" << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            OutputFormat format = output_as_json ? OUTPUT_FORMAT_JSON
+                                                 : (output_as_yaml ? OUTPUT_FORMAT_YAML : OUTPUT_FORMAT_TEXT);
+            WriteFingerprints(reflection.GetShaderModule(), fingerprints, format, std::cout);
+            std::cout << std::endl;
+        }
+        else if (print_entry_point || print_shader_stage || print_source_file) {
             size_t printed_count = 0;
             if (print_entry_point) {
                 std::cout << reflection.GetEntryPointName();
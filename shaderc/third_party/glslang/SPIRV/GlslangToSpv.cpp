@@ -6032,10 +6032,14 @@ void GlslangToSpv(const glslang::TIntermediate& intermediate, std::vector<unsign
 
     glslang::GetThreadPoolAllocator().push();
 
-    TGlslangToSpvTraverser it(&intermediate, logger, *options);
-    root->traverse(&it);
-    it.finishSpv();
-    it.dumpSpv(spirv);
+    // Scoped so the builder, and the arena holding its instructions, is
+    // released as soon as the binary is written, before optimizing it.
+    {
+        TGlslangToSpvTraverser it(&intermediate, logger, *options);
+        root->traverse(&it);
+        it.finishSpv();
+        it.dumpSpv(spirv);
+    }
 
 #ifdef ENABLE_OPT
     // If from HLSL, run spirv-opt to "legalize" the SPIR-V for Vulkan
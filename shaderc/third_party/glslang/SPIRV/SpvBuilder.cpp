@@ -80,7 +80,7 @@ Builder::~Builder()
 
 Id Builder::import(const char* name)
 {
-    Instruction* import = new Instruction(getUniqueId(), NoType, OpExtInstImport);
+    Instruction* import = module.newInstruction(getUniqueId(), NoType, OpExtInstImport);
     import->addStringOperand(name);
 
     imports.push_back(std::unique_ptr<Instruction>(import));
@@ -100,7 +100,7 @@ void Builder::setLine(int lineNum)
 
 void Builder::addLine(Id fileName, int lineNum, int column)
 {
-    Instruction* line = new Instruction(OpLine);
+    Instruction* line = module.newInstruction(OpLine);
     line->addIdOperand(fileName);
     line->addImmediateOperand(lineNum);
     line->addImmediateOperand(column);
@@ -112,7 +112,7 @@ Id Builder::makeVoidType()
 {
     Instruction* type;
     if (groupedTypes[OpTypeVoid].size() == 0) {
-        type = new Instruction(getUniqueId(), NoType, OpTypeVoid);
+        type = module.newInstruction(getUniqueId(), NoType, OpTypeVoid);
         groupedTypes[OpTypeVoid].push_back(type);
         constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(type));
         module.mapInstruction(type);
@@ -126,7 +126,7 @@ Id Builder::makeBoolType()
 {
     Instruction* type;
     if (groupedTypes[OpTypeBool].size() == 0) {
-        type = new Instruction(getUniqueId(), NoType, OpTypeBool);
+        type = module.newInstruction(getUniqueId(), NoType, OpTypeBool);
         groupedTypes[OpTypeBool].push_back(type);
         constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(type));
         module.mapInstruction(type);
@@ -140,7 +140,7 @@ Id Builder::makeSamplerType()
 {
     Instruction* type;
     if (groupedTypes[OpTypeSampler].size() == 0) {
-        type = new Instruction(getUniqueId(), NoType, OpTypeSampler);
+        type = module.newInstruction(getUniqueId(), NoType, OpTypeSampler);
         groupedTypes[OpTypeSampler].push_back(type);
         constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(type));
         module.mapInstruction(type);
@@ -162,7 +162,7 @@ Id Builder::makePointer(StorageClass storageClass, Id pointee)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypePointer);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypePointer);
     type->addImmediateOperand(storageClass);
     type->addIdOperand(pointee);
     groupedTypes[OpTypePointer].push_back(type);
@@ -184,7 +184,7 @@ Id Builder::makeIntegerType(int width, bool hasSign)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeInt);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeInt);
     type->addImmediateOperand(width);
     type->addImmediateOperand(hasSign ? 1 : 0);
     groupedTypes[OpTypeInt].push_back(type);
@@ -217,7 +217,7 @@ Id Builder::makeFloatType(int width)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeFloat);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeFloat);
     type->addImmediateOperand(width);
     groupedTypes[OpTypeFloat].push_back(type);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(type));
@@ -248,7 +248,7 @@ Id Builder::makeStructType(const std::vector<Id>& members, const char* name)
     // structs can be duplicated except for decorations.
 
     // not found, make it
-    Instruction* type = new Instruction(getUniqueId(), NoType, OpTypeStruct);
+    Instruction* type = module.newInstruction(getUniqueId(), NoType, OpTypeStruct);
     for (int op = 0; op < (int)members.size(); ++op)
         type->addIdOperand(members[op]);
     groupedTypes[OpTypeStruct].push_back(type);
@@ -295,7 +295,7 @@ Id Builder::makeVectorType(Id component, int size)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeVector);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeVector);
     type->addIdOperand(component);
     type->addImmediateOperand(size);
     groupedTypes[OpTypeVector].push_back(type);
@@ -321,7 +321,7 @@ Id Builder::makeMatrixType(Id component, int cols, int rows)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeMatrix);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeMatrix);
     type->addIdOperand(column);
     type->addImmediateOperand(cols);
     groupedTypes[OpTypeMatrix].push_back(type);
@@ -349,7 +349,7 @@ Id Builder::makeArrayType(Id element, Id sizeId, int stride)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeArray);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeArray);
     type->addIdOperand(element);
     type->addIdOperand(sizeId);
     groupedTypes[OpTypeArray].push_back(type);
@@ -361,7 +361,7 @@ Id Builder::makeArrayType(Id element, Id sizeId, int stride)
 
 Id Builder::makeRuntimeArray(Id element)
 {
-    Instruction* type = new Instruction(getUniqueId(), NoType, OpTypeRuntimeArray);
+    Instruction* type = module.newInstruction(getUniqueId(), NoType, OpTypeRuntimeArray);
     type->addIdOperand(element);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(type));
     module.mapInstruction(type);
@@ -389,7 +389,7 @@ Id Builder::makeFunctionType(Id returnType, const std::vector<Id>& paramTypes)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeFunction);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeFunction);
     type->addIdOperand(returnType);
     for (int p = 0; p < (int)paramTypes.size(); ++p)
         type->addIdOperand(paramTypes[p]);
@@ -419,7 +419,7 @@ Id Builder::makeImageType(Id sampledType, Dim dim, bool depth, bool arrayed, boo
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeImage);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeImage);
     type->addIdOperand(sampledType);
     type->addImmediateOperand(   dim);
     type->addImmediateOperand(  depth ? 1 : 0);
@@ -492,7 +492,7 @@ Id Builder::makeSampledImageType(Id imageType)
     }
 
     // not found, make it
-    type = new Instruction(getUniqueId(), NoType, OpTypeSampledImage);
+    type = module.newInstruction(getUniqueId(), NoType, OpTypeSampledImage);
     type->addIdOperand(imageType);
 
     groupedTypes[OpTypeSampledImage].push_back(type);
@@ -711,7 +711,7 @@ Id Builder::makeBoolConstant(bool b, bool specConstant)
     }
 
     // Make it
-    Instruction* c = new Instruction(getUniqueId(), typeId, opcode);
+    Instruction* c = module.newInstruction(getUniqueId(), typeId, opcode);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(c));
     groupedConstants[OpTypeBool].push_back(c);
     module.mapInstruction(c);
@@ -731,7 +731,7 @@ Id Builder::makeIntConstant(Id typeId, unsigned value, bool specConstant)
             return existing;
     }
 
-    Instruction* c = new Instruction(getUniqueId(), typeId, opcode);
+    Instruction* c = module.newInstruction(getUniqueId(), typeId, opcode);
     c->addImmediateOperand(value);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(c));
     groupedConstants[OpTypeInt].push_back(c);
@@ -755,7 +755,7 @@ Id Builder::makeInt64Constant(Id typeId, unsigned long long value, bool specCons
             return existing;
     }
 
-    Instruction* c = new Instruction(getUniqueId(), typeId, opcode);
+    Instruction* c = module.newInstruction(getUniqueId(), typeId, opcode);
     c->addImmediateOperand(op1);
     c->addImmediateOperand(op2);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(c));
@@ -781,7 +781,7 @@ Id Builder::makeFloatConstant(float f, bool specConstant)
             return existing;
     }
 
-    Instruction* c = new Instruction(getUniqueId(), typeId, opcode);
+    Instruction* c = module.newInstruction(getUniqueId(), typeId, opcode);
     c->addImmediateOperand(value);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(c));
     groupedConstants[OpTypeFloat].push_back(c);
@@ -808,7 +808,7 @@ Id Builder::makeDoubleConstant(double d, bool specConstant)
             return existing;
     }
 
-    Instruction* c = new Instruction(getUniqueId(), typeId, opcode);
+    Instruction* c = module.newInstruction(getUniqueId(), typeId, opcode);
     c->addImmediateOperand(op1);
     c->addImmediateOperand(op2);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(c));
@@ -838,7 +838,7 @@ Id Builder::makeFloat16Constant(float f16, bool specConstant)
             return existing;
     }
 
-    Instruction* c = new Instruction(getUniqueId(), typeId, opcode);
+    Instruction* c = module.newInstruction(getUniqueId(), typeId, opcode);
     c->addImmediateOperand(value);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(c));
     groupedConstants[OpTypeFloat].push_back(c);
@@ -900,7 +900,7 @@ Id Builder::makeCompositeConstant(Id typeId, const std::vector<Id>& members, boo
             return existing;
     }
 
-    Instruction* c = new Instruction(getUniqueId(), typeId, opcode);
+    Instruction* c = module.newInstruction(getUniqueId(), typeId, opcode);
     for (int op = 0; op < (int)members.size(); ++op)
         c->addIdOperand(members[op]);
     constantsTypesGlobals.push_back(std::unique_ptr<Instruction>(c));
@@ -912,7 +912,7 @@ Id Builder::makeCompositeConstant(Id typeId, const std::vector<Id>& members, boo
 
 Instruction* Builder::addEntryPoint(ExecutionModel model, Function* function, const char* name)
 {
-    Instruction* entryPoint = new Instruction(OpEntryPoint);
+    Instruction* entryPoint = module.newInstruction(OpEntryPoint);
     entryPoint->addImmediateOperand(model);
     entryPoint->addIdOperand(function->getId());
     entryPoint->addStringOperand(name);
@@ -925,7 +925,7 @@ Instruction* Builder::addEntryPoint(ExecutionModel model, Function* function, co
 // Currently relying on the fact that all 'value' of interest are small non-negative values.
 void Builder::addExecutionMode(Function* entryPoint, ExecutionMode mode, int value1, int value2, int value3)
 {
-    Instruction* instr = new Instruction(OpExecutionMode);
+    Instruction* instr = module.newInstruction(OpExecutionMode);
     instr->addIdOperand(entryPoint->getId());
     instr->addImmediateOperand(mode);
     if (value1 >= 0)
@@ -940,7 +940,7 @@ void Builder::addExecutionMode(Function* entryPoint, ExecutionMode mode, int val
 
 void Builder::addName(Id id, const char* string)
 {
-    Instruction* name = new Instruction(OpName);
+    Instruction* name = module.newInstruction(OpName);
     name->addIdOperand(id);
     name->addStringOperand(string);
 
@@ -949,7 +949,7 @@ void Builder::addName(Id id, const char* string)
 
 void Builder::addMemberName(Id id, int memberNumber, const char* string)
 {
-    Instruction* name = new Instruction(OpMemberName);
+    Instruction* name = module.newInstruction(OpMemberName);
     name->addIdOperand(id);
     name->addImmediateOperand(memberNumber);
     name->addStringOperand(string);
@@ -961,7 +961,7 @@ void Builder::addDecoration(Id id, Decoration decoration, int num)
 {
     if (decoration == spv::DecorationMax)
         return;
-    Instruction* dec = new Instruction(OpDecorate);
+    Instruction* dec = module.newInstruction(OpDecorate);
     dec->addIdOperand(id);
     dec->addImmediateOperand(decoration);
     if (num >= 0)
@@ -972,7 +972,7 @@ void Builder::addDecoration(Id id, Decoration decoration, int num)
 
 void Builder::addMemberDecoration(Id id, unsigned int member, Decoration decoration, int num)
 {
-    Instruction* dec = new Instruction(OpMemberDecorate);
+    Instruction* dec = module.newInstruction(OpMemberDecorate);
     dec->addIdOperand(id);
     dec->addImmediateOperand(member);
     dec->addImmediateOperand(decoration);
@@ -1031,11 +1031,11 @@ Function* Builder::makeFunctionEntry(Decoration precision, Id returnType, const
 void Builder::makeReturn(bool implicit, Id retVal)
 {
     if (retVal) {
-        Instruction* inst = new Instruction(NoResult, NoType, OpReturnValue);
+        Instruction* inst = module.newInstruction(NoResult, NoType, OpReturnValue);
         inst->addIdOperand(retVal);
         buildPoint->addInstruction(std::unique_ptr<Instruction>(inst));
     } else
-        buildPoint->addInstruction(std::unique_ptr<Instruction>(new Instruction(NoResult, NoType, OpReturn)));
+        buildPoint->addInstruction(std::unique_ptr<Instruction>(module.newInstruction(NoResult, NoType, OpReturn)));
 
     if (! implicit)
         createAndSetNoPredecessorBlock("post-return");
@@ -1061,7 +1061,7 @@ void Builder::leaveFunction()
 // Comments in header
 void Builder::makeDiscard()
 {
-    buildPoint->addInstruction(std::unique_ptr<Instruction>(new Instruction(OpKill)));
+    buildPoint->addInstruction(std::unique_ptr<Instruction>(module.newInstruction(OpKill)));
     createAndSetNoPredecessorBlock("post-discard");
 }
 
@@ -1069,7 +1069,7 @@ void Builder::makeDiscard()
 Id Builder::createVariable(StorageClass storageClass, Id type, const char* name)
 {
     Id pointerType = makePointer(storageClass, type);
-    Instruction* inst = new Instruction(getUniqueId(), pointerType, OpVariable);
+    Instruction* inst = module.newInstruction(getUniqueId(), pointerType, OpVariable);
     inst->addImmediateOperand(storageClass);
 
     switch (storageClass) {
@@ -1093,7 +1093,7 @@ Id Builder::createVariable(StorageClass storageClass, Id type, const char* name)
 // Comments in header
 Id Builder::createUndefined(Id type)
 {
-  Instruction* inst = new Instruction(getUniqueId(), type, OpUndef);
+  Instruction* inst = module.newInstruction(getUniqueId(), type, OpUndef);
   buildPoint->addInstruction(std::unique_ptr<Instruction>(inst));
   return inst->getResultId();
 }
@@ -1101,7 +1101,7 @@ Id Builder::createUndefined(Id type)
 // Comments in header
 void Builder::createStore(Id rValue, Id lValue)
 {
-    Instruction* store = new Instruction(OpStore);
+    Instruction* store = module.newInstruction(OpStore);
     store->addIdOperand(lValue);
     store->addIdOperand(rValue);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(store));
@@ -1110,7 +1110,7 @@ void Builder::createStore(Id rValue, Id lValue)
 // Comments in header
 Id Builder::createLoad(Id lValue)
 {
-    Instruction* load = new Instruction(getUniqueId(), getDerefTypeId(lValue), OpLoad);
+    Instruction* load = module.newInstruction(getUniqueId(), getDerefTypeId(lValue), OpLoad);
     load->addIdOperand(lValue);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(load));
 
@@ -1134,7 +1134,7 @@ Id Builder::createAccessChain(StorageClass storageClass, Id base, const std::vec
     typeId = makePointer(storageClass, typeId);
 
     // Make the instruction
-    Instruction* chain = new Instruction(getUniqueId(), typeId, OpAccessChain);
+    Instruction* chain = module.newInstruction(getUniqueId(), typeId, OpAccessChain);
     chain->addIdOperand(base);
     for (int i = 0; i < (int)offsets.size(); ++i)
         chain->addIdOperand(offsets[i]);
@@ -1146,7 +1146,7 @@ Id Builder::createAccessChain(StorageClass storageClass, Id base, const std::vec
 Id Builder::createArrayLength(Id base, unsigned int member)
 {
     spv::Id intType = makeIntType(32);
-    Instruction* length = new Instruction(getUniqueId(), intType, OpArrayLength);
+    Instruction* length = module.newInstruction(getUniqueId(), intType, OpArrayLength);
     length->addIdOperand(base);
     length->addImmediateOperand(member);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(length));
@@ -1161,7 +1161,7 @@ Id Builder::createCompositeExtract(Id composite, Id typeId, unsigned index)
     if (generatingOpCodeForSpecConst) {
         return createSpecConstantOp(OpCompositeExtract, typeId, std::vector<Id>(1, composite), std::vector<Id>(1, index));
     }
-    Instruction* extract = new Instruction(getUniqueId(), typeId, OpCompositeExtract);
+    Instruction* extract = module.newInstruction(getUniqueId(), typeId, OpCompositeExtract);
     extract->addIdOperand(composite);
     extract->addImmediateOperand(index);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(extract));
@@ -1176,7 +1176,7 @@ Id Builder::createCompositeExtract(Id composite, Id typeId, const std::vector<un
     if (generatingOpCodeForSpecConst) {
         return createSpecConstantOp(OpCompositeExtract, typeId, std::vector<Id>(1, composite), indexes);
     }
-    Instruction* extract = new Instruction(getUniqueId(), typeId, OpCompositeExtract);
+    Instruction* extract = module.newInstruction(getUniqueId(), typeId, OpCompositeExtract);
     extract->addIdOperand(composite);
     for (int i = 0; i < (int)indexes.size(); ++i)
         extract->addImmediateOperand(indexes[i]);
@@ -1187,7 +1187,7 @@ Id Builder::createCompositeExtract(Id composite, Id typeId, const std::vector<un
 
 Id Builder::createCompositeInsert(Id object, Id composite, Id typeId, unsigned index)
 {
-    Instruction* insert = new Instruction(getUniqueId(), typeId, OpCompositeInsert);
+    Instruction* insert = module.newInstruction(getUniqueId(), typeId, OpCompositeInsert);
     insert->addIdOperand(object);
     insert->addIdOperand(composite);
     insert->addImmediateOperand(index);
@@ -1198,7 +1198,7 @@ Id Builder::createCompositeInsert(Id object, Id composite, Id typeId, unsigned i
 
 Id Builder::createCompositeInsert(Id object, Id composite, Id typeId, const std::vector<unsigned>& indexes)
 {
-    Instruction* insert = new Instruction(getUniqueId(), typeId, OpCompositeInsert);
+    Instruction* insert = module.newInstruction(getUniqueId(), typeId, OpCompositeInsert);
     insert->addIdOperand(object);
     insert->addIdOperand(composite);
     for (int i = 0; i < (int)indexes.size(); ++i)
@@ -1210,7 +1210,7 @@ Id Builder::createCompositeInsert(Id object, Id composite, Id typeId, const std:
 
 Id Builder::createVectorExtractDynamic(Id vector, Id typeId, Id componentIndex)
 {
-    Instruction* extract = new Instruction(getUniqueId(), typeId, OpVectorExtractDynamic);
+    Instruction* extract = module.newInstruction(getUniqueId(), typeId, OpVectorExtractDynamic);
     extract->addIdOperand(vector);
     extract->addIdOperand(componentIndex);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(extract));
@@ -1220,7 +1220,7 @@ Id Builder::createVectorExtractDynamic(Id vector, Id typeId, Id componentIndex)
 
 Id Builder::createVectorInsertDynamic(Id vector, Id typeId, Id component, Id componentIndex)
 {
-    Instruction* insert = new Instruction(getUniqueId(), typeId, OpVectorInsertDynamic);
+    Instruction* insert = module.newInstruction(getUniqueId(), typeId, OpVectorInsertDynamic);
     insert->addIdOperand(vector);
     insert->addIdOperand(component);
     insert->addIdOperand(componentIndex);
@@ -1232,14 +1232,14 @@ Id Builder::createVectorInsertDynamic(Id vector, Id typeId, Id component, Id com
 // An opcode that has no operands, no result id, and no type
 void Builder::createNoResultOp(Op opCode)
 {
-    Instruction* op = new Instruction(opCode);
+    Instruction* op = module.newInstruction(opCode);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
 }
 
 // An opcode that has one operand, no result id, and no type
 void Builder::createNoResultOp(Op opCode, Id operand)
 {
-    Instruction* op = new Instruction(opCode);
+    Instruction* op = module.newInstruction(opCode);
     op->addIdOperand(operand);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
 }
@@ -1247,7 +1247,7 @@ void Builder::createNoResultOp(Op opCode, Id operand)
 // An opcode that has one operand, no result id, and no type
 void Builder::createNoResultOp(Op opCode, const std::vector<Id>& operands)
 {
-    Instruction* op = new Instruction(opCode);
+    Instruction* op = module.newInstruction(opCode);
     for (auto it = operands.cbegin(); it != operands.cend(); ++it)
         op->addIdOperand(*it);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
@@ -1255,7 +1255,7 @@ void Builder::createNoResultOp(Op opCode, const std::vector<Id>& operands)
 
 void Builder::createControlBarrier(Scope execution, Scope memory, MemorySemanticsMask semantics)
 {
-    Instruction* op = new Instruction(OpControlBarrier);
+    Instruction* op = module.newInstruction(OpControlBarrier);
     op->addImmediateOperand(makeUintConstant(execution));
     op->addImmediateOperand(makeUintConstant(memory));
     op->addImmediateOperand(makeUintConstant(semantics));
@@ -1264,7 +1264,7 @@ void Builder::createControlBarrier(Scope execution, Scope memory, MemorySemantic
 
 void Builder::createMemoryBarrier(unsigned executionScope, unsigned memorySemantics)
 {
-    Instruction* op = new Instruction(OpMemoryBarrier);
+    Instruction* op = module.newInstruction(OpMemoryBarrier);
     op->addImmediateOperand(makeUintConstant(executionScope));
     op->addImmediateOperand(makeUintConstant(memorySemantics));
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
@@ -1278,7 +1278,7 @@ Id Builder::createUnaryOp(Op opCode, Id typeId, Id operand)
     if (generatingOpCodeForSpecConst) {
         return createSpecConstantOp(opCode, typeId, std::vector<Id>(1, operand), std::vector<Id>());
     }
-    Instruction* op = new Instruction(getUniqueId(), typeId, opCode);
+    Instruction* op = module.newInstruction(getUniqueId(), typeId, opCode);
     op->addIdOperand(operand);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
 
@@ -1294,7 +1294,7 @@ Id Builder::createBinOp(Op opCode, Id typeId, Id left, Id right)
         operands[0] = left; operands[1] = right;
         return createSpecConstantOp(opCode, typeId, operands, std::vector<Id>());
     }
-    Instruction* op = new Instruction(getUniqueId(), typeId, opCode);
+    Instruction* op = module.newInstruction(getUniqueId(), typeId, opCode);
     op->addIdOperand(left);
     op->addIdOperand(right);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
@@ -1314,7 +1314,7 @@ Id Builder::createTriOp(Op opCode, Id typeId, Id op1, Id op2, Id op3)
         return createSpecConstantOp(
             opCode, typeId, operands, std::vector<Id>());
     }
-    Instruction* op = new Instruction(getUniqueId(), typeId, opCode);
+    Instruction* op = module.newInstruction(getUniqueId(), typeId, opCode);
     op->addIdOperand(op1);
     op->addIdOperand(op2);
     op->addIdOperand(op3);
@@ -1325,7 +1325,7 @@ Id Builder::createTriOp(Op opCode, Id typeId, Id op1, Id op2, Id op3)
 
 Id Builder::createOp(Op opCode, Id typeId, const std::vector<Id>& operands)
 {
-    Instruction* op = new Instruction(getUniqueId(), typeId, opCode);
+    Instruction* op = module.newInstruction(getUniqueId(), typeId, opCode);
     for (auto it = operands.cbegin(); it != operands.cend(); ++it)
         op->addIdOperand(*it);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
@@ -1335,7 +1335,7 @@ Id Builder::createOp(Op opCode, Id typeId, const std::vector<Id>& operands)
 
 Id Builder::createSpecConstantOp(Op opCode, Id typeId, const std::vector<Id>& operands, const std::vector<unsigned>& literals)
 {
-    Instruction* op = new Instruction(getUniqueId(), typeId, OpSpecConstantOp);
+    Instruction* op = module.newInstruction(getUniqueId(), typeId, OpSpecConstantOp);
     op->addImmediateOperand((unsigned) opCode);
     for (auto it = operands.cbegin(); it != operands.cend(); ++it)
         op->addIdOperand(*it);
@@ -1349,7 +1349,7 @@ Id Builder::createSpecConstantOp(Op opCode, Id typeId, const std::vector<Id>& op
 
 Id Builder::createFunctionCall(spv::Function* function, const std::vector<spv::Id>& args)
 {
-    Instruction* op = new Instruction(getUniqueId(), function->getReturnType(), OpFunctionCall);
+    Instruction* op = module.newInstruction(getUniqueId(), function->getReturnType(), OpFunctionCall);
     op->addIdOperand(function->getId());
     for (int a = 0; a < (int)args.size(); ++a)
         op->addIdOperand(args[a]);
@@ -1369,7 +1369,7 @@ Id Builder::createRvalueSwizzle(Decoration precision, Id typeId, Id source, cons
         operands[0] = operands[1] = source;
         return setPrecision(createSpecConstantOp(OpVectorShuffle, typeId, operands, channels), precision);
     }
-    Instruction* swizzle = new Instruction(getUniqueId(), typeId, OpVectorShuffle);
+    Instruction* swizzle = module.newInstruction(getUniqueId(), typeId, OpVectorShuffle);
     assert(isVector(source));
     swizzle->addIdOperand(source);
     swizzle->addIdOperand(source);
@@ -1386,7 +1386,7 @@ Id Builder::createLvalueSwizzle(Id typeId, Id target, Id source, const std::vect
     if (channels.size() == 1 && getNumComponents(source) == 1)
         return createCompositeInsert(source, target, typeId, channels.front());
 
-    Instruction* swizzle = new Instruction(getUniqueId(), typeId, OpVectorShuffle);
+    Instruction* swizzle = module.newInstruction(getUniqueId(), typeId, OpVectorShuffle);
     assert(isVector(target));
     swizzle->addIdOperand(target);
     if (accessChain.component != NoResult)
@@ -1457,7 +1457,7 @@ Id Builder::smearScalar(Decoration precision, Id scalar, Id vectorType)
         auto result_id = makeCompositeConstant(vectorType, members, isSpecConstant(scalar));
         smear = module.getInstruction(result_id);
     } else {
-        smear = new Instruction(getUniqueId(), vectorType, OpCompositeConstruct);
+        smear = module.newInstruction(getUniqueId(), vectorType, OpCompositeConstruct);
         for (int c = 0; c < numComponents; ++c)
             smear->addIdOperand(scalar);
         buildPoint->addInstruction(std::unique_ptr<Instruction>(smear));
@@ -1469,7 +1469,7 @@ Id Builder::smearScalar(Decoration precision, Id scalar, Id vectorType)
 // Comments in header
 Id Builder::createBuiltinCall(Id resultType, Id builtins, int entryPoint, const std::vector<Id>& args)
 {
-    Instruction* inst = new Instruction(getUniqueId(), resultType, OpExtInst);
+    Instruction* inst = module.newInstruction(getUniqueId(), resultType, OpExtInst);
     inst->addIdOperand(builtins);
     inst->addImmediateOperand(entryPoint);
     for (int arg = 0; arg < (int)args.size(); ++arg)
@@ -1651,7 +1651,7 @@ Id Builder::createTextureCall(Decoration precision, Id resultType, bool sparse,
     }
 
     // Build the SPIR-V instruction
-    Instruction* textureInst = new Instruction(getUniqueId(), resultType, opCode);
+    Instruction* textureInst = module.newInstruction(getUniqueId(), resultType, opCode);
     for (int op = 0; op < optArgNum; ++op)
         textureInst->addIdOperand(texArgs[op]);
     if (optArgNum < numArgs)
@@ -1736,7 +1736,7 @@ Id Builder::createTextureQueryCall(Op opCode, const TextureParameters& parameter
         break;
     }
 
-    Instruction* query = new Instruction(getUniqueId(), resultType, opCode);
+    Instruction* query = module.newInstruction(getUniqueId(), resultType, opCode);
     query->addIdOperand(parameters.sampler);
     if (parameters.coords)
         query->addIdOperand(parameters.coords);
@@ -1835,7 +1835,7 @@ Id Builder::createCompositeConstruct(Id typeId, const std::vector<Id>& constitue
                                                  [&](spv::Id id) { return isSpecConstant(id); }));
     }
 
-    Instruction* op = new Instruction(getUniqueId(), typeId, OpCompositeConstruct);
+    Instruction* op = module.newInstruction(getUniqueId(), typeId, OpCompositeConstruct);
     for (int c = 0; c < (int)constituents.size(); ++c)
         op->addIdOperand(constituents[c]);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(op));
@@ -2089,7 +2089,7 @@ void Builder::makeSwitch(Id selector, unsigned int control, int numSegments, con
     createSelectionMerge(mergeBlock, control);
 
     // make the switch instruction
-    Instruction* switchInst = new Instruction(NoResult, NoType, OpSwitch);
+    Instruction* switchInst = module.newInstruction(NoResult, NoType, OpSwitch);
     switchInst->addIdOperand(selector);
     auto defaultOrMerge = (defaultSegment >= 0) ? segmentBlocks[defaultSegment] : mergeBlock;
     switchInst->addIdOperand(defaultOrMerge->getId());
@@ -2558,7 +2558,7 @@ void Builder::createAndSetNoPredecessorBlock(const char* /*name*/)
 // Comments in header
 void Builder::createBranch(Block* block)
 {
-    Instruction* branch = new Instruction(OpBranch);
+    Instruction* branch = module.newInstruction(OpBranch);
     branch->addIdOperand(block->getId());
     buildPoint->addInstruction(std::unique_ptr<Instruction>(branch));
     block->addPredecessor(buildPoint);
@@ -2566,7 +2566,7 @@ void Builder::createBranch(Block* block)
 
 void Builder::createSelectionMerge(Block* mergeBlock, unsigned int control)
 {
-    Instruction* merge = new Instruction(OpSelectionMerge);
+    Instruction* merge = module.newInstruction(OpSelectionMerge);
     merge->addIdOperand(mergeBlock->getId());
     merge->addImmediateOperand(control);
     buildPoint->addInstruction(std::unique_ptr<Instruction>(merge));
@@ -2574,7 +2574,7 @@ void Builder::createSelectionMerge(Block* mergeBlock, unsigned int control)
 
 void Builder::createLoopMerge(Block* mergeBlock, Block* continueBlock, unsigned int control)
 {
-    Instruction* merge = new Instruction(OpLoopMerge);
+    Instruction* merge = module.newInstruction(OpLoopMerge);
     merge->addIdOperand(mergeBlock->getId());
     merge->addIdOperand(continueBlock->getId());
     merge->addImmediateOperand(control);
@@ -2583,7 +2583,7 @@ void Builder::createLoopMerge(Block* mergeBlock, Block* continueBlock, unsigned
 
 void Builder::createConditionalBranch(Id condition, Block* thenBlock, Block* elseBlock)
 {
-    Instruction* branch = new Instruction(OpBranchConditional);
+    Instruction* branch = module.newInstruction(OpBranchConditional);
     branch->addIdOperand(condition);
     branch->addIdOperand(thenBlock->getId());
     branch->addIdOperand(elseBlock->getId());
@@ -72,7 +72,7 @@ public:
     }
     void setSourceFile(const std::string& file)
     {
-        Instruction* fileString = new Instruction(getUniqueId(), NoType, OpString);
+        Instruction* fileString = module.newInstruction(getUniqueId(), NoType, OpString);
         fileString->addStringOperand(file.c_str());
         sourceFileStringId = fileString->getResultId();
         strings.push_back(std::unique_ptr<Instruction>(fileString));
@@ -559,6 +559,9 @@ public:
     void eliminateDeadDecorations();
     void dump(std::vector<unsigned int>&) const;
 
+    // The arena holding the module's instructions, e.g. to read its counters.
+    const Arena& getArena() const { return module.getArena(); }
+
     void createBranch(Block* block);
     void createConditionalBranch(Id condition, Block* thenBlock, Block* elseBlock);
     void createLoopMerge(Block* mergeBlock, Block* continueBlock, unsigned int control);
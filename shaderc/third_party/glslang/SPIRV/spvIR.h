@@ -50,6 +50,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -82,15 +83,154 @@ const MemorySemanticsMask MemorySemanticsAllMemory =
                                       MemorySemanticsAtomicCounterMemoryMask |
                                       MemorySemanticsImageMemoryMask);
 
+//
+// Memory arena for the instructions of a module and their operands.
+//
+// Allocation bumps a pointer through large blocks, and nothing is given back
+// until the whole arena is released, which the module does when it is
+// destroyed.  This replaces many small heap allocations per instruction with
+// a few large ones.
+//
+
+class Arena {
+public:
+    Arena() : next(nullptr), remaining(0), allocationCount(0), allocatedBytes(0), reservedBytes(0) { }
+    ~Arena() { release(); }
+
+    void* allocate(size_t size)
+    {
+        size = (size + Alignment - 1) & ~(size_t)(Alignment - 1);
+        if (size > remaining)
+            addBlock(size);
+        void* memory = next;
+        next += size;
+        remaining -= size;
+        ++allocationCount;
+        allocatedBytes += size;
+        return memory;
+    }
+
+    // Frees all the memory of the arena at once.  Nothing allocated from it
+    // may be used afterwards.
+    void release()
+    {
+        for (int b = 0; b < (int)blocks.size(); ++b)
+            delete [] blocks[b];
+        blocks.clear();
+        next = nullptr;
+        remaining = 0;
+        reservedBytes = 0;
+    }
+
+    // Number of allocations and bytes handed out since the arena was created.
+    size_t getAllocationCount() const { return allocationCount; }
+    size_t getAllocatedBytes() const { return allocatedBytes; }
+    // Number of blocks and bytes currently taken from the heap.
+    size_t getBlockCount() const { return blocks.size(); }
+    size_t getReservedBytes() const { return reservedBytes; }
+
+protected:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    enum {
+        Alignment = 8,
+        DefaultBlockSize = 64 * 1024
+    };
+
+    void addBlock(size_t size)
+    {
+        size_t blockSize = size > DefaultBlockSize ? size : (size_t)DefaultBlockSize;
+        blocks.push_back(new char[blockSize]);
+        next = blocks.back();
+        remaining = blockSize;
+        reservedBytes += blockSize;
+    }
+
+    std::vector<char*> blocks;
+    char* next;
+    size_t remaining;
+    size_t allocationCount;
+    size_t allocatedBytes;
+    size_t reservedBytes;
+};
+
+//
+// STL allocator taking its memory from an arena.  Without an arena it uses
+// the heap, so that instructions built on the stack keep working.
+//
+
+template<class T>
+class ArenaAllocator {
+public:
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T value_type;
+    template<class Other>
+        struct rebind {
+            typedef ArenaAllocator<Other> other;
+        };
+
+    explicit ArenaAllocator(Arena* arena = nullptr) : arena(arena) { }
+    template<class Other>
+        ArenaAllocator(const ArenaAllocator<Other>& other) : arena(other.getArena()) { }
+
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    pointer allocate(size_type n)
+    {
+        if (arena)
+            return reinterpret_cast<pointer>(arena->allocate(n * sizeof(T)));
+        return reinterpret_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+    pointer allocate(size_type n, const void*) { return allocate(n); }
+
+    // Arena memory is only given back with the whole arena.
+    void deallocate(pointer p, size_type)
+    {
+        if (! arena)
+            ::operator delete(p);
+    }
+
+    void construct(pointer p, const T& val) { new ((void*)p) T(val); }
+    void destroy(pointer p) { p->T::~T(); }
+
+    bool operator==(const ArenaAllocator& rhs) const { return arena == rhs.arena; }
+    bool operator!=(const ArenaAllocator& rhs) const { return arena != rhs.arena; }
+
+    size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+    size_type max_size(int size) const { return static_cast<size_type>(-1) / size; }
+
+    Arena* getArena() const { return arena; }
+
+protected:
+    Arena* arena;
+};
+
 //
 // SPIR-V IR instruction.
 //
 
 class Instruction {
 public:
-    Instruction(Id resultId, Id typeId, Op opCode) : resultId(resultId), typeId(typeId), opCode(opCode), block(nullptr) { }
-    explicit Instruction(Op opCode) : resultId(NoResult), typeId(NoType), opCode(opCode), block(nullptr) { }
+    Instruction(Id resultId, Id typeId, Op opCode, Arena* arena = nullptr) :
+        resultId(resultId), typeId(typeId), opCode(opCode), operands(ArenaAllocator<Id>(arena)), block(nullptr) { }
+    explicit Instruction(Op opCode, Arena* arena = nullptr) :
+        resultId(NoResult), typeId(NoType), opCode(opCode), operands(ArenaAllocator<Id>(arena)), block(nullptr) { }
     virtual ~Instruction() {}
+
+    // Instructions that are not on the stack live in the arena of their
+    // module, see Module::newInstruction().  Deleting one only runs its
+    // destructor.
+    static void* operator new(size_t size, Arena& arena) { return arena.allocate(size); }
+    static void operator delete(void*, Arena&) { }
+    static void operator delete(void*) { }
+
     void addIdOperand(Id id) { operands.push_back(id); }
     void addImmediateOperand(unsigned int immediate) { operands.push_back(immediate); }
     void addStringOperand(const char* str)
@@ -156,7 +296,7 @@ protected:
     Id resultId;
     Id typeId;
     Op opCode;
-    std::vector<Id> operands;
+    std::vector<Id, ArenaAllocator<Id> > operands;
     Block* block;
 };
 
@@ -331,6 +471,16 @@ public:
         idToInstruction[resultId] = instruction;
     }
 
+    // Creates an instruction that is stored, with its operands, in the
+    // module's arena.
+    Instruction* newInstruction(Id resultId, Id typeId, Op opCode)
+    {
+        return new (arena) Instruction(resultId, typeId, opCode, &arena);
+    }
+    Instruction* newInstruction(Op opCode) { return newInstruction(NoResult, NoType, opCode); }
+    Arena& getArena() { return arena; }
+    const Arena& getArena() const { return arena; }
+
     Instruction* getInstruction(Id id) const { return idToInstruction[id]; }
     const std::vector<Function*>& getFunctions() const { return functions; }
     spv::Id getTypeId(Id resultId) const { return idToInstruction[resultId]->getTypeId(); }
@@ -348,6 +498,10 @@ public:
 
 protected:
     Module(const Module&);
+
+    // Declared first, so it is destroyed last.
+    Arena arena;
+
     std::vector<Function*> functions;
 
     // map from result id to instruction having that result id
@@ -364,7 +518,7 @@ protected:
 // - the OpFunction instruction
 // - all the OpFunctionParameter instructions
 __inline Function::Function(Id id, Id resultType, Id functionType, Id firstParamId, Module& parent)
-    : parent(parent), functionInstruction(id, resultType, OpFunction), implicitThis(false)
+    : parent(parent), functionInstruction(id, resultType, OpFunction, &parent.getArena()), implicitThis(false)
 {
     // OpFunction
     functionInstruction.addImmediateOperand(FunctionControlMaskNone);
@@ -376,7 +530,7 @@ __inline Function::Function(Id id, Id resultType, Id functionType, Id firstParam
     Instruction* typeInst = parent.getInstruction(functionType);
     int numParams = typeInst->getNumOperands() - 1;
     for (int p = 0; p < numParams; ++p) {
-        Instruction* param = new Instruction(firstParamId + p, typeInst->getIdOperand(p + 1), OpFunctionParameter);
+        Instruction* param = parent.newInstruction(firstParamId + p, typeInst->getIdOperand(p + 1), OpFunctionParameter);
         parent.mapInstruction(param);
         parameterInstructions.push_back(param);
     }
@@ -391,7 +545,7 @@ __inline void Function::addLocalVariable(std::unique_ptr<Instruction> inst)
 
 __inline Block::Block(Id id, Function& parent) : parent(parent), unreachable(false)
 {
-    instructions.push_back(std::unique_ptr<Instruction>(new Instruction(id, NoType, OpLabel)));
+    instructions.push_back(std::unique_ptr<Instruction>(parent.getParent().newInstruction(id, NoType, OpLabel)));
     instructions.back()->setBlock(this);
     parent.getParent().mapInstruction(instructions.back().get());
 }
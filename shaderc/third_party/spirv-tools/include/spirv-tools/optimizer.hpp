@@ -124,6 +124,11 @@ class Optimizer {
   // |out| output stream.
   Optimizer& SetTimeReport(std::ostream* out);
 
+  // Sets the number of threads that passes which work on one function at a
+  // time may use to analyze the functions of the module.  The default is 1.
+  // The optimized binary does not depend on it.
+  Optimizer& SetThreadCount(uint32_t count);
+
  private:
   struct Impl;                  // Opaque struct for holding internal data.
   std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
@@ -49,6 +49,10 @@ class AggressiveDCEPass : public MemPass {
     return ir::IRContext::kAnalysisDefUse;
   }
 
+  // Dead branches and blocks are removed one function at a time; functions
+  // removed as dead are dropped from the per-function analyses.
+  bool ReportsChangedFunctions() const override { return true; }
+
  private:
   // Return true if |varId| is a variable of |storageClass|. |varId| must either
   // be 0 or the result of an instruction.
@@ -40,6 +40,9 @@ class BlockMergePass : public Pass {
   const char* name() const override { return "merge-blocks"; }
   Status Process(ir::IRContext*) override;
 
+  // Merging blocks only changes the function that holds them.
+  bool ReportsChangedFunctions() const override { return true; }
+
  private:
   // Kill any OpName instruction referencing |inst|, then kill |inst|.
   void KillInstAndName(ir::Instruction* inst);
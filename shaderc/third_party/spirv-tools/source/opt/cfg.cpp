@@ -35,8 +35,46 @@ CFG::CFG(ir::Module* module)
       pseudo_exit_block_(std::unique_ptr<ir::Instruction>(new ir::Instruction(
           module->context(), SpvOpLabel, 0, kInvalidId, {}))) {
   for (auto& fn : *module) {
+    std::vector<uint32_t>& labels = function2labels_[&fn];
     for (auto& blk : fn) {
       RegisterBlock(&blk);
+      labels.push_back(blk.id());
+    }
+  }
+}
+
+void CFG::UpdateFunctions(const std::vector<ir::Function*>& functions) {
+  std::unordered_set<const ir::Function*> live_functions;
+  for (auto& fn : *module_) live_functions.insert(&fn);
+
+  auto forget_labels = [this](const std::vector<uint32_t>& labels) {
+    for (uint32_t label : labels) {
+      id2block_.erase(label);
+      label2preds_.erase(label);
+    }
+  };
+  for (auto it = function2labels_.begin(); it != function2labels_.end();) {
+    if (live_functions.count(it->first) == 0) {
+      forget_labels(it->second);
+      it = function2labels_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (ir::Function* fn : functions) {
+    if (live_functions.count(fn) == 0) continue;
+    std::vector<uint32_t>& labels = function2labels_[fn];
+    forget_labels(labels);
+    labels.clear();
+    // Blocks that were added to |fn| after the CFG was built may still have
+    // predecessors listed.
+    for (auto& blk : *fn) {
+      label2preds_.erase(blk.id());
+      labels.push_back(blk.id());
+    }
+    for (auto& blk : *fn) {
+      RegisterBlock(&blk);
     }
   }
 }
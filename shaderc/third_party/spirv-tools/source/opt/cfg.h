@@ -21,6 +21,7 @@
 #include <list>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace spvtools {
 namespace ir {
@@ -134,6 +135,13 @@ class CFG {
 
   std::unordered_set<BasicBlock*> FindReachableBlocks(BasicBlock* start);
 
+  // Replaces the blocks of each function in |functions| with its current
+  // blocks, and removes the blocks of functions that are no longer in the
+  // module.  Edges never cross functions, so the rest of the CFG stays valid.
+  // Blocks registered with RegisterBlock() after the CFG was built are not
+  // removed; their labels are assumed not to be reused.
+  void UpdateFunctions(const std::vector<ir::Function*>& functions);
+
  private:
   using cbb_ptr = const ir::BasicBlock*;
 
@@ -173,6 +181,11 @@ class CFG {
 
   // Map from block's label id to block.
   std::unordered_map<uint32_t, ir::BasicBlock*> id2block_;
+
+  // Map from function to the labels of the blocks it had when the CFG was
+  // built or last updated.
+  std::unordered_map<const ir::Function*, std::vector<uint32_t>>
+      function2labels_;
 };
 
 }  // namespace ir
@@ -45,6 +45,9 @@ class DeadBranchElimPass : public MemPass {
     return ir::IRContext::kAnalysisDefUse;
   }
 
+  // Only the functions with a folded branch change their control flow.
+  bool ReportsChangedFunctions() const override { return true; }
+
  private:
   // If |condId| is boolean constant, return conditional value in |condVal| and
   // return true, otherwise return false.
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <set>
 #include <stack>
+#include <unordered_set>
 
 #include "ir_context.h"
 
@@ -26,10 +27,10 @@ namespace analysis {
 
 void DecorationManager::RemoveDecorationsFrom(
     uint32_t id, std::function<bool(const ir::Instruction&)> pred) {
-  const auto ids_iter = id_to_decoration_insts_.find(id);
-  if (ids_iter == id_to_decoration_insts_.end()) return;
+  TargetData* const ids_data = GetTargetData(id);
+  if (!ids_data) return;
 
-  TargetData& decorations_info = ids_iter->second;
+  TargetData& decorations_info = *ids_data;
   auto context = module_->context();
   std::vector<ir::Instruction*> insts_to_kill;
   const bool is_group = !decorations_info.decorate_insts.empty();
@@ -49,10 +50,9 @@ void DecorationManager::RemoveDecorationsFrom(
 
     std::vector<ir::Instruction*> group_decorations_to_keep;
     const uint32_t group_id = inst->GetSingleWordInOperand(0u);
-    const auto group_iter = id_to_decoration_insts_.find(group_id);
-    assert(group_iter != id_to_decoration_insts_.end() &&
-           "Unknown decoration group");
-    const auto& group_decorations = group_iter->second.direct_decorations;
+    const TargetData* group_data = GetTargetData(group_id);
+    assert(group_data && "Unknown decoration group");
+    const auto& group_decorations = group_data->direct_decorations;
     for (ir::Instruction* decoration : group_decorations) {
       if (!pred(*decoration)) group_decorations_to_keep.push_back(decoration);
     }
@@ -117,6 +117,7 @@ void DecorationManager::RemoveDecorationsFrom(
             return indirect_decorations_to_remove.count(inst);
           }),
       indirect_decorations.end());
+  decorations_info.all_decorations_valid = false;
 
   for (ir::Instruction* inst : insts_to_kill) context->KillInst(inst);
   insts_to_kill.clear();
@@ -133,7 +134,7 @@ void DecorationManager::RemoveDecorationsFrom(
   if (decorations_info.direct_decorations.empty() &&
       decorations_info.indirect_decorations.empty() &&
       decorations_info.decorate_insts.empty()) {
-    id_to_decoration_insts_.erase(ids_iter);
+    decorations_info = TargetData();
 
     // Remove the OpDecorationGroup defining this group.
     if (is_group) context->KillInst(context->get_def_use_mgr()->GetDef(id));
@@ -151,20 +152,65 @@ std::vector<const ir::Instruction*> DecorationManager::GetDecorationsFor(
       ->InternalGetDecorationsFor<const ir::Instruction*>(id, include_linkage);
 }
 
+DecorationManager::DecorationRange DecorationManager::GetDecorationRange(
+    uint32_t id, bool include_linkage) const {
+  static const std::vector<ir::Instruction*> no_decorations;
+  const LinkageFilter filter = {include_linkage};
+
+  const TargetData* target_data = GetTargetData(id);
+  // |id| has no decorations
+  if (!target_data) {
+    return ir::MakeFilterIteratorRange(no_decorations.begin(),
+                                       no_decorations.end(), filter);
+  }
+
+  TargetData& data = target_data_[id_to_target_data_[id]];
+  if (!data.all_decorations_valid) GatherAllDecorations(&data);
+  return ir::MakeFilterIteratorRange(data.all_decorations.cbegin(),
+                                     data.all_decorations.cend(), filter);
+}
+
+void DecorationManager::GatherAllDecorations(TargetData* data) const {
+  data->all_decorations = data->direct_decorations;
+  // Add the decorations of all groups applied to the tracked ID.
+  for (const ir::Instruction* inst : data->indirect_decorations) {
+    const uint32_t group_id = inst->GetSingleWordInOperand(0u);
+    const TargetData* group_data = GetTargetData(group_id);
+    assert(group_data && "Unknown group ID");
+    data->all_decorations.insert(data->all_decorations.end(),
+                                 group_data->direct_decorations.begin(),
+                                 group_data->direct_decorations.end());
+  }
+  data->all_decorations_valid = true;
+}
+
+void DecorationManager::PrepareForConcurrentReads() const {
+  // The first element is unused.
+  for (size_t i = 1; i < target_data_.size(); ++i) {
+    if (!target_data_[i].all_decorations_valid)
+      GatherAllDecorations(&target_data_[i]);
+  }
+}
+
+bool DecorationManager::LinkageFilter::operator()(
+    const ir::Instruction* inst) const {
+  return include_linkage || inst->opcode() != SpvOpDecorate ||
+         inst->GetSingleWordInOperand(1u) != SpvDecorationLinkageAttributes;
+}
+
 bool DecorationManager::HaveTheSameDecorations(uint32_t id1,
                                                uint32_t id2) const {
-  using InstructionList = std::vector<const ir::Instruction*>;
   using DecorationSet = std::set<std::u32string>;
 
-  const InstructionList decorations_for1 = GetDecorationsFor(id1, false);
-  const InstructionList decorations_for2 = GetDecorationsFor(id2, false);
+  const DecorationRange decorations_for1 = GetDecorationRange(id1, false);
+  const DecorationRange decorations_for2 = GetDecorationRange(id2, false);
 
   // This function splits the decoration instructions into different sets,
   // based on their opcode; only OpDecorate, OpDecorateId,
   // OpDecorateStringGOOGLE, and OpMemberDecorate are considered, the other
   // opcodes are ignored.
   const auto fillDecorationSets =
-      [](const InstructionList& decoration_list, DecorationSet* decorate_set,
+      [](const DecorationRange& decoration_list, DecorationSet* decorate_set,
          DecorationSet* decorate_id_set, DecorationSet* decorate_string_set,
          DecorationSet* member_decorate_set) {
         for (const ir::Instruction* inst : decoration_list) {
@@ -249,6 +295,7 @@ bool DecorationManager::AreDecorationsTheSame(const ir::Instruction* inst1,
 void DecorationManager::AnalyzeDecorations() {
   if (!module_) return;
 
+  id_to_target_data_.resize(module_->IdBound(), 0u);
   // For each group and instruction, collect all their decoration instructions.
   for (ir::Instruction& inst : module_->annotations()) {
     AddDecoration(&inst);
@@ -261,7 +308,8 @@ void DecorationManager::AddDecoration(ir::Instruction* inst) {
     case SpvOpDecorateStringGOOGLE:
     case SpvOpMemberDecorate: {
       const auto target_id = inst->GetSingleWordInOperand(0u);
-      id_to_decoration_insts_[target_id].direct_decorations.push_back(inst);
+      GetOrCreateTargetData(target_id).direct_decorations.push_back(inst);
+      InvalidateDecorations(target_id);
       break;
     }
     case SpvOpGroupDecorate:
@@ -270,11 +318,12 @@ void DecorationManager::AddDecoration(ir::Instruction* inst) {
       const uint32_t stride = start;
       for (uint32_t i = start; i < inst->NumInOperands(); i += stride) {
         const auto target_id = inst->GetSingleWordInOperand(i);
-        TargetData& target_data = id_to_decoration_insts_[target_id];
+        TargetData& target_data = GetOrCreateTargetData(target_id);
         target_data.indirect_decorations.push_back(inst);
+        target_data.all_decorations_valid = false;
       }
       const auto target_id = inst->GetSingleWordInOperand(0u);
-      id_to_decoration_insts_[target_id].decorate_insts.push_back(inst);
+      GetOrCreateTargetData(target_id).decorate_insts.push_back(inst);
       break;
     }
     default:
@@ -286,42 +335,15 @@ template <typename T>
 std::vector<T> DecorationManager::InternalGetDecorationsFor(
     uint32_t id, bool include_linkage) {
   std::vector<T> decorations;
-
-  const auto ids_iter = id_to_decoration_insts_.find(id);
-  // |id| has no decorations
-  if (ids_iter == id_to_decoration_insts_.end()) return decorations;
-
-  const TargetData& target_data = ids_iter->second;
-
-  const auto process_direct_decorations =
-      [include_linkage,
-       &decorations](const std::vector<ir::Instruction*>& direct_decorations) {
-        for (ir::Instruction* inst : direct_decorations) {
-          const bool is_linkage = inst->opcode() == SpvOpDecorate &&
-                                  inst->GetSingleWordInOperand(1u) ==
-                                      SpvDecorationLinkageAttributes;
-          if (include_linkage || !is_linkage) decorations.push_back(inst);
-        }
-      };
-
-  // Process |id|'s decorations.
-  process_direct_decorations(ids_iter->second.direct_decorations);
-
-  // Process the decorations of all groups applied to |id|.
-  for (const ir::Instruction* inst : target_data.indirect_decorations) {
-    const uint32_t group_id = inst->GetSingleWordInOperand(0u);
-    const auto group_iter = id_to_decoration_insts_.find(group_id);
-    assert(group_iter != id_to_decoration_insts_.end() && "Unknown group ID");
-    process_direct_decorations(group_iter->second.direct_decorations);
-  }
-
+  for (ir::Instruction* inst : GetDecorationRange(id, include_linkage))
+    decorations.push_back(inst);
   return decorations;
 }
 
 bool DecorationManager::WhileEachDecoration(
     uint32_t id, uint32_t decoration,
     std::function<bool(const ir::Instruction&)> f) {
-  for (const ir::Instruction* inst : GetDecorationsFor(id, true)) {
+  for (const ir::Instruction* inst : GetDecorationRange(id, true)) {
     switch (inst->opcode()) {
       case SpvOpMemberDecorate:
         if (inst->GetSingleWordInOperand(2) == decoration) {
@@ -352,10 +374,14 @@ void DecorationManager::ForEachDecoration(
 }
 
 void DecorationManager::CloneDecorations(uint32_t from, uint32_t to) {
-  const auto decoration_list = id_to_decoration_insts_.find(from);
-  if (decoration_list == id_to_decoration_insts_.end()) return;
+  const TargetData* decoration_list = GetTargetData(from);
+  if (!decoration_list) return;
   auto context = module_->context();
-  for (ir::Instruction* inst : decoration_list->second.direct_decorations) {
+  // Copy the list of instructions as AnalyzeUses is going to add to it when
+  // |from| and |to| are the same.
+  const std::vector<ir::Instruction*> direct_decorations =
+      decoration_list->direct_decorations;
+  for (ir::Instruction* inst : direct_decorations) {
     // simply clone decoration and change |target-id| to |to|
     std::unique_ptr<ir::Instruction> new_inst(inst->Clone(module_->context()));
     new_inst->SetInOperand(0, {to});
@@ -366,7 +392,7 @@ void DecorationManager::CloneDecorations(uint32_t from, uint32_t to) {
   // We need to copy the list of instructions as ForgetUses and AnalyzeUses are
   // going to modify it.
   std::vector<ir::Instruction*> indirect_decorations =
-      decoration_list->second.indirect_decorations;
+      decoration_list->indirect_decorations;
   for (ir::Instruction* inst : indirect_decorations) {
     switch (inst->opcode()) {
       case SpvOpGroupDecorate:
@@ -409,29 +435,71 @@ void DecorationManager::RemoveDecoration(ir::Instruction* inst) {
     case SpvOpDecorateStringGOOGLE:
     case SpvOpMemberDecorate: {
       const auto target_id = inst->GetSingleWordInOperand(0u);
-      auto const iter = id_to_decoration_insts_.find(target_id);
-      if (iter == id_to_decoration_insts_.end()) return;
-      remove_from_container(iter->second.direct_decorations);
+      TargetData* target_data = GetTargetData(target_id);
+      if (!target_data) return;
+      remove_from_container(target_data->direct_decorations);
+      InvalidateDecorations(target_id);
     } break;
     case SpvOpGroupDecorate:
     case SpvOpGroupMemberDecorate: {
       const uint32_t stride = inst->opcode() == SpvOpGroupDecorate ? 1u : 2u;
       for (uint32_t i = 1u; i < inst->NumInOperands(); i += stride) {
         const auto target_id = inst->GetSingleWordInOperand(i);
-        auto const iter = id_to_decoration_insts_.find(target_id);
-        if (iter == id_to_decoration_insts_.end()) continue;
-        remove_from_container(iter->second.indirect_decorations);
+        TargetData* target_data = GetTargetData(target_id);
+        if (!target_data) continue;
+        remove_from_container(target_data->indirect_decorations);
+        target_data->all_decorations_valid = false;
       }
       const auto group_id = inst->GetSingleWordInOperand(0u);
-      auto const iter = id_to_decoration_insts_.find(group_id);
-      if (iter == id_to_decoration_insts_.end()) return;
-      remove_from_container(iter->second.decorate_insts);
+      TargetData* group_data = GetTargetData(group_id);
+      if (!group_data) return;
+      remove_from_container(group_data->decorate_insts);
     } break;
     default:
       break;
   }
 }
 
+DecorationManager::TargetData* DecorationManager::GetTargetData(uint32_t id) {
+  if (id >= id_to_target_data_.size() || id_to_target_data_[id] == 0)
+    return nullptr;
+  return &target_data_[id_to_target_data_[id]];
+}
+
+const DecorationManager::TargetData* DecorationManager::GetTargetData(
+    uint32_t id) const {
+  if (id >= id_to_target_data_.size() || id_to_target_data_[id] == 0)
+    return nullptr;
+  return &target_data_[id_to_target_data_[id]];
+}
+
+DecorationManager::TargetData& DecorationManager::GetOrCreateTargetData(
+    uint32_t id) {
+  if (id >= id_to_target_data_.size()) id_to_target_data_.resize(id + 1, 0u);
+  if (id_to_target_data_[id] == 0) {
+    id_to_target_data_[id] = static_cast<uint32_t>(target_data_.size());
+    target_data_.emplace_back();
+  }
+  return target_data_[id_to_target_data_[id]];
+}
+
+void DecorationManager::InvalidateDecorations(uint32_t id) {
+  TargetData* target_data = GetTargetData(id);
+  if (!target_data) return;
+  target_data->all_decorations_valid = false;
+  for (const ir::Instruction* inst : target_data->decorate_insts)
+    InvalidateGroupTargets(inst);
+}
+
+void DecorationManager::InvalidateGroupTargets(const ir::Instruction* inst) {
+  const uint32_t start = inst->opcode() == SpvOpGroupDecorate ? 1u : 2u;
+  const uint32_t stride = start;
+  for (uint32_t i = start; i < inst->NumInOperands(); i += stride) {
+    TargetData* target_data = GetTargetData(inst->GetSingleWordInOperand(i));
+    if (target_data) target_data->all_decorations_valid = false;
+  }
+}
+
 }  // namespace analysis
 }  // namespace opt
 }  // namespace spvtools
@@ -15,12 +15,12 @@
 #ifndef LIBSPIRV_OPT_DECORATION_MANAGER_H_
 #define LIBSPIRV_OPT_DECORATION_MANAGER_H_
 
+#include <deque>
 #include <functional>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include "instruction.h"
+#include "iterator.h"
 #include "module.h"
 
 namespace spvtools {
@@ -28,10 +28,26 @@ namespace opt {
 namespace analysis {
 
 // A class for analyzing and managing decorations in an ir::Module.
+//
+// Decorations are indexed by id through a flat table. The decorations of each
+// id, including those of the groups applied to it, are gathered into a list
+// on first request and kept until a decoration affecting the id is added or
+// removed.
 class DecorationManager {
  public:
+  // Skips linkage decorations unless |include_linkage| is set.
+  struct LinkageFilter {
+    bool operator()(const ir::Instruction* inst) const;
+    bool include_linkage;
+  };
+  using DecorationIterator =
+      ir::FilterIterator<std::vector<ir::Instruction*>::const_iterator,
+                         LinkageFilter>;
+  using DecorationRange = ir::IteratorRange<DecorationIterator>;
+
   // Constructs a decoration manager from the given |module|
-  explicit DecorationManager(ir::Module* module) : module_(module) {
+  explicit DecorationManager(ir::Module* module)
+      : target_data_(1), module_(module) {
     AnalyzeDecorations();
   }
   DecorationManager() = delete;
@@ -59,6 +75,14 @@ class DecorationManager {
                                                   bool include_linkage);
   std::vector<const ir::Instruction*> GetDecorationsFor(
       uint32_t id, bool include_linkage) const;
+  // Returns the same decorations as GetDecorationsFor() without copying them.
+  // The range is invalidated by any change to the decorations of the module.
+  // The decorations of |id| are gathered on the first call, so concurrent
+  // calls need PrepareForConcurrentReads() first.
+  DecorationRange GetDecorationRange(uint32_t id, bool include_linkage) const;
+  // Gathers the decorations of every decorated ID, so GetDecorationRange()
+  // no longer changes the manager until the decorations change.
+  void PrepareForConcurrentReads() const;
   // Returns whether two IDs have the same decorations. Two SpvOpGroupDecorate
   // instructions that apply the same decorations but to different IDs, still
   // count as being the same.
@@ -118,14 +142,37 @@ class DecorationManager {
                                                    // It is empty if the
                                                    // tracked ID is not a
                                                    // group.
+    // The direct decorations followed by those of each group applied to the
+    // tracked ID. Only meaningful if |all_decorations_valid| is set.
+    std::vector<ir::Instruction*> all_decorations;
+    bool all_decorations_valid = false;
   };
 
-  // Mapping from ids to the instructions applying a decoration to those ids.
-  // In other words, for each id you get all decoration instructions
-  // referencing that id, be it directly (SpvOpDecorate, SpvOpMemberDecorate
-  // and SpvOpDecorateId), or indirectly (SpvOpGroupDecorate,
-  // SpvOpMemberGroupDecorate).
-  std::unordered_map<uint32_t, TargetData> id_to_decoration_insts_;
+  // Returns the decoration information of |id|, or nullptr if |id| has never
+  // been decorated.
+  TargetData* GetTargetData(uint32_t id);
+  const TargetData* GetTargetData(uint32_t id) const;
+  // Returns the decoration information of |id|, creating it if needed.
+  TargetData& GetOrCreateTargetData(uint32_t id);
+  // Fills |data->all_decorations| and marks it as valid.
+  void GatherAllDecorations(TargetData* data) const;
+
+  // Marks the gathered decorations of |id| as stale. If |id| is a group, the
+  // gathered decorations of its targets are marked as well.
+  void InvalidateDecorations(uint32_t id);
+  // Marks the gathered decorations of the targets of |inst|, an
+  // OpGroupDecorate or OpGroupMemberDecorate, as stale.
+  void InvalidateGroupTargets(const ir::Instruction* inst);
+
+  // Index into |target_data_| for each id, or 0 if the id has never been
+  // decorated. The first element of |target_data_| is unused.
+  //
+  // For each id you get all decoration instructions referencing that id, be
+  // it directly (SpvOpDecorate, SpvOpMemberDecorate and SpvOpDecorateId), or
+  // indirectly (SpvOpGroupDecorate, SpvOpMemberGroupDecorate). A deque keeps
+  // references to the data valid while new ids are decorated.
+  std::vector<uint32_t> id_to_target_data_;
+  mutable std::deque<TargetData> target_data_;
   // The enclosing module.
   ir::Module* module_;
 };
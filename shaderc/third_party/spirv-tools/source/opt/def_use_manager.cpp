@@ -14,6 +14,7 @@
 
 #include "def_use_manager.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "log.h"
@@ -23,15 +24,154 @@ namespace spvtools {
 namespace opt {
 namespace analysis {
 
+namespace {
+
+// Moved slices get at least this much room, so short lists of users do not
+// move on every insertion.
+const uint32_t kMinSliceCapacity = 4;
+
+// Arrays smaller than this are never compacted.
+const size_t kMinCompactSize = 1024;
+
+bool IsUseOperand(const ir::Operand& operand) {
+  switch (operand.type) {
+    // For any id type but result id type
+    case SPV_OPERAND_TYPE_ID:
+    case SPV_OPERAND_TYPE_TYPE_ID:
+    case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
+    case SPV_OPERAND_TYPE_SCOPE_ID:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool LessUniqueId(const ir::Instruction* lhs, const ir::Instruction* rhs) {
+  return lhs->unique_id() < rhs->unique_id();
+}
+
+}  // namespace
+
+template <typename T>
+void DefUseManager::ReserveSlice(std::vector<T>* pool, Slice* slice,
+                                 uint32_t capacity, uint32_t* garbage) {
+  if (slice->capacity >= capacity) return;
+  capacity =
+      std::max(capacity, std::max(2 * slice->capacity, kMinSliceCapacity));
+  if (slice->offset + slice->capacity == pool->size()) {
+    // Already at the end, so it can grow in place
+    pool->resize(slice->offset + capacity);
+  } else {
+    const size_t offset = pool->size();
+    pool->resize(offset + capacity);
+    std::copy(pool->begin() + slice->offset,
+              pool->begin() + slice->offset + slice->count,
+              pool->begin() + offset);
+    *garbage += slice->capacity;
+    slice->offset = static_cast<uint32_t>(offset);
+  }
+  slice->capacity = capacity;
+}
+
+DefUseManager::UsedIds* DefUseManager::FindUsedIds(
+    const ir::Instruction* inst) {
+  const uint32_t unique_id = inst->unique_id();
+  if (unique_id >= inst_to_used_ids_.size()) return nullptr;
+  UsedIds* entry = &inst_to_used_ids_[unique_id];
+  return entry->inst == inst ? entry : nullptr;
+}
+
+void DefUseManager::AddUser(uint32_t id, ir::Instruction* user) {
+  if (id >= id_to_users_.size()) id_to_users_.resize(id + 1);
+  Slice* slice = &id_to_users_[id];
+
+  // Analysis visits instructions mostly in unique id order, so users are
+  // usually appended.
+  auto begin = users_.begin() + slice->offset;
+  auto end = begin + slice->count;
+  auto pos = (slice->count == 0 || LessUniqueId(end[-1], user))
+                 ? end
+                 : std::lower_bound(begin, end, user, LessUniqueId);
+  if (pos != end && (*pos)->unique_id() == user->unique_id()) return;
+  const uint32_t index = static_cast<uint32_t>(pos - begin);
+
+  if (slice->count == slice->capacity && users_.size() >= kMinCompactSize &&
+      2 * users_garbage_ > users_.size()) {
+    CompactUsers();
+  }
+  ReserveSlice(&users_, slice, slice->count + 1, &users_garbage_);
+  begin = users_.begin() + slice->offset;
+  std::copy_backward(begin + index, begin + slice->count,
+                     begin + slice->count + 1);
+  begin[index] = user;
+  ++slice->count;
+}
+
+void DefUseManager::RemoveUser(uint32_t id, const ir::Instruction* user) {
+  if (id >= id_to_users_.size()) return;
+  Slice* slice = &id_to_users_[id];
+  auto begin = users_.begin() + slice->offset;
+  auto end = begin + slice->count;
+  auto pos = std::lower_bound(begin, end, user, LessUniqueId);
+  if (pos == end || (*pos)->unique_id() != user->unique_id()) return;
+  std::copy(pos + 1, end, pos);
+  --slice->count;
+}
+
+void DefUseManager::ClearUsers(uint32_t id) {
+  if (id < id_to_users_.size()) id_to_users_[id].count = 0;
+}
+
+void DefUseManager::EraseUseRecords(UsedIds* entry) {
+  const Slice& slice = entry->slice;
+  for (uint32_t i = 0; i < slice.count; ++i) {
+    RemoveUser(used_ids_[slice.offset + i], entry->inst);
+  }
+  entry->inst = nullptr;
+  entry->slice.count = 0;
+}
+
+void DefUseManager::CompactUsers() {
+  std::vector<ir::Instruction*> users;
+  users.reserve(users_.size() - users_garbage_);
+  for (Slice& slice : id_to_users_) {
+    const uint32_t offset = static_cast<uint32_t>(users.size());
+    users.insert(users.end(), users_.begin() + slice.offset,
+                 users_.begin() + slice.offset + slice.count);
+    slice.offset = offset;
+    slice.capacity = slice.count;
+  }
+  users_.swap(users);
+  users_garbage_ = 0;
+}
+
+void DefUseManager::CompactUsedIds() {
+  std::vector<uint32_t> used_ids;
+  used_ids.reserve(used_ids_.size() - used_ids_garbage_);
+  for (UsedIds& entry : inst_to_used_ids_) {
+    Slice& slice = entry.slice;
+    const uint32_t offset = static_cast<uint32_t>(used_ids.size());
+    used_ids.insert(used_ids.end(), used_ids_.begin() + slice.offset,
+                    used_ids_.begin() + slice.offset + slice.count);
+    slice.offset = offset;
+    slice.capacity = slice.count;
+  }
+  used_ids_.swap(used_ids);
+  used_ids_garbage_ = 0;
+}
+
 void DefUseManager::AnalyzeInstDef(ir::Instruction* inst) {
   const uint32_t def_id = inst->result_id();
   if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter != id_to_def_.end()) {
+    ir::Instruction* old_def = GetDef(def_id);
+    if (old_def) {
       // Clear the original instruction that defining the same result id of the
       // new instruction.
-      ClearInst(iter->second);
+      ClearInst(old_def);
+      // Users of an instruction that was never analyzed are dropped with it
+      if (old_def != inst) ClearUsers(def_id);
     }
+    if (def_id >= id_to_def_.size()) id_to_def_.resize(def_id + 1, nullptr);
     id_to_def_[def_id] = inst;
   } else {
     ClearInst(inst);
@@ -42,29 +182,32 @@ void DefUseManager::AnalyzeInstUse(ir::Instruction* inst) {
   // Create entry for the given instruction. Note that the instruction may
   // not have any in-operands. In such cases, we still need a entry for those
   // instructions so this manager knows it has seen the instruction later.
-  auto* used_ids = &inst_to_used_ids_[inst];
-  if (used_ids->size()) {
-    EraseUseRecordsOfOperandIds(inst);
-    used_ids = &inst_to_used_ids_[inst];
+  const uint32_t unique_id = inst->unique_id();
+  if (unique_id >= inst_to_used_ids_.size()) {
+    inst_to_used_ids_.resize(unique_id + 1);
   }
-  used_ids->clear();  // It might have existed before.
+  UsedIds* entry = &inst_to_used_ids_[unique_id];
+  // It might have existed before, possibly for the instruction at the
+  // address |inst| was moved from.
+  if (entry->inst) EraseUseRecords(entry);
+  entry->inst = inst;
 
   for (uint32_t i = 0; i < inst->NumOperands(); ++i) {
-    switch (inst->GetOperand(i).type) {
-      // For any id type but result id type
-      case SPV_OPERAND_TYPE_ID:
-      case SPV_OPERAND_TYPE_TYPE_ID:
-      case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
-      case SPV_OPERAND_TYPE_SCOPE_ID: {
-        uint32_t use_id = inst->GetSingleWordOperand(i);
-        ir::Instruction* def = GetDef(use_id);
-        assert(def && "Definition is not registered.");
-        id_to_users_.insert(UserEntry(def, inst));
-        used_ids->push_back(use_id);
-      } break;
-      default:
-        break;
+    if (!IsUseOperand(inst->GetOperand(i))) continue;
+    uint32_t use_id = inst->GetSingleWordOperand(i);
+    ir::Instruction* def = GetDef(use_id);
+    assert(def && "Definition is not registered.");
+    if (def) AddUser(use_id, inst);
+
+    Slice* slice = &entry->slice;
+    if (slice->count == slice->capacity &&
+        used_ids_.size() >= kMinCompactSize &&
+        2 * used_ids_garbage_ > used_ids_.size()) {
+      CompactUsedIds();
     }
+    ReserveSlice(&used_ids_, slice, slice->count + 1, &used_ids_garbage_);
+    used_ids_[slice->offset + slice->count] = use_id;
+    ++slice->count;
   }
 }
 
@@ -75,42 +218,18 @@ void DefUseManager::AnalyzeInstDefUse(ir::Instruction* inst) {
 
 void DefUseManager::UpdateDefUse(ir::Instruction* inst) {
   const uint32_t def_id = inst->result_id();
-  if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter == id_to_def_.end()) {
-      AnalyzeInstDef(inst);
-    }
+  if (def_id != 0 && GetDef(def_id) == nullptr) {
+    AnalyzeInstDef(inst);
   }
   AnalyzeInstUse(inst);
 }
 
 ir::Instruction* DefUseManager::GetDef(uint32_t id) {
-  auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
+  return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
 }
 
 const ir::Instruction* DefUseManager::GetDef(uint32_t id) const {
-  const auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
-}
-
-DefUseManager::IdToUsersMap::const_iterator DefUseManager::UsersBegin(
-    const ir::Instruction* def) const {
-  return id_to_users_.lower_bound(
-      UserEntry(const_cast<ir::Instruction*>(def), nullptr));
-}
-
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const IdToUsersMap::const_iterator& cached_end,
-                                const ir::Instruction* inst) const {
-  return (iter != cached_end && iter->first == inst);
-}
-
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const ir::Instruction* inst) const {
-  return UsersNotEnd(iter, id_to_users_.end(), inst);
+  return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
 }
 
 bool DefUseManager::WhileEachUser(
@@ -121,9 +240,12 @@ bool DefUseManager::WhileEachUser(
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
 
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    if (!f(iter->second)) return false;
+  // The slice is looked up again on each step, since |f| may move it by
+  // changing the users of other ids.
+  const uint32_t id = def->result_id();
+  for (uint32_t i = 0; id < id_to_users_.size() && i < id_to_users_[id].count;
+       ++i) {
+    if (!f(users_[id_to_users_[id].offset + i])) return false;
   }
   return true;
 }
@@ -155,13 +277,14 @@ bool DefUseManager::WhileEachUse(
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
 
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    ir::Instruction* user = iter->second;
+  const uint32_t id = def->result_id();
+  for (uint32_t i = 0; id < id_to_users_.size() && i < id_to_users_[id].count;
+       ++i) {
+    ir::Instruction* user = users_[id_to_users_[id].offset + i];
     for (uint32_t idx = 0; idx != user->NumOperands(); ++idx) {
       const ir::Operand& op = user->GetOperand(idx);
       if (op.type != SPV_OPERAND_TYPE_RESULT_ID && spvIsIdType(op.type)) {
-        if (def->result_id() == op.words[0]) {
+        if (id == op.words[0]) {
           if (!f(user, idx)) return false;
         }
       }
@@ -192,9 +315,11 @@ void DefUseManager::ForEachUse(
 }
 
 uint32_t DefUseManager::NumUsers(const ir::Instruction* def) const {
-  uint32_t count = 0;
-  ForEachUser(def, [&count](ir::Instruction*) { ++count; });
-  return count;
+  assert(def && (!def->HasResultId() || def == GetDef(def->result_id())) &&
+         "Definition is not registered.");
+  const uint32_t id = def->result_id();
+  if (!def->HasResultId() || id >= id_to_users_.size()) return 0;
+  return id_to_users_[id].count;
 }
 
 uint32_t DefUseManager::NumUsers(uint32_t id) const {
@@ -229,23 +354,40 @@ void DefUseManager::AnalyzeDefUse(ir::Module* module) {
   // Analyze all the defs before any uses to catch forward references.
   module->ForEachInst(
       std::bind(&DefUseManager::AnalyzeInstDef, this, std::placeholders::_1));
+
+  // Size every slice for the uses counted up front, so the uses are stored
+  // back to back without moving.
+  id_to_users_.resize(id_to_def_.size());
+  uint32_t use_count = 0;
+  module->ForEachInst([this, &use_count](ir::Instruction* inst) {
+    for (uint32_t i = 0; i < inst->NumOperands(); ++i) {
+      if (!IsUseOperand(inst->GetOperand(i))) continue;
+      const uint32_t use_id = inst->GetSingleWordOperand(i);
+      if (use_id < id_to_users_.size()) ++id_to_users_[use_id].capacity;
+      ++use_count;
+    }
+  });
+  uint32_t offset = 0;
+  for (Slice& slice : id_to_users_) {
+    slice.offset = offset;
+    offset += slice.capacity;
+  }
+  users_.resize(offset);
+  used_ids_.reserve(use_count);
+
   module->ForEachInst(
       std::bind(&DefUseManager::AnalyzeInstUse, this, std::placeholders::_1));
 }
 
 void DefUseManager::ClearInst(ir::Instruction* inst) {
-  auto iter = inst_to_used_ids_.find(inst);
-  if (iter != inst_to_used_ids_.end()) {
-    EraseUseRecordsOfOperandIds(inst);
-    if (inst->result_id() != 0) {
+  UsedIds* entry = FindUsedIds(inst);
+  if (entry) {
+    EraseUseRecords(entry);
+    const uint32_t def_id = inst->result_id();
+    if (def_id != 0 && GetDef(def_id) == inst) {
       // Remove all uses of this inst.
-      auto users_begin = UsersBegin(inst);
-      auto end = id_to_users_.end();
-      auto new_end = users_begin;
-      for (; UsersNotEnd(new_end, end, inst); ++new_end) {
-      }
-      id_to_users_.erase(users_begin, new_end);
-      id_to_def_.erase(inst->result_id());
+      ClearUsers(def_id);
+      id_to_def_[def_id] = nullptr;
     }
   }
 }
@@ -253,37 +395,32 @@ void DefUseManager::ClearInst(ir::Instruction* inst) {
 void DefUseManager::EraseUseRecordsOfOperandIds(const ir::Instruction* inst) {
   // Go through all ids used by this instruction, remove this instruction's
   // uses of them.
-  auto iter = inst_to_used_ids_.find(inst);
-  if (iter != inst_to_used_ids_.end()) {
-    for (auto use_id : iter->second) {
-      id_to_users_.erase(
-          UserEntry(GetDef(use_id), const_cast<ir::Instruction*>(inst)));
-    }
-    inst_to_used_ids_.erase(inst);
-  }
+  UsedIds* entry = FindUsedIds(inst);
+  if (entry) EraseUseRecords(entry);
 }
 
 bool operator==(const DefUseManager& lhs, const DefUseManager& rhs) {
-  if (lhs.id_to_def_ != rhs.id_to_def_) {
-    return false;
+  const size_t id_bound =
+      std::max(lhs.id_to_def_.size(), rhs.id_to_def_.size());
+  for (uint32_t id = 0; id < id_bound; ++id) {
+    if (lhs.GetDef(id) != rhs.GetDef(id)) return false;
   }
 
-  if (lhs.id_to_users_ != rhs.id_to_users_) {
-    for (auto p : lhs.id_to_users_) {
-      if (rhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
-    }
-    for (auto p : rhs.id_to_users_) {
-      if (lhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
+  const size_t users_bound =
+      std::max(lhs.id_to_users_.size(), rhs.id_to_users_.size());
+  for (uint32_t id = 0; id < users_bound; ++id) {
+    // Both are sorted by unique id
+    const DefUseManager::Slice empty;
+    const DefUseManager::Slice& lhs_slice =
+        id < lhs.id_to_users_.size() ? lhs.id_to_users_[id] : empty;
+    const DefUseManager::Slice& rhs_slice =
+        id < rhs.id_to_users_.size() ? rhs.id_to_users_[id] : empty;
+    if (lhs_slice.count != rhs_slice.count ||
+        !std::equal(lhs.users_.begin() + lhs_slice.offset,
+                    lhs.users_.begin() + lhs_slice.offset + lhs_slice.count,
+                    rhs.users_.begin() + rhs_slice.offset)) {
+      return false;
     }
-    return false;
-  }
-
-  if (lhs.inst_to_used_ids_ != lhs.inst_to_used_ids_) {
-    return false;
   }
   return true;
 }
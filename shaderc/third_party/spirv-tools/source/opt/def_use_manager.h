@@ -15,9 +15,7 @@
 #ifndef LIBSPIRV_OPT_DEF_USE_MANAGER_H_
 #define LIBSPIRV_OPT_DEF_USE_MANAGER_H_
 
-#include <list>
-#include <set>
-#include <unordered_map>
+#include <functional>
 #include <vector>
 
 #include "instruction.h"
@@ -50,54 +48,16 @@ inline bool operator<(const Use& lhs, const Use& rhs) {
   return lhs.operand_index < rhs.operand_index;
 }
 
-// Definition and user pair.
-//
-// The first element of the pair is the definition.
-// The second element of the pair is the user.
-//
-// Definition should never be null. User can be null, however, such an entry
-// should be used only for searching (e.g. all users of a particular definition)
-// and never stored in a container.
-using UserEntry = std::pair<ir::Instruction*, ir::Instruction*>;
-
-// Orders UserEntry for use in associative containers (i.e. less than ordering).
-//
-// The definition of an UserEntry is treated as the major key and the users as
-// the minor key so that all the users of a particular definition are
-// consecutive in a container.
-//
-// A null user always compares less than a real user. This is done to provide
-// easy values to search for the beginning of the users of a particular
-// definition (i.e. using {def, nullptr}).
-struct UserEntryLess {
-  bool operator()(const UserEntry& lhs, const UserEntry& rhs) const {
-    // If lhs.first and rhs.first are both null, fall through to checking the
-    // second entries.
-    if (!lhs.first && rhs.first) return true;
-    if (lhs.first && !rhs.first) return false;
-
-    // If neither definition is null, then compare unique ids.
-    if (lhs.first && rhs.first) {
-      if (lhs.first->unique_id() < rhs.first->unique_id()) return true;
-      if (rhs.first->unique_id() < lhs.first->unique_id()) return false;
-    }
-
-    // Return false on equality.
-    if (!lhs.second && !rhs.second) return false;
-    if (!lhs.second) return true;
-    if (!rhs.second) return false;
-
-    // If neither user is null then compare unique ids.
-    return lhs.second->unique_id() < rhs.second->unique_id();
-  }
-};
-
 // A class for analyzing and managing defs and uses in an ir::Module.
+//
+// Definitions are kept in a table indexed by result id. The users of all ids
+// share one array, holding a slice per id sorted by the users' unique ids,
+// and the ids used by all instructions share another, holding a slice per
+// instruction indexed by its unique id. A slice that outgrows its space
+// moves to the end of its array, and an array is compacted once more than
+// half of it is space left behind by moved slices.
 class DefUseManager {
  public:
-  using IdToDefMap = std::unordered_map<uint32_t, ir::Instruction*>;
-  using IdToUsersMap = std::set<UserEntry, UserEntryLess>;
-
   // Constructs a def-use manager from the given |module|. All internal messages
   // will be communicated to the outside via the given message |consumer|. This
   // instance only keeps a reference to the |consumer|, so the |consumer| should
@@ -194,11 +154,6 @@ class DefUseManager {
   // instructions which decorate the decoration group will not be returned.
   std::vector<ir::Instruction*> GetAnnotations(uint32_t id) const;
 
-  // Returns the map from ids to their def instructions.
-  const IdToDefMap& id_to_defs() const { return id_to_def_; }
-  // Returns the map from instructions to their users.
-  const IdToUsersMap& id_to_users() const { return id_to_users_; }
-
   // Clear the internal def-use record of the given instruction |inst|. This
   // method will update the use information of the operand ids of |inst|. The
   // record: |inst| uses an |id|, will be removed from the use records of |id|.
@@ -219,33 +174,62 @@ class DefUseManager {
   void UpdateDefUse(ir::Instruction* inst);
 
  private:
-  using InstToUsedIdsMap =
-      std::unordered_map<const ir::Instruction*, std::vector<uint32_t>>;
-
-  // Returns the first location that {|def|, nullptr} could be inserted into the
-  // users map without violating ordering.
-  IdToUsersMap::const_iterator UsersBegin(const ir::Instruction* def) const;
-
-  // Returns true if |iter| has not reached the end of |def|'s users.
-  //
-  // In the first version |iter| is compared against the end of the map for
-  // validity before other checks. In the second version, |iter| is compared
-  // against |cached_end| for validity before other checks. This allows caching
-  // the map's end which is a performance improvement on some platforms.
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const ir::Instruction* def) const;
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const IdToUsersMap::const_iterator& cached_end,
-                   const ir::Instruction* def) const;
+  // A range of |users_| or |used_ids_|.
+  struct Slice {
+    uint32_t offset = 0;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+  };
+
+  // The ids used by an instruction. Instructions moved to a new address keep
+  // their unique id, so |inst| tells which one the entry is for. It is
+  // nullptr if the entry is unused.
+  struct UsedIds {
+    const ir::Instruction* inst = nullptr;
+    Slice slice;
+  };
+
+  // Grows |slice| of |pool| to hold at least |capacity| elements, moving it
+  // to the end of |pool| if it is not there already. Space left behind is
+  // added to |garbage|.
+  template <typename T>
+  static void ReserveSlice(std::vector<T>* pool, Slice* slice,
+                           uint32_t capacity, uint32_t* garbage);
+
+  // Returns the entry for the ids used by |inst|, or nullptr if |inst| has
+  // not been analyzed.
+  UsedIds* FindUsedIds(const ir::Instruction* inst);
+
+  // Adds |user| to the users of |id|, unless it is there already.
+  void AddUser(uint32_t id, ir::Instruction* user);
+  // Removes |user| from the users of |id|.
+  void RemoveUser(uint32_t id, const ir::Instruction* user);
+  // Removes every user of |id|.
+  void ClearUsers(uint32_t id);
+  // Removes the records of the ids |entry|'s instruction uses, and frees
+  // |entry| for reuse.
+  void EraseUseRecords(UsedIds* entry);
+
+  // Packs the slices of |users_| and |used_ids_| together, dropping the space
+  // left behind by moved slices.
+  void CompactUsers();
+  void CompactUsedIds();
 
   // Analyzes the defs and uses in the given |module| and populates data
   // structures in this class. Does nothing if |module| is nullptr.
   void AnalyzeDefUse(ir::Module* module);
 
-  IdToDefMap id_to_def_;      // Mapping from ids to their definitions
-  IdToUsersMap id_to_users_;  // Mapping from ids to their users
-  // Mapping from instructions to the ids used in the instruction.
-  InstToUsedIdsMap inst_to_used_ids_;
+  // Definitions indexed by result id, nullptr for ids without one
+  std::vector<ir::Instruction*> id_to_def_;
+  // Users of each id, indexed by the id, as slices of |users_|
+  std::vector<Slice> id_to_users_;
+  std::vector<ir::Instruction*> users_;
+  uint32_t users_garbage_ = 0;
+  // Ids used by each instruction, indexed by its unique id, as slices of
+  // |used_ids_|
+  std::vector<UsedIds> inst_to_used_ids_;
+  std::vector<uint32_t> used_ids_;
+  uint32_t used_ids_garbage_ = 0;
 };
 
 }  // namespace analysis
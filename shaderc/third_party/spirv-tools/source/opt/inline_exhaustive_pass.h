@@ -38,6 +38,9 @@ class InlineExhaustivePass : public InlinePass {
 
   const char* name() const override { return "inline-entry-points-exhaustive"; }
 
+  // Inlining only changes the blocks of the calling functions.
+  bool ReportsChangedFunctions() const override { return true; }
+
  private:
   // Exhaustively inline all function calls in func as well as in
   // all code that is inlined into func. Return true if func is modified.
@@ -23,6 +23,27 @@
 namespace spvtools {
 namespace ir {
 
+namespace {
+
+// Removes the entries of |map| for the functions in |functions|, and for
+// functions that are not in |live_functions|.
+template <typename FunctionMap>
+void DropFunctionEntries(
+    const std::vector<ir::Function*>& functions,
+    const std::unordered_set<const ir::Function*>& live_functions,
+    FunctionMap* map) {
+  for (ir::Function* fn : functions) map->erase(fn);
+  for (auto it = map->begin(); it != map->end();) {
+    if (live_functions.count(it->first) == 0) {
+      it = map->erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace
+
 void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisDefUse) {
     BuildDefUseManager();
@@ -33,6 +54,9 @@ void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisDecorations) {
     BuildDecorationManager();
   }
+  if (set & kAnalysisCombinators) {
+    InitializeCombinators();
+  }
   if (set & kAnalysisCFG) {
     BuildCFG();
   }
@@ -56,6 +80,16 @@ void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   }
 }
 
+void IRContext::PrepareForConcurrentReads(IRContext::Analysis set) {
+  BuildInvalidAnalyses(static_cast<Analysis>(set & ~valid_analyses_));
+  if (set & kAnalysisDecorations) {
+    decoration_mgr_->PrepareForConcurrentReads();
+  }
+  get_type_mgr();
+  get_constant_mgr();
+  get_feature_mgr();
+}
+
 void IRContext::InvalidateAnalysesExceptFor(
     IRContext::Analysis preserved_analyses) {
   uint32_t analyses_to_invalidate = valid_analyses_ & (~preserved_analyses);
@@ -92,6 +126,28 @@ void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
   valid_analyses_ = Analysis(valid_analyses_ & ~analyses_to_invalidate);
 }
 
+void IRContext::InvalidateFunctionAnalyses(
+    const std::vector<ir::Function*>& functions, Analysis analyses) {
+  std::unordered_set<const ir::Function*> live_functions;
+  for (auto& fn : *module()) live_functions.insert(&fn);
+
+  if ((analyses & kAnalysisCFG) && AreAnalysesValid(kAnalysisCFG)) {
+    cfg_->UpdateFunctions(functions);
+  }
+  if (analyses & kAnalysisDominatorAnalysis) {
+    DropFunctionEntries(functions, live_functions, &dominator_trees_);
+    DropFunctionEntries(functions, live_functions, &post_dominator_trees_);
+  }
+  if (analyses & kAnalysisLoopAnalysis) {
+    DropFunctionEntries(functions, live_functions, &loop_descriptors_);
+  }
+}
+
+uint32_t IRContext::GetAnalysisBuildCount(Analysis analysis) const {
+  auto it = analysis_build_counts_.find(analysis);
+  return it != analysis_build_counts_.end() ? it->second : 0;
+}
+
 Instruction* IRContext::KillInst(ir::Instruction* inst) {
   if (!inst) {
     return nullptr;
@@ -226,6 +282,41 @@ bool IRContext::IsConsistent() {
     return false;
   }
 
+  if (!CheckDominatorTrees()) {
+    return false;
+  }
+
+  return true;
+}
+
+bool IRContext::CheckDominatorTrees() {
+  // The trees are built from the CFG, so they can only be checked against a
+  // valid one.
+  if (!AreAnalysesValid(kAnalysisDominatorAnalysis) ||
+      !AreAnalysesValid(kAnalysisCFG)) {
+    return true;
+  }
+
+  for (auto& entry : dominator_trees_) {
+    opt::DominatorAnalysis fresh;
+    fresh.InitializeTree(entry.first);
+    for (const auto& block : *entry.first) {
+      if (entry.second.ImmediateDominator(&block) !=
+          fresh.ImmediateDominator(&block)) {
+        return false;
+      }
+    }
+  }
+  for (auto& entry : post_dominator_trees_) {
+    opt::PostDominatorAnalysis fresh;
+    fresh.InitializeTree(entry.first);
+    for (const auto& block : *entry.first) {
+      if (entry.second.ImmediateDominator(&block) !=
+          fresh.ImmediateDominator(&block)) {
+        return false;
+      }
+    }
+  }
   return true;
 }
 
@@ -542,6 +633,7 @@ void IRContext::InitializeCombinators() {
   }
 
   valid_analyses_ |= kAnalysisCombinators;
+  CountBuild(kAnalysisCombinators);
 }
 
 void IRContext::RemoveFromIdToName(const Instruction* inst) {
@@ -565,6 +657,7 @@ ir::LoopDescriptor* IRContext::GetLoopDescriptor(const ir::Function* f) {
   std::unordered_map<const ir::Function*, ir::LoopDescriptor>::iterator it =
       loop_descriptors_.find(f);
   if (it == loop_descriptors_.end()) {
+    CountBuild(kAnalysisLoopAnalysis);
     return &loop_descriptors_.emplace(std::make_pair(f, ir::LoopDescriptor(f)))
                 .first->second;
   }
@@ -580,6 +673,7 @@ opt::DominatorAnalysis* IRContext::GetDominatorAnalysis(const ir::Function* f) {
 
   if (dominator_trees_.find(f) == dominator_trees_.end()) {
     dominator_trees_[f].InitializeTree(f);
+    CountBuild(kAnalysisDominatorAnalysis);
   }
 
   return &dominator_trees_[f];
@@ -594,6 +688,7 @@ opt::PostDominatorAnalysis* IRContext::GetPostDominatorAnalysis(
 
   if (post_dominator_trees_.find(f) == post_dominator_trees_.end()) {
     post_dominator_trees_[f].InitializeTree(f);
+    CountBuild(kAnalysisDominatorAnalysis);
   }
 
   return &post_dominator_trees_[f];
@@ -312,12 +312,32 @@ class IRContext {
   // Rebuilds the analyses in |set| that are invalid.
   void BuildInvalidAnalyses(Analysis set);
 
+  // Builds the analyses in |set| that are invalid, and the type, constant and
+  // feature managers if they do not exist yet.  If |set| has the decoration
+  // analysis, the decorations of every ID are gathered too.  Afterwards,
+  // queries of them that do not create anything leave the context unchanged,
+  // so several threads may make them as long as no thread changes the module.
+  void PrepareForConcurrentReads(Analysis set);
+
   // Invalidates all of the analyses except for those in |preserved_analyses|.
   void InvalidateAnalysesExceptFor(Analysis preserved_analyses);
 
   // Invalidates the analyses marked in |analyses_to_invalidate|.
   void InvalidateAnalyses(Analysis analyses_to_invalidate);
 
+  // Invalidates the CFG, dominator and loop analyses in |analyses| for the
+  // functions in |functions| only, and drops them for functions that are no
+  // longer in the module.  No function may have been added since they were
+  // built.  The CFG is updated right away, while the dominator trees and loop
+  // descriptors of those functions are rebuilt on demand.
+  void InvalidateFunctionAnalyses(const std::vector<ir::Function*>& functions,
+                                  Analysis analyses);
+
+  // Returns the number of times |analysis| has been built.  Each dominator
+  // tree, post-dominator tree and loop descriptor counts as a build of its
+  // analysis.
+  uint32_t GetAnalysisBuildCount(Analysis analysis) const;
+
   // Deletes the instruction defining the given |id|. Returns true on
   // success, false if the given |id| is not defined at all. This method also
   // erases the name, decorations, and defintion of |id|.
@@ -450,6 +470,7 @@ class IRContext {
   void BuildDefUseManager() {
     def_use_mgr_.reset(new opt::analysis::DefUseManager(module()));
     valid_analyses_ = valid_analyses_ | kAnalysisDefUse;
+    CountBuild(kAnalysisDefUse);
   }
 
   // Builds the instruction-block map for the whole module.
@@ -463,27 +484,32 @@ class IRContext {
       }
     }
     valid_analyses_ = valid_analyses_ | kAnalysisInstrToBlockMapping;
+    CountBuild(kAnalysisInstrToBlockMapping);
   }
 
   void BuildDecorationManager() {
     decoration_mgr_.reset(new opt::analysis::DecorationManager(module()));
     valid_analyses_ = valid_analyses_ | kAnalysisDecorations;
+    CountBuild(kAnalysisDecorations);
   }
 
   void BuildCFG() {
     cfg_.reset(new ir::CFG(module()));
     valid_analyses_ = valid_analyses_ | kAnalysisCFG;
+    CountBuild(kAnalysisCFG);
   }
 
   void BuildScalarEvolutionAnalysis() {
     scalar_evolution_analysis_.reset(new opt::ScalarEvolutionAnalysis(this));
     valid_analyses_ = valid_analyses_ | kAnalysisScalarEvolution;
+    CountBuild(kAnalysisScalarEvolution);
   }
 
   // Builds the liveness analysis from scratch, even if it was already valid.
   void BuildRegPressureAnalysis() {
     reg_pressure_.reset(new opt::LivenessAnalysis(this));
     valid_analyses_ = valid_analyses_ | kAnalysisRegisterPressure;
+    CountBuild(kAnalysisRegisterPressure);
   }
 
   // Builds the value number table analysis from scratch, even if it was already
@@ -491,6 +517,7 @@ class IRContext {
   void BuildValueNumberTable() {
     vn_table_.reset(new opt::ValueNumberTable(this));
     valid_analyses_ = valid_analyses_ | kAnalysisValueNumberTable;
+    CountBuild(kAnalysisValueNumberTable);
   }
 
   // Removes all computed dominator and post-dominator trees. This will force
@@ -519,6 +546,9 @@ class IRContext {
   // accordingly.
   void InitializeCombinators();
 
+  // Records that |analysis| was built.
+  void CountBuild(Analysis analysis) { ++analysis_build_counts_[analysis]; }
+
   // Add the combinator opcode for the given capability to combinator_ops_.
   void AddCombinatorsForCapability(uint32_t capability);
 
@@ -532,6 +562,11 @@ class IRContext {
   // true if the cfg is invalidated.
   bool CheckCFG();
 
+  // Returns false if a cached dominator or post-dominator tree differs from
+  // one built from the current CFG.  Returns true if either analysis is
+  // invalid.
+  bool CheckDominatorTrees();
+
   // The SPIR-V syntax context containing grammar tables for opcodes and
   // operands.
   spv_context syntax_context_;
@@ -601,6 +636,9 @@ class IRContext {
   std::unique_ptr<opt::LivenessAnalysis> reg_pressure_;
 
   std::unique_ptr<opt::ValueNumberTable> vn_table_;
+
+  // The number of times each analysis has been built.
+  std::map<Analysis, uint32_t> analysis_build_counts_;
 };
 
 inline ir::IRContext::Analysis operator|(ir::IRContext::Analysis lhs,
@@ -831,6 +869,7 @@ void IRContext::BuildIdToNameMap() {
     }
   }
   valid_analyses_ = valid_analyses_ | kAnalysisNameMap;
+  CountBuild(kAnalysisNameMap);
 }
 
 IteratorRange<std::multimap<uint32_t, Instruction*>::iterator>
@@ -30,9 +30,8 @@ const uint32_t kVariableInitIdInIdx = 1;
 
 }  // anonymous namespace
 
-bool LocalSingleStoreElimPass::LocalSingleStoreElim(ir::Function* func) {
-  bool modified = false;
-
+void LocalSingleStoreElimPass::FindSingleStores(
+    ir::Function* func, std::vector<SingleStore>* single_stores) const {
   // Check all function scope variables in |func|.
   ir::BasicBlock* entry_block = &*func->begin();
   for (ir::Instruction& inst : *entry_block) {
@@ -40,7 +39,23 @@ bool LocalSingleStoreElimPass::LocalSingleStoreElim(ir::Function* func) {
       break;
     }
 
-    modified |= ProcessVariable(&inst);
+    SingleStore single_store;
+    FindUses(&inst, &single_store.uses);
+    single_store.store_inst =
+        FindSingleStoreAndCheckUses(&inst, single_store.uses);
+    if (single_store.store_inst != nullptr) {
+      single_stores->push_back(std::move(single_store));
+    }
+  }
+}
+
+bool LocalSingleStoreElimPass::LocalSingleStoreElim(
+    const std::vector<SingleStore>& single_stores) {
+  // Rewriting the loads of one variable does not add or remove uses of the
+  // others, so all of them can be found before the first rewrite.
+  bool modified = false;
+  for (const SingleStore& single_store : single_stores) {
+    modified |= RewriteLoads(single_store.store_inst, single_store.uses);
   }
   return modified;
 }
@@ -69,10 +84,14 @@ Pass::Status LocalSingleStoreElimPass::ProcessImpl() {
   // Do not process if any disallowed extensions are enabled
   if (!AllExtensionsSupported()) return Status::SuccessWithoutChange;
   // Process all entry point functions
-  ProcessFunction pfn = [this](ir::Function* fp) {
-    return LocalSingleStoreElim(fp);
-  };
-  bool modified = ProcessEntryPointCallTree(pfn, get_module());
+  bool modified = ProcessFunctionsInParallel<std::vector<SingleStore>>(
+      GetEntryPointCallTree(get_module()), ir::IRContext::kAnalysisDefUse,
+      [this](ir::Function* fp, std::vector<SingleStore>* single_stores) {
+        FindSingleStores(fp, single_stores);
+      },
+      [this](ir::Function*, const std::vector<SingleStore>& single_stores) {
+        return LocalSingleStoreElim(single_stores);
+      });
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
 
@@ -120,19 +139,6 @@ void LocalSingleStoreElimPass::InitExtensionWhiteList() {
       "SPV_EXT_descriptor_indexing",
   });
 }
-bool LocalSingleStoreElimPass::ProcessVariable(ir::Instruction* var_inst) {
-  vector<ir::Instruction*> users;
-  FindUses(var_inst, &users);
-
-  ir::Instruction* store_inst = FindSingleStoreAndCheckUses(var_inst, users);
-
-  if (store_inst == nullptr) {
-    return false;
-  }
-
-  return RewriteLoads(store_inst, users);
-}
-
 ir::Instruction* LocalSingleStoreElimPass::FindSingleStoreAndCheckUses(
     ir::Instruction* var_inst, const vector<ir::Instruction*>& users) const {
   // Make sure there is exactly 1 store.
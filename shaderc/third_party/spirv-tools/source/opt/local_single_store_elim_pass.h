@@ -36,21 +36,41 @@ namespace opt {
 class LocalSingleStoreElimPass : public Pass {
   using cbb_ptr = const ir::BasicBlock*;
 
+  // The single store to a variable, and the uses of the variable.
+  struct SingleStore {
+    ir::Instruction* store_inst;
+    std::vector<ir::Instruction*> uses;
+  };
+
  public:
   LocalSingleStoreElimPass();
   const char* name() const override { return "eliminate-local-single-store"; }
   Status Process(ir::IRContext* irContext) override;
 
   ir::IRContext::Analysis GetPreservedAnalyses() override {
-    return ir::IRContext::kAnalysisDefUse;
+    return ir::IRContext::kAnalysisDefUse |
+           ir::IRContext::kAnalysisInstrToBlockMapping |
+           ir::IRContext::kAnalysisDecorations |
+           ir::IRContext::kAnalysisCombinators | ir::IRContext::kAnalysisCFG |
+           ir::IRContext::kAnalysisDominatorAnalysis |
+           ir::IRContext::kAnalysisLoopAnalysis |
+           ir::IRContext::kAnalysisNameMap;
   }
 
+  // Finding the single stores only reads the module.
+  bool IsFunctionLocal() const override { return true; }
+
  private:
-  // Do "single-store" optimization of function variables defined only
-  // with a single non-access-chain store in |func|. Replace all their
-  // non-access-chain loads with the value that is stored and eliminate
-  // any resulting dead code.
-  bool LocalSingleStoreElim(ir::Function* func);
+  // Adds to |single_stores| the function variables of |func| that are
+  // defined only with a single non-access-chain store.  Does not change the
+  // module.
+  void FindSingleStores(ir::Function* func,
+                        std::vector<SingleStore>* single_stores) const;
+
+  // Do "single-store" optimization of the variables in |single_stores|.
+  // Replace all their non-access-chain loads that are dominated by the store
+  // with the value that is stored and eliminate any resulting dead code.
+  bool LocalSingleStoreElim(const std::vector<SingleStore>& single_stores);
 
   // Initialize extensions whitelist
   void InitExtensionWhiteList();
@@ -61,12 +81,6 @@ class LocalSingleStoreElimPass : public Pass {
   void Initialize(ir::IRContext* irContext);
   Pass::Status ProcessImpl();
 
-  // If there is a single store to |var_inst|, and it covers the entire
-  // variable, then replace all of the loads of the entire variable that are
-  // dominated by the store by the value that was stored.  Returns true if the
-  // module was changed.
-  bool ProcessVariable(ir::Instruction* var_inst);
-
   // Collects all of the uses of |var_inst| into |uses|.  This looks through
   // OpObjectCopy's that copy the address of the variable, and collects those
   // uses as well.
@@ -16,6 +16,9 @@
 
 #include "pass.h"
 
+#include <atomic>
+#include <thread>
+
 #include "iterator.h"
 
 namespace spvtools {
@@ -28,7 +31,11 @@ const uint32_t kTypePointerTypeIdInIdx = 1;
 
 }  // namespace
 
-Pass::Pass() : consumer_(nullptr), context_(nullptr), already_run_(false) {}
+Pass::Pass()
+    : consumer_(nullptr),
+      context_(nullptr),
+      already_run_(false),
+      thread_count_(1) {}
 
 void Pass::AddCalls(ir::Function* func, std::queue<uint32_t>* todo) {
   for (auto bi = func->begin(); bi != func->end(); ++bi)
@@ -49,6 +56,16 @@ bool Pass::ProcessEntryPointCallTree(ProcessFunction& pfn, ir::Module* module) {
   return ProcessCallTreeFromRoots(pfn, id2function, &roots);
 }
 
+std::vector<ir::Function*> Pass::GetEntryPointCallTree(ir::Module* module) {
+  std::vector<ir::Function*> functions;
+  ProcessFunction collect = [&functions](ir::Function* fp) {
+    functions.push_back(fp);
+    return false;
+  };
+  ProcessEntryPointCallTree(collect, module);
+  return functions;
+}
+
 bool Pass::ProcessReachableCallTree(ProcessFunction& pfn,
                                     ir::IRContext* irContext) {
   // Map from function's result id to function
@@ -95,7 +112,10 @@ bool Pass::ProcessCallTreeFromRoots(
     roots->pop();
     if (done.insert(fi).second) {
       ir::Function* fn = id2function.at(fi);
-      modified = pfn(fn) || modified;
+      if (pfn(fn)) {
+        changed_functions_.push_back(fn);
+        modified = true;
+      }
       AddCalls(fn, roots);
     }
   }
@@ -110,12 +130,39 @@ Pass::Status Pass::Run(ir::IRContext* ctx) {
 
   Pass::Status status = Process(ctx);
   if (status == Status::SuccessWithChange) {
-    ctx->InvalidateAnalysesExceptFor(GetPreservedAnalyses());
+    ir::IRContext::Analysis preserved = GetPreservedAnalyses();
+    if (ReportsChangedFunctions()) {
+      const ir::IRContext::Analysis function_analyses =
+          ir::IRContext::kAnalysisCFG |
+          ir::IRContext::kAnalysisDominatorAnalysis |
+          ir::IRContext::kAnalysisLoopAnalysis;
+      ctx->InvalidateFunctionAnalyses(
+          changed_functions_,
+          static_cast<ir::IRContext::Analysis>(function_analyses & ~preserved));
+      preserved |= function_analyses;
+    }
+    ctx->InvalidateAnalysesExceptFor(preserved);
   }
   assert(ctx->IsConsistent());
   return status;
 }
 
+void Pass::ParallelFor(size_t count, const std::function<void(size_t)>& f) {
+  std::atomic<size_t> next(0);
+  auto worker = [count, &f, &next]() {
+    for (size_t i = next++; i < count; i = next++) f(i);
+  };
+
+  // The calling thread is one of the workers.
+  const size_t extra_threads =
+      std::min(static_cast<size_t>(thread_count_), count) - 1;
+  std::vector<std::thread> threads;
+  threads.reserve(extra_threads);
+  for (size_t i = 0; i < extra_threads; ++i) threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads) thread.join();
+}
+
 uint32_t Pass::GetPointeeTypeId(const ir::Instruction* ptrInst) const {
   const uint32_t ptrTypeId = ptrInst->type_id();
   const ir::Instruction* ptrTypeInst = get_def_use_mgr()->GetDef(ptrTypeId);
@@ -16,11 +16,13 @@
 #define LIBSPIRV_OPT_PASS_H_
 
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "basic_block.h"
 #include "def_use_manager.h"
@@ -132,6 +134,23 @@ class Pass {
     return ir::IRContext::kAnalysisNone;
   }
 
+  // Returns true if the pass only changes the blocks and branches of a
+  // function while processing it with ProcessEntryPointCallTree,
+  // ProcessReachableCallTree or ProcessFunctionsInParallel, and the
+  // processing returns true, and the pass does not add functions.  The CFG,
+  // dominator and loop analyses of the other functions are then kept even if
+  // GetPreservedAnalyses() does not include them.
+  virtual bool ReportsChangedFunctions() const { return false; }
+
+  // Returns true if the pass only changes one function at a time and splits
+  // its work on a function into an analysis that only reads the module and a
+  // rewrite, using ProcessFunctionsInParallel.  Such passes may be given more
+  // than one thread.
+  virtual bool IsFunctionLocal() const { return false; }
+
+  // Sets the number of threads ProcessFunctionsInParallel may use.
+  void SetThreadCount(uint32_t count) { thread_count_ = count; }
+
   // Return type id for |ptrInst|'s pointee
   uint32_t GetPointeeTypeId(const ir::Instruction* ptrInst) const;
 
@@ -148,7 +167,32 @@ class Pass {
   // Return the next available SSA id and increment it.
   uint32_t TakeNextId() { return context_->TakeNextId(); }
 
+  // Returns the functions that ProcessEntryPointCallTree visits, in the order
+  // it visits them.
+  std::vector<ir::Function*> GetEntryPointCallTree(ir::Module* module);
+
+  // Calls |analyze| on each function in |functions| to fill in a |Result|,
+  // and then |apply| on each function and its result, in order.  Returns true
+  // if any call to |apply| returns true.
+  //
+  // With more than one thread the calls to |analyze| run concurrently, before
+  // any call to |apply|.  The analyses in |analyses| are built beforehand, and
+  // |analyze| may only query them, the type, constant and feature managers,
+  // and the instructions of the module.  It must not change anything.  The
+  // result of |analyze| must not depend on what |apply| did to other
+  // functions.
+  template <typename Result>
+  bool ProcessFunctionsInParallel(
+      const std::vector<ir::Function*>& functions,
+      ir::IRContext::Analysis analyses,
+      const std::function<void(ir::Function*, Result*)>& analyze,
+      const std::function<bool(ir::Function*, const Result&)>& apply);
+
  private:
+  // Calls |f| with each index less than |count|, spread over up to
+  // |thread_count_| threads.  Returns once all calls are done.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& f);
+
   MessageConsumer consumer_;  // Message consumer.
 
   // The context that this pass belongs to.
@@ -158,8 +202,47 @@ class Pass {
   // enforce proper resetting of internal state for each instance.  This member
   // is used to check that we do not run the same instance twice.
   bool already_run_;
+
+  // The number of threads a function-local pass may use.
+  uint32_t thread_count_;
+
+  // The functions for which a ProcessFunction call returned true.
+  std::vector<ir::Function*> changed_functions_;
 };
 
+template <typename Result>
+bool Pass::ProcessFunctionsInParallel(
+    const std::vector<ir::Function*>& functions,
+    ir::IRContext::Analysis analyses,
+    const std::function<void(ir::Function*, Result*)>& analyze,
+    const std::function<bool(ir::Function*, const Result&)>& apply) {
+  bool modified = false;
+  if (thread_count_ <= 1 || functions.size() <= 1) {
+    for (ir::Function* function : functions) {
+      Result result;
+      analyze(function, &result);
+      if (apply(function, result)) {
+        changed_functions_.push_back(function);
+        modified = true;
+      }
+    }
+    return modified;
+  }
+
+  context()->PrepareForConcurrentReads(analyses);
+  std::vector<Result> results(functions.size());
+  ParallelFor(functions.size(), [&functions, &results, &analyze](size_t i) {
+    analyze(functions[i], &results[i]);
+  });
+  for (size_t i = 0; i < functions.size(); ++i) {
+    if (apply(functions[i], results[i])) {
+      changed_functions_.push_back(functions[i]);
+      modified = true;
+    }
+  }
+  return modified;
+}
+
 }  // namespace opt
 }  // namespace spvtools
 
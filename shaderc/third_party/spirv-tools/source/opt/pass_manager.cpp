@@ -14,6 +14,7 @@
 
 #include "pass_manager.h"
 
+#include <iomanip>
 #include <iostream>
 #include <vector>
 
@@ -25,6 +26,37 @@ namespace spvtools {
 
 namespace opt {
 
+namespace {
+
+// Prints how many times each analysis of |context| has been built.
+void PrintAnalysisBuildCounts(const ir::IRContext* context,
+                              std::ostream* out) {
+  static const struct {
+    ir::IRContext::Analysis analysis;
+    const char* name;
+  } kAnalyses[] = {
+      {ir::IRContext::kAnalysisDefUse, "def-use"},
+      {ir::IRContext::kAnalysisInstrToBlockMapping, "instr-to-block"},
+      {ir::IRContext::kAnalysisDecorations, "decorations"},
+      {ir::IRContext::kAnalysisCombinators, "combinators"},
+      {ir::IRContext::kAnalysisCFG, "cfg"},
+      {ir::IRContext::kAnalysisDominatorAnalysis, "dominators"},
+      {ir::IRContext::kAnalysisLoopAnalysis, "loops"},
+      {ir::IRContext::kAnalysisNameMap, "name-map"},
+      {ir::IRContext::kAnalysisScalarEvolution, "scalar-evolution"},
+      {ir::IRContext::kAnalysisRegisterPressure, "register-pressure"},
+      {ir::IRContext::kAnalysisValueNumberTable, "value-numbers"},
+  };
+  *out << std::setw(30) << "ANALYSIS name" << std::setw(12) << "Builds"
+       << std::endl;
+  for (const auto& entry : kAnalyses) {
+    *out << std::setw(30) << entry.name << std::setw(12)
+         << context->GetAnalysisBuildCount(entry.analysis) << std::endl;
+  }
+}
+
+}  // namespace
+
 Pass::Status PassManager::Run(ir::IRContext* context) {
   auto status = Pass::Status::SuccessWithoutChange;
 
@@ -46,6 +78,7 @@ Pass::Status PassManager::Run(ir::IRContext* context) {
   for (auto& pass : passes_) {
     print_disassembly("; IR before pass ", pass.get());
     SPIRV_TIMER_SCOPED(time_report_stream_, (pass ? pass->name() : ""), true);
+    if (pass->IsFunctionLocal()) pass->SetThreadCount(thread_count_);
     const auto one_status = pass->Run(context);
     if (one_status == Pass::Status::Failure) return one_status;
     if (one_status == Pass::Status::SuccessWithChange) status = one_status;
@@ -54,6 +87,9 @@ Pass::Status PassManager::Run(ir::IRContext* context) {
     pass.reset(nullptr);
   }
   print_disassembly("; IR after last pass", nullptr);
+  if (time_report_stream_) {
+    PrintAnalysisBuildCounts(context, time_report_stream_);
+  }
 
   // Set the Id bound in the header in case a pass forgot to do so.
   //
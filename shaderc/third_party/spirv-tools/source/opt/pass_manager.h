@@ -42,7 +42,8 @@ class PassManager {
   PassManager()
       : consumer_(nullptr),
         print_all_stream_(nullptr),
-        time_report_stream_(nullptr) {}
+        time_report_stream_(nullptr),
+        thread_count_(1) {}
 
   // Sets the message consumer to the given |consumer|.
   void SetMessageConsumer(MessageConsumer c) { consumer_ = std::move(c); }
@@ -88,6 +89,14 @@ class PassManager {
     return *this;
   }
 
+  // Sets the number of threads that passes which are function local may use
+  // to analyze the functions of the module.  The default is 1.  The result of
+  // Run() does not depend on it.
+  PassManager& SetThreadCount(uint32_t count) {
+    thread_count_ = count;
+    return *this;
+  }
+
  private:
   // Consumer for messages.
   MessageConsumer consumer_;
@@ -99,6 +108,8 @@ class PassManager {
   // The output stream to write the resource utilization of each pass. If this
   // is null, no output is generated.
   std::ostream* time_report_stream_;
+  // The number of threads given to function-local passes.
+  uint32_t thread_count_;
 };
 
 inline void PassManager::AddPass(std::unique_ptr<Pass> pass) {
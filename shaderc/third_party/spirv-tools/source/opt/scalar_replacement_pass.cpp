@@ -379,7 +379,7 @@ uint32_t ScalarReplacementPass::GetOrCreatePointerType(uint32_t id) {
         global.GetSingleWordInOperand(1u) == id) {
       if (!context()->get_feature_mgr()->HasExtension(
               libspirv::Extension::kSPV_KHR_variable_pointers) ||
-          get_decoration_mgr()->GetDecorationsFor(id, false).empty()) {
+          get_decoration_mgr()->GetDecorationRange(id, false).empty()) {
         // If variable pointers is enabled, only reuse a decoration-less
         // pointer of the correct type.
         ptrId = global.result_id();
@@ -561,7 +561,7 @@ bool ScalarReplacementPass::CheckType(const ir::Instruction* typeInst) const {
 bool ScalarReplacementPass::CheckTypeAnnotations(
     const ir::Instruction* typeInst) const {
   for (auto inst :
-       get_decoration_mgr()->GetDecorationsFor(typeInst->result_id(), false)) {
+       get_decoration_mgr()->GetDecorationRange(typeInst->result_id(), false)) {
     uint32_t decoration;
     if (inst->opcode() == SpvOpDecorate) {
       decoration = inst->GetSingleWordInOperand(1u);
@@ -594,7 +594,7 @@ bool ScalarReplacementPass::CheckTypeAnnotations(
 bool ScalarReplacementPass::CheckAnnotations(
     const ir::Instruction* varInst) const {
   for (auto inst :
-       get_decoration_mgr()->GetDecorationsFor(varInst->result_id(), false)) {
+       get_decoration_mgr()->GetDecorationRange(varInst->result_id(), false)) {
     assert(inst->opcode() == SpvOpDecorate);
     uint32_t decoration = inst->GetSingleWordInOperand(1u);
     switch (decoration) {
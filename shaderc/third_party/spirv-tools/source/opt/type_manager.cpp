@@ -624,9 +624,8 @@ Type* TypeManager::RecordIfTypeDefinition(
   } else {
     SPIRV_ASSERT(consumer_, type != nullptr,
                  "type should not be nullptr at this point");
-    std::vector<ir::Instruction*> decorations =
-        context()->get_decoration_mgr()->GetDecorationsFor(id, true);
-    for (auto dec : decorations) {
+    for (auto dec :
+         context()->get_decoration_mgr()->GetDecorationRange(id, true)) {
       AttachDecoration(*dec, type);
     }
     std::unique_ptr<Type> unique(type);
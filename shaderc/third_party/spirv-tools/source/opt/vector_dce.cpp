@@ -26,19 +26,22 @@ namespace opt {
 Pass::Status VectorDCE::Process(ir::IRContext* ctx) {
   InitializeProcessing(ctx);
 
-  bool modified = false;
+  std::vector<ir::Function*> functions;
   for (ir::Function& function : *get_module()) {
-    modified |= VectorDCEFunction(&function);
+    functions.push_back(&function);
   }
+  bool modified = ProcessFunctionsInParallel<LiveComponentMap>(
+      functions,
+      ir::IRContext::kAnalysisDefUse | ir::IRContext::kAnalysisCombinators,
+      [this](ir::Function* function, LiveComponentMap* live_components) {
+        FindLiveComponents(function, live_components);
+      },
+      [this](ir::Function* function, const LiveComponentMap& live_components) {
+        return RewriteInstructions(function, live_components);
+      });
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
 
-bool VectorDCE::VectorDCEFunction(ir::Function* function) {
-  LiveComponentMap live_components;
-  FindLiveComponents(function, &live_components);
-  return RewriteInstructions(function, live_components);
-}
-
 void VectorDCE::FindLiveComponents(ir::Function* function,
                                    LiveComponentMap* live_components) {
   std::vector<WorkListItem> work_list;
@@ -40,6 +40,9 @@ class VectorDCE : public MemPass {
   const char* name() const override { return "vector-dce"; }
   Status Process(ir::IRContext*) override;
 
+  // Finding the live components only reads the module.
+  bool IsFunctionLocal() const override { return true; }
+
   VectorDCE() : all_components_live_(kMaxVectorSize) {
     for (uint32_t i = 0; i < kMaxVectorSize; i++) {
       all_components_live_.Set(i);
@@ -56,10 +59,6 @@ class VectorDCE : public MemPass {
   }
 
  private:
-  // Runs the vector dce pass on |function|.  Returns true if |function| was
-  // modified.
-  bool VectorDCEFunction(ir::Function* function);
-
   // Identifies the live components of the vectors that are results of
   // instructions in |function|.  The results are stored in |live_components|.
   void FindLiveComponents(ir::Function* function,
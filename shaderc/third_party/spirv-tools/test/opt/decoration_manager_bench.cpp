@@ -0,0 +1,186 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Micro-benchmark for DecorationManager queries on a decoration heavy module,
+// shaped like HLSL output: every stage input carries a location and a
+// semantic string, every structured buffer has a counter buffer, and a
+// decoration group is applied to all inputs.
+//
+// Usage: decoration_manager_bench [input_count [buffer_count [repetitions]]]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "opt/build_module.h"
+#include "opt/decoration_manager.h"
+#include "opt/ir_context.h"
+
+namespace {
+
+using spvtools::ir::Instruction;
+using spvtools::opt::analysis::DecorationManager;
+
+std::string MakeModule(uint32_t input_count, uint32_t buffer_count) {
+  std::ostringstream text;
+  text << "OpCapability Shader\n"
+       << "OpExtension \"SPV_GOOGLE_decorate_string\"\n"
+       << "OpExtension \"SPV_GOOGLE_hlsl_functionality1\"\n"
+       << "OpMemoryModel Logical GLSL450\n"
+       << "OpEntryPoint Fragment %main \"main\"";
+  for (uint32_t i = 0; i < input_count; ++i) text << " %in" << i;
+  text << "\nOpExecutionMode %main OriginUpperLeft\n";
+
+  text << "OpDecorate %group RelaxedPrecision\n"
+       << "%group = OpDecorationGroup\n"
+       << "OpGroupDecorate %group";
+  for (uint32_t i = 0; i < input_count; ++i) text << " %in" << i;
+  text << "\n";
+  for (uint32_t i = 0; i < input_count; ++i) {
+    text << "OpDecorate %in" << i << " Location " << i << "\n"
+         << "OpDecorateStringGOOGLE %in" << i
+         << " HlslSemanticGOOGLE \"TEXCOORD" << i << "\"\n";
+  }
+  text << "OpDecorate %rt ArrayStride 4\n"
+       << "OpMemberDecorate %sb 0 Offset 0\n"
+       << "OpDecorate %sb BufferBlock\n"
+       << "OpMemberDecorate %cs 0 Offset 0\n"
+       << "OpDecorate %cs BufferBlock\n";
+  for (uint32_t i = 0; i < buffer_count; ++i) {
+    text << "OpDecorate %buf" << i << " DescriptorSet 0\n"
+         << "OpDecorate %buf" << i << " Binding " << 2 * i << "\n"
+         << "OpDecorateStringGOOGLE %buf" << i
+         << " HlslSemanticGOOGLE \"BUFFER" << i << "\"\n"
+         << "OpDecorate %cnt" << i << " DescriptorSet 0\n"
+         << "OpDecorate %cnt" << i << " Binding " << 2 * i + 1 << "\n"
+         << "OpDecorateId %buf" << i << " HlslCounterBufferGOOGLE %cnt" << i
+         << "\n";
+  }
+
+  text << "%void = OpTypeVoid\n"
+       << "%fn = OpTypeFunction %void\n"
+       << "%float = OpTypeFloat 32\n"
+       << "%int = OpTypeInt 32 1\n"
+       << "%v4 = OpTypeVector %float 4\n"
+       << "%rt = OpTypeRuntimeArray %float\n"
+       << "%sb = OpTypeStruct %rt\n"
+       << "%cs = OpTypeStruct %int\n"
+       << "%pin = OpTypePointer Input %v4\n"
+       << "%psb = OpTypePointer Uniform %sb\n"
+       << "%pcs = OpTypePointer Uniform %cs\n";
+  for (uint32_t i = 0; i < input_count; ++i)
+    text << "%in" << i << " = OpVariable %pin Input\n";
+  for (uint32_t i = 0; i < buffer_count; ++i) {
+    text << "%buf" << i << " = OpVariable %psb Uniform\n"
+         << "%cnt" << i << " = OpVariable %pcs Uniform\n";
+  }
+  text << "%main = OpFunction %void None %fn\n"
+       << "%entry = OpLabel\n"
+       << "OpReturn\n"
+       << "OpFunctionEnd\n";
+  return text.str();
+}
+
+// Runs |f| |repetitions| times and prints the mean time per run.
+template <typename F>
+void Measure(const char* name, uint32_t repetitions, F f) {
+  const auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < repetitions; ++i) f();
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  printf("%-28s %12.2f us\n", name, elapsed.count() / repetitions);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const uint32_t input_count = argc > 1 ? atoi(argv[1]) : 256;
+  const uint32_t buffer_count = argc > 2 ? atoi(argv[2]) : 256;
+  const uint32_t repetitions = argc > 3 ? atoi(argv[3]) : 100;
+
+  std::unique_ptr<spvtools::ir::IRContext> context =
+      spvtools::BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr,
+                            MakeModule(input_count, buffer_count));
+  if (!context) {
+    fprintf(stderr, "error: failed to build the module\n");
+    return 1;
+  }
+
+  std::vector<uint32_t> ids;
+  for (const Instruction& inst : context->types_values())
+    ids.push_back(inst.result_id());
+  // The first annotation decorates the group.
+  const uint32_t group_id =
+      context->module()->annotation_begin()->GetSingleWordInOperand(0u);
+  DecorationManager* decoration_mgr = context->get_decoration_mgr();
+
+  // Keeps the compiler from dropping the queries.
+  size_t sink = 0;
+  printf("%u ids, %u inputs, %u buffers\n", static_cast<uint32_t>(ids.size()),
+         input_count, buffer_count);
+
+  Measure("analyze", repetitions, [&context, &sink]() {
+    DecorationManager decoration_mgr(context->module());
+    sink += decoration_mgr.GetDecorationsFor(1u, true).size();
+  });
+  Measure("GetDecorationsFor", repetitions, [&]() {
+    for (uint32_t id : ids)
+      sink += decoration_mgr->GetDecorationsFor(id, false).size();
+  });
+  Measure("GetDecorationRange", repetitions, [&]() {
+    for (uint32_t id : ids) {
+      for (const Instruction* inst :
+           decoration_mgr->GetDecorationRange(id, false))
+        sink += inst->opcode();
+    }
+  });
+  Measure("WhileEachDecoration", repetitions, [&]() {
+    for (uint32_t id : ids) {
+      decoration_mgr->WhileEachDecoration(
+          id, SpvDecorationHlslSemanticGOOGLE, [&sink](const Instruction&) {
+            ++sink;
+            return true;
+          });
+    }
+  });
+  Measure("HaveTheSameDecorations", repetitions, [&]() {
+    for (size_t i = 1; i < ids.size(); ++i)
+      sink += decoration_mgr->HaveTheSameDecorations(ids[i - 1], ids[i]);
+  });
+
+  // Adding and removing a decoration of the group invalidates the gathered
+  // decorations of every input.
+  Measure("change group and query", repetitions, [&]() {
+    std::unique_ptr<Instruction> decoration(new Instruction(
+        context.get(), SpvOpDecorate, 0, 0,
+        {{SPV_OPERAND_TYPE_ID, {group_id}},
+         {SPV_OPERAND_TYPE_DECORATION, {SpvDecorationFlat}}}));
+    Instruction* inst = decoration.get();
+    context->module()->AddAnnotationInst(std::move(decoration));
+    context->AnalyzeUses(inst);
+    for (uint32_t id : ids) {
+      for (const Instruction* dec :
+           decoration_mgr->GetDecorationRange(id, true))
+        sink += dec->opcode();
+    }
+    context->KillInst(inst);
+  });
+
+  printf("checksum %zu\n", sink);
+  return 0;
+}
@@ -129,6 +129,11 @@ typedef struct String {
   const char*           string;
 } String;
 
+typedef struct PointerAccess {
+  uint32_t              id;
+  uint32_t              flags;
+} PointerAccess;
+
 typedef struct Function {
   uint32_t              id;
   uint32_t              callee_count;
@@ -136,6 +141,13 @@ typedef struct Function {
   struct Function**     callee_ptrs;
   uint32_t              accessed_ptr_count;
   uint32_t*             accessed_ptrs;
+  // Image and sampler operands of each OpSampledImage
+  uint32_t              sampled_image_count;
+  uint32_t*             sampled_images;
+  // Variables reached by loads, stores, image reads and writes and atomics,
+  // sorted by id
+  uint32_t              pointer_access_count;
+  PointerAccess*        pointer_accesses;
 } Function;
 
 typedef struct Parser {
@@ -156,12 +168,25 @@ typedef struct Parser {
   uint32_t              type_count;
   uint32_t              descriptor_count;
   uint32_t              push_constant_count;
+
+  // Only populated by the optional analyses, see ParseIds()
+  uint32_t              id_bound;
+  Node**                id_nodes;
+
+  // Only populated when the module is created with an entry point filter,
+  // see SelectEntryPoints(): the selected entry point functions and the
+  // variables their call graphs access, both sorted
+  const SpvReflectShaderModuleOptions* p_options;
+  uint32_t              selected_function_count;
+  uint32_t*             selected_functions;
+  uint32_t              used_variable_count;
+  uint32_t*             used_variables;
 } Parser;
 
-//static uint32_t Min(uint32_t a, uint32_t b)
-//{
-//  return a < b ? a : b;
-//}
+static uint32_t Min(uint32_t a, uint32_t b)
+{
+  return a < b ? a : b;
+}
 
 static uint32_t Max(uint32_t a, uint32_t b)
 {
@@ -494,16 +519,21 @@ static void DestroyParser(Parser* p_parser)
       }
     }
 
-    // Free functions
-    for (size_t i = 0; i < p_parser->function_count; ++i) {
+    // Free functions, which are not allocated if parsing stopped early
+    for (size_t i = 0; IsNotNull(p_parser->functions) && (i < p_parser->function_count); ++i) {
       SafeFree(p_parser->functions[i].callees);
       SafeFree(p_parser->functions[i].callee_ptrs);
       SafeFree(p_parser->functions[i].accessed_ptrs);
+      SafeFree(p_parser->functions[i].sampled_images);
+      SafeFree(p_parser->functions[i].pointer_accesses);
     }
 
     SafeFree(p_parser->nodes);
     SafeFree(p_parser->strings);
     SafeFree(p_parser->functions);
+    SafeFree(p_parser->id_nodes);
+    SafeFree(p_parser->selected_functions);
+    SafeFree(p_parser->used_variables);
     p_parser->node_count = 0;
   }
 }
@@ -779,6 +809,21 @@ static SpvReflectResult ParseStrings(Parser* p_parser)
   return SPV_REFLECT_RESULT_SUCCESS;
 }
 
+// Length of a literal string operand, bounded by the instruction's words
+static size_t GetLiteralStringLength(const Parser* p_parser, const Node* p_node, uint32_t first_word)
+{
+  if (p_node->word_count <= first_word) {
+    return 0;
+  }
+  const char* str = (const char*)(p_parser->spirv_code + p_node->word_offset + first_word);
+  size_t max_length = (p_node->word_count - first_word) * SPIRV_WORD_SIZE;
+  size_t length = 0;
+  while ((length < max_length) && (str[length] != '\0')) {
+    ++length;
+  }
+  return length;
+}
+
 static SpvReflectResult ParseSource(Parser* p_parser, SpvReflectShaderModule* p_module)
 {
   assert(IsNotNull(p_parser));
@@ -795,13 +840,315 @@ static SpvReflectResult ParseSource(Parser* p_parser, SpvReflectShaderModule* p_
         }
       }
     }
+
+    // Source text, split across OpSourceContinued if it is long
+    for (size_t i = 0; i < p_parser->node_count; ++i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      if ((p_node->op != SpvOpSource) || (p_node->word_count <= 4)) {
+        continue;
+      }
+      size_t length = GetLiteralStringLength(p_parser, p_node, 4);
+      size_t end = i + 1;
+      for (; (end < p_parser->node_count) && (p_parser->nodes[end].op == SpvOpSourceContinued); ++end) {
+        length += GetLiteralStringLength(p_parser, &(p_parser->nodes[end]), 1);
+      }
+
+      char* source = (char*)calloc(length + 1, sizeof(*source));
+      if (IsNull(source)) {
+        return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+      }
+      length = GetLiteralStringLength(p_parser, p_node, 4);
+      memcpy(source, p_parser->spirv_code + p_node->word_offset + 4, length);
+      for (size_t j = i + 1; j < end; ++j) {
+        Node* p_continued = &(p_parser->nodes[j]);
+        size_t continued_length = GetLiteralStringLength(p_parser, p_continued, 1);
+        memcpy(source + length, p_parser->spirv_code + p_continued->word_offset + 1, continued_length);
+        length += continued_length;
+      }
+      p_module->source_source = source;
+      break;
+    }
+  }
+
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+// Loads read storage buffers, but only load the handle of images
+static const uint32_t kPointerAccessLoad = 0x80000000;
+
+// Returns how many pointer or image operands an instruction accesses, and
+// writes their word indices and access flags
+static uint32_t GetPointerAccesses(SpvOp op, uint32_t* p_indices, uint32_t* p_flags)
+{
+  switch (op) {
+    case SpvOpLoad: {
+      p_indices[0] = 3;
+      p_flags[0] = kPointerAccessLoad;
+      return 1;
+    }
+    case SpvOpStore:
+    case SpvOpImageWrite: {
+      p_indices[0] = 1;
+      p_flags[0] = SPV_REFLECT_BINDING_ACCESS_WRITE;
+      return 1;
+    }
+    case SpvOpCopyMemory:
+    case SpvOpCopyMemorySized: {
+      p_indices[0] = 1;
+      p_flags[0] = SPV_REFLECT_BINDING_ACCESS_WRITE;
+      p_indices[1] = 2;
+      p_flags[1] = kPointerAccessLoad;
+      return 2;
+    }
+    case SpvOpImageRead:
+    case SpvOpImageSparseRead:
+    case SpvOpImageFetch:
+    case SpvOpImageSparseFetch: {
+      p_indices[0] = 3;
+      p_flags[0] = SPV_REFLECT_BINDING_ACCESS_READ;
+      return 1;
+    }
+    case SpvOpAtomicLoad:
+    case SpvOpAtomicExchange:
+    case SpvOpAtomicCompareExchange:
+    case SpvOpAtomicCompareExchangeWeak:
+    case SpvOpAtomicIIncrement:
+    case SpvOpAtomicIDecrement:
+    case SpvOpAtomicIAdd:
+    case SpvOpAtomicISub:
+    case SpvOpAtomicSMin:
+    case SpvOpAtomicUMin:
+    case SpvOpAtomicSMax:
+    case SpvOpAtomicUMax:
+    case SpvOpAtomicAnd:
+    case SpvOpAtomicOr:
+    case SpvOpAtomicXor:
+    case SpvOpAtomicFlagTestAndSet: {
+      p_indices[0] = 3;
+      p_flags[0] = SPV_REFLECT_BINDING_ACCESS_ATOMIC;
+      return 1;
+    }
+    case SpvOpAtomicStore:
+    case SpvOpAtomicFlagClear: {
+      p_indices[0] = 1;
+      p_flags[0] = SPV_REFLECT_BINDING_ACCESS_ATOMIC;
+      return 1;
+    }
+    default: break;
+  }
+  return 0;
+}
+
+// Instructions whose result points into, or is the handle of, the same
+// variable as their first operand
+static bool IsPointerPassThrough(SpvOp op)
+{
+  switch (op) {
+    case SpvOpLoad:
+    case SpvOpCopyObject:
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+    case SpvOpPtrAccessChain:
+    case SpvOpInBoundsPtrAccessChain:
+    case SpvOpImageTexelPointer:
+      return true;
+    default: break;
+  }
+  return false;
+}
+
+// Instructions that hand a pointer or image on to ids that are not traced:
+// the arguments of a call and the operands of a phi or select. Returns how
+// many such operands there are, and writes the word index of the first and
+// the stride between them
+static uint32_t GetUntracedPointerOperands(SpvOp op, uint32_t word_count, uint32_t* p_first, uint32_t* p_stride)
+{
+  switch (op) {
+    case SpvOpFunctionCall: {
+      *p_first = 4;
+      *p_stride = 1;
+      return (word_count > 4) ? (word_count - 4) : 0;
+    }
+    case SpvOpPhi: {
+      *p_first = 3;
+      *p_stride = 2;
+      return (word_count > 3) ? ((word_count - 3) / 2) : 0;
+    }
+    case SpvOpSelect: {
+      *p_first = 4;
+      *p_stride = 1;
+      return 2;
+    }
+    default: break;
+  }
+  return 0;
+}
+
+static uint32_t GetPointerRoot(const uint32_t* p_roots, uint32_t id_bound, uint32_t id)
+{
+  return ((id < id_bound) && (p_roots[id] != 0)) ? p_roots[id] : id;
+}
+
+static int SortComparePointerAccess(const void* a, const void* b)
+{
+  const PointerAccess* p_elem_a = (const PointerAccess*)a;
+  const PointerAccess* p_elem_b = (const PointerAccess*)b;
+  if (p_elem_a->id != p_elem_b->id) {
+    return (p_elem_a->id < p_elem_b->id) ? -1 : 1;
+  }
+  return 0;
+}
+
+static bool IsEntryPointSelected(const Parser* p_parser, const char* name)
+{
+  if (IsNull(p_parser->p_options)) {
+    return true;
+  }
+  for (uint32_t i = 0; i < p_parser->p_options->entry_point_count; ++i) {
+    if (strcmp(p_parser->p_options->entry_point_names[i], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+// Narrows the entry points to reflect down to those listed in p_options,
+// and collects the functions they start at for FindReachableFunctions().
+//
+static SpvReflectResult SelectEntryPoints(Parser* p_parser, const SpvReflectShaderModuleOptions* p_options)
+{
+  if (IsNull(p_options) || (p_options->entry_point_count == 0)) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  if (IsNull(p_options->entry_point_names)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  for (uint32_t i = 0; i < p_options->entry_point_count; ++i) {
+    if (IsNull(p_options->entry_point_names[i])) {
+      return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+    }
+  }
+  p_parser->p_options = p_options;
+
+  const char** entry_point_names = NULL;
+  if (p_parser->entry_point_count > 0) {
+    entry_point_names = (const char**)calloc(p_parser->entry_point_count, sizeof(*entry_point_names));
+    p_parser->selected_functions = (uint32_t*)calloc(p_parser->entry_point_count,
+                                                     sizeof(*(p_parser->selected_functions)));
+    if (IsNull(entry_point_names) || IsNull(p_parser->selected_functions)) {
+      SafeFree(entry_point_names);
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+
+  uint32_t entry_point_count = 0;
+  uint32_t selected_count = 0;
+  for (size_t i = 0; (entry_point_count < p_parser->entry_point_count) && (i < p_parser->node_count); ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    if (p_node->op != SpvOpEntryPoint) {
+      continue;
+    }
+    uint32_t name_length_with_terminator = 0;
+    SpvReflectResult result = ReadStr(p_parser, p_node->word_offset + 3, 0, p_node->word_count,
+                                      &name_length_with_terminator, NULL);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      SafeFree(entry_point_names);
+      return result;
+    }
+    const char* name = (const char*)(p_parser->spirv_code + p_node->word_offset + 3);
+    entry_point_names[entry_point_count++] = name;
+    if (IsEntryPointSelected(p_parser, name)) {
+      CHECKED_READU32(p_parser, p_node->word_offset + 2, p_parser->selected_functions[selected_count]);
+      ++selected_count;
+    }
+  }
+
+  SpvReflectResult result = SPV_REFLECT_RESULT_SUCCESS;
+  for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < p_options->entry_point_count); ++i) {
+    result = SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+    for (uint32_t j = 0; j < entry_point_count; ++j) {
+      if (strcmp(p_options->entry_point_names[i], entry_point_names[j]) == 0) {
+        result = SPV_REFLECT_RESULT_SUCCESS;
+        break;
+      }
+    }
+  }
+  SafeFree(entry_point_names);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  // Several entry points can share a function
+  p_parser->entry_point_count = selected_count;
+  qsort(p_parser->selected_functions, selected_count, sizeof(*(p_parser->selected_functions)), SortCompareUint32);
+  p_parser->selected_function_count = (uint32_t)DedupSortedUint32(p_parser->selected_functions, selected_count);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+//
+// Marks the functions that the selected entry points can call, starting
+// from the entry points themselves. Calls are collected in one pass and
+// then followed until no more functions are marked.
+//
+static SpvReflectResult FindReachableFunctions(Parser* p_parser, uint32_t id_bound, uint8_t* p_reachable)
+{
+  for (uint32_t i = 0; i < p_parser->selected_function_count; ++i) {
+    if (p_parser->selected_functions[i] < id_bound) {
+      p_reachable[p_parser->selected_functions[i]] = 1;
+    }
+  }
+
+  size_t call_count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    if (p_parser->nodes[i].op == SpvOpFunctionCall) {
+      ++call_count;
+    }
+  }
+  if (call_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  // Caller and callee of each call
+  uint32_t* calls = (uint32_t*)calloc(2 * call_count, sizeof(*calls));
+  if (IsNull(calls)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  call_count = 0;
+  uint32_t function_id = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    if (p_node->op == SpvOpFunction) {
+      function_id = p_node->result_id;
+    }
+    else if (p_node->op == SpvOpFunctionCall) {
+      calls[2 * call_count] = function_id;
+      CHECKED_READU32(p_parser, p_node->word_offset + 3, calls[2 * call_count + 1]);
+      ++call_count;
+    }
   }
 
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 0; i < call_count; ++i) {
+      uint32_t caller = calls[2 * i];
+      uint32_t callee = calls[2 * i + 1];
+      if ((caller < id_bound) && (callee < id_bound) && p_reachable[caller] && !p_reachable[callee]) {
+        p_reachable[callee] = 1;
+        changed = true;
+      }
+    }
+  }
+  SafeFree(calls);
   return SPV_REFLECT_RESULT_SUCCESS;
 }
 
-static SpvReflectResult ParseFunction(Parser* p_parser, Node* p_func_node, Function* p_func, size_t first_label_index)
+static SpvReflectResult ParseFunction(Parser* p_parser, Node* p_func_node, Function* p_func, size_t first_label_index,
+                                      uint32_t* pointer_roots, const uint8_t* handle_types, uint32_t id_bound)
 {
+  uint32_t access_indices[2];
+  uint32_t access_flags[2];
+
   p_func->id = p_func_node->result_id;
 
   p_func->callee_count = 0;
@@ -835,8 +1182,17 @@ static SpvReflectResult ParseFunction(Parser* p_parser, Node* p_func_node, Funct
         p_func->accessed_ptr_count += 2;
       }
       break;
+      case SpvOpSampledImage: {
+        ++(p_func->sampled_image_count);
+      }
+      break;
       default: break;
     }
+    p_func->pointer_access_count += GetPointerAccesses(p_node->op, access_indices, access_flags);
+    uint32_t first_operand = 0;
+    uint32_t operand_stride = 0;
+    p_func->pointer_access_count += GetUntracedPointerOperands(p_node->op, p_node->word_count,
+                                                               &first_operand, &operand_stride);
   }
 
   if (p_func->callee_count > 0) {
@@ -855,8 +1211,26 @@ static SpvReflectResult ParseFunction(Parser* p_parser, Node* p_func_node, Funct
     }
   }
 
+  if (p_func->sampled_image_count > 0) {
+    p_func->sampled_images = (uint32_t*)calloc(2 * p_func->sampled_image_count,
+                                               sizeof(*(p_func->sampled_images)));
+    if (IsNull(p_func->sampled_images)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+
+  if (p_func->pointer_access_count > 0) {
+    p_func->pointer_accesses = (PointerAccess*)calloc(p_func->pointer_access_count,
+                                                      sizeof(*(p_func->pointer_accesses)));
+    if (IsNull(p_func->pointer_accesses)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+
   p_func->callee_count = 0;
   p_func->accessed_ptr_count = 0;
+  p_func->sampled_image_count = 0;
+  p_func->pointer_access_count = 0;
   for (size_t i = first_label_index; i < p_parser->node_count; ++i) {
     Node* p_node = &(p_parser->nodes[i]);
     if (p_node->op == SpvOpFunctionEnd) {
@@ -900,8 +1274,56 @@ static SpvReflectResult ParseFunction(Parser* p_parser, Node* p_func_node, Funct
         (++p_func->accessed_ptr_count);
       }
       break;
+      case SpvOpSampledImage:
+      {
+        CHECKED_READU32(p_parser, p_node->word_offset + 3,
+                        p_func->sampled_images[2 * p_func->sampled_image_count]);
+        CHECKED_READU32(p_parser, p_node->word_offset + 4,
+                        p_func->sampled_images[2 * p_func->sampled_image_count + 1]);
+        (++p_func->sampled_image_count);
+      }
+      break;
       default: break;
     }
+
+    // Blocks appear before the blocks they dominate, so a pointer's base is
+    // always visited before the pointer itself. Only loads of image and
+    // sampler handles keep their root; loaded values are not pointers.
+    if (IsPointerPassThrough(p_node->op)) {
+      uint32_t result_type_id = 0;
+      uint32_t result_id = 0;
+      uint32_t base_id = 0;
+      CHECKED_READU32(p_parser, p_node->word_offset + 1, result_type_id);
+      CHECKED_READU32(p_parser, p_node->word_offset + 2, result_id);
+      CHECKED_READU32(p_parser, p_node->word_offset + 3, base_id);
+      bool is_handle = (result_type_id < id_bound) && handle_types[result_type_id];
+      if ((result_id < id_bound) && ((p_node->op != SpvOpLoad) || is_handle)) {
+        pointer_roots[result_id] = GetPointerRoot(pointer_roots, id_bound, base_id);
+      }
+    }
+    uint32_t access_count = GetPointerAccesses(p_node->op, access_indices, access_flags);
+    for (uint32_t j = 0; j < access_count; ++j) {
+      uint32_t pointer_id = 0;
+      CHECKED_READU32(p_parser, p_node->word_offset + access_indices[j], pointer_id);
+      PointerAccess* p_access = &(p_func->pointer_accesses[p_func->pointer_access_count]);
+      p_access->id = GetPointerRoot(pointer_roots, id_bound, pointer_id);
+      p_access->flags = access_flags[j];
+      (++p_func->pointer_access_count);
+    }
+    // Whatever the callee or the merged pointer does is not known, so the
+    // variable is assumed to be both read and written
+    uint32_t first_operand = 0;
+    uint32_t operand_stride = 0;
+    uint32_t operand_count = GetUntracedPointerOperands(p_node->op, p_node->word_count,
+                                                        &first_operand, &operand_stride);
+    for (uint32_t j = 0; j < operand_count; ++j) {
+      uint32_t operand_id = 0;
+      CHECKED_READU32(p_parser, p_node->word_offset + first_operand + j * operand_stride, operand_id);
+      PointerAccess* p_access = &(p_func->pointer_accesses[p_func->pointer_access_count]);
+      p_access->id = GetPointerRoot(pointer_roots, id_bound, operand_id);
+      p_access->flags = SPV_REFLECT_BINDING_ACCESS_READ | SPV_REFLECT_BINDING_ACCESS_WRITE;
+      (++p_func->pointer_access_count);
+    }
   }
 
   if (p_func->callee_count > 0) {
@@ -918,6 +1340,22 @@ static SpvReflectResult ParseFunction(Parser* p_parser, Node* p_func_node, Funct
   p_func->accessed_ptr_count = (uint32_t)DedupSortedUint32(p_func->accessed_ptrs,
                                                            p_func->accessed_ptr_count);
 
+  if (p_func->pointer_access_count > 0) {
+    qsort(p_func->pointer_accesses, p_func->pointer_access_count,
+          sizeof(*(p_func->pointer_accesses)), SortComparePointerAccess);
+    uint32_t access_count = 0;
+    for (uint32_t i = 0; i < p_func->pointer_access_count; ++i) {
+      const PointerAccess* p_access = &(p_func->pointer_accesses[i]);
+      if ((access_count > 0) && (p_func->pointer_accesses[access_count - 1].id == p_access->id)) {
+        p_func->pointer_accesses[access_count - 1].flags |= p_access->flags;
+      }
+      else {
+        p_func->pointer_accesses[access_count++] = *p_access;
+      }
+    }
+    p_func->pointer_access_count = access_count;
+  }
+
   return SPV_REFLECT_RESULT_SUCCESS;
 }
 
@@ -945,6 +1383,48 @@ static SpvReflectResult ParseFunctions(Parser* p_parser)
       return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
     }
 
+    // Scratch map from pointer and image ids to the variable they point into
+    uint32_t id_bound = 0;
+    CHECKED_READU32(p_parser, 3, id_bound);
+    uint32_t* pointer_roots = NULL;
+    if (id_bound > 0) {
+      pointer_roots = (uint32_t*)calloc(id_bound, sizeof(*pointer_roots));
+      if (IsNull(pointer_roots)) {
+        return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+      }
+    }
+    // Image and sampler types, whose loads are handles rather than values
+    uint8_t* handle_types = NULL;
+    if (id_bound > 0) {
+      handle_types = (uint8_t*)calloc(id_bound, sizeof(*handle_types));
+      if (IsNull(handle_types)) {
+        SafeFree(pointer_roots);
+        return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+      }
+      for (size_t i = 0; i < p_parser->node_count; ++i) {
+        const Node* p_node = &(p_parser->nodes[i]);
+        bool is_handle = (p_node->op == SpvOpTypeImage) ||
+                         (p_node->op == SpvOpTypeSampler) ||
+                         (p_node->op == SpvOpTypeSampledImage);
+        if (is_handle && (p_node->result_id < id_bound)) {
+          handle_types[p_node->result_id] = 1;
+        }
+      }
+    }
+    // With an entry point filter, only the selected call graphs are scanned
+    uint8_t* reachable = NULL;
+    if (IsNotNull(p_parser->p_options) && (id_bound > 0)) {
+      reachable = (uint8_t*)calloc(id_bound, sizeof(*reachable));
+      SpvReflectResult result = IsNull(reachable) ? SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED
+                                                  : FindReachableFunctions(p_parser, id_bound, reachable);
+      if (result != SPV_REFLECT_RESULT_SUCCESS) {
+        SafeFree(reachable);
+        SafeFree(handle_types);
+        SafeFree(pointer_roots);
+        return result;
+      }
+    }
+
     size_t function_index = 0;
     for (size_t i = 0; i < p_parser->node_count; ++i) {
       Node* p_node = &(p_parser->nodes[i]);
@@ -970,14 +1450,24 @@ static SpvReflectResult ParseFunctions(Parser* p_parser)
       }
 
       Function* p_function = &(p_parser->functions[function_index]);
+      ++function_index;
+      if (IsNotNull(reachable) && ((p_node->result_id >= id_bound) || !reachable[p_node->result_id])) {
+        p_function->id = p_node->result_id;
+        continue;
+      }
 
-      SpvReflectResult result = ParseFunction(p_parser, p_node, p_function, i);
+      SpvReflectResult result = ParseFunction(p_parser, p_node, p_function, i, pointer_roots, handle_types,
+                                              id_bound);
       if (result != SPV_REFLECT_RESULT_SUCCESS) {
+        SafeFree(reachable);
+        SafeFree(handle_types);
+        SafeFree(pointer_roots);
         return result;
       }
-
-      ++function_index;
     }
+    SafeFree(reachable);
+    SafeFree(handle_types);
+    SafeFree(pointer_roots);
 
     qsort(p_parser->functions, p_parser->function_count,
           sizeof(*(p_parser->functions)), SortCompareFunctions);
@@ -1007,6 +1497,47 @@ static SpvReflectResult ParseFunctions(Parser* p_parser)
   return SPV_REFLECT_RESULT_SUCCESS;
 }
 
+//
+// Collects the variables that the selected entry points access. Functions
+// outside their call graphs were not scanned and add nothing.
+//
+static SpvReflectResult ParseUsedVariables(Parser* p_parser)
+{
+  if (IsNull(p_parser->p_options)) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  size_t used_variable_count = 0;
+  for (size_t i = 0; i < p_parser->function_count; ++i) {
+    used_variable_count += p_parser->functions[i].accessed_ptr_count;
+  }
+  if (used_variable_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  p_parser->used_variables = (uint32_t*)calloc(used_variable_count, sizeof(*(p_parser->used_variables)));
+  if (IsNull(p_parser->used_variables)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  used_variable_count = 0;
+  for (size_t i = 0; i < p_parser->function_count; ++i) {
+    const Function* p_func = &(p_parser->functions[i]);
+    if (p_func->accessed_ptr_count == 0) {
+      continue;
+    }
+    memcpy(&p_parser->used_variables[used_variable_count], p_func->accessed_ptrs,
+           p_func->accessed_ptr_count * sizeof(*(p_parser->used_variables)));
+    used_variable_count += p_func->accessed_ptr_count;
+  }
+  qsort(p_parser->used_variables, used_variable_count, sizeof(*(p_parser->used_variables)), SortCompareUint32);
+  p_parser->used_variable_count = (uint32_t)DedupSortedUint32(p_parser->used_variables, used_variable_count);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static bool IsVariableUsed(const Parser* p_parser, uint32_t variable_id)
+{
+  return IsNull(p_parser->p_options) ||
+         SearchSortedUint32(p_parser->used_variables, p_parser->used_variable_count, variable_id);
+}
+
 static SpvReflectResult ParseMemberCounts(Parser* p_parser)
 {
   assert(IsNotNull(p_parser));
@@ -1324,6 +1855,12 @@ static SpvReflectResult ParseType(Parser* p_parser, Node* p_node, Decorations* p
       p_type->op = p_node->op;
       p_type->decoration_flags = ApplyDecorations(&p_node->decorations);
     }
+    else if ((p_type->op == SpvOpTypeArray) || (p_type->op == SpvOpTypeRuntimeArray)) {
+      // Arrays of blocks take Block or BufferBlock from the element struct,
+      // but no other element decorations
+      p_type->decoration_flags |= ApplyDecorations(&p_node->decorations) &
+                                  (SPV_REFLECT_DECORATION_BLOCK | SPV_REFLECT_DECORATION_BUFFER_BLOCK);
+    }
 
     switch (p_node->op) {
       default: break;
@@ -1594,6 +2131,9 @@ static SpvReflectResult ParseDescriptorBindings(Parser* p_parser, SpvReflectShad
     if ((p_node->decorations.set.value == INVALID_VALUE) || (p_node->decorations.binding.value == INVALID_VALUE)) {
       continue;
     }
+    if (!IsVariableUsed(p_parser, p_node->result_id)) {
+      continue;
+    }
 
     p_module->descriptor_binding_count += 1;
   }
@@ -1628,6 +2168,9 @@ static SpvReflectResult ParseDescriptorBindings(Parser* p_parser, SpvReflectShad
     if ((p_node->decorations.set.value == INVALID_VALUE) || (p_node->decorations.binding.value == INVALID_VALUE)) {
       continue;
     }
+    if (!IsVariableUsed(p_parser, p_node->result_id)) {
+      continue;
+    }
 
     SpvReflectTypeDescription* p_type = FindType(p_module, p_node->type_id);
     if (IsNull(p_type)) {
@@ -2358,58 +2901,261 @@ static SpvReflectResult TraverseCallGraph(Parser* p_parser,
   return SPV_REFLECT_RESULT_SUCCESS;
 }
 
-static SpvReflectResult ParseStaticallyUsedResources(Parser* p_parser,
-                                                     SpvReflectShaderModule *p_module,
-                                                     SpvReflectEntryPoint *p_entry,
-                                                     size_t uniform_count,
-                                                     uint32_t* uniforms,
-                                                     size_t push_constant_count,
-                                                     uint32_t* push_constants)
+//
+// Follows an image or sampler value back to the descriptor binding it was
+// loaded from. Values passed in as function parameters are not traced.
+//
+static SpvReflectDescriptorBinding* FindValueDescriptorBinding(Parser* p_parser,
+                                                               SpvReflectShaderModule* p_module,
+                                                               uint32_t value_id)
 {
-  // Find function with the right id
-  Function* p_func = NULL;
-  for (size_t i = 0; i < p_parser->function_count; ++i) {
-    if (p_parser->functions[i].id == p_entry->id) {
-      p_func = &(p_parser->functions[i]);
-      break;
+  uint32_t id = value_id;
+  for (size_t depth = 0; depth < p_parser->node_count; ++depth) {
+    // Access chains and copies do not record a result id during node parsing,
+    // so read it from the instruction itself.
+    Node* p_node = NULL;
+    for (size_t i = 0; i < p_parser->node_count; ++i) {
+      Node* p_elem = &(p_parser->nodes[i]);
+      if ((p_elem->op == SpvOpVariable) && (p_elem->result_id == id)) {
+        for (uint32_t j = 0; j < p_module->descriptor_binding_count; ++j) {
+          if (p_module->descriptor_bindings[j].spirv_id == id) {
+            return &p_module->descriptor_bindings[j];
+          }
+        }
+        return NULL;
+      }
+      bool is_pass_through = (p_elem->op == SpvOpLoad) || (p_elem->op == SpvOpCopyObject) ||
+                             (p_elem->op == SpvOpAccessChain) || (p_elem->op == SpvOpInBoundsAccessChain) ||
+                             (p_elem->op == SpvOpPtrAccessChain) || (p_elem->op == SpvOpInBoundsPtrAccessChain);
+      if (is_pass_through) {
+        if ((p_elem->word_count >= 4) && (p_parser->spirv_code[p_elem->word_offset + 2] == id)) {
+          p_node = p_elem;
+          break;
+        }
+      }
+    }
+    if (IsNull(p_node)) {
+      return NULL;
     }
+    id = p_parser->spirv_code[p_node->word_offset + 3];
   }
-  if (p_func == NULL) {
-    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  return NULL;
+}
+
+static int CompareBindingNumbers(const SpvReflectDescriptorBinding* p_a, const SpvReflectDescriptorBinding* p_b)
+{
+  if (p_a->set != p_b->set) {
+    return (p_a->set < p_b->set) ? -1 : 1;
   }
+  if (p_a->binding != p_b->binding) {
+    return (p_a->binding < p_b->binding) ? -1 : 1;
+  }
+  return 0;
+}
 
-  size_t called_function_count = 0;
+// Aliased variables share binding numbers within a module
+static int CompareDescriptorBindingNumbers(const SpvReflectDescriptorBinding* p_a,
+                                           const SpvReflectDescriptorBinding* p_b)
+{
+  int value = CompareBindingNumbers(p_a, p_b);
+  if ((value == 0) && (p_a->spirv_id != p_b->spirv_id)) {
+    value = (p_a->spirv_id < p_b->spirv_id) ? -1 : 1;
+  }
+  return value;
+}
 
-  SpvReflectResult result;
-  if ((result = TraverseCallGraph(p_parser,
-                                  p_func,
-                                  &called_function_count,
-                                  NULL,
-                                  0)) !=
-      SPV_REFLECT_RESULT_SUCCESS) {
-    return result;
+static int SortCompareImageSamplerPair(const void* a, const void* b)
+{
+  const SpvReflectImageSamplerPair* p_elem_a = (const SpvReflectImageSamplerPair*)a;
+  const SpvReflectImageSamplerPair* p_elem_b = (const SpvReflectImageSamplerPair*)b;
+  int value = CompareDescriptorBindingNumbers(p_elem_a->p_image, p_elem_b->p_image);
+  if (value == 0) {
+    value = CompareDescriptorBindingNumbers(p_elem_a->p_sampler, p_elem_b->p_sampler);
   }
+  return value;
+}
 
-  uint32_t* called_functions = NULL;
-  if (called_function_count > 0) {
-    called_functions = (uint32_t*)calloc(called_function_count,
-                                                   sizeof(*called_functions));
-    if (IsNull(called_functions)) {
-      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+static SpvReflectResult ParseImageSamplerPairs(Parser*                  p_parser,
+                                               SpvReflectShaderModule*  p_module,
+                                               SpvReflectEntryPoint*    p_entry,
+                                               size_t                   called_function_count,
+                                               const uint32_t*          called_functions)
+{
+  // Both the functions and called_functions are sorted by id
+  uint32_t sampled_image_count = 0;
+  for (size_t i = 0, j = 0; i < called_function_count; ++i) {
+    while (p_parser->functions[j].id != called_functions[i]) {
+      ++j;
     }
+    sampled_image_count += p_parser->functions[j].sampled_image_count;
   }
-  called_function_count = 0;
-  if ((result = TraverseCallGraph(p_parser,
-                                  p_func,
-                                  &called_function_count,
-                                  called_functions,
-                                  0)) !=
-      SPV_REFLECT_RESULT_SUCCESS) {
-    return result;
+  if (sampled_image_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
   }
 
-  if (called_function_count > 0) {
-    qsort(called_functions, called_function_count, sizeof(*called_functions),
+  p_entry->image_sampler_pairs = (SpvReflectImageSamplerPair*)calloc(sampled_image_count,
+                                                                     sizeof(*(p_entry->image_sampler_pairs)));
+  if (IsNull(p_entry->image_sampler_pairs)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  uint32_t pair_count = 0;
+  for (size_t i = 0, k = 0; i < called_function_count; ++i) {
+    while (p_parser->functions[k].id != called_functions[i]) {
+      ++k;
+    }
+    const Function* p_func = &(p_parser->functions[k]);
+    for (uint32_t j = 0; j < p_func->sampled_image_count; ++j) {
+      SpvReflectImageSamplerPair* p_pair = &p_entry->image_sampler_pairs[pair_count];
+      p_pair->p_image = FindValueDescriptorBinding(p_parser, p_module, p_func->sampled_images[2 * j]);
+      p_pair->p_sampler = FindValueDescriptorBinding(p_parser, p_module, p_func->sampled_images[2 * j + 1]);
+      if (IsNotNull(p_pair->p_image) && IsNotNull(p_pair->p_sampler)) {
+        ++pair_count;
+      }
+    }
+  }
+
+  qsort(p_entry->image_sampler_pairs, pair_count, sizeof(*(p_entry->image_sampler_pairs)),
+        SortCompareImageSamplerPair);
+  p_entry->image_sampler_pair_count = 0;
+  for (uint32_t i = 0; i < pair_count; ++i) {
+    const SpvReflectImageSamplerPair* p_pair = &p_entry->image_sampler_pairs[i];
+    if ((p_entry->image_sampler_pair_count == 0) ||
+        (SortCompareImageSamplerPair(p_pair, &p_entry->image_sampler_pairs[p_entry->image_sampler_pair_count - 1]) != 0)) {
+      p_entry->image_sampler_pairs[p_entry->image_sampler_pair_count++] = *p_pair;
+    }
+  }
+  if (p_entry->image_sampler_pair_count == 0) {
+    SafeFree(p_entry->image_sampler_pairs);
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static bool IsAccessClassifiedDescriptorType(SpvReflectDescriptorType descriptor_type)
+{
+  switch (descriptor_type) {
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+    case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+      return true;
+    default: break;
+  }
+  return false;
+}
+
+static SpvReflectResult ParseBindingAccesses(Parser*                  p_parser,
+                                             SpvReflectShaderModule*  p_module,
+                                             SpvReflectEntryPoint*    p_entry,
+                                             size_t                   called_function_count,
+                                             const uint32_t*          called_functions)
+{
+  uint32_t access_count = 0;
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    if (IsAccessClassifiedDescriptorType(p_module->descriptor_bindings[i].descriptor_type)) {
+      ++access_count;
+    }
+  }
+  if (access_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+
+  p_entry->binding_accesses = (SpvReflectDescriptorBindingAccess*)calloc(access_count,
+                                                                         sizeof(*(p_entry->binding_accesses)));
+  if (IsNull(p_entry->binding_accesses)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    SpvReflectDescriptorBinding* p_binding = &(p_module->descriptor_bindings[i]);
+    if (!IsAccessClassifiedDescriptorType(p_binding->descriptor_type)) {
+      continue;
+    }
+
+    PointerAccess key = { p_binding->spirv_id, 0 };
+    uint32_t flags = 0;
+    // Both the functions and called_functions are sorted by id
+    for (size_t j = 0, k = 0; j < called_function_count; ++j) {
+      while (p_parser->functions[k].id != called_functions[j]) {
+        ++k;
+      }
+      const Function* p_func = &(p_parser->functions[k]);
+      if (p_func->pointer_access_count == 0) {
+        continue;
+      }
+      const PointerAccess* p_access = (const PointerAccess*)bsearch(&key, p_func->pointer_accesses,
+                                                                    p_func->pointer_access_count,
+                                                                    sizeof(*(p_func->pointer_accesses)),
+                                                                    SortComparePointerAccess);
+      if (IsNotNull(p_access)) {
+        flags |= p_access->flags;
+      }
+    }
+    bool is_buffer = (p_binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER) ||
+                     (p_binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+    if ((flags & kPointerAccessLoad) && is_buffer) {
+      flags |= SPV_REFLECT_BINDING_ACCESS_READ;
+    }
+
+    SpvReflectDescriptorBindingAccess* p_binding_access = &(p_entry->binding_accesses[p_entry->binding_access_count]);
+    p_binding_access->p_binding = p_binding;
+    p_binding_access->access = flags & ~kPointerAccessLoad;
+    ++(p_entry->binding_access_count);
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult ParseStaticallyUsedResources(Parser* p_parser,
+                                                     SpvReflectShaderModule *p_module,
+                                                     SpvReflectEntryPoint *p_entry,
+                                                     size_t uniform_count,
+                                                     uint32_t* uniforms,
+                                                     size_t push_constant_count,
+                                                     uint32_t* push_constants)
+{
+  // Find function with the right id
+  Function* p_func = NULL;
+  for (size_t i = 0; i < p_parser->function_count; ++i) {
+    if (p_parser->functions[i].id == p_entry->id) {
+      p_func = &(p_parser->functions[i]);
+      break;
+    }
+  }
+  if (p_func == NULL) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  size_t called_function_count = 0;
+
+  SpvReflectResult result;
+  if ((result = TraverseCallGraph(p_parser,
+                                  p_func,
+                                  &called_function_count,
+                                  NULL,
+                                  0)) !=
+      SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  uint32_t* called_functions = NULL;
+  if (called_function_count > 0) {
+    called_functions = (uint32_t*)calloc(called_function_count,
+                                                   sizeof(*called_functions));
+    if (IsNull(called_functions)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+  called_function_count = 0;
+  if ((result = TraverseCallGraph(p_parser,
+                                  p_func,
+                                  &called_function_count,
+                                  called_functions,
+                                  0)) !=
+      SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  if (called_function_count > 0) {
+    qsort(called_functions, called_function_count, sizeof(*called_functions),
           SortCompareUint32);
   }
   called_function_count = DedupSortedUint32(called_functions, called_function_count);
@@ -2443,7 +3189,15 @@ static SpvReflectResult ParseStaticallyUsedResources(Parser* p_parser,
            p_parser->functions[j].accessed_ptr_count * sizeof(*used_variables));
     used_variable_count += p_parser->functions[j].accessed_ptr_count;
   }
+  result = ParseImageSamplerPairs(p_parser, p_module, p_entry, called_function_count, called_functions);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseBindingAccesses(p_parser, p_module, p_entry, called_function_count, called_functions);
+  }
   SafeFree(called_functions);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    SafeFree(used_variables);
+    return result;
+  }
 
   if (used_variable_count > 0) {
     qsort(used_variables, used_variable_count, sizeof(*used_variables),
@@ -2519,6 +3273,11 @@ static SpvReflectResult ParseEntryPoints(Parser* p_parser, SpvReflectShaderModul
     if (p_node->op != SpvOpEntryPoint) {
       continue;
     }
+    // SelectEntryPoints() has checked the names of filtered modules
+    if (IsNotNull(p_parser->p_options) &&
+        !IsEntryPointSelected(p_parser, (const char*)(p_parser->spirv_code + p_node->word_offset + 3))) {
+      continue;
+    }
 
     SpvReflectEntryPoint* p_entry_point = &(p_module->entry_points[entry_point_index]);
     CHECKED_READU32_CAST(p_parser, p_node->word_offset + 1, SpvExecutionModel, p_entry_point->spirv_execution_model);
@@ -2594,7 +3353,8 @@ static SpvReflectResult ParsePushConstantBlocks(Parser* p_parser, SpvReflectShad
 {
   for (size_t i = 0; i < p_parser->node_count; ++i) {
     Node* p_node = &(p_parser->nodes[i]);
-    if ((p_node->op != SpvOpVariable) || (p_node->storage_class != SpvStorageClassPushConstant)) {
+    if ((p_node->op != SpvOpVariable) || (p_node->storage_class != SpvStorageClassPushConstant) ||
+        !IsVariableUsed(p_parser, p_node->result_id)) {
       continue;
     }
 
@@ -2613,7 +3373,8 @@ static SpvReflectResult ParsePushConstantBlocks(Parser* p_parser, SpvReflectShad
   uint32_t push_constant_index = 0;
   for (size_t i = 0; i < p_parser->node_count; ++i) {
     Node* p_node = &(p_parser->nodes[i]);
-    if ((p_node->op != SpvOpVariable) || (p_node->storage_class != SpvStorageClassPushConstant)) {
+    if ((p_node->op != SpvOpVariable) || (p_node->storage_class != SpvStorageClassPushConstant) ||
+        !IsVariableUsed(p_parser, p_node->result_id)) {
       continue;
     }
 
@@ -2859,6 +3620,16 @@ SpvReflectResult spvReflectCreateShaderModule(
   const void*              p_code,
   SpvReflectShaderModule*  p_module
 )
+{
+  return spvReflectCreateShaderModuleWithOptions(size, p_code, NULL, p_module);
+}
+
+SpvReflectResult spvReflectCreateShaderModuleWithOptions(
+  size_t                                size,
+  const void*                           p_code,
+  const SpvReflectShaderModuleOptions*  p_options,
+  SpvReflectShaderModule*               p_module
+)
 {
   // Initialize all module fields to zero
   memset(p_module, 0, sizeof(*p_module));
@@ -2896,6 +3667,11 @@ SpvReflectResult spvReflectCreateShaderModule(
   if (result == SPV_REFLECT_RESULT_SUCCESS) {
     result = ParseNodes(&parser);
   }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    uint32_t entry_point_count = parser.entry_point_count;
+    result = SelectEntryPoints(&parser, p_options);
+    p_module->_internal->entry_points_filtered = (parser.entry_point_count < entry_point_count) ? 1 : 0;
+  }
   if (result == SPV_REFLECT_RESULT_SUCCESS) {
     result = ParseStrings(&parser);
   }
@@ -2905,6 +3681,9 @@ SpvReflectResult spvReflectCreateShaderModule(
   if (result == SPV_REFLECT_RESULT_SUCCESS) {
     result = ParseFunctions(&parser);
   }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseUsedVariables(&parser);
+  }
   if (result == SPV_REFLECT_RESULT_SUCCESS) {
     result = ParseMemberCounts(&parser);
   }
@@ -3028,12 +3807,277 @@ static void SafeFreeInterfaceVariable(SpvReflectInterfaceVariable* p_interface)
   }
 }
 
+// Parts of a module that spvReflectChange*() write and that clones copy
+// before their first change
+enum {
+  MODULE_PART_CODE         = 0x00000001,
+  MODULE_PART_ENTRY_POINTS = 0x00000002,
+  MODULE_PART_BINDINGS     = 0x00000004,
+};
+
+static bool CopyArray(const void* p_src, size_t count, size_t element_size, void** pp_dst)
+{
+  *pp_dst = NULL;
+  if (IsNull(p_src) || (count == 0)) {
+    return true;
+  }
+  *pp_dst = malloc(count * element_size);
+  if (IsNull(*pp_dst)) {
+    return false;
+  }
+  memcpy(*pp_dst, p_src, count * element_size);
+  return true;
+}
+
+//
+// Frees entry point arrays copied by CopyEntryPoints(). The used uniform
+// and push constant id lists are never written, so they stay shared.
+//
+static void FreeCopiedEntryPoints(SpvReflectEntryPoint* p_entries, uint32_t entry_count)
+{
+  if (IsNull(p_entries)) {
+    return;
+  }
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    SpvReflectEntryPoint* p_entry = &p_entries[i];
+    if (IsNotNull(p_entry->descriptor_sets)) {
+      for (uint32_t j = 0; j < p_entry->descriptor_set_count; ++j) {
+        SafeFree(p_entry->descriptor_sets[j].bindings);
+      }
+    }
+    SafeFree(p_entry->descriptor_sets);
+    SafeFree(p_entry->input_variables);
+    SafeFree(p_entry->output_variables);
+    SafeFree(p_entry->image_sampler_pairs);
+    SafeFree(p_entry->binding_accesses);
+  }
+  free(p_entries);
+}
+
+static SpvReflectResult CopyEntryPoints(SpvReflectShaderModule* p_module)
+{
+  SpvReflectEntryPoint* p_entries = NULL;
+  if (!CopyArray(p_module->entry_points, p_module->entry_point_count, sizeof(*p_entries), (void**)&p_entries)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  // Clear the copied pointers first so a failure frees only new arrays
+  for (uint32_t i = 0; i < p_module->entry_point_count; ++i) {
+    p_entries[i].input_variables = NULL;
+    p_entries[i].output_variables = NULL;
+    p_entries[i].descriptor_sets = NULL;
+    p_entries[i].image_sampler_pairs = NULL;
+    p_entries[i].binding_accesses = NULL;
+  }
+
+  bool success = true;
+  for (uint32_t i = 0; success && (i < p_module->entry_point_count); ++i) {
+    const SpvReflectEntryPoint* p_src = &p_module->entry_points[i];
+    SpvReflectEntryPoint* p_dst = &p_entries[i];
+    success = CopyArray(p_src->input_variables, p_src->input_variable_count, sizeof(*(p_src->input_variables)),
+                        (void**)&p_dst->input_variables) &&
+              CopyArray(p_src->output_variables, p_src->output_variable_count, sizeof(*(p_src->output_variables)),
+                        (void**)&p_dst->output_variables) &&
+              CopyArray(p_src->image_sampler_pairs, p_src->image_sampler_pair_count,
+                        sizeof(*(p_src->image_sampler_pairs)), (void**)&p_dst->image_sampler_pairs) &&
+              CopyArray(p_src->binding_accesses, p_src->binding_access_count, sizeof(*(p_src->binding_accesses)),
+                        (void**)&p_dst->binding_accesses);
+    if (success && IsNotNull(p_src->descriptor_sets)) {
+      p_dst->descriptor_sets = (SpvReflectDescriptorSet*)calloc(Max(p_src->descriptor_set_count, 1),
+                                                                sizeof(*(p_dst->descriptor_sets)));
+      success = IsNotNull(p_dst->descriptor_sets);
+      for (uint32_t j = 0; success && (j < p_src->descriptor_set_count); ++j) {
+        p_dst->descriptor_sets[j].set = p_src->descriptor_sets[j].set;
+        p_dst->descriptor_sets[j].binding_count = p_src->descriptor_sets[j].binding_count;
+        success = CopyArray(p_src->descriptor_sets[j].bindings, p_src->descriptor_sets[j].binding_count,
+                            sizeof(*(p_src->descriptor_sets[j].bindings)), (void**)&p_dst->descriptor_sets[j].bindings);
+      }
+    }
+  }
+  if (!success) {
+    FreeCopiedEntryPoints(p_entries, p_module->entry_point_count);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  p_module->entry_points = p_entries;
+  if (p_module->entry_point_count > 0) {
+    p_module->input_variables = p_entries[0].input_variables;
+    p_module->output_variables = p_entries[0].output_variables;
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectDescriptorBinding* RemapCopiedBinding(SpvReflectDescriptorBinding*        p_binding,
+                                                       const SpvReflectDescriptorBinding*  p_old_bindings,
+                                                       uint32_t                            binding_count,
+                                                       SpvReflectDescriptorBinding*        p_new_bindings)
+{
+  if ((p_binding >= p_old_bindings) && (p_binding < p_old_bindings + binding_count)) {
+    return p_new_bindings + (p_binding - p_old_bindings);
+  }
+  return p_binding;
+}
+
+//
+// Copies the descriptor bindings of a module whose entry points are
+// already its own, and points the sets, UAV counters, image sampler pairs
+// and binding accesses at the copies.
+//
+static SpvReflectResult CopyDescriptorBindings(SpvReflectShaderModule* p_module)
+{
+  const SpvReflectDescriptorBinding* p_old_bindings = p_module->descriptor_bindings;
+  uint32_t binding_count = p_module->descriptor_binding_count;
+  SpvReflectDescriptorBinding* p_bindings = NULL;
+  if (!CopyArray(p_old_bindings, binding_count, sizeof(*p_bindings), (void**)&p_bindings)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  for (uint32_t i = 0; i < binding_count; ++i) {
+    p_bindings[i].uav_counter_binding = RemapCopiedBinding(p_bindings[i].uav_counter_binding, p_old_bindings,
+                                                           binding_count, p_bindings);
+  }
+  for (uint32_t i = 0; i < p_module->entry_point_count; ++i) {
+    SpvReflectEntryPoint* p_entry = &p_module->entry_points[i];
+    for (uint32_t j = 0; j < p_entry->image_sampler_pair_count; ++j) {
+      SpvReflectImageSamplerPair* p_pair = &p_entry->image_sampler_pairs[j];
+      p_pair->p_image = RemapCopiedBinding(p_pair->p_image, p_old_bindings, binding_count, p_bindings);
+      p_pair->p_sampler = RemapCopiedBinding(p_pair->p_sampler, p_old_bindings, binding_count, p_bindings);
+    }
+    for (uint32_t j = 0; j < p_entry->binding_access_count; ++j) {
+      SpvReflectDescriptorBindingAccess* p_access = &p_entry->binding_accesses[j];
+      p_access->p_binding = RemapCopiedBinding(p_access->p_binding, p_old_bindings, binding_count, p_bindings);
+    }
+  }
+  p_module->descriptor_bindings = p_bindings;
+
+  // The sets' binding arrays belong to the module the bindings came from
+  for (uint32_t i = 0; i < SPV_REFLECT_MAX_DESCRIPTOR_SETS; ++i) {
+    p_module->descriptor_sets[i].bindings = NULL;
+  }
+  return SynchronizeDescriptorSets(p_module);
+}
+
+//
+// Copies the parts of a clone, or of a module that has been cloned, that a
+// change is about to write, unless the module already has its own.
+//
+static SpvReflectResult MakeModuleWritable(SpvReflectShaderModule* p_module, uint32_t parts)
+{
+  struct SpvReflectShaderModule::Internal* p_internal = p_module->_internal;
+  if (IsNull(p_internal->p_shared)) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  if ((parts & MODULE_PART_BINDINGS) != 0) {
+    parts |= MODULE_PART_ENTRY_POINTS;
+  }
+  parts &= ~p_internal->owned_parts;
+
+  if ((parts & MODULE_PART_CODE) != 0) {
+    uint32_t* p_code = NULL;
+    if (!CopyArray(p_internal->spirv_code, p_internal->spirv_size, 1, (void**)&p_code)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    p_internal->spirv_code = p_code;
+    p_internal->owned_parts |= MODULE_PART_CODE;
+  }
+  if ((parts & MODULE_PART_ENTRY_POINTS) != 0) {
+    SpvReflectResult result = CopyEntryPoints(p_module);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+    p_internal->owned_parts |= MODULE_PART_ENTRY_POINTS;
+  }
+  if ((parts & MODULE_PART_BINDINGS) != 0) {
+    // Owned once copied, so a failed rebuild of the sets still frees them
+    const SpvReflectDescriptorBinding* p_old_bindings = p_module->descriptor_bindings;
+    SpvReflectResult result = CopyDescriptorBindings(p_module);
+    if ((result == SPV_REFLECT_RESULT_SUCCESS) || (p_module->descriptor_bindings != p_old_bindings)) {
+      p_internal->owned_parts |= MODULE_PART_BINDINGS;
+    }
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectCloneShaderModule(
+  SpvReflectShaderModule*  p_module,
+  SpvReflectShaderModule*  p_clone
+)
+{
+  if (IsNull(p_module) || IsNull(p_clone) || IsNull(p_module->_internal)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_clone, 0, sizeof(*p_clone));
+
+  // The first clone moves the module's data into a shared copy of the
+  // module; the module's own fields keep pointing at it
+  if (IsNull(p_module->_internal->p_shared)) {
+    SpvReflectShaderModule* p_shared = (SpvReflectShaderModule*)calloc(1, sizeof(*p_shared));
+    struct SpvReflectShaderModule::Internal* p_internal =
+        (struct SpvReflectShaderModule::Internal*)calloc(1, sizeof(*p_internal));
+    if (IsNull(p_shared) || IsNull(p_internal)) {
+      SafeFree(p_shared);
+      SafeFree(p_internal);
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    *p_shared = *p_module;
+    *p_internal = *(p_module->_internal);
+    p_internal->p_shared = p_shared;
+    p_internal->owned_parts = 0;
+    p_shared->_internal->shared_ref_count = 1;
+    p_module->_internal = p_internal;
+  }
+
+  struct SpvReflectShaderModule::Internal* p_internal =
+      (struct SpvReflectShaderModule::Internal*)calloc(1, sizeof(*p_internal));
+  if (IsNull(p_internal)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  *p_clone = *p_module;
+  *p_internal = *(p_module->_internal);
+  p_internal->owned_parts = 0;
+  p_clone->_internal = p_internal;
+  p_internal->p_shared->_internal->shared_ref_count += 1;
+
+  SpvReflectResult result = MakeModuleWritable(p_clone, p_module->_internal->owned_parts);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyShaderModule(p_clone);
+    memset(p_clone, 0, sizeof(*p_clone));
+  }
+  return result;
+}
+
 void spvReflectDestroyShaderModule(SpvReflectShaderModule* p_module)
 {
   if (IsNull(p_module->_internal)) {
     return;
   }
 
+  // Clones free the parts they copied and release the shared data
+  SpvReflectShaderModule* p_shared = p_module->_internal->p_shared;
+  if (IsNotNull(p_shared)) {
+    uint32_t owned_parts = p_module->_internal->owned_parts;
+    if ((owned_parts & MODULE_PART_BINDINGS) != 0) {
+      for (uint32_t i = 0; i < SPV_REFLECT_MAX_DESCRIPTOR_SETS; ++i) {
+        SafeFree(p_module->descriptor_sets[i].bindings);
+      }
+      SafeFree(p_module->descriptor_bindings);
+    }
+    if ((owned_parts & MODULE_PART_ENTRY_POINTS) != 0) {
+      FreeCopiedEntryPoints(p_module->entry_points, p_module->entry_point_count);
+    }
+    if ((owned_parts & MODULE_PART_CODE) != 0) {
+      SafeFree(p_module->_internal->spirv_code);
+    }
+    SafeFree(p_module->_internal);
+    p_shared->_internal->shared_ref_count -= 1;
+    if (p_shared->_internal->shared_ref_count == 0) {
+      spvReflectDestroyShaderModule(p_shared);
+      SafeFree(p_shared);
+    }
+    return;
+  }
+
   // Descriptor set bindings
   for (size_t i = 0; i < p_module->descriptor_set_count; ++i) {
     SpvReflectDescriptorSet* p_set = &p_module->descriptor_sets[i];
@@ -3064,9 +4108,14 @@ void spvReflectDestroyShaderModule(SpvReflectShaderModule* p_module)
     SafeFree(p_entry->output_variables);
     SafeFree(p_entry->used_uniforms);
     SafeFree(p_entry->used_push_constants);
+    SafeFree(p_entry->image_sampler_pairs);
+    SafeFree(p_entry->binding_accesses);
   }
   SafeFree(p_module->entry_points);
 
+  // Source text
+  SafeFree(p_module->source_source);
+
   // Push constants
   for (size_t i = 0; i < p_module->push_constant_block_count; ++i) {
     SafeFreeBlockVariables(&p_module->push_constant_blocks[i]);
@@ -3482,46 +4531,203 @@ SpvReflectResult spvReflectEnumerateEntryPointPushConstantBlocks(
   return SPV_REFLECT_RESULT_SUCCESS;
 }
 
-const SpvReflectDescriptorBinding* spvReflectGetDescriptorBinding(const SpvReflectShaderModule* p_module,
-                                                                  uint32_t                      binding_number,
-                                                                  uint32_t                      set_number,
-                                                                  SpvReflectResult*             p_result)
+SpvReflectResult spvReflectEnumerateEntryPointImageSamplerPairs(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  uint32_t*                      p_count,
+  SpvReflectImageSamplerPair**   pp_pairs
+)
 {
-  const SpvReflectDescriptorBinding* p_descriptor = NULL;
-  if (IsNotNull(p_module)) {
-    for (uint32_t index = 0; index < p_module->descriptor_binding_count; ++index) {
-      const SpvReflectDescriptorBinding* p_potential = &p_module->descriptor_bindings[index];
-      if ((p_potential->binding == binding_number) && (p_potential->set == set_number)) {
-        p_descriptor = p_potential;
-        break;
-      }
-    }
+  if (IsNull(p_module)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
   }
-  if (IsNotNull(p_result)) {
-    *p_result = IsNotNull(p_descriptor)
-        ?  SPV_REFLECT_RESULT_SUCCESS
-        : (IsNull(p_module) ? SPV_REFLECT_RESULT_ERROR_NULL_POINTER
-                            : SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  if (IsNull(p_count)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
   }
-  return p_descriptor;
-}
 
-const SpvReflectDescriptorBinding* spvReflectGetEntryPointDescriptorBinding(
-  const SpvReflectShaderModule* p_module,
-  const char*                   entry_point,
-  uint32_t                      binding_number,
-  uint32_t                      set_number,
-  SpvReflectResult*             p_result)
-{
   const SpvReflectEntryPoint* p_entry =
       spvReflectGetEntryPoint(p_module, entry_point);
   if (IsNull(p_entry)) {
-    if (IsNotNull(p_result)) {
-      *p_result = SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  if (IsNotNull(pp_pairs)) {
+    if (*p_count != p_entry->image_sampler_pair_count) {
+      return SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH;
+    }
+
+    for (uint32_t index = 0; index < *p_count; ++index) {
+      pp_pairs[index] = &p_entry->image_sampler_pairs[index];
     }
-    return NULL;
   }
-  const SpvReflectDescriptorBinding* p_descriptor = NULL;
+  else {
+    *p_count = p_entry->image_sampler_pair_count;
+  }
+
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectEnumerateEntryPointBindingAccesses(
+  const SpvReflectShaderModule*       p_module,
+  const char*                         entry_point,
+  uint32_t*                           p_count,
+  SpvReflectDescriptorBindingAccess** pp_accesses
+)
+{
+  if (IsNull(p_module)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if (IsNull(p_count)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  const SpvReflectEntryPoint* p_entry =
+      spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  if (IsNotNull(pp_accesses)) {
+    if (*p_count != p_entry->binding_access_count) {
+      return SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH;
+    }
+
+    for (uint32_t index = 0; index < *p_count; ++index) {
+      pp_accesses[index] = &p_entry->binding_accesses[index];
+    }
+  }
+  else {
+    *p_count = p_entry->binding_access_count;
+  }
+
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+typedef struct SamplerPairUse {
+  const SpvReflectImageSamplerPair*  p_pair;
+  uint32_t                           stage;
+} SamplerPairUse;
+
+// Bindings from different modules only share their numbers
+static int SortCompareSamplerPairUse(const void* a, const void* b)
+{
+  const SamplerPairUse* p_elem_a = (const SamplerPairUse*)a;
+  const SamplerPairUse* p_elem_b = (const SamplerPairUse*)b;
+  int value = CompareBindingNumbers(p_elem_a->p_pair->p_sampler, p_elem_b->p_pair->p_sampler);
+  if (value == 0) {
+    value = CompareBindingNumbers(p_elem_a->p_pair->p_image, p_elem_b->p_pair->p_image);
+  }
+  return value;
+}
+
+SpvReflectResult spvReflectEnumerateSamplerUsage(
+  uint32_t                            entry_point_count,
+  const SpvReflectEntryPoint* const*  pp_entry_points,
+  uint32_t*                           p_count,
+  SpvReflectSamplerUsage*             p_usages
+)
+{
+  if ((IsNull(pp_entry_points) && (entry_point_count > 0)) || IsNull(p_count)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  uint32_t use_count = 0;
+  for (uint32_t i = 0; i < entry_point_count; ++i) {
+    if (IsNull(pp_entry_points[i])) {
+      return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+    }
+    use_count += pp_entry_points[i]->image_sampler_pair_count;
+  }
+  SamplerPairUse* p_uses = (SamplerPairUse*)calloc(use_count + 1, sizeof(*p_uses));
+  if (IsNull(p_uses)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  use_count = 0;
+  for (uint32_t i = 0; i < entry_point_count; ++i) {
+    const SpvReflectEntryPoint* p_entry = pp_entry_points[i];
+    for (uint32_t j = 0; j < p_entry->image_sampler_pair_count; ++j) {
+      p_uses[use_count].p_pair = &p_entry->image_sampler_pairs[j];
+      p_uses[use_count].stage = p_entry->shader_stage;
+      ++use_count;
+    }
+  }
+  qsort(p_uses, use_count, sizeof(*p_uses), SortCompareSamplerPairUse);
+
+  uint32_t usage_count = 0;
+  for (uint32_t i = 0; i < use_count;) {
+    SpvReflectSamplerUsage usage;
+    memset(&usage, 0, sizeof(usage));
+    usage.p_sampler = p_uses[i].p_pair->p_sampler;
+    usage.p_image = p_uses[i].p_pair->p_image;
+    uint32_t j = i;
+    for (; (j < use_count) && (CompareBindingNumbers(p_uses[j].p_pair->p_sampler, usage.p_sampler) == 0); ++j) {
+      usage.stage_flags |= p_uses[j].stage;
+      if ((j == i) || (CompareBindingNumbers(p_uses[j].p_pair->p_image, p_uses[j - 1].p_pair->p_image) != 0)) {
+        ++usage.image_count;
+      }
+    }
+    if (usage.image_count > 1) {
+      usage.p_image = NULL;
+    }
+    if (IsNotNull(p_usages) && (usage_count < *p_count)) {
+      p_usages[usage_count] = usage;
+    }
+    ++usage_count;
+    i = j;
+  }
+  SafeFree(p_uses);
+
+  if (IsNotNull(p_usages)) {
+    if (usage_count != *p_count) {
+      return SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH;
+    }
+  }
+  else {
+    *p_count = usage_count;
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+const SpvReflectDescriptorBinding* spvReflectGetDescriptorBinding(const SpvReflectShaderModule* p_module,
+                                                                  uint32_t                      binding_number,
+                                                                  uint32_t                      set_number,
+                                                                  SpvReflectResult*             p_result)
+{
+  const SpvReflectDescriptorBinding* p_descriptor = NULL;
+  if (IsNotNull(p_module)) {
+    for (uint32_t index = 0; index < p_module->descriptor_binding_count; ++index) {
+      const SpvReflectDescriptorBinding* p_potential = &p_module->descriptor_bindings[index];
+      if ((p_potential->binding == binding_number) && (p_potential->set == set_number)) {
+        p_descriptor = p_potential;
+        break;
+      }
+    }
+  }
+  if (IsNotNull(p_result)) {
+    *p_result = IsNotNull(p_descriptor)
+        ?  SPV_REFLECT_RESULT_SUCCESS
+        : (IsNull(p_module) ? SPV_REFLECT_RESULT_ERROR_NULL_POINTER
+                            : SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  }
+  return p_descriptor;
+}
+
+const SpvReflectDescriptorBinding* spvReflectGetEntryPointDescriptorBinding(
+  const SpvReflectShaderModule* p_module,
+  const char*                   entry_point,
+  uint32_t                      binding_number,
+  uint32_t                      set_number,
+  SpvReflectResult*             p_result)
+{
+  const SpvReflectEntryPoint* p_entry =
+      spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    if (IsNotNull(p_result)) {
+      *p_result = SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+    }
+    return NULL;
+  }
+  const SpvReflectDescriptorBinding* p_descriptor = NULL;
   if (IsNotNull(p_module)) {
     for (uint32_t index = 0; index < p_module->descriptor_binding_count; ++index) {
       const SpvReflectDescriptorBinding* p_potential = &p_module->descriptor_bindings[index];
@@ -3972,9 +5178,11 @@ SpvReflectResult spvReflectChangeDescriptorBindingNumbers(SpvReflectShaderModule
   }
 
   SpvReflectDescriptorBinding* p_target_descriptor = NULL;
+  uint32_t target_index = 0;
   for (uint32_t index = 0; index < p_module->descriptor_binding_count; ++index) {
     if(&p_module->descriptor_bindings[index] == p_binding) {
       p_target_descriptor = &p_module->descriptor_bindings[index];
+      target_index = index;
       break;
     }
   }
@@ -3983,6 +5191,11 @@ SpvReflectResult spvReflectChangeDescriptorBindingNumbers(SpvReflectShaderModule
     if (p_target_descriptor->word_offset.binding > (p_module->_internal->spirv_word_count - 1)) {
       return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
     }
+    SpvReflectResult result = MakeModuleWritable(p_module, MODULE_PART_CODE | MODULE_PART_BINDINGS);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+    p_target_descriptor = &p_module->descriptor_bindings[target_index];
     // Binding number
     if (new_binding_number != SPV_REFLECT_BINDING_NUMBER_DONT_CHANGE) {
       uint32_t* p_code = p_module->_internal->spirv_code + p_target_descriptor->word_offset.binding;
@@ -4033,18 +5246,33 @@ SpvReflectResult spvReflectChangeDescriptorSetNumber(SpvReflectShaderModule*
 
   SpvReflectResult result = SPV_REFLECT_RESULT_SUCCESS;
   if (IsNotNull(p_target_set) && new_set_number != SPV_REFLECT_SET_NUMBER_DONT_CHANGE) {
-    for (uint32_t index = 0; index < p_target_set->binding_count; ++index) {
-      SpvReflectDescriptorBinding* p_descriptor = p_target_set->bindings[index];
+    // Making the module writable can move the bindings and rebuild the
+    // sets, so find the set's bindings by index first
+    uint32_t  binding_count = p_target_set->binding_count;
+    uint32_t* p_indices = (uint32_t*)calloc(Max(binding_count, 1), sizeof(*p_indices));
+    if (IsNull(p_indices)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    for (uint32_t index = 0; index < binding_count; ++index) {
+      const SpvReflectDescriptorBinding* p_descriptor = p_target_set->bindings[index];
       if (p_descriptor->word_offset.set > (p_module->_internal->spirv_word_count - 1)) {
+        SafeFree(p_indices);
         return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
       }
-
-      uint32_t* p_code = p_module->_internal->spirv_code + p_descriptor->word_offset.set;
-      *p_code = new_set_number;
-      p_descriptor->set = new_set_number;
+      p_indices[index] = (uint32_t)(p_descriptor - p_module->descriptor_bindings);
     }
 
-    result = SynchronizeDescriptorSets(p_module);
+    result = MakeModuleWritable(p_module, MODULE_PART_CODE | MODULE_PART_BINDINGS);
+    if (result == SPV_REFLECT_RESULT_SUCCESS) {
+      for (uint32_t index = 0; index < binding_count; ++index) {
+        SpvReflectDescriptorBinding* p_descriptor = &p_module->descriptor_bindings[p_indices[index]];
+        uint32_t* p_code = p_module->_internal->spirv_code + p_descriptor->word_offset.set;
+        *p_code = new_set_number;
+        p_descriptor->set = new_set_number;
+      }
+      result = SynchronizeDescriptorSets(p_module);
+    }
+    SafeFree(p_indices);
   }
 
   return result;
@@ -4075,6 +5303,10 @@ SpvReflectResult spvReflectChangeInputVariableLocation(SpvReflectShaderModule*
   }
   for (uint32_t index = 0; index < p_module->input_variable_count; ++index) {
     if(&p_module->input_variables[index] == p_input_variable) {
+      SpvReflectResult result = MakeModuleWritable(p_module, MODULE_PART_CODE | MODULE_PART_ENTRY_POINTS);
+      if (result != SPV_REFLECT_RESULT_SUCCESS) {
+        return result;
+      }
       return ChangeVariableLocation(p_module, &p_module->input_variables[index], new_location);
     }
   }
@@ -4093,6 +5325,10 @@ SpvReflectResult spvReflectChangeOutputVariableLocation(SpvReflectShaderModule*
   }
   for (uint32_t index = 0; index < p_module->output_variable_count; ++index) {
     if(&p_module->output_variables[index] == p_output_variable) {
+      SpvReflectResult result = MakeModuleWritable(p_module, MODULE_PART_CODE | MODULE_PART_ENTRY_POINTS);
+      if (result != SPV_REFLECT_RESULT_SUCCESS) {
+        return result;
+      }
       return ChangeVariableLocation(p_module, &p_module->output_variables[index], new_location);
     }
   }
@@ -4114,3 +5350,8066 @@ const char* spvReflectSourceLanguage(SpvSourceLanguage source_lang)
   }
   return "";
 }
+
+//
+// Returns true if an instruction that may appear in a function body has a
+// result type and result id as its first two operands. OpLabel only has a
+// result id and is handled separately by the callers.
+//
+static bool HasResultAndType(SpvOp op)
+{
+  switch (op) {
+    default: break;
+    case SpvOpNop:
+    case SpvOpLine:
+    case SpvOpNoLine:
+    case SpvOpLabel:
+    case SpvOpFunctionEnd:
+    case SpvOpStore:
+    case SpvOpCopyMemory:
+    case SpvOpCopyMemorySized:
+    case SpvOpSelectionMerge:
+    case SpvOpLoopMerge:
+    case SpvOpBranch:
+    case SpvOpBranchConditional:
+    case SpvOpSwitch:
+    case SpvOpKill:
+    case SpvOpReturn:
+    case SpvOpReturnValue:
+    case SpvOpUnreachable:
+    case SpvOpLifetimeStart:
+    case SpvOpLifetimeStop:
+    case SpvOpControlBarrier:
+    case SpvOpMemoryBarrier:
+    case SpvOpMemoryNamedBarrier:
+    case SpvOpAtomicStore:
+    case SpvOpImageWrite:
+    case SpvOpEmitVertex:
+    case SpvOpEndPrimitive:
+    case SpvOpEmitStreamVertex:
+    case SpvOpEndStreamPrimitive:
+    case SpvOpCommitReadPipe:
+    case SpvOpCommitWritePipe:
+    case SpvOpGroupCommitReadPipe:
+    case SpvOpGroupCommitWritePipe:
+    case SpvOpRetainEvent:
+    case SpvOpReleaseEvent:
+    case SpvOpSetUserEventStatus:
+    case SpvOpCaptureEventProfilingInfo:
+    case SpvOpGroupWaitEvents:
+      return false;
+  }
+  return true;
+}
+
+static bool IsBlockTerminator(SpvOp op)
+{
+  switch (op) {
+    default: break;
+    case SpvOpBranch:
+    case SpvOpBranchConditional:
+    case SpvOpSwitch:
+    case SpvOpKill:
+    case SpvOpReturn:
+    case SpvOpReturnValue:
+    case SpvOpUnreachable:
+      return true;
+  }
+  return false;
+}
+
+//
+// ParseNodes() only records result ids for the instructions reflection
+// needs. The optional analyses need every definition, so this assigns the
+// remaining result ids and builds an id indexed table of defining nodes.
+//
+static SpvReflectResult ParseIds(Parser* p_parser)
+{
+  assert(IsNotNull(p_parser));
+  assert(IsNotNull(p_parser->spirv_code));
+  assert(IsNotNull(p_parser->nodes));
+
+  // Id bound from the module header
+  CHECKED_READU32(p_parser, 3, p_parser->id_bound);
+  if (p_parser->id_bound == 0) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  p_parser->id_nodes = (Node**)calloc(p_parser->id_bound, sizeof(*(p_parser->id_nodes)));
+  if (IsNull(p_parser->id_nodes)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  bool in_function = false;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    switch (p_node->op) {
+      default: {
+        if (in_function && (p_node->result_id == 0) && HasResultAndType(p_node->op)) {
+          CHECKED_READU32(p_parser, p_node->word_offset + 1, p_node->result_type_id);
+          CHECKED_READU32(p_parser, p_node->word_offset + 2, p_node->result_id);
+        }
+      }
+      break;
+
+      case SpvOpFunction: {
+        CHECKED_READU32(p_parser, p_node->word_offset + 1, p_node->result_type_id);
+        in_function = true;
+      }
+      break;
+
+      case SpvOpFunctionEnd: {
+        in_function = false;
+      }
+      break;
+
+      case SpvOpLabel:
+      case SpvOpString:
+      case SpvOpExtInstImport: {
+        CHECKED_READU32(p_parser, p_node->word_offset + 1, p_node->result_id);
+      }
+      break;
+
+      case SpvOpUndef:
+      case SpvOpSpecConstantTrue:
+      case SpvOpSpecConstantFalse:
+      case SpvOpSpecConstant:
+      case SpvOpSpecConstantComposite:
+      case SpvOpSpecConstantOp: {
+        CHECKED_READU32(p_parser, p_node->word_offset + 1, p_node->result_type_id);
+        CHECKED_READU32(p_parser, p_node->word_offset + 2, p_node->result_id);
+      }
+      break;
+    }
+
+    if (p_node->word_offset + p_node->word_count > p_parser->spirv_word_count) {
+      return SPV_REFLECT_RESULT_ERROR_SPIRV_UNEXPECTED_EOF;
+    }
+    if (p_node->result_id != 0) {
+      if (p_node->result_id >= p_parser->id_bound) {
+        return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+      }
+      p_parser->id_nodes[p_node->result_id] = p_node;
+    }
+  }
+
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+//
+// Re-parses the module's SPIR-V for the optional analyses. The parser is
+// destroyed at the end of spvReflectCreateShaderModule(), so analyses that
+// need the instruction stream build their own and release it when done.
+//
+static SpvReflectResult CreateAnalysisParser(const SpvReflectShaderModule* p_module, Parser* p_parser)
+{
+  memset(p_parser, 0, sizeof(*p_parser));
+  if (IsNull(p_module->_internal)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  SpvReflectResult result = CreateParser(p_module->_internal->spirv_size,
+                                         p_module->_internal->spirv_code,
+                                         p_parser);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseNodes(p_parser);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseStrings(p_parser);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseFunctions(p_parser);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseIds(p_parser);
+  }
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    DestroyParser(p_parser);
+  }
+  return result;
+}
+
+// Rewrites that renumber or replace bindings across the whole module need
+// the bindings of every entry point, which a filtered module does not have
+static bool IsEntryPointFiltered(const SpvReflectShaderModule* p_module)
+{
+  return IsNotNull(p_module->_internal) && (p_module->_internal->entry_points_filtered != 0);
+}
+
+static Node* FindIdNode(const Parser* p_parser, uint32_t id)
+{
+  if (IsNull(p_parser->id_nodes) || (id >= p_parser->id_bound)) {
+    return NULL;
+  }
+  return p_parser->id_nodes[id];
+}
+
+static Function* FindFunction(const Parser* p_parser, uint32_t function_id)
+{
+  // Functions are sorted by id in ParseFunctions()
+  size_t lo = 0;
+  size_t hi = p_parser->function_count;
+  while (lo < hi) {
+    size_t mid = (hi - lo) / 2 + lo;
+    Function* p_func = &(p_parser->functions[mid]);
+    if (p_func->id == function_id) {
+      return p_func;
+    } else if (p_func->id < function_id) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return NULL;
+}
+
+//
+// Copies the operands of p_node that may reference ids into p_ids and
+// returns how many were written; p_ids must hold at least word_count
+// entries. Operands known to be literals or labels are skipped, anything
+// else is returned as-is so callers must filter against the ids they track.
+//
+static uint32_t GetIdOperands(const Parser* p_parser, const Node* p_node, uint32_t* p_ids)
+{
+  uint32_t first = HasResultAndType(p_node->op) ? 3 : 1;
+  uint32_t end = p_node->word_count;
+  uint32_t step = 1;
+  switch (p_node->op) {
+    default: break;
+    case SpvOpLabel:
+    case SpvOpBranch:
+    case SpvOpSelectionMerge:
+    case SpvOpLoopMerge:
+    case SpvOpLine:
+    case SpvOpNoLine:
+    case SpvOpFunctionEnd: {
+      end = 0;
+    }
+    break;
+    case SpvOpLoad:
+    case SpvOpCompositeExtract:
+    case SpvOpBranchConditional:
+    case SpvOpSwitch:
+    case SpvOpReturnValue: {
+      end = first + 1;
+    }
+    break;
+    case SpvOpStore:
+    case SpvOpCopyMemory:
+    case SpvOpCompositeInsert:
+    case SpvOpVectorShuffle: {
+      end = first + 2;
+    }
+    break;
+    case SpvOpCopyMemorySized: {
+      end = first + 3;
+    }
+    break;
+    case SpvOpVariable: {
+      first = 4;
+    }
+    break;
+    case SpvOpExtInst: {
+      first = 5;
+    }
+    break;
+    case SpvOpPhi: {
+      step = 2;
+    }
+    break;
+  }
+
+  if (end > p_node->word_count) {
+    end = p_node->word_count;
+  }
+  if (p_node->word_offset + end > p_parser->spirv_word_count) {
+    end = (uint32_t)(p_parser->spirv_word_count - p_node->word_offset);
+  }
+
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  uint32_t count = 0;
+  for (uint32_t i = first; i < end; i += step) {
+    p_ids[count++] = p_words[i];
+  }
+  return count;
+}
+
+//
+// Copies the labels a block terminator may branch to into p_labels, which
+// must hold at least word_count entries, and returns how many were written.
+//
+static uint32_t GetSuccessorLabels(const Parser* p_parser, const Node* p_node, uint32_t* p_labels)
+{
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  uint32_t count = 0;
+  if ((p_node->op == SpvOpBranch) && (p_node->word_count > 1)) {
+    p_labels[count++] = p_words[1];
+  }
+  else if ((p_node->op == SpvOpBranchConditional) && (p_node->word_count > 3)) {
+    p_labels[count++] = p_words[2];
+    p_labels[count++] = p_words[3];
+  }
+  else if ((p_node->op == SpvOpSwitch) && (p_node->word_count > 2)) {
+    p_labels[count++] = p_words[2];
+    // Case literals are as wide as the selector
+    Node* p_selector = FindIdNode(p_parser, p_words[1]);
+    Node* p_selector_type = IsNotNull(p_selector) ? FindIdNode(p_parser, p_selector->result_type_id) : NULL;
+    uint32_t literal_word_count = 1;
+    if (IsNotNull(p_selector_type) && (p_selector_type->op == SpvOpTypeInt) &&
+        (p_parser->spirv_code[p_selector_type->word_offset + 2] > 32)) {
+      literal_word_count = 2;
+    }
+    for (uint32_t k = 3; (k + literal_word_count) < p_node->word_count; k += literal_word_count + 1) {
+      p_labels[count++] = p_words[k + literal_word_count];
+    }
+  }
+  return count;
+}
+
+static uint32_t GetConstantValue(const Parser* p_parser, uint32_t constant_id)
+{
+  Node* p_node = FindIdNode(p_parser, constant_id);
+  if (IsNull(p_node) || (p_node->word_count < 4) ||
+      ((p_node->op != SpvOpConstant) && (p_node->op != SpvOpSpecConstant))) {
+    return 0;
+  }
+  return p_parser->spirv_code[p_node->word_offset + 3];
+}
+
+//
+// Size of a type either in 32-bit registers, where 64-bit components take
+// two registers and pointers and opaque handles take none, or in tightly
+// packed bytes.
+//
+static uint32_t GetTypeSize(const Parser* p_parser, uint32_t type_id, bool in_bytes, uint32_t depth)
+{
+  Node* p_type = FindIdNode(p_parser, type_id);
+  if (IsNull(p_type) || (depth > p_parser->type_count)) {
+    return 0;
+  }
+
+  const uint32_t* p_words = p_parser->spirv_code + p_type->word_offset;
+  uint32_t size = 0;
+  switch (p_type->op) {
+    default: break;
+    case SpvOpTypeBool: {
+      size = in_bytes ? 4 : 1;
+    }
+    break;
+    case SpvOpTypeInt:
+    case SpvOpTypeFloat: {
+      uint32_t width = p_words[2];
+      size = in_bytes ? (width / SPIRV_BYTE_WIDTH) : ((width > 32) ? 2 : 1);
+    }
+    break;
+    case SpvOpTypeVector:
+    case SpvOpTypeMatrix: {
+      size = p_words[3] * GetTypeSize(p_parser, p_words[2], in_bytes, depth + 1);
+    }
+    break;
+    case SpvOpTypeArray: {
+      size = GetConstantValue(p_parser, p_type->array_traits.length_id) *
+             GetTypeSize(p_parser, p_type->array_traits.element_type_id, in_bytes, depth + 1);
+    }
+    break;
+    case SpvOpTypeStruct: {
+      for (uint32_t i = 2; i < p_type->word_count; ++i) {
+        size += GetTypeSize(p_parser, p_words[i], in_bytes, depth + 1);
+      }
+    }
+    break;
+    case SpvOpTypePointer: {
+      size = in_bytes ? 8 : 0;
+    }
+    break;
+  }
+  return size;
+}
+
+static bool TestBit(const uint32_t* p_bits, uint32_t index)
+{
+  return (p_bits[index >> 5] & (1u << (index & 31))) != 0;
+}
+
+static void SetBit(uint32_t* p_bits, uint32_t index)
+{
+  p_bits[index >> 5] |= (1u << (index & 31));
+}
+
+static void ClearBit(uint32_t* p_bits, uint32_t index)
+{
+  p_bits[index >> 5] &= ~(1u << (index & 31));
+}
+
+//
+// Collects the sorted, unique ids of the functions reachable from p_func.
+//
+static SpvReflectResult EnumerateCalledFunctions(Parser* p_parser, Function* p_func,
+                                                 size_t* p_count, uint32_t** pp_func_ids)
+{
+  *p_count = 0;
+  *pp_func_ids = NULL;
+
+  size_t count = 0;
+  SpvReflectResult result = TraverseCallGraph(p_parser, p_func, &count, NULL, 0);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  uint32_t* func_ids = (uint32_t*)calloc(count, sizeof(*func_ids));
+  if (IsNull(func_ids)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  count = 0;
+  result = TraverseCallGraph(p_parser, p_func, &count, func_ids, 0);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    SafeFree(func_ids);
+    return result;
+  }
+
+  qsort(func_ids, count, sizeof(*func_ids), SortCompareUint32);
+  *p_count = DedupSortedUint32(func_ids, count);
+  *pp_func_ids = func_ids;
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+enum {
+  DEFAULT_REGISTERS_PER_LANE     = 256,
+  DEFAULT_REGISTER_GRANULARITY   = 4,
+  DEFAULT_MAX_WAVES_PER_SIMD     = 10,
+  DEFAULT_SIMDS_PER_COMPUTE_UNIT = 4,
+  DEFAULT_WAVE_SIZE              = 64,
+  DEFAULT_SHARED_MEMORY_SIZE     = 65536,
+};
+
+typedef struct PressureBlock {
+  uint32_t                      label_node;
+  uint32_t                      end_node;
+  uint32_t                      successor_index;
+  uint32_t                      successor_count;
+} PressureBlock;
+
+typedef struct PressureContext {
+  Parser*                       p_parser;
+  uint32_t*                     value_slots;
+  uint32_t*                     block_slots;
+  uint32_t*                     operands;
+  bool*                         computed;
+  SpvReflectFunctionPressure*   functions;
+  // Values that take half their registers, NULL to use full size for all
+  const bool*                   half_precision_ids;
+} PressureContext;
+
+static bool CreatesRegisterUsage(const Node* p_node)
+{
+  return (p_node->result_id != 0) &&
+         (p_node->op != SpvOpLabel) &&
+         (p_node->op != SpvOpUndef) &&
+         (p_node->op != SpvOpFunction);
+}
+
+static uint32_t GetValueRegisterCount(const Parser* p_parser, const Node* p_node)
+{
+  if (p_node->op == SpvOpVariable) {
+    // Function scope variables end up in registers once the driver's
+    // compiler has promoted them, so count the pointee.
+    Node* p_ptr_type = FindIdNode(p_parser, p_node->type_id);
+    return IsNotNull(p_ptr_type) ? GetTypeSize(p_parser, p_ptr_type->type_id, false, 0) : 0;
+  }
+  return GetTypeSize(p_parser, p_node->result_type_id, false, 0);
+}
+
+static uint32_t LookupSlot(const Parser* p_parser, const uint32_t* p_slots, uint32_t id)
+{
+  return (id < p_parser->id_bound) ? p_slots[id] : (uint32_t)INVALID_VALUE;
+}
+
+static SpvReflectResult ComputeBlockPressures(PressureContext*             p_ctx,
+                                              size_t                       first_node,
+                                              size_t                       end_node,
+                                              uint32_t                     value_count,
+                                              uint32_t                     block_count,
+                                              uint32_t                     successor_capacity,
+                                              SpvReflectFunctionPressure*  p_pressure)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  if (block_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+
+  uint32_t word_count = Max((value_count + 31) / 32, 1);
+  size_t set_size = (size_t)block_count * word_count;
+
+  uint32_t* weights = (uint32_t*)calloc(value_count + 1, sizeof(*weights));
+  PressureBlock* blocks = (PressureBlock*)calloc(block_count, sizeof(*blocks));
+  uint32_t* successors = (uint32_t*)calloc(successor_capacity + 1, sizeof(*successors));
+  uint32_t* bits = (uint32_t*)calloc(5 * set_size + word_count, sizeof(*bits));
+  p_pressure->blocks = (SpvReflectBlockPressure*)calloc(block_count, sizeof(*(p_pressure->blocks)));
+  if (IsNull(weights) || IsNull(blocks) || IsNull(successors) || IsNull(bits) || IsNull(p_pressure->blocks)) {
+    SafeFree(weights);
+    SafeFree(blocks);
+    SafeFree(successors);
+    SafeFree(bits);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  p_pressure->block_count = block_count;
+
+  uint32_t* use_sets = bits;
+  uint32_t* def_sets = use_sets + set_size;
+  uint32_t* phi_sets = def_sets + set_size;
+  uint32_t* in_sets = phi_sets + set_size;
+  uint32_t* out_sets = in_sets + set_size;
+  uint32_t* live = out_sets + set_size;
+
+  // Upward exposed uses and definitions of each block. Values feeding an
+  // OpPhi are used at the end of the corresponding predecessor instead.
+  uint32_t block_index = (uint32_t)INVALID_VALUE;
+  uint32_t successor_count = 0;
+  for (size_t i = first_node; i < end_node; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if (p_node->op == SpvOpLabel) {
+      block_index = p_ctx->block_slots[p_node->result_id];
+      blocks[block_index].label_node = (uint32_t)i;
+      blocks[block_index].end_node = (uint32_t)i;
+      blocks[block_index].successor_index = successor_count;
+      p_pressure->blocks[block_index].label_id = p_node->result_id;
+      continue;
+    }
+
+    uint32_t def = (uint32_t)INVALID_VALUE;
+    if (CreatesRegisterUsage(p_node)) {
+      def = p_ctx->value_slots[p_node->result_id];
+      weights[def] = GetValueRegisterCount(p_parser, p_node);
+      if (IsNotNull(p_ctx->half_precision_ids) && p_ctx->half_precision_ids[p_node->result_id]) {
+        weights[def] = (weights[def] + 1) / 2;
+      }
+    }
+    // Function parameters
+    if (block_index == (uint32_t)INVALID_VALUE) {
+      continue;
+    }
+
+    uint32_t* p_use = use_sets + block_index * word_count;
+    uint32_t* p_def = def_sets + block_index * word_count;
+    if (p_node->op == SpvOpPhi) {
+      for (uint32_t k = 3; (k + 1) < p_node->word_count; k += 2) {
+        uint32_t value = LookupSlot(p_parser, p_ctx->value_slots, p_words[k]);
+        uint32_t parent = LookupSlot(p_parser, p_ctx->block_slots, p_words[k + 1]);
+        if ((value != (uint32_t)INVALID_VALUE) && (parent != (uint32_t)INVALID_VALUE)) {
+          SetBit(phi_sets + parent * word_count, value);
+        }
+      }
+    }
+    else {
+      uint32_t operand_count = GetIdOperands(p_parser, p_node, p_ctx->operands);
+      for (uint32_t k = 0; k < operand_count; ++k) {
+        uint32_t value = LookupSlot(p_parser, p_ctx->value_slots, p_ctx->operands[k]);
+        if ((value != (uint32_t)INVALID_VALUE) && !TestBit(p_def, value)) {
+          SetBit(p_use, value);
+        }
+      }
+    }
+    if (def != (uint32_t)INVALID_VALUE) {
+      SetBit(p_def, def);
+    }
+
+    if (IsBlockTerminator(p_node->op)) {
+      // Labels are converted to block slots in place
+      uint32_t* p_labels = &successors[successor_count];
+      uint32_t label_count = GetSuccessorLabels(p_parser, p_node, p_labels);
+      for (uint32_t k = 0; k < label_count; ++k) {
+        uint32_t target = LookupSlot(p_parser, p_ctx->block_slots, p_labels[k]);
+        if (target != (uint32_t)INVALID_VALUE) {
+          successors[successor_count++] = target;
+        }
+      }
+      blocks[block_index].end_node = (uint32_t)i;
+      blocks[block_index].successor_count = successor_count - blocks[block_index].successor_index;
+      block_index = (uint32_t)INVALID_VALUE;
+    }
+  }
+
+  // Backward data flow until the live sets are stable
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (uint32_t b = block_count; b-- > 0;) {
+      const uint32_t* p_use = use_sets + b * word_count;
+      const uint32_t* p_def = def_sets + b * word_count;
+      const uint32_t* p_phi = phi_sets + b * word_count;
+      uint32_t* p_in = in_sets + b * word_count;
+      uint32_t* p_out = out_sets + b * word_count;
+      for (uint32_t w = 0; w < word_count; ++w) {
+        uint32_t out = p_phi[w];
+        for (uint32_t k = 0; k < blocks[b].successor_count; ++k) {
+          out |= in_sets[successors[blocks[b].successor_index + k] * word_count + w];
+        }
+        uint32_t in = p_use[w] | (out & ~p_def[w]);
+        if ((out != p_out[w]) || (in != p_in[w])) {
+          p_out[w] = out;
+          p_in[w] = in;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // Walk each block backwards from its live-out set to find the peak
+  for (uint32_t b = 0; b < block_count; ++b) {
+    memcpy(live, out_sets + b * word_count, word_count * sizeof(*live));
+    uint32_t live_values = 0;
+    uint32_t live_registers = 0;
+    for (uint32_t v = 0; v < value_count; ++v) {
+      if (TestBit(live, v)) {
+        ++live_values;
+        live_registers += weights[v];
+      }
+    }
+    uint32_t peak_values = live_values;
+    uint32_t peak_registers = live_registers;
+
+    for (size_t i = blocks[b].end_node; i > blocks[b].label_node; --i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      if (p_node->op == SpvOpPhi) {
+        continue;
+      }
+      if (CreatesRegisterUsage(p_node)) {
+        uint32_t def = p_ctx->value_slots[p_node->result_id];
+        if (TestBit(live, def)) {
+          ClearBit(live, def);
+          --live_values;
+          live_registers -= weights[def];
+        }
+        // The result needs a register even when it is never read
+        peak_values = Max(peak_values, live_values + 1);
+        peak_registers = Max(peak_registers, live_registers + weights[def]);
+      }
+      if ((p_node->op == SpvOpFunctionCall) && (p_node->word_count > 3)) {
+        Function* p_callee = FindFunction(p_parser, p_parser->spirv_code[p_node->word_offset + 3]);
+        if (IsNotNull(p_callee)) {
+          const SpvReflectFunctionPressure* p_callee_pressure = &(p_ctx->functions[p_callee - p_parser->functions]);
+          peak_values = Max(peak_values, live_values + p_callee_pressure->max_live_values);
+          peak_registers = Max(peak_registers, live_registers + p_callee_pressure->max_live_registers);
+        }
+      }
+      uint32_t operand_count = GetIdOperands(p_parser, p_node, p_ctx->operands);
+      for (uint32_t k = 0; k < operand_count; ++k) {
+        uint32_t value = LookupSlot(p_parser, p_ctx->value_slots, p_ctx->operands[k]);
+        if ((value != (uint32_t)INVALID_VALUE) && !TestBit(live, value)) {
+          SetBit(live, value);
+          ++live_values;
+          live_registers += weights[value];
+        }
+      }
+      peak_values = Max(peak_values, live_values);
+      peak_registers = Max(peak_registers, live_registers);
+    }
+
+    // OpPhi results are all defined on entry to the block
+    for (size_t i = blocks[b].label_node + 1; i <= blocks[b].end_node; ++i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      if ((p_node->op == SpvOpPhi) && CreatesRegisterUsage(p_node)) {
+        uint32_t def = p_ctx->value_slots[p_node->result_id];
+        if (!TestBit(live, def)) {
+          SetBit(live, def);
+          ++live_values;
+          live_registers += weights[def];
+        }
+      }
+    }
+    peak_values = Max(peak_values, live_values);
+    peak_registers = Max(peak_registers, live_registers);
+
+    p_pressure->blocks[b].max_live_values = peak_values;
+    p_pressure->blocks[b].max_live_registers = peak_registers;
+    p_pressure->max_live_values = Max(p_pressure->max_live_values, peak_values);
+    p_pressure->max_live_registers = Max(p_pressure->max_live_registers, peak_registers);
+  }
+
+  SafeFree(weights);
+  SafeFree(blocks);
+  SafeFree(successors);
+  SafeFree(bits);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult ComputeFunctionPressure(PressureContext* p_ctx, Function* p_func, uint32_t depth)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  size_t function_index = (size_t)(p_func - p_parser->functions);
+  if (p_ctx->computed[function_index]) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  if (depth > p_parser->function_count) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_RECURSION;
+  }
+
+  // Callees first, their peak is added to whatever is live across the call
+  for (uint32_t i = 0; i < p_func->callee_count; ++i) {
+    SpvReflectResult result = ComputeFunctionPressure(p_ctx, p_func->callee_ptrs[i], depth + 1);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+  }
+
+  Node* p_func_node = FindIdNode(p_parser, p_func->id);
+  if (IsNull(p_func_node) || (p_func_node->op != SpvOpFunction)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  // Number the values and blocks of the function
+  size_t first_node = (size_t)(p_func_node - p_parser->nodes) + 1;
+  size_t end_node = first_node;
+  uint32_t value_count = 0;
+  uint32_t block_count = 0;
+  uint32_t successor_capacity = 0;
+  for (; (end_node < p_parser->node_count) && (p_parser->nodes[end_node].op != SpvOpFunctionEnd); ++end_node) {
+    Node* p_node = &(p_parser->nodes[end_node]);
+    if (p_node->op == SpvOpLabel) {
+      p_ctx->block_slots[p_node->result_id] = block_count++;
+    }
+    else if (CreatesRegisterUsage(p_node)) {
+      p_ctx->value_slots[p_node->result_id] = value_count++;
+    }
+    if (IsBlockTerminator(p_node->op)) {
+      successor_capacity += p_node->word_count;
+    }
+  }
+
+  SpvReflectFunctionPressure* p_pressure = &(p_ctx->functions[function_index]);
+  p_pressure->function_id = p_func->id;
+  SpvReflectResult result = ComputeBlockPressures(p_ctx,
+                                                  first_node,
+                                                  end_node,
+                                                  value_count,
+                                                  block_count,
+                                                  successor_capacity,
+                                                  p_pressure);
+
+  // Reset the slots for the next function
+  for (size_t i = first_node; i < end_node; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    if (p_node->result_id != 0) {
+      p_ctx->value_slots[p_node->result_id] = (uint32_t)INVALID_VALUE;
+      p_ctx->block_slots[p_node->result_id] = (uint32_t)INVALID_VALUE;
+    }
+  }
+
+  p_ctx->computed[function_index] = (result == SPV_REFLECT_RESULT_SUCCESS);
+  return result;
+}
+
+static void ParseLocalSize(const Parser* p_parser, uint32_t entry_point_id, uint32_t* p_local_size)
+{
+  p_local_size[0] = p_local_size[1] = p_local_size[2] = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if ((p_node->op == SpvOpExecutionMode) && (p_node->word_count >= 6) &&
+        (p_words[1] == entry_point_id) && (p_words[2] == SpvExecutionModeLocalSize)) {
+      p_local_size[0] = p_words[3];
+      p_local_size[1] = p_words[4];
+      p_local_size[2] = p_words[5];
+    }
+  }
+
+  // A constant decorated with the WorkgroupSize built-in takes precedence
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if ((p_node->op != SpvOpDecorate) || (p_node->word_count < 4) ||
+        (p_words[2] != SpvDecorationBuiltIn) || (p_words[3] != SpvBuiltInWorkgroupSize)) {
+      continue;
+    }
+    Node* p_constant = FindIdNode(p_parser, p_words[1]);
+    if (IsNull(p_constant) || (p_constant->word_count < 6) ||
+        ((p_constant->op != SpvOpConstantComposite) && (p_constant->op != SpvOpSpecConstantComposite))) {
+      continue;
+    }
+    for (uint32_t k = 0; k < 3; ++k) {
+      p_local_size[k] = GetConstantValue(p_parser, p_parser->spirv_code[p_constant->word_offset + 3 + k]);
+    }
+  }
+}
+
+static SpvReflectResult ParseSharedMemorySize(Parser* p_parser, size_t function_count,
+                                              const uint32_t* function_ids, uint32_t* p_size)
+{
+  *p_size = 0;
+
+  size_t ptr_count = 0;
+  for (size_t i = 0; i < function_count; ++i) {
+    ptr_count += FindFunction(p_parser, function_ids[i])->accessed_ptr_count;
+  }
+  if (ptr_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+
+  uint32_t* ptrs = (uint32_t*)calloc(ptr_count, sizeof(*ptrs));
+  if (IsNull(ptrs)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  ptr_count = 0;
+  for (size_t i = 0; i < function_count; ++i) {
+    Function* p_func = FindFunction(p_parser, function_ids[i]);
+    if (p_func->accessed_ptr_count == 0) {
+      continue;
+    }
+    memcpy(&ptrs[ptr_count], p_func->accessed_ptrs, p_func->accessed_ptr_count * sizeof(*ptrs));
+    ptr_count += p_func->accessed_ptr_count;
+  }
+  qsort(ptrs, ptr_count, sizeof(*ptrs), SortCompareUint32);
+  ptr_count = DedupSortedUint32(ptrs, ptr_count);
+
+  for (size_t i = 0; i < ptr_count; ++i) {
+    Node* p_node = FindIdNode(p_parser, ptrs[i]);
+    if (IsNull(p_node) || (p_node->op != SpvOpVariable) || (p_node->storage_class != SpvStorageClassWorkgroup)) {
+      continue;
+    }
+    Node* p_ptr_type = FindIdNode(p_parser, p_node->type_id);
+    if (IsNotNull(p_ptr_type)) {
+      *p_size += GetTypeSize(p_parser, p_ptr_type->type_id, true, 0);
+    }
+  }
+
+  SafeFree(ptrs);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static void ApplyOccupancyBudget(const SpvReflectOccupancyBudget* p_budget, SpvReflectRegisterPressure* p_pressure)
+{
+  SpvReflectOccupancyBudget budget = {
+    DEFAULT_REGISTERS_PER_LANE,
+    DEFAULT_REGISTER_GRANULARITY,
+    DEFAULT_MAX_WAVES_PER_SIMD,
+    DEFAULT_SIMDS_PER_COMPUTE_UNIT,
+    DEFAULT_WAVE_SIZE,
+    DEFAULT_SHARED_MEMORY_SIZE,
+  };
+  if (IsNotNull(p_budget)) {
+    budget.registers_per_lane     = p_budget->registers_per_lane     ? p_budget->registers_per_lane     : budget.registers_per_lane;
+    budget.register_granularity   = p_budget->register_granularity   ? p_budget->register_granularity   : budget.register_granularity;
+    budget.max_waves_per_simd     = p_budget->max_waves_per_simd     ? p_budget->max_waves_per_simd     : budget.max_waves_per_simd;
+    budget.simds_per_compute_unit = p_budget->simds_per_compute_unit ? p_budget->simds_per_compute_unit : budget.simds_per_compute_unit;
+    budget.wave_size              = p_budget->wave_size              ? p_budget->wave_size              : budget.wave_size;
+    budget.shared_memory_size     = p_budget->shared_memory_size     ? p_budget->shared_memory_size     : budget.shared_memory_size;
+  }
+
+  // Registers are allocated in groups, anything over the register file spills
+  uint32_t granularity = budget.register_granularity;
+  uint32_t allocated = ((p_pressure->max_live_registers + granularity - 1) / granularity) * granularity;
+  if (allocated > budget.registers_per_lane) {
+    p_pressure->spilled_registers = allocated - budget.registers_per_lane;
+    allocated = budget.registers_per_lane;
+  }
+  p_pressure->allocated_registers = allocated;
+  p_pressure->waves_by_registers = budget.max_waves_per_simd;
+  if (allocated > 0) {
+    p_pressure->waves_by_registers = Max(budget.registers_per_lane / allocated, 1);
+  }
+  if (p_pressure->waves_by_registers > budget.max_waves_per_simd) {
+    p_pressure->waves_by_registers = budget.max_waves_per_simd;
+  }
+
+  // Shared memory limits how many workgroups fit on a compute unit at once
+  p_pressure->waves_by_shared_memory = budget.max_waves_per_simd;
+  if (p_pressure->shared_memory_size > 0) {
+    uint32_t thread_count = Max(p_pressure->local_size[0], 1) *
+                            Max(p_pressure->local_size[1], 1) *
+                            Max(p_pressure->local_size[2], 1);
+    uint32_t waves_per_group = (thread_count + budget.wave_size - 1) / budget.wave_size;
+    uint32_t group_count = budget.shared_memory_size / p_pressure->shared_memory_size;
+    uint32_t simd_count = budget.simds_per_compute_unit;
+    uint32_t waves = (group_count * waves_per_group + simd_count - 1) / simd_count;
+    if (waves < p_pressure->waves_by_shared_memory) {
+      p_pressure->waves_by_shared_memory = waves;
+    }
+  }
+
+  p_pressure->occupancy = p_pressure->waves_by_registers;
+  if (p_pressure->waves_by_shared_memory < p_pressure->occupancy) {
+    p_pressure->occupancy = p_pressure->waves_by_shared_memory;
+  }
+}
+
+static void DestroyPressureContext(PressureContext* p_ctx)
+{
+  if (IsNotNull(p_ctx->functions)) {
+    for (size_t i = 0; i < p_ctx->p_parser->function_count; ++i) {
+      SafeFree(p_ctx->functions[i].blocks);
+    }
+  }
+  SafeFree(p_ctx->functions);
+  SafeFree(p_ctx->computed);
+  SafeFree(p_ctx->operands);
+  SafeFree(p_ctx->block_slots);
+  SafeFree(p_ctx->value_slots);
+}
+
+static SpvReflectResult ParseRegisterPressure(PressureContext*                  p_ctx,
+                                              const SpvReflectEntryPoint*       p_entry,
+                                              const SpvReflectOccupancyBudget*  p_budget,
+                                              SpvReflectRegisterPressure*       p_pressure)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  Function* p_entry_func = FindFunction(p_parser, p_entry->id);
+  if (IsNull(p_entry_func)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  p_ctx->value_slots = (uint32_t*)malloc(p_parser->id_bound * sizeof(*(p_ctx->value_slots)));
+  p_ctx->block_slots = (uint32_t*)malloc(p_parser->id_bound * sizeof(*(p_ctx->block_slots)));
+  p_ctx->operands = (uint32_t*)calloc(UINT16_MAX, sizeof(*(p_ctx->operands)));
+  p_ctx->computed = (bool*)calloc(p_parser->function_count, sizeof(*(p_ctx->computed)));
+  p_ctx->functions = (SpvReflectFunctionPressure*)calloc(p_parser->function_count, sizeof(*(p_ctx->functions)));
+  if (IsNull(p_ctx->value_slots) || IsNull(p_ctx->block_slots) || IsNull(p_ctx->operands) ||
+      IsNull(p_ctx->computed) || IsNull(p_ctx->functions)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  memset(p_ctx->value_slots, 0xFF, p_parser->id_bound * sizeof(*(p_ctx->value_slots)));
+  memset(p_ctx->block_slots, 0xFF, p_parser->id_bound * sizeof(*(p_ctx->block_slots)));
+
+  SpvReflectResult result = ComputeFunctionPressure(p_ctx, p_entry_func, 0);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  // Function names
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    if ((p_node->op != SpvOpName) || (p_node->word_count < 3)) {
+      continue;
+    }
+    Function* p_func = FindFunction(p_parser, p_parser->spirv_code[p_node->word_offset + 1]);
+    if (IsNotNull(p_func)) {
+      p_ctx->functions[p_func - p_parser->functions].name = p_node->name;
+    }
+  }
+
+  // Reachable functions, entry point first
+  size_t function_count = 0;
+  uint32_t* function_ids = NULL;
+  result = EnumerateCalledFunctions(p_parser, p_entry_func, &function_count, &function_ids);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  p_pressure->functions = (SpvReflectFunctionPressure*)calloc(function_count, sizeof(*(p_pressure->functions)));
+  if (IsNull(p_pressure->functions)) {
+    SafeFree(function_ids);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  p_pressure->function_count = (uint32_t)function_count;
+  uint32_t function_index = 1;
+  for (size_t i = 0; i < function_count; ++i) {
+    Function* p_func = FindFunction(p_parser, function_ids[i]);
+    SpvReflectFunctionPressure* p_src = &(p_ctx->functions[p_func - p_parser->functions]);
+    SpvReflectFunctionPressure* p_dst = (p_func == p_entry_func) ? &(p_pressure->functions[0])
+                                                                 : &(p_pressure->functions[function_index++]);
+    *p_dst = *p_src;
+    p_src->blocks = NULL;
+  }
+
+  p_pressure->entry_point_name = p_entry->name;
+  p_pressure->shader_stage = p_entry->shader_stage;
+  p_pressure->max_live_values = p_pressure->functions[0].max_live_values;
+  p_pressure->max_live_registers = p_pressure->functions[0].max_live_registers;
+  ParseLocalSize(p_parser, p_entry->id, p_pressure->local_size);
+  result = ParseSharedMemorySize(p_parser, function_count, function_ids, &p_pressure->shared_memory_size);
+  SafeFree(function_ids);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  ApplyOccupancyBudget(p_budget, p_pressure);
+
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectGetEntryPointRegisterPressure(
+  const SpvReflectShaderModule*     p_module,
+  const char*                       entry_point,
+  const SpvReflectOccupancyBudget*  p_budget,
+  SpvReflectRegisterPressure*       p_pressure
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_pressure)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_pressure, 0, sizeof(*p_pressure));
+
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  Parser parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  PressureContext context;
+  memset(&context, 0, sizeof(context));
+  context.p_parser = &parser;
+  result = ParseRegisterPressure(&context, p_entry, p_budget, p_pressure);
+  DestroyPressureContext(&context);
+  DestroyParser(&parser);
+
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyRegisterPressure(p_pressure);
+  }
+  return result;
+}
+
+void spvReflectDestroyRegisterPressure(SpvReflectRegisterPressure* p_pressure)
+{
+  if (IsNull(p_pressure)) {
+    return;
+  }
+  for (uint32_t i = 0; i < p_pressure->function_count; ++i) {
+    SafeFree(p_pressure->functions[i].blocks);
+  }
+  SafeFree(p_pressure->functions);
+  p_pressure->function_count = 0;
+}
+
+enum {
+  DEFAULT_LOOP_TRIP_COUNT = 16,
+};
+
+// Sin through InverseSqrt in the GLSL.std.450 extended instruction set
+enum {
+  GLSL_STD_450_SIN          = 13,
+  GLSL_STD_450_INVERSE_SQRT = 32,
+};
+
+typedef enum LoopCompare {
+  LOOP_COMPARE_INVALID,
+  LOOP_COMPARE_LESS,
+  LOOP_COMPARE_LESS_EQUAL,
+  LOOP_COMPARE_GREATER,
+  LOOP_COMPARE_GREATER_EQUAL,
+  LOOP_COMPARE_EQUAL,
+  LOOP_COMPARE_NOT_EQUAL,
+} LoopCompare;
+
+typedef struct CostBlock {
+  uint32_t                      label_node;
+  uint32_t                      end_node;
+  uint32_t                      merge_id;
+  uint32_t                      successor_index;
+  uint32_t                      successor_count;
+  uint64_t                      weight;
+} CostBlock;
+
+typedef struct CostContext {
+  Parser*                       p_parser;
+  uint32_t*                     block_slots;
+  uint64_t                      default_trip_count;
+  bool*                         computed;
+  SpvReflectFunctionCost*       functions;
+  uint32_t*                     block_counts;
+  CostBlock**                   blocks;
+} CostContext;
+
+static uint64_t SaturatingMultiply(uint64_t a, uint64_t b)
+{
+  if ((a != 0) && (b > UINT64_MAX / a)) {
+    return UINT64_MAX;
+  }
+  return a * b;
+}
+
+static void AddWeighted(uint64_t* p_dst, uint64_t value, uint64_t weight)
+{
+  uint64_t product = SaturatingMultiply(value, weight);
+  *p_dst = (product > UINT64_MAX - *p_dst) ? UINT64_MAX : (*p_dst + product);
+}
+
+static void AccumulateInstructionCost(SpvReflectInstructionCost*        p_dst,
+                                      const SpvReflectInstructionCost*  p_src,
+                                      uint64_t                          weight)
+{
+  AddWeighted(&p_dst->instruction_count, p_src->instruction_count, weight);
+  for (uint32_t i = 0; i < 4; ++i) {
+    AddWeighted(&p_dst->alu_count[i], p_src->alu_count[i], weight);
+  }
+  AddWeighted(&p_dst->transcendental_count, p_src->transcendental_count, weight);
+  AddWeighted(&p_dst->sample_count, p_src->sample_count, weight);
+  AddWeighted(&p_dst->fetch_count, p_src->fetch_count, weight);
+  AddWeighted(&p_dst->gather_count, p_src->gather_count, weight);
+  AddWeighted(&p_dst->image_write_count, p_src->image_write_count, weight);
+  AddWeighted(&p_dst->atomic_count, p_src->atomic_count, weight);
+  AddWeighted(&p_dst->barrier_count, p_src->barrier_count, weight);
+  AddWeighted(&p_dst->call_count, p_src->call_count, weight);
+  for (uint32_t i = 0; i < SPV_REFLECT_MAX_STORAGE_CLASSES; ++i) {
+    AddWeighted(&p_dst->load_count[i], p_src->load_count[i], weight);
+    AddWeighted(&p_dst->store_count[i], p_src->store_count[i], weight);
+  }
+}
+
+//
+// Component width of a numeric type, 0 for anything else.
+//
+static uint32_t GetScalarWidth(const Parser* p_parser, uint32_t type_id)
+{
+  Node* p_type = FindIdNode(p_parser, type_id);
+  for (uint32_t depth = 0; IsNotNull(p_type) && (depth < 2); ++depth) {
+    if ((p_type->op == SpvOpTypeInt) || (p_type->op == SpvOpTypeFloat)) {
+      return p_parser->spirv_code[p_type->word_offset + 2];
+    }
+    if ((p_type->op != SpvOpTypeVector) && (p_type->op != SpvOpTypeMatrix)) {
+      break;
+    }
+    p_type = FindIdNode(p_parser, p_parser->spirv_code[p_type->word_offset + 2]);
+  }
+  return 0;
+}
+
+static uint32_t GetPointerStorageClass(const Parser* p_parser, uint32_t pointer_id)
+{
+  Node* p_node = FindIdNode(p_parser, pointer_id);
+  if (IsNull(p_node)) {
+    return (uint32_t)INVALID_VALUE;
+  }
+  if (p_node->op == SpvOpVariable) {
+    return (uint32_t)p_node->storage_class;
+  }
+  Node* p_type = FindIdNode(p_parser, p_node->result_type_id);
+  if (IsNull(p_type) || (p_type->op != SpvOpTypePointer)) {
+    return (uint32_t)INVALID_VALUE;
+  }
+  return (uint32_t)p_type->storage_class;
+}
+
+static bool IsGlslStd450(const Parser* p_parser, uint32_t set_id)
+{
+  Node* p_node = FindIdNode(p_parser, set_id);
+  if (IsNull(p_node) || (p_node->op != SpvOpExtInstImport) || (p_node->word_count < 3)) {
+    return false;
+  }
+  const char* name = (const char*)(p_parser->spirv_code + p_node->word_offset + 2);
+  size_t max_length = (p_node->word_count - 2) * SPIRV_WORD_SIZE;
+  return strncmp(name, "GLSL.std.450", max_length) == 0;
+}
+
+static void CountInstruction(const Parser* p_parser, const Node* p_node, uint64_t weight,
+                             SpvReflectInstructionCost* p_cost)
+{
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  switch (p_node->op) {
+    default: break;
+    case SpvOpNop:
+    case SpvOpLabel:
+    case SpvOpLine:
+    case SpvOpNoLine:
+    case SpvOpSelectionMerge:
+    case SpvOpLoopMerge: {
+      return;
+    }
+  }
+  AddWeighted(&p_cost->instruction_count, 1, weight);
+
+  SpvOp op = p_node->op;
+  bool is_alu = (op == SpvOpTranspose) ||
+                ((op >= SpvOpConvertFToU) && (op <= SpvOpBitcast)) ||
+                ((op >= SpvOpSNegate) && (op <= SpvOpSMulExtended)) ||
+                ((op >= SpvOpAny) && (op <= SpvOpFUnordGreaterThanEqual)) ||
+                ((op >= SpvOpShiftRightLogical) && (op <= SpvOpBitCount)) ||
+                ((op >= SpvOpDPdx) && (op <= SpvOpFwidthCoarse));
+  if (op == SpvOpExtInst) {
+    if ((p_node->word_count > 4) && IsGlslStd450(p_parser, p_words[3]) &&
+        (p_words[4] >= GLSL_STD_450_SIN) && (p_words[4] <= GLSL_STD_450_INVERSE_SQRT)) {
+      AddWeighted(&p_cost->transcendental_count, 1, weight);
+      return;
+    }
+    is_alu = true;
+  }
+  if (is_alu) {
+    // Comparisons produce booleans, use the width of what they compare
+    uint32_t width = GetScalarWidth(p_parser, p_node->result_type_id);
+    if ((width == 0) && (p_node->word_count > 3)) {
+      uint32_t operand_index = (op == SpvOpExtInst) ? 5 : 3;
+      Node* p_operand = (operand_index < p_node->word_count) ? FindIdNode(p_parser, p_words[operand_index]) : NULL;
+      width = IsNotNull(p_operand) ? GetScalarWidth(p_parser, p_operand->result_type_id) : 32;
+    }
+    uint32_t bucket = (width <= 8) ? 0 : (width <= 16) ? 1 : (width <= 32) ? 2 : 3;
+    AddWeighted(&p_cost->alu_count[bucket], 1, weight);
+    return;
+  }
+
+  switch (op) {
+    default: break;
+    case SpvOpImageSampleImplicitLod:
+    case SpvOpImageSampleExplicitLod:
+    case SpvOpImageSampleDrefImplicitLod:
+    case SpvOpImageSampleDrefExplicitLod:
+    case SpvOpImageSampleProjImplicitLod:
+    case SpvOpImageSampleProjExplicitLod:
+    case SpvOpImageSampleProjDrefImplicitLod:
+    case SpvOpImageSampleProjDrefExplicitLod:
+    case SpvOpImageSparseSampleImplicitLod:
+    case SpvOpImageSparseSampleExplicitLod:
+    case SpvOpImageSparseSampleDrefImplicitLod:
+    case SpvOpImageSparseSampleDrefExplicitLod:
+    case SpvOpImageSparseSampleProjImplicitLod:
+    case SpvOpImageSparseSampleProjExplicitLod:
+    case SpvOpImageSparseSampleProjDrefImplicitLod:
+    case SpvOpImageSparseSampleProjDrefExplicitLod: {
+      AddWeighted(&p_cost->sample_count, 1, weight);
+    }
+    break;
+    case SpvOpImageFetch:
+    case SpvOpImageRead:
+    case SpvOpImageSparseFetch:
+    case SpvOpImageSparseRead: {
+      AddWeighted(&p_cost->fetch_count, 1, weight);
+    }
+    break;
+    case SpvOpImageGather:
+    case SpvOpImageDrefGather:
+    case SpvOpImageSparseGather:
+    case SpvOpImageSparseDrefGather: {
+      AddWeighted(&p_cost->gather_count, 1, weight);
+    }
+    break;
+    case SpvOpImageWrite: {
+      AddWeighted(&p_cost->image_write_count, 1, weight);
+    }
+    break;
+    case SpvOpAtomicLoad:
+    case SpvOpAtomicStore:
+    case SpvOpAtomicExchange:
+    case SpvOpAtomicCompareExchange:
+    case SpvOpAtomicCompareExchangeWeak:
+    case SpvOpAtomicIIncrement:
+    case SpvOpAtomicIDecrement:
+    case SpvOpAtomicIAdd:
+    case SpvOpAtomicISub:
+    case SpvOpAtomicSMin:
+    case SpvOpAtomicUMin:
+    case SpvOpAtomicSMax:
+    case SpvOpAtomicUMax:
+    case SpvOpAtomicAnd:
+    case SpvOpAtomicOr:
+    case SpvOpAtomicXor:
+    case SpvOpAtomicFlagTestAndSet:
+    case SpvOpAtomicFlagClear: {
+      AddWeighted(&p_cost->atomic_count, 1, weight);
+    }
+    break;
+    case SpvOpControlBarrier:
+    case SpvOpMemoryBarrier:
+    case SpvOpMemoryNamedBarrier: {
+      AddWeighted(&p_cost->barrier_count, 1, weight);
+    }
+    break;
+    case SpvOpFunctionCall: {
+      AddWeighted(&p_cost->call_count, 1, weight);
+    }
+    break;
+    case SpvOpLoad: {
+      uint32_t storage_class = (p_node->word_count > 3) ? GetPointerStorageClass(p_parser, p_words[3]) : (uint32_t)INVALID_VALUE;
+      if (storage_class < SPV_REFLECT_MAX_STORAGE_CLASSES) {
+        AddWeighted(&p_cost->load_count[storage_class], 1, weight);
+      }
+    }
+    break;
+    case SpvOpStore: {
+      uint32_t storage_class = (p_node->word_count > 1) ? GetPointerStorageClass(p_parser, p_words[1]) : (uint32_t)INVALID_VALUE;
+      if (storage_class < SPV_REFLECT_MAX_STORAGE_CLASSES) {
+        AddWeighted(&p_cost->store_count[storage_class], 1, weight);
+      }
+    }
+    break;
+    case SpvOpCopyMemory:
+    case SpvOpCopyMemorySized: {
+      if (p_node->word_count > 2) {
+        uint32_t dst_storage_class = GetPointerStorageClass(p_parser, p_words[1]);
+        uint32_t src_storage_class = GetPointerStorageClass(p_parser, p_words[2]);
+        if (dst_storage_class < SPV_REFLECT_MAX_STORAGE_CLASSES) {
+          AddWeighted(&p_cost->store_count[dst_storage_class], 1, weight);
+        }
+        if (src_storage_class < SPV_REFLECT_MAX_STORAGE_CLASSES) {
+          AddWeighted(&p_cost->load_count[src_storage_class], 1, weight);
+        }
+      }
+    }
+    break;
+  }
+}
+
+static LoopCompare GetLoopCompare(SpvOp op, bool* p_is_signed)
+{
+  *p_is_signed = false;
+  switch (op) {
+    default: break;
+    case SpvOpSLessThan         : *p_is_signed = true; return LOOP_COMPARE_LESS;
+    case SpvOpULessThan         : return LOOP_COMPARE_LESS;
+    case SpvOpSLessThanEqual    : *p_is_signed = true; return LOOP_COMPARE_LESS_EQUAL;
+    case SpvOpULessThanEqual    : return LOOP_COMPARE_LESS_EQUAL;
+    case SpvOpSGreaterThan      : *p_is_signed = true; return LOOP_COMPARE_GREATER;
+    case SpvOpUGreaterThan      : return LOOP_COMPARE_GREATER;
+    case SpvOpSGreaterThanEqual : *p_is_signed = true; return LOOP_COMPARE_GREATER_EQUAL;
+    case SpvOpUGreaterThanEqual : return LOOP_COMPARE_GREATER_EQUAL;
+    case SpvOpIEqual            : *p_is_signed = true; return LOOP_COMPARE_EQUAL;
+    case SpvOpINotEqual         : *p_is_signed = true; return LOOP_COMPARE_NOT_EQUAL;
+  }
+  return LOOP_COMPARE_INVALID;
+}
+
+// Same comparison with the operands swapped
+static LoopCompare SwapLoopCompare(LoopCompare compare)
+{
+  switch (compare) {
+    default: break;
+    case LOOP_COMPARE_LESS          : return LOOP_COMPARE_GREATER;
+    case LOOP_COMPARE_LESS_EQUAL    : return LOOP_COMPARE_GREATER_EQUAL;
+    case LOOP_COMPARE_GREATER       : return LOOP_COMPARE_LESS;
+    case LOOP_COMPARE_GREATER_EQUAL : return LOOP_COMPARE_LESS_EQUAL;
+  }
+  return compare;
+}
+
+static LoopCompare NegateLoopCompare(LoopCompare compare)
+{
+  switch (compare) {
+    default: break;
+    case LOOP_COMPARE_LESS          : return LOOP_COMPARE_GREATER_EQUAL;
+    case LOOP_COMPARE_LESS_EQUAL    : return LOOP_COMPARE_GREATER;
+    case LOOP_COMPARE_GREATER       : return LOOP_COMPARE_LESS_EQUAL;
+    case LOOP_COMPARE_GREATER_EQUAL : return LOOP_COMPARE_LESS;
+    case LOOP_COMPARE_EQUAL         : return LOOP_COMPARE_NOT_EQUAL;
+    case LOOP_COMPARE_NOT_EQUAL     : return LOOP_COMPARE_EQUAL;
+  }
+  return compare;
+}
+
+static bool GetIntConstant(const Parser* p_parser, uint32_t constant_id, bool is_signed, int64_t* p_value)
+{
+  Node* p_node = FindIdNode(p_parser, constant_id);
+  if (IsNull(p_node) || (p_node->op != SpvOpConstant) || (p_node->word_count != 4)) {
+    return false;
+  }
+  Node* p_type = FindIdNode(p_parser, p_node->result_type_id);
+  if (IsNull(p_type) || (p_type->op != SpvOpTypeInt) || (p_parser->spirv_code[p_type->word_offset + 2] != 32)) {
+    return false;
+  }
+  uint32_t word = p_parser->spirv_code[p_node->word_offset + 3];
+  *p_value = is_signed ? (int64_t)(int32_t)word : (int64_t)word;
+  return true;
+}
+
+//
+// Recognizes value_id as the induction variable plus or minus a constant.
+// The induction variable is either an OpPhi result or, before SSA
+// promotion, any OpLoad from the variable pointer_id.
+//
+static bool GetInductionStep(const Parser* p_parser, uint32_t value_id, uint32_t induction_id,
+                             uint32_t pointer_id, int64_t* p_step)
+{
+  Node* p_node = FindIdNode(p_parser, value_id);
+  if (IsNull(p_node) || (p_node->word_count < 5) || ((p_node->op != SpvOpIAdd) && (p_node->op != SpvOpISub))) {
+    return false;
+  }
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  for (uint32_t k = 0; k < 2; ++k) {
+    uint32_t operand_id = p_words[3 + k];
+    uint32_t other_id = p_words[4 - k];
+    // Only IAdd is commutative
+    if ((k == 1) && (p_node->op == SpvOpISub)) {
+      break;
+    }
+    bool is_induction = (operand_id == induction_id);
+    if (!is_induction && (pointer_id != 0)) {
+      Node* p_load = FindIdNode(p_parser, operand_id);
+      is_induction = IsNotNull(p_load) && (p_load->op == SpvOpLoad) && (p_load->word_count > 3) &&
+                     (p_parser->spirv_code[p_load->word_offset + 3] == pointer_id);
+    }
+    int64_t step = 0;
+    if (is_induction && GetIntConstant(p_parser, other_id, true, &step)) {
+      *p_step = (p_node->op == SpvOpISub) ? -step : step;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool ComputeTripCount(LoopCompare compare, int64_t init, int64_t bound, int64_t step, uint64_t* p_trip_count)
+{
+  int64_t distance = bound - init;
+  switch (compare) {
+    default: break;
+    case LOOP_COMPARE_LESS: {
+      if (step > 0) {
+        *p_trip_count = (distance > 0) ? (uint64_t)((distance + step - 1) / step) : 0;
+        return true;
+      }
+    }
+    break;
+    case LOOP_COMPARE_LESS_EQUAL: {
+      if (step > 0) {
+        *p_trip_count = (distance >= 0) ? (uint64_t)(distance / step + 1) : 0;
+        return true;
+      }
+    }
+    break;
+    case LOOP_COMPARE_GREATER: {
+      if (step < 0) {
+        *p_trip_count = (distance < 0) ? (uint64_t)((-distance - step - 1) / -step) : 0;
+        return true;
+      }
+    }
+    break;
+    case LOOP_COMPARE_GREATER_EQUAL: {
+      if (step < 0) {
+        *p_trip_count = (distance <= 0) ? (uint64_t)(-distance / -step + 1) : 0;
+        return true;
+      }
+    }
+    break;
+    case LOOP_COMPARE_NOT_EQUAL: {
+      if ((step != 0) && ((distance % step) == 0) && ((distance / step) >= 0)) {
+        *p_trip_count = (uint64_t)(distance / step);
+        return true;
+      }
+    }
+    break;
+  }
+  return false;
+}
+
+//
+// Derives the trip count of the loop headed by the given block from the
+// conditional branch that exits to its merge block, for induction variables
+// with a constant initial value and a constant step.
+//
+static bool ParseLoopTripCount(CostContext*     p_ctx,
+                               const CostBlock* blocks,
+                               uint32_t         block_count,
+                               uint32_t         header,
+                               const uint8_t*   in_loop,
+                               size_t           first_node,
+                               uint64_t*        p_trip_count)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  uint32_t merge_id = blocks[header].merge_id;
+
+  const uint32_t* p_branch = NULL;
+  for (uint32_t b = 0; (b < block_count) && IsNull(p_branch); ++b) {
+    Node* p_end = &(p_parser->nodes[blocks[b].end_node]);
+    const uint32_t* p_words = p_parser->spirv_code + p_end->word_offset;
+    if (in_loop[b] && (p_end->op == SpvOpBranchConditional) && (p_end->word_count > 3) &&
+        ((p_words[2] == merge_id) || (p_words[3] == merge_id))) {
+      p_branch = p_words;
+    }
+  }
+  if (IsNull(p_branch)) {
+    return false;
+  }
+
+  Node* p_condition = FindIdNode(p_parser, p_branch[1]);
+  if (IsNull(p_condition) || (p_condition->word_count < 5)) {
+    return false;
+  }
+  bool is_signed = false;
+  LoopCompare compare = GetLoopCompare(p_condition->op, &is_signed);
+  if (compare == LOOP_COMPARE_INVALID) {
+    return false;
+  }
+  const uint32_t* p_operands = p_parser->spirv_code + p_condition->word_offset + 3;
+  uint32_t induction_id = p_operands[0];
+  int64_t bound = 0;
+  if (!GetIntConstant(p_parser, p_operands[1], is_signed, &bound)) {
+    if (!GetIntConstant(p_parser, p_operands[0], is_signed, &bound)) {
+      return false;
+    }
+    induction_id = p_operands[1];
+    compare = SwapLoopCompare(compare);
+  }
+  // Normalize to the condition for staying in the loop
+  if (p_branch[2] == merge_id) {
+    compare = NegateLoopCompare(compare);
+  }
+
+  Node* p_induction = FindIdNode(p_parser, induction_id);
+  if (IsNull(p_induction)) {
+    return false;
+  }
+  const uint32_t* p_words = p_parser->spirv_code + p_induction->word_offset;
+  int64_t init = 0;
+  int64_t step = 0;
+  if (p_induction->op == SpvOpPhi) {
+    bool has_init = false;
+    bool has_step = false;
+    for (uint32_t k = 3; (k + 1) < p_induction->word_count; k += 2) {
+      uint32_t parent = LookupSlot(p_parser, p_ctx->block_slots, p_words[k + 1]);
+      if (parent == (uint32_t)INVALID_VALUE) {
+        return false;
+      }
+      if (in_loop[parent]) {
+        has_step = !has_step && GetInductionStep(p_parser, p_words[k], induction_id, 0, &step);
+        if (!has_step) {
+          return false;
+        }
+      }
+      else {
+        has_init = !has_init && GetIntConstant(p_parser, p_words[k], is_signed, &init);
+        if (!has_init) {
+          return false;
+        }
+      }
+    }
+    if (!has_init || !has_step) {
+      return false;
+    }
+  }
+  else if ((p_induction->op == SpvOpLoad) && (p_induction->word_count > 3)) {
+    uint32_t pointer_id = p_words[3];
+    Node* p_variable = FindIdNode(p_parser, pointer_id);
+    if (IsNull(p_variable) || (p_variable->op != SpvOpVariable) ||
+        (p_variable->storage_class != SpvStorageClassFunction)) {
+      return false;
+    }
+    // The last store ahead of the header initializes the variable
+    uint32_t init_id = 0;
+    for (size_t i = first_node; i < blocks[header].label_node; ++i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      if ((p_node->op == SpvOpStore) && (p_parser->spirv_code[p_node->word_offset + 1] == pointer_id)) {
+        init_id = p_parser->spirv_code[p_node->word_offset + 2];
+      }
+    }
+    if (!GetIntConstant(p_parser, init_id, is_signed, &init)) {
+      return false;
+    }
+    // The loop must update it exactly once
+    uint32_t store_count = 0;
+    for (uint32_t b = 0; b < block_count; ++b) {
+      if (!in_loop[b]) {
+        continue;
+      }
+      for (size_t i = blocks[b].label_node; i <= blocks[b].end_node; ++i) {
+        Node* p_node = &(p_parser->nodes[i]);
+        if ((p_node->op == SpvOpStore) && (p_parser->spirv_code[p_node->word_offset + 1] == pointer_id)) {
+          if ((++store_count > 1) ||
+              !GetInductionStep(p_parser, p_parser->spirv_code[p_node->word_offset + 2], 0, pointer_id, &step)) {
+            return false;
+          }
+        }
+      }
+    }
+    if (store_count != 1) {
+      return false;
+    }
+  }
+  else {
+    return false;
+  }
+
+  return ComputeTripCount(compare, init, bound, step, p_trip_count);
+}
+
+//
+// Multiplies the weight of every block inside a loop by its trip count. A
+// loop is the set of blocks reachable from its header without leaving
+// through the merge block that can branch back to the header.
+//
+static void ApplyLoopWeights(CostContext*             p_ctx,
+                             CostBlock*               blocks,
+                             uint32_t                 block_count,
+                             const uint32_t*          successors,
+                             uint8_t*                 in_loop,
+                             uint32_t*                stack,
+                             size_t                   first_node,
+                             SpvReflectFunctionCost*  p_cost)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  for (uint32_t header = 0; header < block_count; ++header) {
+    if (blocks[header].merge_id == 0) {
+      continue;
+    }
+    uint32_t merge = LookupSlot(p_parser, p_ctx->block_slots, blocks[header].merge_id);
+
+    memset(in_loop, 0, block_count * sizeof(*in_loop));
+    uint32_t stack_size = 0;
+    in_loop[header] = 1;
+    stack[stack_size++] = header;
+    while (stack_size > 0) {
+      const CostBlock* p_block = &blocks[stack[--stack_size]];
+      for (uint32_t k = 0; k < p_block->successor_count; ++k) {
+        uint32_t successor = successors[p_block->successor_index + k];
+        if ((successor != merge) && !in_loop[successor]) {
+          in_loop[successor] = 1;
+          stack[stack_size++] = successor;
+        }
+      }
+    }
+
+    in_loop[header] = 2;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (uint32_t b = 0; b < block_count; ++b) {
+        if (in_loop[b] != 1) {
+          continue;
+        }
+        for (uint32_t k = 0; k < blocks[b].successor_count; ++k) {
+          if (in_loop[successors[blocks[b].successor_index + k]] == 2) {
+            in_loop[b] = 2;
+            changed = true;
+            break;
+          }
+        }
+      }
+    }
+    for (uint32_t b = 0; b < block_count; ++b) {
+      in_loop[b] = (in_loop[b] == 2) ? 1 : 0;
+    }
+
+    uint64_t trip_count = 0;
+    if (!ParseLoopTripCount(p_ctx, blocks, block_count, header, in_loop, first_node, &trip_count)) {
+      trip_count = p_ctx->default_trip_count;
+      ++p_cost->unknown_trip_count_loop_count;
+    }
+    ++p_cost->loop_count;
+    // The header runs at least once even if the body never does
+    trip_count = (trip_count > 0) ? trip_count : 1;
+    for (uint32_t b = 0; b < block_count; ++b) {
+      if (in_loop[b]) {
+        blocks[b].weight = SaturatingMultiply(blocks[b].weight, trip_count);
+      }
+    }
+  }
+}
+
+static SpvReflectResult ComputeFunctionCost(CostContext* p_ctx, Function* p_func, uint32_t depth)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  size_t function_index = (size_t)(p_func - p_parser->functions);
+  if (p_ctx->computed[function_index]) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  if (depth > p_parser->function_count) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_RECURSION;
+  }
+
+  // Callees first, their total is added at every call site
+  for (uint32_t i = 0; i < p_func->callee_count; ++i) {
+    SpvReflectResult result = ComputeFunctionCost(p_ctx, p_func->callee_ptrs[i], depth + 1);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+  }
+
+  Node* p_func_node = FindIdNode(p_parser, p_func->id);
+  if (IsNull(p_func_node) || (p_func_node->op != SpvOpFunction)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  // Number the blocks of the function
+  size_t first_node = (size_t)(p_func_node - p_parser->nodes) + 1;
+  size_t end_node = first_node;
+  uint32_t block_count = 0;
+  uint32_t successor_capacity = 0;
+  for (; (end_node < p_parser->node_count) && (p_parser->nodes[end_node].op != SpvOpFunctionEnd); ++end_node) {
+    Node* p_node = &(p_parser->nodes[end_node]);
+    if (p_node->op == SpvOpLabel) {
+      p_ctx->block_slots[p_node->result_id] = block_count++;
+    }
+    if (IsBlockTerminator(p_node->op)) {
+      successor_capacity += p_node->word_count;
+    }
+  }
+
+  SpvReflectFunctionCost* p_cost = &(p_ctx->functions[function_index]);
+  p_cost->function_id = p_func->id;
+
+  CostBlock* blocks = (CostBlock*)calloc(block_count + 1, sizeof(*blocks));
+  uint32_t* successors = (uint32_t*)calloc(successor_capacity + 1, sizeof(*successors));
+  uint32_t* stack = (uint32_t*)calloc(block_count + 1, sizeof(*stack));
+  uint8_t* in_loop = (uint8_t*)calloc(block_count + 1, sizeof(*in_loop));
+  SpvReflectResult result = SPV_REFLECT_RESULT_SUCCESS;
+  if (IsNull(blocks) || IsNull(successors) || IsNull(stack) || IsNull(in_loop)) {
+    result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    uint32_t block_index = (uint32_t)INVALID_VALUE;
+    uint32_t successor_count = 0;
+    for (size_t i = first_node; i < end_node; ++i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      if (p_node->op == SpvOpLabel) {
+        block_index = p_ctx->block_slots[p_node->result_id];
+        blocks[block_index].label_node = (uint32_t)i;
+        blocks[block_index].end_node = (uint32_t)i;
+        blocks[block_index].successor_index = successor_count;
+        blocks[block_index].weight = 1;
+        continue;
+      }
+      if (block_index == (uint32_t)INVALID_VALUE) {
+        continue;
+      }
+      if ((p_node->op == SpvOpLoopMerge) && (p_node->word_count > 2)) {
+        blocks[block_index].merge_id = p_parser->spirv_code[p_node->word_offset + 1];
+      }
+      blocks[block_index].end_node = (uint32_t)i;
+      if (IsBlockTerminator(p_node->op)) {
+        uint32_t* p_labels = &successors[successor_count];
+        uint32_t label_count = GetSuccessorLabels(p_parser, p_node, p_labels);
+        for (uint32_t k = 0; k < label_count; ++k) {
+          uint32_t target = LookupSlot(p_parser, p_ctx->block_slots, p_labels[k]);
+          if (target != (uint32_t)INVALID_VALUE) {
+            successors[successor_count++] = target;
+          }
+        }
+        blocks[block_index].successor_count = successor_count - blocks[block_index].successor_index;
+        block_index = (uint32_t)INVALID_VALUE;
+      }
+    }
+
+    ApplyLoopWeights(p_ctx, blocks, block_count, successors, in_loop, stack, first_node, p_cost);
+
+    SpvReflectInstructionCost calls;
+    memset(&calls, 0, sizeof(calls));
+    for (uint32_t b = 0; b < block_count; ++b) {
+      for (size_t i = blocks[b].label_node; i <= blocks[b].end_node; ++i) {
+        Node* p_node = &(p_parser->nodes[i]);
+        CountInstruction(p_parser, p_node, blocks[b].weight, &p_cost->self);
+        if ((p_node->op == SpvOpFunctionCall) && (p_node->word_count > 3)) {
+          Function* p_callee = FindFunction(p_parser, p_parser->spirv_code[p_node->word_offset + 3]);
+          if (IsNotNull(p_callee)) {
+            AccumulateInstructionCost(&calls, &(p_ctx->functions[p_callee - p_parser->functions].total), blocks[b].weight);
+          }
+        }
+      }
+    }
+    p_cost->total = p_cost->self;
+    AccumulateInstructionCost(&p_cost->total, &calls, 1);
+
+    // Kept for source line attribution
+    p_ctx->block_counts[function_index] = block_count;
+    p_ctx->blocks[function_index] = blocks;
+    blocks = NULL;
+  }
+
+  // Reset the slots for the next function
+  for (size_t i = first_node; i < end_node; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    if (p_node->op == SpvOpLabel) {
+      p_ctx->block_slots[p_node->result_id] = (uint32_t)INVALID_VALUE;
+    }
+  }
+  SafeFree(blocks);
+  SafeFree(successors);
+  SafeFree(stack);
+  SafeFree(in_loop);
+
+  p_ctx->computed[function_index] = (result == SPV_REFLECT_RESULT_SUCCESS);
+  return result;
+}
+
+static SpvReflectResult CreateCostContext(const SpvReflectShaderModule* p_module,
+                                          uint32_t                      default_trip_count,
+                                          Parser*                       p_parser,
+                                          CostContext*                  p_ctx)
+{
+  memset(p_ctx, 0, sizeof(*p_ctx));
+  SpvReflectResult result = CreateAnalysisParser(p_module, p_parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  p_ctx->p_parser = p_parser;
+  p_ctx->default_trip_count = (default_trip_count > 0) ? default_trip_count : DEFAULT_LOOP_TRIP_COUNT;
+
+  p_ctx->block_slots = (uint32_t*)malloc(p_parser->id_bound * sizeof(*(p_ctx->block_slots)));
+  p_ctx->computed = (bool*)calloc(p_parser->function_count, sizeof(*(p_ctx->computed)));
+  p_ctx->functions = (SpvReflectFunctionCost*)calloc(p_parser->function_count, sizeof(*(p_ctx->functions)));
+  p_ctx->block_counts = (uint32_t*)calloc(p_parser->function_count, sizeof(*(p_ctx->block_counts)));
+  p_ctx->blocks = (CostBlock**)calloc(p_parser->function_count, sizeof(*(p_ctx->blocks)));
+  if (IsNull(p_ctx->block_slots) || IsNull(p_ctx->computed) || IsNull(p_ctx->functions) ||
+      IsNull(p_ctx->block_counts) || IsNull(p_ctx->blocks)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  memset(p_ctx->block_slots, 0xFF, p_parser->id_bound * sizeof(*(p_ctx->block_slots)));
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static void DestroyCostContext(CostContext* p_ctx)
+{
+  if (IsNotNull(p_ctx->blocks)) {
+    for (size_t i = 0; i < p_ctx->p_parser->function_count; ++i) {
+      SafeFree(p_ctx->blocks[i]);
+    }
+  }
+  SafeFree(p_ctx->blocks);
+  SafeFree(p_ctx->block_counts);
+  SafeFree(p_ctx->functions);
+  SafeFree(p_ctx->computed);
+  SafeFree(p_ctx->block_slots);
+  if (IsNotNull(p_ctx->p_parser)) {
+    DestroyParser(p_ctx->p_parser);
+  }
+}
+
+static SpvReflectResult ParseInstructionCost(CostContext*                      p_ctx,
+                                             const SpvReflectEntryPoint*       p_entry,
+                                             SpvReflectInstructionCostReport*  p_report)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  Function* p_entry_func = FindFunction(p_parser, p_entry->id);
+  if (IsNull(p_entry_func)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  SpvReflectResult result = ComputeFunctionCost(p_ctx, p_entry_func, 0);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  // Function names
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    if ((p_node->op != SpvOpName) || (p_node->word_count < 3)) {
+      continue;
+    }
+    Function* p_func = FindFunction(p_parser, p_parser->spirv_code[p_node->word_offset + 1]);
+    if (IsNotNull(p_func)) {
+      p_ctx->functions[p_func - p_parser->functions].name = p_node->name;
+    }
+  }
+
+  // Reachable functions, entry point first
+  size_t function_count = 0;
+  uint32_t* function_ids = NULL;
+  result = EnumerateCalledFunctions(p_parser, p_entry_func, &function_count, &function_ids);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  p_report->functions = (SpvReflectFunctionCost*)calloc(function_count, sizeof(*(p_report->functions)));
+  if (IsNull(p_report->functions)) {
+    SafeFree(function_ids);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  p_report->function_count = (uint32_t)function_count;
+  uint32_t function_index = 1;
+  for (size_t i = 0; i < function_count; ++i) {
+    Function* p_func = FindFunction(p_parser, function_ids[i]);
+    SpvReflectFunctionCost* p_dst = (p_func == p_entry_func) ? &(p_report->functions[0])
+                                                             : &(p_report->functions[function_index++]);
+    *p_dst = p_ctx->functions[p_func - p_parser->functions];
+  }
+  SafeFree(function_ids);
+
+  p_report->entry_point_name = p_entry->name;
+  p_report->shader_stage = p_entry->shader_stage;
+  p_report->total = p_report->functions[0].total;
+
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectGetEntryPointInstructionCost(
+  const SpvReflectShaderModule*     p_module,
+  const char*                       entry_point,
+  uint32_t                          default_trip_count,
+  SpvReflectInstructionCostReport*  p_report
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_report)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_report, 0, sizeof(*p_report));
+
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  Parser parser;
+  CostContext context;
+  SpvReflectResult result = CreateCostContext(p_module, default_trip_count, &parser, &context);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseInstructionCost(&context, p_entry, p_report);
+  }
+  DestroyCostContext(&context);
+
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyInstructionCostReport(p_report);
+  }
+  return result;
+}
+
+void spvReflectDestroyInstructionCostReport(SpvReflectInstructionCostReport* p_report)
+{
+  if (IsNull(p_report)) {
+    return;
+  }
+  SafeFree(p_report->functions);
+  p_report->function_count = 0;
+}
+
+static const char* GetLineFileName(const Parser* p_parser, uint32_t file_id)
+{
+  Node* p_node = FindIdNode(p_parser, file_id);
+  if (IsNull(p_node) || (p_node->op != SpvOpString) || (p_node->word_count < 3)) {
+    return NULL;
+  }
+  return (const char*)(p_parser->spirv_code + p_node->word_offset + 2);
+}
+
+static void EmitSourceLineRange(const SpvReflectSourceLineRange* p_range,
+                                SpvReflectSourceLineRange*       p_ranges,
+                                uint32_t                         capacity,
+                                uint32_t*                        p_count)
+{
+  if (p_range->word_count == 0) {
+    return;
+  }
+  if (IsNotNull(p_ranges) && (*p_count < capacity)) {
+    p_ranges[*p_count] = *p_range;
+  }
+  ++(*p_count);
+}
+
+//
+// Collects the runs of function body instructions covered by an OpLine,
+// which applies until the next OpLine or OpNoLine or the end of the block.
+// Returns the number of ranges, writing at most capacity of them.
+//
+static uint32_t ParseSourceLineRanges(const Parser* p_parser, SpvReflectSourceLineRange* p_ranges, uint32_t capacity)
+{
+  SpvReflectSourceLineRange range;
+  memset(&range, 0, sizeof(range));
+  uint32_t function_id = 0;
+  uint32_t count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    switch (p_node->op) {
+      default: break;
+      case SpvOpFunction:
+      case SpvOpFunctionEnd: {
+        EmitSourceLineRange(&range, p_ranges, capacity, &count);
+        memset(&range, 0, sizeof(range));
+        function_id = (p_node->op == SpvOpFunction) ? p_node->result_id : 0;
+        continue;
+      }
+      case SpvOpLine: {
+        EmitSourceLineRange(&range, p_ranges, capacity, &count);
+        memset(&range, 0, sizeof(range));
+        if ((function_id != 0) && (p_node->word_count >= 4)) {
+          range.function_id = function_id;
+          range.file = GetLineFileName(p_parser, p_words[1]);
+          range.line = p_words[2];
+          range.column = p_words[3];
+        }
+        continue;
+      }
+      case SpvOpNoLine: {
+        EmitSourceLineRange(&range, p_ranges, capacity, &count);
+        memset(&range, 0, sizeof(range));
+        continue;
+      }
+    }
+
+    if ((range.function_id == 0) || (p_node->op == SpvOpLabel)) {
+      continue;
+    }
+    if (range.word_count == 0) {
+      range.word_offset = p_node->word_offset;
+    }
+    range.word_count = p_node->word_offset + p_node->word_count - range.word_offset;
+    if (IsBlockTerminator(p_node->op)) {
+      EmitSourceLineRange(&range, p_ranges, capacity, &count);
+      memset(&range, 0, sizeof(range));
+    }
+  }
+  EmitSourceLineRange(&range, p_ranges, capacity, &count);
+  return count;
+}
+
+SpvReflectResult spvReflectEnumerateSourceLineRanges(
+  const SpvReflectShaderModule*  p_module,
+  uint32_t*                      p_count,
+  SpvReflectSourceLineRange*     p_ranges
+)
+{
+  if (IsNull(p_module) || IsNull(p_count)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  Parser parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  uint32_t count = ParseSourceLineRanges(&parser, NULL, 0);
+  if (IsNotNull(p_ranges)) {
+    if (*p_count != count) {
+      result = SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH;
+    }
+    else {
+      ParseSourceLineRanges(&parser, p_ranges, count);
+    }
+  }
+  else {
+    *p_count = count;
+  }
+
+  DestroyParser(&parser);
+  return result;
+}
+
+static int CompareSourceLine(const SpvReflectSourceLineCost* p_a, const SpvReflectSourceLineCost* p_b)
+{
+  int file_order = strcmp(IsNotNull(p_a->file) ? p_a->file : "", IsNotNull(p_b->file) ? p_b->file : "");
+  if (file_order != 0) {
+    return file_order;
+  }
+  return (p_a->line < p_b->line) ? -1 : ((p_a->line > p_b->line) ? 1 : 0);
+}
+
+static int SortCompareSourceLine(const void* a, const void* b)
+{
+  return CompareSourceLine((const SpvReflectSourceLineCost*)a, (const SpvReflectSourceLineCost*)b);
+}
+
+static int SortCompareSourceLineCost(const void* a, const void* b)
+{
+  const SpvReflectSourceLineCost* p_a = (const SpvReflectSourceLineCost*)a;
+  const SpvReflectSourceLineCost* p_b = (const SpvReflectSourceLineCost*)b;
+  if (p_a->cost.instruction_count != p_b->cost.instruction_count) {
+    return (p_a->cost.instruction_count > p_b->cost.instruction_count) ? -1 : 1;
+  }
+  return CompareSourceLine(p_a, p_b);
+}
+
+// Post order of the call graph below p_func, callees before their callers
+static void OrderCallGraph(const Parser* p_parser, Function* p_func, bool* p_visited,
+                           uint32_t* p_order, uint32_t* p_order_count)
+{
+  size_t function_index = (size_t)(p_func - p_parser->functions);
+  p_visited[function_index] = true;
+  for (size_t i = 0; i < p_func->callee_count; ++i) {
+    Function* p_callee = p_func->callee_ptrs[i];
+    if (!p_visited[p_callee - p_parser->functions]) {
+      OrderCallGraph(p_parser, p_callee, p_visited, p_order, p_order_count);
+    }
+  }
+  p_order[(*p_order_count)++] = (uint32_t)function_index;
+}
+
+static void AttributeSourceLineCost(CostContext*                     p_ctx,
+                                    Function*                        p_entry_func,
+                                    uint32_t*                        line_slots,
+                                    uint64_t*                        function_weights,
+                                    uint32_t*                        order,
+                                    bool*                            visited,
+                                    SpvReflectSourceLineCost*        lines,
+                                    SpvReflectSourceLineCostReport*  p_report)
+{
+  Parser* p_parser = p_ctx->p_parser;
+
+  // Every OpLine gets a slot, duplicates are merged afterwards
+  uint32_t line_count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    if ((p_node->op == SpvOpLine) && (p_node->word_count >= 4)) {
+      const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+      lines[line_count].file = GetLineFileName(p_parser, p_words[1]);
+      lines[line_count].line = p_words[2];
+      line_slots[i] = line_count++;
+    }
+  }
+
+  // Callers come before callees so a function's weight is complete before
+  // its call sites are visited
+  uint32_t order_count = 0;
+  OrderCallGraph(p_parser, p_entry_func, visited, order, &order_count);
+  function_weights[p_entry_func - p_parser->functions] = 1;
+  for (uint32_t k = order_count; k-- > 0;) {
+    uint32_t function_index = order[k];
+    const CostBlock* blocks = p_ctx->blocks[function_index];
+    for (uint32_t b = 0; b < p_ctx->block_counts[function_index]; ++b) {
+      uint64_t weight = SaturatingMultiply(blocks[b].weight, function_weights[function_index]);
+      SpvReflectInstructionCost* p_line_cost = &p_report->unattributed;
+      for (size_t i = blocks[b].label_node; i <= blocks[b].end_node; ++i) {
+        Node* p_node = &(p_parser->nodes[i]);
+        if ((p_node->op == SpvOpLine) && (p_node->word_count >= 4)) {
+          p_line_cost = &(lines[line_slots[i]].cost);
+          continue;
+        }
+        if (p_node->op == SpvOpNoLine) {
+          p_line_cost = &p_report->unattributed;
+          continue;
+        }
+        CountInstruction(p_parser, p_node, weight, p_line_cost);
+        CountInstruction(p_parser, p_node, weight, &p_report->total);
+        if ((p_node->op == SpvOpFunctionCall) && (p_node->word_count > 3)) {
+          Function* p_callee = FindFunction(p_parser, p_parser->spirv_code[p_node->word_offset + 3]);
+          if (IsNotNull(p_callee)) {
+            AddWeighted(&function_weights[p_callee - p_parser->functions], weight, 1);
+          }
+        }
+      }
+    }
+  }
+
+  // Merge lines that appear more than once and drop the ones never reached
+  qsort(lines, line_count, sizeof(*lines), SortCompareSourceLine);
+  uint32_t merged_count = 0;
+  for (uint32_t i = 0; i < line_count; ++i) {
+    if (lines[i].cost.instruction_count == 0) {
+      continue;
+    }
+    if ((merged_count > 0) && (CompareSourceLine(&lines[merged_count - 1], &lines[i]) == 0)) {
+      AccumulateInstructionCost(&(lines[merged_count - 1].cost), &(lines[i].cost), 1);
+      continue;
+    }
+    lines[merged_count++] = lines[i];
+  }
+  qsort(lines, merged_count, sizeof(*lines), SortCompareSourceLineCost);
+  p_report->line_count = merged_count;
+}
+
+static SpvReflectResult ParseSourceLineCost(CostContext*                     p_ctx,
+                                            const SpvReflectEntryPoint*      p_entry,
+                                            SpvReflectSourceLineCostReport*  p_report)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  Function* p_entry_func = FindFunction(p_parser, p_entry->id);
+  if (IsNull(p_entry_func)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  SpvReflectResult result = ComputeFunctionCost(p_ctx, p_entry_func, 0);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  uint32_t line_count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    line_count += (p_parser->nodes[i].op == SpvOpLine) ? 1 : 0;
+  }
+
+  uint32_t* line_slots = (uint32_t*)calloc(p_parser->node_count, sizeof(*line_slots));
+  uint64_t* function_weights = (uint64_t*)calloc(p_parser->function_count, sizeof(*function_weights));
+  uint32_t* order = (uint32_t*)calloc(p_parser->function_count, sizeof(*order));
+  bool* visited = (bool*)calloc(p_parser->function_count, sizeof(*visited));
+  p_report->lines = (SpvReflectSourceLineCost*)calloc(line_count + 1, sizeof(*(p_report->lines)));
+  if (IsNull(line_slots) || IsNull(function_weights) || IsNull(order) || IsNull(visited) || IsNull(p_report->lines)) {
+    result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    AttributeSourceLineCost(p_ctx, p_entry_func, line_slots, function_weights, order, visited,
+                            p_report->lines, p_report);
+  }
+  SafeFree(line_slots);
+  SafeFree(function_weights);
+  SafeFree(order);
+  SafeFree(visited);
+
+  p_report->entry_point_name = p_entry->name;
+  p_report->shader_stage = p_entry->shader_stage;
+  return result;
+}
+
+SpvReflectResult spvReflectGetEntryPointSourceLineCost(
+  const SpvReflectShaderModule*     p_module,
+  const char*                       entry_point,
+  uint32_t                          default_trip_count,
+  SpvReflectSourceLineCostReport*   p_report
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_report)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_report, 0, sizeof(*p_report));
+
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  Parser parser;
+  CostContext context;
+  SpvReflectResult result = CreateCostContext(p_module, default_trip_count, &parser, &context);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseSourceLineCost(&context, p_entry, p_report);
+  }
+  DestroyCostContext(&context);
+
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroySourceLineCostReport(p_report);
+  }
+  return result;
+}
+
+void spvReflectDestroySourceLineCostReport(SpvReflectSourceLineCostReport* p_report)
+{
+  if (IsNull(p_report)) {
+    return;
+  }
+  SafeFree(p_report->lines);
+  p_report->line_count = 0;
+}
+
+//
+// Number of interface locations a value of type_id occupies. Three and four
+// component vectors of 64-bit components take two locations.
+//
+static uint32_t GetLocationCount(const Parser* p_parser, uint32_t type_id, uint32_t depth)
+{
+  Node* p_type = FindIdNode(p_parser, type_id);
+  if (IsNull(p_type) || (depth > p_parser->type_count)) {
+    return 0;
+  }
+
+  const uint32_t* p_words = p_parser->spirv_code + p_type->word_offset;
+  uint32_t count = 1;
+  switch (p_type->op) {
+    default: break;
+    case SpvOpTypeVector: {
+      count = ((GetScalarWidth(p_parser, type_id) > 32) && (p_words[3] > 2)) ? 2 : 1;
+    }
+    break;
+    case SpvOpTypeMatrix: {
+      count = p_words[3] * GetLocationCount(p_parser, p_words[2], depth + 1);
+    }
+    break;
+    case SpvOpTypeArray: {
+      count = GetConstantValue(p_parser, p_type->array_traits.length_id) *
+              GetLocationCount(p_parser, p_type->array_traits.element_type_id, depth + 1);
+    }
+    break;
+    case SpvOpTypeStruct: {
+      count = 0;
+      for (uint32_t i = 2; i < p_type->word_count; ++i) {
+        count += GetLocationCount(p_parser, p_words[i], depth + 1);
+      }
+    }
+    break;
+  }
+  return count;
+}
+
+static bool HasDecoration(const Parser* p_parser, uint32_t id, SpvDecoration decoration)
+{
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    if ((p_node->op == SpvOpDecorate) && (p_node->word_count > 2)) {
+      const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+      if ((p_words[1] == id) && (p_words[2] == (uint32_t)decoration)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//
+// Per-vertex inputs of tessellation and geometry shaders, and per-vertex
+// outputs of tessellation control shaders, have an outer array indexed by
+// vertex that does not consume locations.
+//
+static bool IsArrayedInterface(const Parser* p_parser, SpvExecutionModel model, const Node* p_var_node)
+{
+  if (HasDecoration(p_parser, p_var_node->result_id, SpvDecorationPatch)) {
+    return false;
+  }
+  switch (model) {
+    default: break;
+    case SpvExecutionModelTessellationControl: {
+      return true;
+    }
+    case SpvExecutionModelTessellationEvaluation:
+    case SpvExecutionModelGeometry: {
+      return p_var_node->storage_class == SpvStorageClassInput;
+    }
+  }
+  return false;
+}
+
+//
+// Locations [first, end) used by an interface variable. Returns false for
+// built-ins and variables without a Location decoration.
+//
+static bool GetLocationRange(const Parser*                       p_parser,
+                             SpvExecutionModel                   model,
+                             const SpvReflectInterfaceVariable*  p_var,
+                             uint32_t*                           p_first,
+                             uint32_t*                           p_end)
+{
+  if (((p_var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) != 0) ||
+      (p_var->location == (uint32_t)INVALID_VALUE)) {
+    return false;
+  }
+  Node* p_var_node = FindIdNode(p_parser, p_var->spirv_id);
+  Node* p_pointer = IsNotNull(p_var_node) ? FindIdNode(p_parser, p_var_node->type_id) : NULL;
+  if (IsNull(p_pointer)) {
+    return false;
+  }
+
+  uint32_t type_id = p_pointer->type_id;
+  Node* p_type = FindIdNode(p_parser, type_id);
+  if (IsNotNull(p_type) && (p_type->op == SpvOpTypeArray) && IsArrayedInterface(p_parser, model, p_var_node)) {
+    type_id = p_type->array_traits.element_type_id;
+  }
+  *p_first = p_var->location;
+  *p_end = p_var->location + Max(GetLocationCount(p_parser, type_id, 0), 1);
+  return true;
+}
+
+static bool IsAccessChain(SpvOp op)
+{
+  return (op == SpvOpAccessChain) || (op == SpvOpInBoundsAccessChain) ||
+         (op == SpvOpPtrAccessChain) || (op == SpvOpInBoundsPtrAccessChain);
+}
+
+static bool IsRemovedId(const Parser* p_parser, const uint32_t* p_removed, uint32_t id)
+{
+  return (id < p_parser->id_bound) && TestBit(p_removed, id);
+}
+
+//
+// Marks the output variables that cannot be removed in p_kept. A candidate
+// survives only if every use is a name, decoration, entry point operand,
+// access chain or a store into it.
+//
+static SpvReflectResult FindLiveOutputUses(const Parser* p_parser, const uint32_t* p_roots, uint32_t* p_kept)
+{
+  uint32_t max_word_count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    max_word_count = Max(max_word_count, p_parser->nodes[i].word_count);
+  }
+  uint32_t* ids = (uint32_t*)calloc(max_word_count + 1, sizeof(*ids));
+  if (IsNull(ids)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  bool in_function = false;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    switch (p_node->op) {
+      default: {
+        // Outside of function bodies only these can reference variables,
+        // the literals of anything else must not be mistaken for ids.
+        if (!in_function && (p_node->op != SpvOpExtInst) &&
+            (p_node->op != SpvOpGroupDecorate) && (p_node->op != SpvOpGroupMemberDecorate)) {
+          continue;
+        }
+      }
+      break;
+
+      case SpvOpFunction: {
+        in_function = true;
+      }
+      break;
+
+      case SpvOpFunctionEnd: {
+        in_function = false;
+      }
+      continue;
+
+      case SpvOpName:
+      case SpvOpDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
+      case SpvOpEntryPoint:
+      case SpvOpVariable:
+      case SpvOpAccessChain:
+      case SpvOpInBoundsAccessChain:
+      case SpvOpPtrAccessChain:
+      case SpvOpInBoundsPtrAccessChain: {
+        // Access chain indices are integers, never pointers
+      }
+      continue;
+
+      case SpvOpStore:
+      case SpvOpCopyMemory: {
+        if ((p_node->word_count > 2) && (p_words[1] < p_parser->id_bound) && (p_roots[p_words[1]] != 0)) {
+          if ((p_words[2] >= p_parser->id_bound) || (p_roots[p_words[2]] == 0)) {
+            continue;
+          }
+        }
+      }
+      break;
+    }
+
+    uint32_t id_count = GetIdOperands(p_parser, p_node, ids);
+    for (uint32_t j = 0; j < id_count; ++j) {
+      if ((ids[j] < p_parser->id_bound) && (p_roots[ids[j]] != 0)) {
+        SetBit(p_kept, p_roots[ids[j]]);
+      }
+    }
+  }
+
+  SafeFree(ids);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+//
+// Copies the module's instructions into p_code, leaving out the variables
+// and access chains flagged in p_removed along with the stores into them,
+// their names, their decorations and their entry point interface operands.
+// Returns the new word count.
+//
+static uint32_t WriteCodeWithoutIds(const Parser*    p_parser,
+                                    const uint32_t*  p_removed,
+                                    uint32_t*        p_code,
+                                    uint32_t*        p_removed_variable_count)
+{
+  uint32_t word_count = (p_parser->node_count > 0) ? p_parser->nodes[0].word_offset : 0;
+  memcpy(p_code, p_parser->spirv_code, word_count * SPIRV_WORD_SIZE);
+
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    bool is_dead = false;
+    switch (p_node->op) {
+      default: break;
+
+      case SpvOpVariable: {
+        is_dead = IsRemovedId(p_parser, p_removed, p_node->result_id);
+        *p_removed_variable_count += is_dead ? 1 : 0;
+      }
+      break;
+
+      case SpvOpAccessChain:
+      case SpvOpInBoundsAccessChain:
+      case SpvOpPtrAccessChain:
+      case SpvOpInBoundsPtrAccessChain: {
+        is_dead = IsRemovedId(p_parser, p_removed, p_node->result_id);
+      }
+      break;
+
+      case SpvOpDecorateId: {
+        // Also drops CounterBuffer decorations naming a removed variable
+        for (uint32_t j = 1; !is_dead && (j < p_node->word_count); ++j) {
+          is_dead = ((j == 1) || (j > 2)) && IsRemovedId(p_parser, p_removed, p_words[j]);
+        }
+      }
+      break;
+
+      case SpvOpName:
+      case SpvOpDecorate:
+      case SpvOpDecorateStringGOOGLE:
+      case SpvOpStore:
+      case SpvOpCopyMemory: {
+        is_dead = (p_node->word_count > 1) && IsRemovedId(p_parser, p_removed, p_words[1]);
+      }
+      break;
+
+      case SpvOpEntryPoint: {
+        uint32_t first_interface_word = 3 + (uint32_t)(GetLiteralStringLength(p_parser, p_node, 3) / SPIRV_WORD_SIZE) + 1;
+        uint32_t start = word_count;
+        for (uint32_t j = 0; j < p_node->word_count; ++j) {
+          if ((j < first_interface_word) || !IsRemovedId(p_parser, p_removed, p_words[j])) {
+            p_code[word_count++] = p_words[j];
+          }
+        }
+        p_code[start] = ((word_count - start) << 16) | (p_words[0] & 0xFFFF);
+      }
+      continue;
+    }
+
+    if (!is_dead) {
+      memcpy(p_code + word_count, p_words, p_node->word_count * SPIRV_WORD_SIZE);
+      word_count += p_node->word_count;
+    }
+  }
+  return word_count;
+}
+
+SpvReflectResult spvReflectEliminateDeadOutputs(
+  SpvReflectShaderModule*        p_module,
+  const char*                    entry_point,
+  const SpvReflectShaderModule*  p_next_stage,
+  const char*                    next_entry_point,
+  uint32_t*                      p_removed_count
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_next_stage) || IsNull(next_entry_point)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if (IsNotNull(p_removed_count)) {
+    *p_removed_count = 0;
+  }
+  // Outputs are only known to be private if every entry point is reflected
+  if (IsEntryPointFiltered(p_module)) {
+    return SPV_REFLECT_RESULT_NOT_READY;
+  }
+
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  const SpvReflectEntryPoint* p_next_entry = spvReflectGetEntryPoint(p_next_stage, next_entry_point);
+  if (IsNull(p_entry) || IsNull(p_next_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+  // Fragment outputs go to attachments and compute has no outputs to match
+  const uint32_t producer_stages = SPV_REFLECT_SHADER_STAGE_VERTEX_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_GEOMETRY_BIT;
+  const uint32_t consumer_stages = SPV_REFLECT_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_GEOMETRY_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_FRAGMENT_BIT;
+  if (((p_entry->shader_stage & producer_stages) == 0) ||
+      ((p_next_entry->shader_stage & consumer_stages) == 0)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_EXECUTION_MODE;
+  }
+
+  Parser parser;
+  Parser next_parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  result = CreateAnalysisParser(p_next_stage, &next_parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    DestroyParser(&parser);
+    return result;
+  }
+
+  uint32_t* roots = (uint32_t*)calloc(parser.id_bound, sizeof(*roots));
+  uint32_t* kept = (uint32_t*)calloc((parser.id_bound + 31) / 32, sizeof(*kept));
+  uint32_t* removed = (uint32_t*)calloc((parser.id_bound + 31) / 32, sizeof(*removed));
+  uint32_t* input_ranges = (uint32_t*)calloc(2 * p_next_entry->input_variable_count + 1, sizeof(*input_ranges));
+  uint32_t* p_code = NULL;
+  if (IsNull(roots) || IsNull(kept) || IsNull(removed) || IsNull(input_ranges)) {
+    result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  // Locations read by the next stage
+  uint32_t input_range_count = 0;
+  for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < p_next_entry->input_variable_count); ++i) {
+    uint32_t* p_range = &input_ranges[2 * input_range_count];
+    if (GetLocationRange(&next_parser, p_next_entry->spirv_execution_model,
+                         &p_next_entry->input_variables[i], &p_range[0], &p_range[1])) {
+      ++input_range_count;
+    }
+  }
+
+  // Outputs that no input overlaps and that no other entry point writes
+  uint32_t candidate_count = 0;
+  for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < p_entry->output_variable_count); ++i) {
+    const SpvReflectInterfaceVariable* p_var = &p_entry->output_variables[i];
+    uint32_t first = 0;
+    uint32_t end = 0;
+    if ((p_var->spirv_id >= parser.id_bound) ||
+        !GetLocationRange(&parser, p_entry->spirv_execution_model, p_var, &first, &end)) {
+      continue;
+    }
+    bool is_live = false;
+    for (uint32_t j = 0; !is_live && (j < input_range_count); ++j) {
+      is_live = (first < input_ranges[2 * j + 1]) && (input_ranges[2 * j] < end);
+    }
+    for (uint32_t j = 0; !is_live && (j < p_module->entry_point_count); ++j) {
+      const SpvReflectEntryPoint* p_other = &p_module->entry_points[j];
+      for (uint32_t k = 0; (p_other != p_entry) && (k < p_other->output_variable_count); ++k) {
+        is_live |= (p_other->output_variables[k].spirv_id == p_var->spirv_id);
+      }
+    }
+    if (!is_live) {
+      roots[p_var->spirv_id] = p_var->spirv_id;
+      ++candidate_count;
+    }
+  }
+
+  if ((result == SPV_REFLECT_RESULT_SUCCESS) && (candidate_count > 0)) {
+    // Access chains follow their base in module order
+    for (size_t i = 0; i < parser.node_count; ++i) {
+      const Node* p_node = &(parser.nodes[i]);
+      if (IsAccessChain(p_node->op) && (p_node->word_count > 3) && (p_node->result_id < parser.id_bound)) {
+        uint32_t base_id = parser.spirv_code[p_node->word_offset + 3];
+        if (base_id < parser.id_bound) {
+          roots[p_node->result_id] = roots[base_id];
+        }
+      }
+    }
+    result = FindLiveOutputUses(&parser, roots, kept);
+    for (uint32_t id = 0; id < parser.id_bound; ++id) {
+      if ((roots[id] != 0) && !TestBit(kept, roots[id])) {
+        SetBit(removed, id);
+      }
+    }
+  }
+
+  uint32_t removed_count = 0;
+  uint32_t word_count = 0;
+  if ((result == SPV_REFLECT_RESULT_SUCCESS) && (candidate_count > 0)) {
+    p_code = (uint32_t*)calloc(parser.spirv_word_count, sizeof(*p_code));
+    if (IsNull(p_code)) {
+      result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    else {
+      word_count = WriteCodeWithoutIds(&parser, removed, p_code, &removed_count);
+    }
+  }
+
+  // Re-reflect the rewritten module, keeping the original on failure
+  if ((result == SPV_REFLECT_RESULT_SUCCESS) && (removed_count > 0)) {
+    SpvReflectShaderModule module;
+    result = spvReflectCreateShaderModule(word_count * SPIRV_WORD_SIZE, p_code, &module);
+    if (result == SPV_REFLECT_RESULT_SUCCESS) {
+      spvReflectDestroyShaderModule(p_module);
+      *p_module = module;
+    }
+  }
+  if ((result == SPV_REFLECT_RESULT_SUCCESS) && IsNotNull(p_removed_count)) {
+    *p_removed_count = removed_count;
+  }
+
+  SafeFree(roots);
+  SafeFree(kept);
+  SafeFree(removed);
+  SafeFree(input_ranges);
+  SafeFree(p_code);
+  DestroyParser(&parser);
+  DestroyParser(&next_parser);
+  return result;
+}
+
+static int SortCompareDescriptorBindingRemap(const void* a, const void* b)
+{
+  const SpvReflectDescriptorBindingRemap* p_elem_a = (const SpvReflectDescriptorBindingRemap*)a;
+  const SpvReflectDescriptorBindingRemap* p_elem_b = (const SpvReflectDescriptorBindingRemap*)b;
+  if (p_elem_a->old_set != p_elem_b->old_set) {
+    return (p_elem_a->old_set < p_elem_b->old_set) ? -1 : 1;
+  }
+  if (p_elem_a->old_binding != p_elem_b->old_binding) {
+    return (p_elem_a->old_binding < p_elem_b->old_binding) ? -1 : 1;
+  }
+  if (p_elem_a->spirv_id != p_elem_b->spirv_id) {
+    return (p_elem_a->spirv_id < p_elem_b->spirv_id) ? -1 : 1;
+  }
+  return 0;
+}
+
+//
+// Sets the bit of every id used as an operand inside a function body, by an
+// extended instruction or by a group decoration.
+//
+static SpvReflectResult FindReferencedIds(const Parser* p_parser, uint32_t* p_referenced)
+{
+  uint32_t max_word_count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    max_word_count = Max(max_word_count, p_parser->nodes[i].word_count);
+  }
+  uint32_t* ids = (uint32_t*)calloc(max_word_count + 1, sizeof(*ids));
+  if (IsNull(ids)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  bool in_function = false;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    if (p_node->op == SpvOpFunction) {
+      in_function = true;
+    }
+    else if (p_node->op == SpvOpFunctionEnd) {
+      in_function = false;
+    }
+    if (!in_function && (p_node->op != SpvOpExtInst) &&
+        (p_node->op != SpvOpGroupDecorate) && (p_node->op != SpvOpGroupMemberDecorate)) {
+      continue;
+    }
+    uint32_t id_count = GetIdOperands(p_parser, p_node, ids);
+    for (uint32_t j = 0; j < id_count; ++j) {
+      if (ids[j] < p_parser->id_bound) {
+        SetBit(p_referenced, ids[j]);
+      }
+    }
+  }
+
+  SafeFree(ids);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+//
+// Assigns the new set and binding numbers of the live entries of a remap
+// table sorted by old set and binding.
+//
+static void RenumberDescriptorBindings(SpvReflectDescriptorCompactionFlags flags,
+                                       uint32_t                            remap_count,
+                                       SpvReflectDescriptorBindingRemap*   p_remaps)
+{
+  uint32_t set = 0;
+  uint32_t binding = 0;
+  const SpvReflectDescriptorBindingRemap* p_prev = NULL;
+  for (uint32_t i = 0; i < remap_count; ++i) {
+    SpvReflectDescriptorBindingRemap* p_remap = &p_remaps[i];
+    p_remap->set = p_remap->old_set;
+    p_remap->binding = p_remap->old_binding;
+    // Undecorated variables have nothing to patch
+    if (p_remap->removed || (p_remap->old_set == (uint32_t)INVALID_VALUE) ||
+        (p_remap->old_binding == (uint32_t)INVALID_VALUE)) {
+      continue;
+    }
+    if (IsNull(p_prev) || (p_prev->old_set != p_remap->old_set)) {
+      set = IsNull(p_prev) ? 0 : set + 1;
+      binding = 0;
+    }
+    else if (p_prev->old_binding != p_remap->old_binding) {
+      ++binding;
+    }
+    if ((flags & SPV_REFLECT_DESCRIPTOR_COMPACTION_COLLAPSE_SETS) != 0) {
+      p_remap->set = set;
+    }
+    p_remap->binding = binding;
+    p_prev = p_remap;
+  }
+}
+
+//
+// Rewrites the Binding and DescriptorSet decorations of rewritten code
+// according to the remap table. p_remap_index maps an id to its remap
+// entry plus one.
+//
+static void PatchDescriptorDecorations(const uint32_t*                          p_remap_index,
+                                       uint32_t                                 id_bound,
+                                       const SpvReflectDescriptorBindingRemap*  p_remaps,
+                                       uint32_t*                                p_code,
+                                       uint32_t                                 word_count)
+{
+  uint32_t word_index = SPIRV_STARTING_WORD_INDEX;
+  while (word_index < word_count) {
+    uint32_t* p_words = p_code + word_index;
+    uint32_t instruction_word_count = p_words[0] >> 16;
+    if (instruction_word_count == 0) {
+      break;
+    }
+    if (((p_words[0] & 0xFFFF) == SpvOpDecorate) && (instruction_word_count > 3) &&
+        (p_words[1] < id_bound) && (p_remap_index[p_words[1]] != 0)) {
+      const SpvReflectDescriptorBindingRemap* p_remap = &p_remaps[p_remap_index[p_words[1]] - 1];
+      if (p_words[2] == SpvDecorationBinding) {
+        p_words[3] = p_remap->binding;
+      }
+      else if (p_words[2] == SpvDecorationDescriptorSet) {
+        p_words[3] = p_remap->set;
+      }
+    }
+    word_index += instruction_word_count;
+  }
+}
+
+SpvReflectResult spvReflectCompactDescriptorBindings(
+  SpvReflectShaderModule*                 p_module,
+  SpvReflectDescriptorCompactionFlags     flags,
+  SpvReflectDescriptorBindingRemapTable*  p_table
+)
+{
+  if (IsNull(p_module) || IsNull(p_table)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_table, 0, sizeof(*p_table));
+  if (IsEntryPointFiltered(p_module)) {
+    return SPV_REFLECT_RESULT_NOT_READY;
+  }
+
+  Parser parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  const uint32_t remap_count = p_module->descriptor_binding_count;
+  SpvReflectDescriptorBindingRemap* p_remaps =
+    (SpvReflectDescriptorBindingRemap*)calloc(remap_count + 1, sizeof(*p_remaps));
+  uint32_t* referenced = (uint32_t*)calloc((parser.id_bound + 31) / 32, sizeof(*referenced));
+  uint32_t* removed = (uint32_t*)calloc((parser.id_bound + 31) / 32, sizeof(*removed));
+  uint32_t* remap_index = (uint32_t*)calloc(parser.id_bound, sizeof(*remap_index));
+  uint32_t* p_code = (uint32_t*)calloc(parser.spirv_word_count, sizeof(*p_code));
+  if (IsNull(p_remaps) || IsNull(referenced) || IsNull(removed) || IsNull(remap_index) || IsNull(p_code)) {
+    result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = FindReferencedIds(&parser, referenced);
+  }
+
+  // A binding goes only if no entry point accesses it and nothing at all
+  // references it, unreachable functions included
+  uint32_t removed_count = 0;
+  for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < remap_count); ++i) {
+    const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[i];
+    SpvReflectDescriptorBindingRemap* p_remap = &p_remaps[i];
+    p_remap->spirv_id = p_binding->spirv_id;
+    p_remap->old_set = p_binding->set;
+    p_remap->old_binding = p_binding->binding;
+    if ((p_binding->spirv_id < parser.id_bound) && !p_binding->accessed &&
+        !TestBit(referenced, p_binding->spirv_id)) {
+      p_remap->removed = 1;
+      SetBit(removed, p_binding->spirv_id);
+      ++removed_count;
+    }
+  }
+
+  bool changed = false;
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    qsort(p_remaps, remap_count, sizeof(*p_remaps), SortCompareDescriptorBindingRemap);
+    RenumberDescriptorBindings(flags, remap_count, p_remaps);
+    changed = (removed_count > 0);
+    for (uint32_t i = 0; i < remap_count; ++i) {
+      const SpvReflectDescriptorBindingRemap* p_remap = &p_remaps[i];
+      changed |= (p_remap->set != p_remap->old_set) || (p_remap->binding != p_remap->old_binding);
+      if (p_remap->spirv_id < parser.id_bound) {
+        remap_index[p_remap->spirv_id] = i + 1;
+      }
+    }
+  }
+
+  // Re-reflect the rewritten module, keeping the original on failure
+  if ((result == SPV_REFLECT_RESULT_SUCCESS) && changed) {
+    uint32_t removed_variable_count = 0;
+    uint32_t word_count = WriteCodeWithoutIds(&parser, removed, p_code, &removed_variable_count);
+    PatchDescriptorDecorations(remap_index, parser.id_bound, p_remaps, p_code, word_count);
+    SpvReflectShaderModule module;
+    result = spvReflectCreateShaderModule(word_count * SPIRV_WORD_SIZE, p_code, &module);
+    if (result == SPV_REFLECT_RESULT_SUCCESS) {
+      spvReflectDestroyShaderModule(p_module);
+      *p_module = module;
+    }
+  }
+
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    p_table->removed_count = removed_count;
+    p_table->remap_count = remap_count;
+    p_table->remaps = p_remaps;
+    p_remaps = NULL;
+  }
+
+  SafeFree(p_remaps);
+  SafeFree(referenced);
+  SafeFree(removed);
+  SafeFree(remap_index);
+  SafeFree(p_code);
+  DestroyParser(&parser);
+  return result;
+}
+
+void spvReflectDestroyDescriptorBindingRemapTable(SpvReflectDescriptorBindingRemapTable* p_table)
+{
+  if (IsNull(p_table)) {
+    return;
+  }
+  SafeFree(p_table->remaps);
+  p_table->removed_count = 0;
+  p_table->remap_count = 0;
+}
+
+enum {
+  MAX_LOCATION_COMPONENTS = 4,
+};
+
+// Interpolation decorations that must agree within a location
+enum {
+  VARYING_INTERPOLATION_FLAT          = 0x1,
+  VARYING_INTERPOLATION_NOPERSPECTIVE = 0x2,
+  VARYING_INTERPOLATION_CENTROID      = 0x4,
+  VARYING_INTERPOLATION_SAMPLE        = 0x8,
+};
+
+typedef enum VaryingComponentType {
+  VARYING_COMPONENT_TYPE_FLOAT,
+  VARYING_COMPONENT_TYPE_INT,
+  VARYING_COMPONENT_TYPE_UINT,
+} VaryingComponentType;
+
+typedef struct VaryingCandidate {
+  SpvReflectVaryingAssignment   assignment;
+  uint32_t                      key;
+} VaryingCandidate;
+
+typedef struct VaryingSlot {
+  uint32_t                      location;
+  uint32_t                      key;
+  uint32_t                      used_component_count;
+} VaryingSlot;
+
+static int SortCompareLocationRange(const void* a, const void* b)
+{
+  const uint32_t* p_elem_a = (const uint32_t*)a;
+  const uint32_t* p_elem_b = (const uint32_t*)b;
+  if (p_elem_a[0] != p_elem_b[0]) {
+    return (p_elem_a[0] < p_elem_b[0]) ? -1 : 1;
+  }
+  return 0;
+}
+
+//
+// Number of distinct locations covered by range_count [first, end) pairs.
+// Sorts p_ranges in place.
+//
+static uint32_t CountLocations(uint32_t* p_ranges, uint32_t range_count)
+{
+  qsort(p_ranges, range_count, 2 * sizeof(*p_ranges), SortCompareLocationRange);
+  uint32_t count = 0;
+  uint32_t covered_end = 0;
+  for (uint32_t i = 0; i < range_count; ++i) {
+    uint32_t first = Max(p_ranges[2 * i], covered_end);
+    if (p_ranges[2 * i + 1] > first) {
+      count += p_ranges[2 * i + 1] - first;
+      covered_end = p_ranges[2 * i + 1];
+    }
+  }
+  return count;
+}
+
+//
+// Describes a 32-bit scalar or vector varying that may share its location
+// with others of the same key. Arrays, matrices, structs, 64-bit types,
+// per-vertex arrayed interfaces and variables that already have a
+// Component decoration are left where they are.
+//
+static bool GetVaryingPackingKey(const Parser*                       p_parser,
+                                 SpvExecutionModel                   model,
+                                 const SpvReflectInterfaceVariable*  p_var,
+                                 uint32_t*                           p_key,
+                                 uint32_t*                           p_component_count)
+{
+  if (((p_var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) != 0) ||
+      (p_var->location == (uint32_t)INVALID_VALUE)) {
+    return false;
+  }
+  Node* p_var_node = FindIdNode(p_parser, p_var->spirv_id);
+  Node* p_pointer = IsNotNull(p_var_node) ? FindIdNode(p_parser, p_var_node->type_id) : NULL;
+  Node* p_type = IsNotNull(p_pointer) ? FindIdNode(p_parser, p_pointer->type_id) : NULL;
+  if (IsNull(p_type) || IsArrayedInterface(p_parser, model, p_var_node)) {
+    return false;
+  }
+
+  uint32_t component_count = 1;
+  Node* p_scalar = p_type;
+  if (p_type->op == SpvOpTypeVector) {
+    component_count = p_parser->spirv_code[p_type->word_offset + 3];
+    p_scalar = FindIdNode(p_parser, p_parser->spirv_code[p_type->word_offset + 2]);
+  }
+  if (IsNull(p_scalar) || (GetScalarWidth(p_parser, p_scalar->result_id) != 32)) {
+    return false;
+  }
+
+  VaryingComponentType component_type = VARYING_COMPONENT_TYPE_FLOAT;
+  if (p_scalar->op == SpvOpTypeInt) {
+    component_type = (p_parser->spirv_code[p_scalar->word_offset + 3] != 0) ? VARYING_COMPONENT_TYPE_INT
+                                                                           : VARYING_COMPONENT_TYPE_UINT;
+  }
+
+  uint32_t id = p_var->spirv_id;
+  if (HasDecoration(p_parser, id, SpvDecorationComponent) || HasDecoration(p_parser, id, SpvDecorationIndex) ||
+      HasDecoration(p_parser, id, SpvDecorationPatch)) {
+    return false;
+  }
+  uint32_t interpolation = 0;
+  interpolation |= HasDecoration(p_parser, id, SpvDecorationFlat) ? VARYING_INTERPOLATION_FLAT : 0;
+  interpolation |= HasDecoration(p_parser, id, SpvDecorationNoPerspective) ? VARYING_INTERPOLATION_NOPERSPECTIVE : 0;
+  interpolation |= HasDecoration(p_parser, id, SpvDecorationCentroid) ? VARYING_INTERPOLATION_CENTROID : 0;
+  interpolation |= HasDecoration(p_parser, id, SpvDecorationSample) ? VARYING_INTERPOLATION_SAMPLE : 0;
+
+  *p_key = ((uint32_t)component_type << 4) | interpolation;
+  *p_component_count = component_count;
+  return true;
+}
+
+static bool IsSharedWithOtherEntryPoint(const SpvReflectShaderModule* p_module,
+                                        const SpvReflectEntryPoint*   p_entry,
+                                        uint32_t                      var_id)
+{
+  for (uint32_t i = 0; i < p_module->entry_point_count; ++i) {
+    const SpvReflectEntryPoint* p_other = &p_module->entry_points[i];
+    if (p_other == p_entry) {
+      continue;
+    }
+    for (uint32_t j = 0; j < p_other->input_variable_count; ++j) {
+      if (p_other->input_variables[j].spirv_id == var_id) {
+        return true;
+      }
+    }
+    for (uint32_t j = 0; j < p_other->output_variable_count; ++j) {
+      if (p_other->output_variables[j].spirv_id == var_id) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static int SortCompareVaryingCandidate(const void* a, const void* b)
+{
+  const VaryingCandidate* p_elem_a = (const VaryingCandidate*)a;
+  const VaryingCandidate* p_elem_b = (const VaryingCandidate*)b;
+  if (p_elem_a->key != p_elem_b->key) {
+    return (p_elem_a->key < p_elem_b->key) ? -1 : 1;
+  }
+  // Widest first packs best
+  if (p_elem_a->assignment.component_count != p_elem_b->assignment.component_count) {
+    return (p_elem_a->assignment.component_count > p_elem_b->assignment.component_count) ? -1 : 1;
+  }
+  if (p_elem_a->assignment.old_location != p_elem_b->assignment.old_location) {
+    return (p_elem_a->assignment.old_location < p_elem_b->assignment.old_location) ? -1 : 1;
+  }
+  return 0;
+}
+
+static bool IsLocationTaken(const uint32_t* p_ranges, uint32_t range_count,
+                            const VaryingSlot* p_slots, uint32_t slot_count, uint32_t location)
+{
+  for (uint32_t i = 0; i < range_count; ++i) {
+    if ((p_ranges[2 * i] <= location) && (location < p_ranges[2 * i + 1])) {
+      return true;
+    }
+  }
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    if (p_slots[i].location == location) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+// First fit decreasing: each candidate goes to the first location of its key
+// with enough free components, or to the lowest location nobody uses.
+//
+static uint32_t AssignVaryingComponents(VaryingCandidate*  p_candidates,
+                                        uint32_t           candidate_count,
+                                        const uint32_t*    p_reserved_ranges,
+                                        uint32_t           reserved_range_count,
+                                        VaryingSlot*       p_slots)
+{
+  qsort(p_candidates, candidate_count, sizeof(*p_candidates), SortCompareVaryingCandidate);
+
+  uint32_t slot_count = 0;
+  for (uint32_t i = 0; i < candidate_count; ++i) {
+    SpvReflectVaryingAssignment* p_assignment = &p_candidates[i].assignment;
+    VaryingSlot* p_slot = NULL;
+    for (uint32_t j = 0; IsNull(p_slot) && (j < slot_count); ++j) {
+      if ((p_slots[j].key == p_candidates[i].key) &&
+          (p_slots[j].used_component_count + p_assignment->component_count <= MAX_LOCATION_COMPONENTS)) {
+        p_slot = &p_slots[j];
+      }
+    }
+    if (IsNull(p_slot)) {
+      uint32_t location = 0;
+      while (IsLocationTaken(p_reserved_ranges, reserved_range_count, p_slots, slot_count, location)) {
+        ++location;
+      }
+      p_slot = &p_slots[slot_count++];
+      p_slot->location = location;
+      p_slot->key = p_candidates[i].key;
+      p_slot->used_component_count = 0;
+    }
+    p_assignment->location = p_slot->location;
+    p_assignment->component = p_slot->used_component_count;
+    p_slot->used_component_count += p_assignment->component_count;
+  }
+  return slot_count;
+}
+
+//
+// Copies the module's instructions into p_code, rewriting the Location of
+// every id with an entry in p_locations and adding a Component decoration
+// after it when p_components is not zero.
+//
+static uint32_t WritePackedVaryingCode(const Parser*    p_parser,
+                                       const uint32_t*  p_locations,
+                                       const uint32_t*  p_components,
+                                       uint32_t*        p_code)
+{
+  uint32_t word_count = (p_parser->node_count > 0) ? p_parser->nodes[0].word_offset : 0;
+  memcpy(p_code, p_parser->spirv_code, word_count * SPIRV_WORD_SIZE);
+
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    memcpy(p_code + word_count, p_words, p_node->word_count * SPIRV_WORD_SIZE);
+    word_count += p_node->word_count;
+
+    if ((p_node->op != SpvOpDecorate) || (p_node->word_count != 4) ||
+        (p_words[2] != SpvDecorationLocation) || (p_words[1] >= p_parser->id_bound) ||
+        (p_locations[p_words[1]] == (uint32_t)INVALID_VALUE)) {
+      continue;
+    }
+    uint32_t id = p_words[1];
+    p_code[word_count - 1] = p_locations[id];
+    if (p_components[id] != 0) {
+      p_code[word_count++] = (4 << 16) | SpvOpDecorate;
+      p_code[word_count++] = id;
+      p_code[word_count++] = SpvDecorationComponent;
+      p_code[word_count++] = p_components[id];
+    }
+  }
+  return word_count;
+}
+
+//
+// Rewrites p_parser's module with the given locations and components and
+// reflects the result into p_new_module.
+//
+static SpvReflectResult CreatePackedVaryingModule(const Parser*            p_parser,
+                                                  const uint32_t*          p_locations,
+                                                  const uint32_t*          p_components,
+                                                  uint32_t                 component_decoration_count,
+                                                  SpvReflectShaderModule*  p_new_module)
+{
+  uint32_t* p_code = (uint32_t*)calloc(p_parser->spirv_word_count + 4 * component_decoration_count, sizeof(*p_code));
+  if (IsNull(p_code)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  uint32_t word_count = WritePackedVaryingCode(p_parser, p_locations, p_components, p_code);
+  SpvReflectResult result = spvReflectCreateShaderModule(word_count * SPIRV_WORD_SIZE, p_code, p_new_module);
+  SafeFree(p_code);
+  return result;
+}
+
+static SpvReflectResult ParseVaryingPacking(SpvReflectShaderModule*          p_module,
+                                            const SpvReflectEntryPoint*      p_entry,
+                                            Parser*                          p_parser,
+                                            SpvReflectShaderModule*          p_next_stage,
+                                            const SpvReflectEntryPoint*      p_next_entry,
+                                            Parser*                          p_next_parser,
+                                            SpvReflectVaryingPackingReport*  p_report)
+{
+  uint32_t var_count = p_entry->output_variable_count + p_next_entry->input_variable_count;
+  uint32_t* ranges = (uint32_t*)calloc(2 * var_count + 1, sizeof(*ranges));
+  uint32_t* reserved_ranges = (uint32_t*)calloc(2 * var_count + 1, sizeof(*reserved_ranges));
+  VaryingCandidate* candidates = (VaryingCandidate*)calloc(p_entry->output_variable_count + 1, sizeof(*candidates));
+  VaryingSlot* slots = (VaryingSlot*)calloc(p_entry->output_variable_count + 1, sizeof(*slots));
+  uint32_t* locations = (uint32_t*)calloc(p_parser->id_bound, sizeof(*locations));
+  uint32_t* components = (uint32_t*)calloc(p_parser->id_bound, sizeof(*components));
+  uint32_t* next_locations = (uint32_t*)calloc(p_next_parser->id_bound, sizeof(*next_locations));
+  uint32_t* next_components = (uint32_t*)calloc(p_next_parser->id_bound, sizeof(*next_components));
+  SpvReflectResult result = SPV_REFLECT_RESULT_SUCCESS;
+  if (IsNull(ranges) || IsNull(reserved_ranges) || IsNull(candidates) || IsNull(slots) ||
+      IsNull(locations) || IsNull(components) || IsNull(next_locations) || IsNull(next_components)) {
+    result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  // Location ranges of both sides of the interface
+  uint32_t range_count = 0;
+  for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < var_count); ++i) {
+    bool is_output = (i < p_entry->output_variable_count);
+    const SpvReflectInterfaceVariable* p_var = is_output
+        ? &p_entry->output_variables[i]
+        : &p_next_entry->input_variables[i - p_entry->output_variable_count];
+    if (GetLocationRange(is_output ? p_parser : p_next_parser,
+                         is_output ? p_entry->spirv_execution_model : p_next_entry->spirv_execution_model,
+                         p_var, &ranges[2 * range_count], &ranges[2 * range_count + 1])) {
+      ++range_count;
+    }
+  }
+
+  //
+  // An output joins the packing when exactly one variable on each side uses
+  // its location and both have the same scalar type, width and interpolation.
+  // Every other location stays where it is.
+  //
+  uint32_t candidate_count = 0;
+  uint32_t reserved_range_count = 0;
+  for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < var_count); ++i) {
+    bool is_output = (i < p_entry->output_variable_count);
+    const SpvReflectInterfaceVariable* p_var = is_output
+        ? &p_entry->output_variables[i]
+        : &p_next_entry->input_variables[i - p_entry->output_variable_count];
+    uint32_t first = 0;
+    uint32_t end = 0;
+    if (!GetLocationRange(is_output ? p_parser : p_next_parser,
+                          is_output ? p_entry->spirv_execution_model : p_next_entry->spirv_execution_model,
+                          p_var, &first, &end)) {
+      continue;
+    }
+
+    const SpvReflectInterfaceVariable* p_input = NULL;
+    uint32_t overlap_count = 0;
+    for (uint32_t j = 0; j < var_count; ++j) {
+      const SpvReflectInterfaceVariable* p_other = (j < p_entry->output_variable_count)
+          ? &p_entry->output_variables[j]
+          : &p_next_entry->input_variables[j - p_entry->output_variable_count];
+      uint32_t other_first = 0;
+      uint32_t other_end = 0;
+      if ((p_other != p_var) &&
+          GetLocationRange((j < p_entry->output_variable_count) ? p_parser : p_next_parser,
+                           (j < p_entry->output_variable_count) ? p_entry->spirv_execution_model
+                                                                : p_next_entry->spirv_execution_model,
+                           p_other, &other_first, &other_end) &&
+          (first < other_end) && (other_first < end)) {
+        ++overlap_count;
+        p_input = (j >= p_entry->output_variable_count) ? p_other : NULL;
+      }
+    }
+
+    uint32_t key = 0;
+    uint32_t component_count = 0;
+    uint32_t input_key = 0;
+    uint32_t input_component_count = 0;
+    bool is_candidate = is_output && (overlap_count == 1) && IsNotNull(p_input) &&
+                        (p_input->location == p_var->location) &&
+                        GetVaryingPackingKey(p_parser, p_entry->spirv_execution_model, p_var,
+                                             &key, &component_count) &&
+                        GetVaryingPackingKey(p_next_parser, p_next_entry->spirv_execution_model, p_input,
+                                             &input_key, &input_component_count) &&
+                        ((key >> 4) == (input_key >> 4)) && (component_count == input_component_count) &&
+                        !IsSharedWithOtherEntryPoint(p_module, p_entry, p_var->spirv_id) &&
+                        !IsSharedWithOtherEntryPoint(p_next_stage, p_next_entry, p_input->spirv_id);
+    if (is_candidate) {
+      VaryingCandidate* p_candidate = &candidates[candidate_count++];
+      p_candidate->key = (key << 8) | input_key;
+      p_candidate->assignment.output_spirv_id = p_var->spirv_id;
+      p_candidate->assignment.input_spirv_id = p_input->spirv_id;
+      p_candidate->assignment.component_count = component_count;
+      p_candidate->assignment.old_location = p_var->location;
+    }
+    else {
+      // Inputs paired with a candidate output move along with it, outputs
+      // are all visited before the inputs
+      bool paired = false;
+      for (uint32_t j = 0; !is_output && (j < candidate_count); ++j) {
+        paired |= (candidates[j].assignment.input_spirv_id == p_var->spirv_id);
+      }
+      if (!paired) {
+        reserved_ranges[2 * reserved_range_count] = first;
+        reserved_ranges[2 * reserved_range_count + 1] = end;
+        ++reserved_range_count;
+      }
+    }
+  }
+
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    p_report->location_count_before = CountLocations(ranges, range_count);
+    p_report->location_count_after = p_report->location_count_before;
+    uint32_t slot_count = AssignVaryingComponents(candidates, candidate_count,
+                                                  reserved_ranges, reserved_range_count, slots);
+    // Slots come after the reserved ranges in the after count
+    for (uint32_t i = 0; i < slot_count; ++i) {
+      reserved_ranges[2 * (reserved_range_count + i)] = slots[i].location;
+      reserved_ranges[2 * (reserved_range_count + i) + 1] = slots[i].location + 1;
+    }
+    uint32_t location_count_after = CountLocations(reserved_ranges, reserved_range_count + slot_count);
+    // Leave the modules alone unless packing frees a location
+    if (location_count_after < p_report->location_count_before) {
+      p_report->location_count_after = location_count_after;
+      p_report->assignment_count = candidate_count;
+      p_report->assignments = (SpvReflectVaryingAssignment*)calloc(candidate_count, sizeof(*(p_report->assignments)));
+      if (IsNull(p_report->assignments)) {
+        result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+      }
+    }
+  }
+
+  if ((result == SPV_REFLECT_RESULT_SUCCESS) && (p_report->assignment_count > 0)) {
+    bool is_same_module = (p_module == p_next_stage);
+    memset(locations, 0xFF, p_parser->id_bound * sizeof(*locations));
+    memset(next_locations, 0xFF, p_next_parser->id_bound * sizeof(*next_locations));
+    uint32_t component_decoration_count = 0;
+    for (uint32_t i = 0; i < candidate_count; ++i) {
+      const SpvReflectVaryingAssignment* p_assignment = &candidates[i].assignment;
+      p_report->assignments[i] = *p_assignment;
+      uint32_t* p_next_locations = is_same_module ? locations : next_locations;
+      uint32_t* p_next_components = is_same_module ? components : next_components;
+      locations[p_assignment->output_spirv_id] = p_assignment->location;
+      components[p_assignment->output_spirv_id] = p_assignment->component;
+      p_next_locations[p_assignment->input_spirv_id] = p_assignment->location;
+      p_next_components[p_assignment->input_spirv_id] = p_assignment->component;
+      component_decoration_count += (p_assignment->component != 0) ? 2 : 0;
+    }
+
+    // Both stages change or neither does
+    SpvReflectShaderModule module;
+    SpvReflectShaderModule next_module;
+    memset(&next_module, 0, sizeof(next_module));
+    result = CreatePackedVaryingModule(p_parser, locations, components, component_decoration_count, &module);
+    if ((result == SPV_REFLECT_RESULT_SUCCESS) && !is_same_module) {
+      result = CreatePackedVaryingModule(p_next_parser, next_locations, next_components,
+                                         component_decoration_count, &next_module);
+      if (result != SPV_REFLECT_RESULT_SUCCESS) {
+        spvReflectDestroyShaderModule(&module);
+      }
+    }
+    if (result == SPV_REFLECT_RESULT_SUCCESS) {
+      spvReflectDestroyShaderModule(p_module);
+      *p_module = module;
+      if (!is_same_module) {
+        spvReflectDestroyShaderModule(p_next_stage);
+        *p_next_stage = next_module;
+      }
+    }
+  }
+
+  SafeFree(ranges);
+  SafeFree(reserved_ranges);
+  SafeFree(candidates);
+  SafeFree(slots);
+  SafeFree(locations);
+  SafeFree(components);
+  SafeFree(next_locations);
+  SafeFree(next_components);
+  return result;
+}
+
+SpvReflectResult spvReflectPackVaryings(
+  SpvReflectShaderModule*          p_module,
+  const char*                      entry_point,
+  SpvReflectShaderModule*          p_next_stage,
+  const char*                      next_entry_point,
+  SpvReflectVaryingPackingReport*  p_report
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_next_stage) ||
+      IsNull(next_entry_point) || IsNull(p_report)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_report, 0, sizeof(*p_report));
+  // Varyings are only known to be private if every entry point is reflected
+  if (IsEntryPointFiltered(p_module) || IsEntryPointFiltered(p_next_stage)) {
+    return SPV_REFLECT_RESULT_NOT_READY;
+  }
+
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  const SpvReflectEntryPoint* p_next_entry = spvReflectGetEntryPoint(p_next_stage, next_entry_point);
+  if (IsNull(p_entry) || IsNull(p_next_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+  const uint32_t producer_stages = SPV_REFLECT_SHADER_STAGE_VERTEX_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_GEOMETRY_BIT;
+  const uint32_t consumer_stages = SPV_REFLECT_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_GEOMETRY_BIT |
+                                   SPV_REFLECT_SHADER_STAGE_FRAGMENT_BIT;
+  if (((p_entry->shader_stage & producer_stages) == 0) ||
+      ((p_next_entry->shader_stage & consumer_stages) == 0)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_EXECUTION_MODE;
+  }
+
+  Parser parser;
+  Parser next_parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  result = CreateAnalysisParser(p_next_stage, &next_parser);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseVaryingPacking(p_module, p_entry, &parser, p_next_stage, p_next_entry, &next_parser, p_report);
+    DestroyParser(&next_parser);
+  }
+  DestroyParser(&parser);
+
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyVaryingPackingReport(p_report);
+  }
+  return result;
+}
+
+void spvReflectDestroyVaryingPackingReport(SpvReflectVaryingPackingReport* p_report)
+{
+  if (IsNull(p_report)) {
+    return;
+  }
+  SafeFree(p_report->assignments);
+  p_report->assignment_count = 0;
+}
+
+enum {
+  DEFAULT_PUSH_CONSTANT_BUDGET = 128,
+};
+
+typedef struct PushConstantContext {
+  Parser                          parser;
+  const SpvReflectShaderModule*   p_module;
+  // Descriptor binding index plus one of the uniform buffer an id points
+  // into, and the top level member it points at
+  uint32_t*                       roots;
+  uint32_t*                       members;
+  // Per binding, whether it is used in a way that hides which members are
+  // read, and where its members start in access_counts and shared
+  bool*                           opaque;
+  uint32_t*                       member_bases;
+  uint32_t*                       access_counts;
+  bool*                           shared;
+  uint32_t*                       entry_functions;
+  uint32_t*                       other_functions;
+  uint32_t*                       operands;
+} PushConstantContext;
+
+typedef struct PushConstantSlot {
+  uint32_t                        alignment;
+  uint32_t                        size;
+  uint32_t                        index;
+} PushConstantSlot;
+
+static void DestroyPushConstantContext(PushConstantContext* p_ctx)
+{
+  SafeFree(p_ctx->roots);
+  SafeFree(p_ctx->members);
+  SafeFree(p_ctx->opaque);
+  SafeFree(p_ctx->member_bases);
+  SafeFree(p_ctx->access_counts);
+  SafeFree(p_ctx->shared);
+  SafeFree(p_ctx->entry_functions);
+  SafeFree(p_ctx->other_functions);
+  SafeFree(p_ctx->operands);
+  DestroyParser(&p_ctx->parser);
+}
+
+// Sets the bit of every function reachable from an entry point
+static SpvReflectResult MarkReachableFunctions(Parser* p_parser, uint32_t entry_point_id, uint32_t* p_bits)
+{
+  Function* p_entry_func = FindFunction(p_parser, entry_point_id);
+  if (IsNull(p_entry_func)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+  size_t function_count = 0;
+  uint32_t* function_ids = NULL;
+  SpvReflectResult result = EnumerateCalledFunctions(p_parser, p_entry_func, &function_count, &function_ids);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  for (size_t i = 0; i < function_count; ++i) {
+    SetBit(p_bits, (uint32_t)(FindFunction(p_parser, function_ids[i]) - p_parser->functions));
+  }
+  SafeFree(function_ids);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+//
+// Follows access chains from the uniform buffer variables and records
+// which top level members each function reads.
+//
+static void ParseUniformMemberAccesses(PushConstantContext* p_ctx)
+{
+  Parser* p_parser = &p_ctx->parser;
+  uint32_t function_index = (uint32_t)INVALID_VALUE;
+  uint32_t* ids = p_ctx->operands;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    switch (p_node->op) {
+      default: {
+        if ((function_index == (uint32_t)INVALID_VALUE) && (p_node->op != SpvOpExtInst) &&
+            (p_node->op != SpvOpGroupDecorate) && (p_node->op != SpvOpGroupMemberDecorate)) {
+          continue;
+        }
+      }
+      break;
+
+      case SpvOpFunction: {
+        Function* p_func = FindFunction(p_parser, p_node->result_id);
+        function_index = IsNotNull(p_func) ? (uint32_t)(p_func - p_parser->functions) : (uint32_t)INVALID_VALUE;
+      }
+      continue;
+
+      case SpvOpFunctionEnd: {
+        function_index = (uint32_t)INVALID_VALUE;
+      }
+      continue;
+
+      case SpvOpName:
+      case SpvOpDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
+      case SpvOpEntryPoint:
+      case SpvOpVariable: {
+      }
+      continue;
+
+      case SpvOpAccessChain:
+      case SpvOpInBoundsAccessChain: {
+        uint32_t base_id = p_words[3];
+        if ((base_id >= p_parser->id_bound) || (p_ctx->roots[base_id] == 0) ||
+            (p_node->result_id >= p_parser->id_bound)) {
+          continue;
+        }
+        uint32_t binding_index = p_ctx->roots[base_id] - 1;
+        uint32_t member = p_ctx->members[base_id];
+        if ((member == (uint32_t)INVALID_VALUE) && (p_node->word_count > 4)) {
+          const Node* p_index = FindIdNode(p_parser, p_words[4]);
+          const uint32_t member_count = p_ctx->p_module->descriptor_bindings[binding_index].block.member_count;
+          member = GetConstantValue(p_parser, p_words[4]);
+          if (IsNull(p_index) || (p_index->op != SpvOpConstant) || (member >= member_count)) {
+            p_ctx->opaque[binding_index] = true;
+            continue;
+          }
+          uint32_t member_index = p_ctx->member_bases[binding_index] + member;
+          if ((function_index != (uint32_t)INVALID_VALUE) && TestBit(p_ctx->entry_functions, function_index)) {
+            p_ctx->access_counts[member_index] += 1;
+          }
+          if ((function_index != (uint32_t)INVALID_VALUE) && TestBit(p_ctx->other_functions, function_index)) {
+            p_ctx->shared[member_index] = true;
+          }
+        }
+        p_ctx->roots[p_node->result_id] = binding_index + 1;
+        p_ctx->members[p_node->result_id] = member;
+      }
+      continue;
+
+      case SpvOpLoad: {
+        uint32_t pointer_id = p_words[3];
+        if ((pointer_id < p_parser->id_bound) && (p_ctx->roots[pointer_id] != 0) &&
+            (p_ctx->members[pointer_id] == (uint32_t)INVALID_VALUE)) {
+          p_ctx->opaque[p_ctx->roots[pointer_id] - 1] = true;
+        }
+      }
+      continue;
+    }
+
+    uint32_t id_count = GetIdOperands(p_parser, p_node, ids);
+    for (uint32_t j = 0; j < id_count; ++j) {
+      if ((ids[j] < p_parser->id_bound) && (p_ctx->roots[ids[j]] != 0)) {
+        p_ctx->opaque[p_ctx->roots[ids[j]] - 1] = true;
+      }
+    }
+  }
+}
+
+static SpvReflectResult CreatePushConstantContext(const SpvReflectShaderModule*  p_module,
+                                                  const SpvReflectEntryPoint*    p_entry,
+                                                  PushConstantContext*           p_ctx)
+{
+  memset(p_ctx, 0, sizeof(*p_ctx));
+  p_ctx->p_module = p_module;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &p_ctx->parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  Parser* p_parser = &p_ctx->parser;
+
+  uint32_t max_word_count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    max_word_count = Max(max_word_count, p_parser->nodes[i].word_count);
+  }
+  uint32_t total_member_count = 0;
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    total_member_count += p_module->descriptor_bindings[i].block.member_count;
+  }
+  const uint32_t function_word_count = (uint32_t)(p_parser->function_count + 31) / 32;
+  p_ctx->roots = (uint32_t*)calloc(p_parser->id_bound, sizeof(*(p_ctx->roots)));
+  p_ctx->members = (uint32_t*)calloc(p_parser->id_bound, sizeof(*(p_ctx->members)));
+  p_ctx->opaque = (bool*)calloc(p_module->descriptor_binding_count + 1, sizeof(*(p_ctx->opaque)));
+  p_ctx->member_bases = (uint32_t*)calloc(p_module->descriptor_binding_count + 1, sizeof(*(p_ctx->member_bases)));
+  p_ctx->access_counts = (uint32_t*)calloc(total_member_count + 1, sizeof(*(p_ctx->access_counts)));
+  p_ctx->shared = (bool*)calloc(total_member_count + 1, sizeof(*(p_ctx->shared)));
+  p_ctx->entry_functions = (uint32_t*)calloc(function_word_count + 1, sizeof(*(p_ctx->entry_functions)));
+  p_ctx->other_functions = (uint32_t*)calloc(function_word_count + 1, sizeof(*(p_ctx->other_functions)));
+  p_ctx->operands = (uint32_t*)calloc(max_word_count + 1, sizeof(*(p_ctx->operands)));
+  if (IsNull(p_ctx->roots) || IsNull(p_ctx->members) || IsNull(p_ctx->opaque) || IsNull(p_ctx->member_bases) ||
+      IsNull(p_ctx->access_counts) || IsNull(p_ctx->shared) ||
+      IsNull(p_ctx->entry_functions) || IsNull(p_ctx->other_functions) || IsNull(p_ctx->operands)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  memset(p_ctx->members, 0xFF, p_parser->id_bound * sizeof(*(p_ctx->members)));
+
+  for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < p_module->entry_point_count); ++i) {
+    const SpvReflectEntryPoint* p_other = &p_module->entry_points[i];
+    uint32_t* p_bits = (p_other == p_entry) ? p_ctx->entry_functions : p_ctx->other_functions;
+    result = MarkReachableFunctions(p_parser, p_other->id, p_bits);
+  }
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  // Single uniform buffers, arrays of them are indexed per draw
+  uint32_t member_base = 0;
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[i];
+    p_ctx->member_bases[i] = member_base;
+    member_base += p_binding->block.member_count;
+    if ((p_binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER) &&
+        (p_binding->array.dims_count == 0) && (p_binding->block.member_count > 0) &&
+        (p_binding->spirv_id < p_parser->id_bound)) {
+      p_ctx->roots[p_binding->spirv_id] = i + 1;
+    }
+  }
+
+  ParseUniformMemberAccesses(p_ctx);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+//
+// std430 size and alignment of a uniform block member. Returns false for
+// members that cannot be promoted.
+//
+static bool GetStd430Layout(const SpvReflectBlockVariable* p_member, uint32_t* p_size, uint32_t* p_alignment)
+{
+  const SpvReflectTypeDescription* p_type = p_member->type_description;
+  if (IsNull(p_type) ||
+      ((p_type->type_flags & (SPV_REFLECT_TYPE_FLAG_ARRAY | SPV_REFLECT_TYPE_FLAG_STRUCT |
+                              SPV_REFLECT_TYPE_FLAG_EXTERNAL_MASK)) != 0) ||
+      ((p_type->type_flags & (SPV_REFLECT_TYPE_FLAG_INT | SPV_REFLECT_TYPE_FLAG_FLOAT)) == 0)) {
+    return false;
+  }
+  // 8 and 16-bit push constants need extra capabilities
+  const uint32_t width = p_member->numeric.scalar.width;
+  if ((width != 32) && (width != 64)) {
+    return false;
+  }
+
+  const uint32_t scalar_size = width / SPIRV_BYTE_WIDTH;
+  uint32_t vector_count = 1;
+  uint32_t component_count = 1;
+  if ((p_type->type_flags & SPV_REFLECT_TYPE_FLAG_MATRIX) != 0) {
+    bool row_major = (p_member->decoration_flags & SPV_REFLECT_DECORATION_ROW_MAJOR) != 0;
+    vector_count = row_major ? p_member->numeric.matrix.row_count : p_member->numeric.matrix.column_count;
+    component_count = row_major ? p_member->numeric.matrix.column_count : p_member->numeric.matrix.row_count;
+  }
+  else if ((p_type->type_flags & SPV_REFLECT_TYPE_FLAG_VECTOR) != 0) {
+    component_count = p_member->numeric.vector.component_count;
+  }
+  if ((vector_count == 0) || (component_count == 0) || (component_count > 4)) {
+    return false;
+  }
+
+  // Three component vectors align like four, matrices are arrays of their
+  // column or row vectors
+  *p_alignment = ((component_count == 3) ? 4 : component_count) * scalar_size;
+  *p_size = (vector_count > 1) ? vector_count * (*p_alignment) : component_count * scalar_size;
+  return true;
+}
+
+static int SortComparePushConstantCandidate(const void* a, const void* b)
+{
+  const SpvReflectPushConstantCandidate* p_elem_a = (const SpvReflectPushConstantCandidate*)a;
+  const SpvReflectPushConstantCandidate* p_elem_b = (const SpvReflectPushConstantCandidate*)b;
+  if (p_elem_a->size != p_elem_b->size) {
+    return (p_elem_a->size < p_elem_b->size) ? -1 : 1;
+  }
+  if (p_elem_a->access_count != p_elem_b->access_count) {
+    return (p_elem_a->access_count > p_elem_b->access_count) ? -1 : 1;
+  }
+  if (p_elem_a->set != p_elem_b->set) {
+    return (p_elem_a->set < p_elem_b->set) ? -1 : 1;
+  }
+  if (p_elem_a->binding != p_elem_b->binding) {
+    return (p_elem_a->binding < p_elem_b->binding) ? -1 : 1;
+  }
+  if (p_elem_a->member_index != p_elem_b->member_index) {
+    return (p_elem_a->member_index < p_elem_b->member_index) ? -1 : 1;
+  }
+  return 0;
+}
+
+static int SortComparePushConstantSlot(const void* a, const void* b)
+{
+  const PushConstantSlot* p_elem_a = (const PushConstantSlot*)a;
+  const PushConstantSlot* p_elem_b = (const PushConstantSlot*)b;
+  if (p_elem_a->alignment != p_elem_b->alignment) {
+    return (p_elem_a->alignment > p_elem_b->alignment) ? -1 : 1;
+  }
+  if (p_elem_a->size != p_elem_b->size) {
+    return (p_elem_a->size > p_elem_b->size) ? -1 : 1;
+  }
+  if (p_elem_a->index != p_elem_b->index) {
+    return (p_elem_a->index < p_elem_b->index) ? -1 : 1;
+  }
+  return 0;
+}
+
+static uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+  return (alignment > 0) ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+//
+// Places the promoted candidates after base_offset, largest alignment
+// first so that only the first member can need padding. Returns the end
+// of the layout.
+//
+static uint32_t LayoutPushConstantPlan(SpvReflectPushConstantPlan* p_plan, PushConstantSlot* p_slots)
+{
+  uint32_t slot_count = 0;
+  for (uint32_t i = 0; i < p_plan->candidate_count; ++i) {
+    SpvReflectPushConstantCandidate* p_candidate = &p_plan->candidates[i];
+    p_candidate->offset = 0;
+    if (p_candidate->promoted) {
+      PushConstantSlot* p_slot = &p_slots[slot_count++];
+      p_slot->alignment = p_candidate->alignment;
+      p_slot->size = p_candidate->size;
+      p_slot->index = i;
+    }
+  }
+  qsort(p_slots, slot_count, sizeof(*p_slots), SortComparePushConstantSlot);
+
+  uint32_t end = p_plan->base_offset;
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    SpvReflectPushConstantCandidate* p_candidate = &p_plan->candidates[p_slots[i].index];
+    p_candidate->offset = AlignUp(end, p_candidate->alignment);
+    end = p_candidate->offset + p_candidate->size;
+  }
+  return end;
+}
+
+static SpvReflectResult ParsePushConstantPlan(const PushConstantContext*   p_ctx,
+                                              const SpvReflectEntryPoint*  p_entry,
+                                              uint32_t                     budget,
+                                              SpvReflectPushConstantPlan*  p_plan)
+{
+  const SpvReflectShaderModule* p_module = p_ctx->p_module;
+  p_plan->budget = (budget > 0) ? budget : DEFAULT_PUSH_CONSTANT_BUDGET;
+
+  // Promoted members go after the push constants already in use
+  for (uint32_t i = 0; i < p_module->push_constant_block_count; ++i) {
+    const SpvReflectBlockVariable* p_block = &p_module->push_constant_blocks[i];
+    bool is_used = false;
+    for (uint32_t j = 0; j < p_entry->used_push_constant_count; ++j) {
+      is_used |= (p_entry->used_push_constants[j] == p_block->spirv_id);
+    }
+    for (uint32_t j = 0; is_used && (j < p_block->member_count); ++j) {
+      const SpvReflectBlockVariable* p_member = &p_block->members[j];
+      p_plan->base_offset = Max(p_plan->base_offset, p_member->absolute_offset + p_member->size);
+    }
+  }
+  p_plan->size = p_plan->base_offset;
+
+  uint32_t candidate_count = 0;
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[i];
+    if ((p_binding->spirv_id >= p_ctx->parser.id_bound) || (p_ctx->roots[p_binding->spirv_id] != i + 1) ||
+        p_ctx->opaque[i]) {
+      continue;
+    }
+    for (uint32_t j = 0; j < p_binding->block.member_count; ++j) {
+      uint32_t member_index = p_ctx->member_bases[i] + j;
+      candidate_count += ((p_ctx->access_counts[member_index] > 0) && !p_ctx->shared[member_index]) ? 1 : 0;
+    }
+  }
+  if (candidate_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+
+  p_plan->candidates = (SpvReflectPushConstantCandidate*)calloc(candidate_count, sizeof(*(p_plan->candidates)));
+  PushConstantSlot* p_slots = (PushConstantSlot*)calloc(candidate_count, sizeof(*p_slots));
+  if (IsNull(p_plan->candidates) || IsNull(p_slots)) {
+    SafeFree(p_slots);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[i];
+    if ((p_binding->spirv_id >= p_ctx->parser.id_bound) || (p_ctx->roots[p_binding->spirv_id] != i + 1) ||
+        p_ctx->opaque[i]) {
+      continue;
+    }
+    for (uint32_t j = 0; j < p_binding->block.member_count; ++j) {
+      uint32_t member_index = p_ctx->member_bases[i] + j;
+      SpvReflectPushConstantCandidate candidate;
+      memset(&candidate, 0, sizeof(candidate));
+      if ((p_ctx->access_counts[member_index] == 0) || p_ctx->shared[member_index] ||
+          !GetStd430Layout(&p_binding->block.members[j], &candidate.size, &candidate.alignment)) {
+        continue;
+      }
+      candidate.binding_spirv_id = p_binding->spirv_id;
+      candidate.set = p_binding->set;
+      candidate.binding = p_binding->binding;
+      candidate.member_index = j;
+      candidate.uniform_offset = p_binding->block.members[j].offset;
+      candidate.access_count = p_ctx->access_counts[member_index];
+      p_plan->candidates[p_plan->candidate_count++] = candidate;
+    }
+  }
+  qsort(p_plan->candidates, p_plan->candidate_count, sizeof(*(p_plan->candidates)), SortComparePushConstantCandidate);
+
+  // Smallest first, keeping each member whose layout still fits. Promotion
+  // adds a block, and an entry point can only use one, so entry points
+  // that already have push constants only get their candidates ranked.
+  const bool has_push_constants = (p_entry->used_push_constant_count > 0);
+  for (uint32_t i = 0; !has_push_constants && (i < p_plan->candidate_count); ++i) {
+    p_plan->candidates[i].promoted = 1;
+    if (LayoutPushConstantPlan(p_plan, p_slots) > p_plan->budget) {
+      p_plan->candidates[i].promoted = 0;
+    }
+    else {
+      p_plan->promoted_count += 1;
+    }
+  }
+  p_plan->size = LayoutPushConstantPlan(p_plan, p_slots);
+
+  SafeFree(p_slots);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectGetPushConstantPlan(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  uint32_t                       budget,
+  SpvReflectPushConstantPlan*    p_plan
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_plan)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_plan, 0, sizeof(*p_plan));
+
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  PushConstantContext context;
+  SpvReflectResult result = CreatePushConstantContext(p_module, p_entry, &context);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParsePushConstantPlan(&context, p_entry, budget, p_plan);
+  }
+  DestroyPushConstantContext(&context);
+
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyPushConstantPlan(p_plan);
+  }
+  return result;
+}
+
+typedef struct PromotedMember {
+  const SpvReflectBlockVariable*  p_member;
+  uint32_t                        uniform_member_index;
+  uint32_t                        offset;
+  uint32_t                        size;
+  uint32_t                        alignment;
+  uint32_t                        type_id;
+  uint32_t                        constant_id;
+  bool                            is_new_constant;
+} PromotedMember;
+
+typedef struct PushConstantPointer {
+  uint32_t                        pointee_id;
+  uint32_t                        pointer_id;
+  bool                            is_new;
+} PushConstantPointer;
+
+typedef struct PushConstantRewrite {
+  const PushConstantContext*      p_ctx;
+  const SpvReflectEntryPoint*     p_entry;
+  PromotedMember*                 p_members;
+  uint32_t                        member_count;
+  // Promoted member index plus one, per uniform block member
+  uint32_t*                       new_indices;
+  PushConstantPointer*            p_pointers;
+  uint32_t                        pointer_count;
+  uint32_t                        int_type_id;
+  uint32_t                        struct_id;
+  uint32_t                        struct_pointer_id;
+  uint32_t                        variable_id;
+  uint32_t                        id_bound;
+} PushConstantRewrite;
+
+static int SortComparePromotedMember(const void* a, const void* b)
+{
+  const PromotedMember* p_elem_a = (const PromotedMember*)a;
+  const PromotedMember* p_elem_b = (const PromotedMember*)b;
+  if (p_elem_a->offset != p_elem_b->offset) {
+    return (p_elem_a->offset < p_elem_b->offset) ? -1 : 1;
+  }
+  return 0;
+}
+
+// Debug instructions and everything that must precede them
+static bool IsModulePreambleOp(SpvOp op)
+{
+  switch (op) {
+    default: break;
+    case SpvOpCapability:
+    case SpvOpExtension:
+    case SpvOpExtInstImport:
+    case SpvOpMemoryModel:
+    case SpvOpEntryPoint:
+    case SpvOpExecutionMode:
+    case SpvOpExecutionModeId:
+    case SpvOpString:
+    case SpvOpSource:
+    case SpvOpSourceContinued:
+    case SpvOpSourceExtension:
+    case SpvOpName:
+    case SpvOpMemberName:
+    case SpvOpModuleProcessed: {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool IsAnnotationOp(SpvOp op)
+{
+  switch (op) {
+    default: break;
+    case SpvOpDecorate:
+    case SpvOpMemberDecorate:
+    case SpvOpDecorationGroup:
+    case SpvOpGroupDecorate:
+    case SpvOpGroupMemberDecorate:
+    case SpvOpDecorateId:
+    case SpvOpDecorateStringGOOGLE:
+    case SpvOpMemberDecorateStringGOOGLE: {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Access chains that read a promoted member, or point into one
+static bool IsPromotedChain(const PushConstantRewrite* p_rewrite, const Node* p_node)
+{
+  const PushConstantContext* p_ctx = p_rewrite->p_ctx;
+  if (!IsAccessChain(p_node->op) || (p_node->result_id >= p_ctx->parser.id_bound) ||
+      (p_ctx->roots[p_node->result_id] == 0) || (p_ctx->members[p_node->result_id] == (uint32_t)INVALID_VALUE)) {
+    return false;
+  }
+  uint32_t binding_index = p_ctx->roots[p_node->result_id] - 1;
+  return p_rewrite->new_indices[p_ctx->member_bases[binding_index] + p_ctx->members[p_node->result_id]] != 0;
+}
+
+static uint32_t WriteDebugName(uint32_t* p_code, SpvOp op, uint32_t id, uint32_t member, const char* name)
+{
+  size_t length = IsNotNull(name) ? strlen(name) : 0;
+  uint32_t operand_count = (op == SpvOpMemberName) ? 2 : 1;
+  uint32_t word_count = 1 + operand_count + (uint32_t)(length / SPIRV_WORD_SIZE) + 1;
+  memset(p_code, 0, word_count * SPIRV_WORD_SIZE);
+  p_code[0] = (word_count << 16) | op;
+  p_code[1] = id;
+  p_code[2] = member;
+  if (length > 0) {
+    memcpy(p_code + 1 + operand_count, name, length);
+  }
+  return word_count;
+}
+
+//
+// Finds or allocates the ids the new push constant block needs: index
+// constants for its members and PushConstant pointers to whatever the
+// rewritten access chains point at.
+//
+static SpvReflectResult AllocatePushConstantIds(PushConstantRewrite* p_rewrite)
+{
+  const Parser* p_parser = &p_rewrite->p_ctx->parser;
+  uint32_t int_type_id = 0;
+  // Prefer a signed type, which is what glslang indexes structs with
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if ((p_node->op == SpvOpTypeInt) && (p_node->word_count > 3) && (p_words[2] == 32) &&
+        ((int_type_id == 0) || (p_words[3] != 0))) {
+      int_type_id = p_node->result_id;
+    }
+  }
+  // Constant member indices imply an integer type
+  if (int_type_id == 0) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+  p_rewrite->int_type_id = int_type_id;
+
+  p_rewrite->id_bound = p_parser->id_bound;
+  for (uint32_t k = 0; k < p_rewrite->member_count; ++k) {
+    PromotedMember* p_member = &p_rewrite->p_members[k];
+    for (size_t i = 0; (p_member->constant_id == 0) && (i < p_parser->node_count); ++i) {
+      const Node* p_node = &(p_parser->nodes[i]);
+      const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+      if ((p_node->op == SpvOpConstant) && (p_node->word_count == 4) &&
+          (p_words[1] == int_type_id) && (p_words[3] == k)) {
+        p_member->constant_id = p_node->result_id;
+      }
+    }
+    if (p_member->constant_id == 0) {
+      p_member->constant_id = p_rewrite->id_bound++;
+      p_member->is_new_constant = true;
+    }
+  }
+  p_rewrite->struct_id = p_rewrite->id_bound++;
+  p_rewrite->struct_pointer_id = p_rewrite->id_bound++;
+  p_rewrite->variable_id = p_rewrite->id_bound++;
+
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    if (!IsPromotedChain(p_rewrite, p_node)) {
+      continue;
+    }
+    const Node* p_result_type = FindIdNode(p_parser, p_parser->spirv_code[p_node->word_offset + 1]);
+    if (IsNull(p_result_type) || (p_result_type->op != SpvOpTypePointer)) {
+      return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+    }
+    bool is_known = false;
+    for (uint32_t j = 0; !is_known && (j < p_rewrite->pointer_count); ++j) {
+      is_known = (p_rewrite->p_pointers[j].pointee_id == p_result_type->type_id);
+    }
+    if (is_known) {
+      continue;
+    }
+    PushConstantPointer* p_pointer = &p_rewrite->p_pointers[p_rewrite->pointer_count++];
+    p_pointer->pointee_id = p_result_type->type_id;
+    for (size_t j = 0; (p_pointer->pointer_id == 0) && (j < p_parser->node_count); ++j) {
+      const Node* p_type = &(p_parser->nodes[j]);
+      if ((p_type->op == SpvOpTypePointer) && (p_type->storage_class == SpvStorageClassPushConstant) &&
+          (p_type->type_id == p_pointer->pointee_id)) {
+        p_pointer->pointer_id = p_type->result_id;
+      }
+    }
+    if (p_pointer->pointer_id == 0) {
+      p_pointer->pointer_id = p_rewrite->id_bound++;
+      p_pointer->is_new = true;
+    }
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static uint32_t WritePushConstantNames(const PushConstantRewrite* p_rewrite, uint32_t* p_code)
+{
+  uint32_t word_count = 0;
+  word_count += WriteDebugName(p_code + word_count, SpvOpName, p_rewrite->struct_id, 0, "PromotedPushConstants");
+  word_count += WriteDebugName(p_code + word_count, SpvOpName, p_rewrite->variable_id, 0, "promoted");
+  for (uint32_t k = 0; k < p_rewrite->member_count; ++k) {
+    word_count += WriteDebugName(p_code + word_count, SpvOpMemberName, p_rewrite->struct_id, k,
+                                 p_rewrite->p_members[k].p_member->name);
+  }
+  return word_count;
+}
+
+static uint32_t WritePushConstantDecorations(const PushConstantRewrite* p_rewrite, uint32_t* p_code)
+{
+  uint32_t word_count = 0;
+  p_code[word_count++] = (3 << 16) | SpvOpDecorate;
+  p_code[word_count++] = p_rewrite->struct_id;
+  p_code[word_count++] = SpvDecorationBlock;
+  for (uint32_t k = 0; k < p_rewrite->member_count; ++k) {
+    const PromotedMember* p_member = &p_rewrite->p_members[k];
+    p_code[word_count++] = (5 << 16) | SpvOpMemberDecorate;
+    p_code[word_count++] = p_rewrite->struct_id;
+    p_code[word_count++] = k;
+    p_code[word_count++] = SpvDecorationOffset;
+    p_code[word_count++] = p_member->offset;
+    if ((p_member->p_member->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_MATRIX) == 0) {
+      continue;
+    }
+    // Columns or rows are packed at their std430 alignment
+    bool row_major = (p_member->p_member->decoration_flags & SPV_REFLECT_DECORATION_ROW_MAJOR) != 0;
+    p_code[word_count++] = (4 << 16) | SpvOpMemberDecorate;
+    p_code[word_count++] = p_rewrite->struct_id;
+    p_code[word_count++] = k;
+    p_code[word_count++] = row_major ? SpvDecorationRowMajor : SpvDecorationColMajor;
+    p_code[word_count++] = (5 << 16) | SpvOpMemberDecorate;
+    p_code[word_count++] = p_rewrite->struct_id;
+    p_code[word_count++] = k;
+    p_code[word_count++] = SpvDecorationMatrixStride;
+    p_code[word_count++] = p_member->alignment;
+  }
+  return word_count;
+}
+
+static uint32_t WritePushConstantTypes(const PushConstantRewrite* p_rewrite, uint32_t* p_code)
+{
+  uint32_t word_count = 0;
+  for (uint32_t k = 0; k < p_rewrite->member_count; ++k) {
+    if (p_rewrite->p_members[k].is_new_constant) {
+      p_code[word_count++] = (4 << 16) | SpvOpConstant;
+      p_code[word_count++] = p_rewrite->int_type_id;
+      p_code[word_count++] = p_rewrite->p_members[k].constant_id;
+      p_code[word_count++] = k;
+    }
+  }
+  p_code[word_count++] = ((2 + p_rewrite->member_count) << 16) | SpvOpTypeStruct;
+  p_code[word_count++] = p_rewrite->struct_id;
+  for (uint32_t k = 0; k < p_rewrite->member_count; ++k) {
+    p_code[word_count++] = p_rewrite->p_members[k].type_id;
+  }
+  p_code[word_count++] = (4 << 16) | SpvOpTypePointer;
+  p_code[word_count++] = p_rewrite->struct_pointer_id;
+  p_code[word_count++] = SpvStorageClassPushConstant;
+  p_code[word_count++] = p_rewrite->struct_id;
+  for (uint32_t i = 0; i < p_rewrite->pointer_count; ++i) {
+    if (p_rewrite->p_pointers[i].is_new) {
+      p_code[word_count++] = (4 << 16) | SpvOpTypePointer;
+      p_code[word_count++] = p_rewrite->p_pointers[i].pointer_id;
+      p_code[word_count++] = SpvStorageClassPushConstant;
+      p_code[word_count++] = p_rewrite->p_pointers[i].pointee_id;
+    }
+  }
+  p_code[word_count++] = (4 << 16) | SpvOpVariable;
+  p_code[word_count++] = p_rewrite->struct_pointer_id;
+  p_code[word_count++] = p_rewrite->variable_id;
+  p_code[word_count++] = SpvStorageClassPushConstant;
+  return word_count;
+}
+
+//
+// Copies the module's instructions into p_code with the push constant
+// block declared and the access chains to promoted members redirected to
+// it. Returns the new word count.
+//
+static uint32_t WritePushConstantCode(const PushConstantRewrite* p_rewrite, uint32_t* p_code)
+{
+  const Parser* p_parser = &p_rewrite->p_ctx->parser;
+  uint32_t word_count = (p_parser->node_count > 0) ? p_parser->nodes[0].word_offset : 0;
+  memcpy(p_code, p_parser->spirv_code, word_count * SPIRV_WORD_SIZE);
+  p_code[3] = p_rewrite->id_bound;
+
+
+  // Interface lists name every global variable since SPIR-V 1.4
+  const bool list_all_globals = (p_parser->spirv_code[1] >= 0x00010400);
+  bool names_written = false;
+  bool decorations_written = false;
+  bool types_written = false;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if (!names_written && !IsModulePreambleOp(p_node->op)) {
+      word_count += WritePushConstantNames(p_rewrite, p_code + word_count);
+      names_written = true;
+    }
+    if (!decorations_written && !IsModulePreambleOp(p_node->op) && !IsAnnotationOp(p_node->op)) {
+      word_count += WritePushConstantDecorations(p_rewrite, p_code + word_count);
+      decorations_written = true;
+    }
+    if (!types_written && (p_node->op == SpvOpFunction)) {
+      word_count += WritePushConstantTypes(p_rewrite, p_code + word_count);
+      types_written = true;
+    }
+
+    uint32_t* p_copy = p_code + word_count;
+    memcpy(p_copy, p_words, p_node->word_count * SPIRV_WORD_SIZE);
+    word_count += p_node->word_count;
+
+    if ((p_node->op == SpvOpEntryPoint) && list_all_globals && (p_words[2] == p_rewrite->p_entry->id)) {
+      p_code[word_count++] = p_rewrite->variable_id;
+      p_copy[0] = ((p_node->word_count + 1) << 16) | SpvOpEntryPoint;
+    }
+    else if (IsPromotedChain(p_rewrite, p_node)) {
+      const PushConstantContext* p_ctx = p_rewrite->p_ctx;
+      const Node* p_result_type = FindIdNode(p_parser, p_words[1]);
+      for (uint32_t j = 0; j < p_rewrite->pointer_count; ++j) {
+        if (p_rewrite->p_pointers[j].pointee_id == p_result_type->type_id) {
+          p_copy[1] = p_rewrite->p_pointers[j].pointer_id;
+        }
+      }
+      // Chains on the block itself select the member, the rest only
+      // change storage class
+      if (p_ctx->members[p_words[3]] == (uint32_t)INVALID_VALUE) {
+        uint32_t binding_index = p_ctx->roots[p_node->result_id] - 1;
+        uint32_t k = p_rewrite->new_indices[p_ctx->member_bases[binding_index] + p_ctx->members[p_node->result_id]] - 1;
+        p_copy[3] = p_rewrite->variable_id;
+        p_copy[4] = p_rewrite->p_members[k].constant_id;
+      }
+    }
+  }
+  return word_count;
+}
+
+//
+// Matches the promoted candidates of a caller's plan with a fresh plan
+// and checks that their offsets are aligned and do not overlap.
+//
+static SpvReflectResult ParsePromotedMembers(const PushConstantContext*         p_ctx,
+                                             const SpvReflectPushConstantPlan*  p_plan,
+                                             const SpvReflectPushConstantPlan*  p_fresh_plan,
+                                             PushConstantRewrite*               p_rewrite)
+{
+  const SpvReflectShaderModule* p_module = p_ctx->p_module;
+  for (uint32_t i = 0; i < p_plan->candidate_count; ++i) {
+    const SpvReflectPushConstantCandidate* p_candidate = &p_plan->candidates[i];
+    if (!p_candidate->promoted) {
+      continue;
+    }
+    const SpvReflectPushConstantCandidate* p_fresh = NULL;
+    for (uint32_t j = 0; IsNull(p_fresh) && (j < p_fresh_plan->candidate_count); ++j) {
+      if ((p_fresh_plan->candidates[j].binding_spirv_id == p_candidate->binding_spirv_id) &&
+          (p_fresh_plan->candidates[j].member_index == p_candidate->member_index)) {
+        p_fresh = &p_fresh_plan->candidates[j];
+      }
+    }
+    if (IsNull(p_fresh) || (p_candidate->binding_spirv_id >= p_ctx->parser.id_bound)) {
+      return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+    }
+    if ((p_candidate->offset % p_fresh->alignment) != 0) {
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+
+    uint32_t binding_index = p_ctx->roots[p_candidate->binding_spirv_id] - 1;
+    const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[binding_index];
+    const Node* p_variable = FindIdNode(&p_ctx->parser, p_binding->spirv_id);
+    const Node* p_pointer = IsNotNull(p_variable) ? FindIdNode(&p_ctx->parser, p_variable->type_id) : NULL;
+    const Node* p_struct = IsNotNull(p_pointer) ? FindIdNode(&p_ctx->parser, p_pointer->type_id) : NULL;
+    if (IsNull(p_struct) || (p_struct->op != SpvOpTypeStruct) || (p_candidate->member_index + 2 >= p_struct->word_count)) {
+      return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+    }
+    uint32_t member_index = p_ctx->member_bases[binding_index] + p_candidate->member_index;
+    if (p_rewrite->new_indices[member_index] != 0) {
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+    p_rewrite->new_indices[member_index] = (uint32_t)INVALID_VALUE;
+
+    PromotedMember* p_member = &p_rewrite->p_members[p_rewrite->member_count++];
+    p_member->p_member = &p_binding->block.members[p_candidate->member_index];
+    p_member->uniform_member_index = member_index;
+    p_member->offset = p_candidate->offset;
+    p_member->size = p_fresh->size;
+    p_member->alignment = p_fresh->alignment;
+    p_member->type_id = p_ctx->parser.spirv_code[p_struct->word_offset + 2 + p_candidate->member_index];
+  }
+
+  qsort(p_rewrite->p_members, p_rewrite->member_count, sizeof(*(p_rewrite->p_members)), SortComparePromotedMember);
+  for (uint32_t k = 0; k < p_rewrite->member_count; ++k) {
+    const PromotedMember* p_member = &p_rewrite->p_members[k];
+    if ((k > 0) && (p_member[-1].offset + p_member[-1].size > p_member->offset)) {
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+    p_rewrite->new_indices[p_member->uniform_member_index] = k + 1;
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectPromotePushConstants(
+  SpvReflectShaderModule*            p_module,
+  const char*                        entry_point,
+  const SpvReflectPushConstantPlan*  p_plan
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_plan)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if (IsEntryPointFiltered(p_module)) {
+    return SPV_REFLECT_RESULT_NOT_READY;
+  }
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+  uint32_t promoted_count = 0;
+  for (uint32_t i = 0; i < p_plan->candidate_count; ++i) {
+    promoted_count += p_plan->candidates[i].promoted ? 1 : 0;
+  }
+  if (promoted_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  // An entry point can only use one push constant block
+  if (p_entry->used_push_constant_count > 0) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_STORAGE_CLASS;
+  }
+
+  PushConstantContext context;
+  SpvReflectPushConstantPlan fresh_plan;
+  memset(&fresh_plan, 0, sizeof(fresh_plan));
+  PushConstantRewrite rewrite;
+  memset(&rewrite, 0, sizeof(rewrite));
+  uint32_t* p_code = NULL;
+  SpvReflectResult result = CreatePushConstantContext(p_module, p_entry, &context);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParsePushConstantPlan(&context, p_entry, p_plan->budget, &fresh_plan);
+  }
+
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    uint32_t total_member_count = 0;
+    for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+      total_member_count += p_module->descriptor_bindings[i].block.member_count;
+    }
+    rewrite.p_ctx = &context;
+    rewrite.p_entry = p_entry;
+    rewrite.p_members = (PromotedMember*)calloc(promoted_count, sizeof(*(rewrite.p_members)));
+    rewrite.new_indices = (uint32_t*)calloc(total_member_count + 1, sizeof(*(rewrite.new_indices)));
+    rewrite.p_pointers = (PushConstantPointer*)calloc(context.parser.node_count + 1, sizeof(*(rewrite.p_pointers)));
+    if (IsNull(rewrite.p_members) || IsNull(rewrite.new_indices) || IsNull(rewrite.p_pointers)) {
+      result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParsePromotedMembers(&context, p_plan, &fresh_plan, &rewrite);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = AllocatePushConstantIds(&rewrite);
+  }
+
+  // Re-reflect the rewritten module, keeping the original on failure
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    size_t extra_word_count = 32 + 4 * rewrite.pointer_count;
+    for (uint32_t k = 0; k < rewrite.member_count; ++k) {
+      const char* name = rewrite.p_members[k].p_member->name;
+      extra_word_count += 32 + (IsNotNull(name) ? strlen(name) / SPIRV_WORD_SIZE : 0);
+    }
+    p_code = (uint32_t*)calloc(context.parser.spirv_word_count + extra_word_count, sizeof(*p_code));
+    if (IsNull(p_code)) {
+      result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    uint32_t word_count = WritePushConstantCode(&rewrite, p_code);
+    SpvReflectShaderModule module;
+    result = spvReflectCreateShaderModule(word_count * SPIRV_WORD_SIZE, p_code, &module);
+    if (result == SPV_REFLECT_RESULT_SUCCESS) {
+      spvReflectDestroyShaderModule(p_module);
+      *p_module = module;
+    }
+  }
+
+  SafeFree(rewrite.p_members);
+  SafeFree(rewrite.new_indices);
+  SafeFree(rewrite.p_pointers);
+  SafeFree(p_code);
+  spvReflectDestroyPushConstantPlan(&fresh_plan);
+  DestroyPushConstantContext(&context);
+  return result;
+}
+
+void spvReflectDestroyPushConstantPlan(SpvReflectPushConstantPlan* p_plan)
+{
+  if (IsNull(p_plan)) {
+    return;
+  }
+  SafeFree(p_plan->candidates);
+  p_plan->candidate_count = 0;
+  p_plan->promoted_count = 0;
+}
+
+//
+// Streaming MurmurHash3 x64_128 over 32-bit words. Words are paired into
+// 64-bit lanes low word first, so the digest does not depend on the host's
+// byte order.
+//
+typedef struct FingerprintHasher {
+  uint64_t                          h1;
+  uint64_t                          h2;
+  uint32_t                          block[4];
+  uint32_t                          block_word_count;
+  uint64_t                          word_count;
+} FingerprintHasher;
+
+static uint64_t RotateLeft64(uint64_t value, uint32_t shift)
+{
+  return (value << shift) | (value >> (64 - shift));
+}
+
+static uint64_t MixHash64(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xFF51AFD7ED558CCDULL;
+  k ^= k >> 33;
+  k *= 0xC4CEB9FE1A85EC53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+static const uint64_t kHashC1 = 0x87C37B91114253D5ULL;
+static const uint64_t kHashC2 = 0x4CF5AD432745937FULL;
+
+static void HashWord(FingerprintHasher* p_hasher, uint32_t word)
+{
+  p_hasher->block[p_hasher->block_word_count++] = word;
+  p_hasher->word_count += 1;
+  if (p_hasher->block_word_count < 4) {
+    return;
+  }
+  p_hasher->block_word_count = 0;
+
+  uint64_t k1 = (uint64_t)p_hasher->block[0] | ((uint64_t)p_hasher->block[1] << 32);
+  uint64_t k2 = (uint64_t)p_hasher->block[2] | ((uint64_t)p_hasher->block[3] << 32);
+
+  k1 *= kHashC1;
+  k1 = RotateLeft64(k1, 31);
+  k1 *= kHashC2;
+  p_hasher->h1 ^= k1;
+  p_hasher->h1 = RotateLeft64(p_hasher->h1, 27);
+  p_hasher->h1 += p_hasher->h2;
+  p_hasher->h1 = p_hasher->h1 * 5 + 0x52DCE729;
+
+  k2 *= kHashC2;
+  k2 = RotateLeft64(k2, 33);
+  k2 *= kHashC1;
+  p_hasher->h2 ^= k2;
+  p_hasher->h2 = RotateLeft64(p_hasher->h2, 31);
+  p_hasher->h2 += p_hasher->h1;
+  p_hasher->h2 = p_hasher->h2 * 5 + 0x38495AB5;
+}
+
+static void FinishHash(FingerprintHasher* p_hasher, SpvReflectFingerprint* p_fingerprint)
+{
+  uint64_t h1 = p_hasher->h1;
+  uint64_t h2 = p_hasher->h2;
+  const uint32_t* p_tail = p_hasher->block;
+  if (p_hasher->block_word_count > 2) {
+    uint64_t k2 = (uint64_t)p_tail[2];
+    k2 *= kHashC2;
+    k2 = RotateLeft64(k2, 33);
+    k2 *= kHashC1;
+    h2 ^= k2;
+  }
+  if (p_hasher->block_word_count > 0) {
+    uint64_t k1 = (uint64_t)p_tail[0];
+    if (p_hasher->block_word_count > 1) {
+      k1 |= (uint64_t)p_tail[1] << 32;
+    }
+    k1 *= kHashC1;
+    k1 = RotateLeft64(k1, 31);
+    k1 *= kHashC2;
+    h1 ^= k1;
+  }
+
+  uint64_t length = p_hasher->word_count * SPIRV_WORD_SIZE;
+  h1 ^= length;
+  h2 ^= length;
+  h1 += h2;
+  h2 += h1;
+  h1 = MixHash64(h1);
+  h2 = MixHash64(h2);
+  h1 += h2;
+  h2 += h1;
+  p_fingerprint->value[0] = h1;
+  p_fingerprint->value[1] = h2;
+}
+
+// Leading word of each fingerprint so that empty layouts of different kinds
+// do not collide.
+enum FingerprintKind {
+  FINGERPRINT_KIND_MODULE         = 0x4D4F4431, // "MOD1"
+  FINGERPRINT_KIND_DESCRIPTOR_SET = 0x53455431, // "SET1"
+  FINGERPRINT_KIND_PUSH_CONSTANTS = 0x50434231, // "PCB1"
+  FINGERPRINT_KIND_VERTEX_INPUTS  = 0x56545831, // "VTX1"
+  FINGERPRINT_KIND_BLOCK_LAYOUT   = 0x424C4B31, // "BLK1"
+};
+
+static void BeginHash(FingerprintHasher* p_hasher, FingerprintKind kind)
+{
+  memset(p_hasher, 0, sizeof(*p_hasher));
+  HashWord(p_hasher, (uint32_t)kind);
+}
+
+static bool IsDebugOp(SpvOp op)
+{
+  switch (op) {
+    default: break;
+    case SpvOpSourceContinued:
+    case SpvOpSource:
+    case SpvOpSourceExtension:
+    case SpvOpName:
+    case SpvOpMemberName:
+    case SpvOpString:
+    case SpvOpLine:
+    case SpvOpNoLine:
+    case SpvOpModuleProcessed:
+      return true;
+  }
+  return false;
+}
+
+//
+// Number of words taken by the literal string starting at p_words[first].
+// Strings are nul terminated and zero padded, so the last word is the first
+// one whose high byte is zero.
+//
+static uint32_t GetStringWordCount(const uint32_t* p_words, uint32_t first, uint32_t end)
+{
+  for (uint32_t i = first; i < end; ++i) {
+    if ((p_words[i] >> 24) == 0) {
+      return i - first + 1;
+    }
+  }
+  return (end > first) ? (end - first) : 0;
+}
+
+//
+// Memory operands are a mask followed by its parameters: a literal for
+// Aligned and a scope id each for MakePointerAvailable and
+// MakePointerVisible. OpCopyMemory may carry a second mask for the source.
+// The bundled spirv.h predates the Vulkan memory model bits.
+//
+static const uint32_t kMemoryAccessMakePointerAvailableMask = 0x00000008;
+static const uint32_t kMemoryAccessMakePointerVisibleMask   = 0x00000010;
+
+static bool IsMemoryOperandId(const uint32_t* p_words, uint32_t word_count, uint32_t mask_index, uint32_t index)
+{
+  uint32_t k = mask_index;
+  while (k < word_count) {
+    uint32_t mask = p_words[k];
+    if (index == k++) {
+      return false;
+    }
+    if ((mask & SpvMemoryAccessAlignedMask) != 0) {
+      if (index == k++) {
+        return false;
+      }
+    }
+    if ((mask & kMemoryAccessMakePointerAvailableMask) != 0) {
+      if (index == k++) {
+        return true;
+      }
+    }
+    if ((mask & kMemoryAccessMakePointerVisibleMask) != 0) {
+      if (index == k++) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//
+// Whether word index of an instruction holds an id rather than a literal.
+// Operands are ids unless listed here; instructions from extensions that
+// are not listed have their literals treated as ids.
+//
+static bool IsIdOperand(const Parser* p_parser, SpvOp op, const uint32_t* p_words, uint32_t word_count, uint32_t index)
+{
+  switch (op) {
+    default: break;
+
+    case SpvOpCapability:
+    case SpvOpExtension:
+    case SpvOpMemoryModel:
+      return false;
+
+    case SpvOpEntryPoint: {
+      if (index < 3) {
+        return index == 2;
+      }
+      return index >= 3 + GetStringWordCount(p_words, 3, word_count);
+    }
+
+    case SpvOpExecutionMode:
+    case SpvOpExtInstImport:
+    case SpvOpTypeInt:
+    case SpvOpTypeFloat:
+    case SpvOpTypeOpaque:
+    case SpvOpTypePipe:
+    case SpvOpTypeForwardPointer:
+    case SpvOpDecorate:
+    case SpvOpMemberDecorate:
+    case SpvOpDecorateStringGOOGLE:
+    case SpvOpMemberDecorateStringGOOGLE:
+      return index == 1;
+
+    case SpvOpExecutionModeId:
+    case SpvOpDecorateId:
+    case SpvOpTypePointer:
+      return index != 2;
+
+    case SpvOpTypeVector:
+    case SpvOpTypeMatrix:
+    case SpvOpTypeImage:
+    case SpvOpConstant:
+    case SpvOpSpecConstant:
+    case SpvOpConstantSampler:
+      return index < 3;
+
+    case SpvOpVariable:
+    case SpvOpFunction:
+      return index != 3;
+
+    case SpvOpSpecConstantOp: {
+      if (index < 3) {
+        return true;
+      }
+      if (index == 3) {
+        return false;
+      }
+      // Operands follow the embedded opcode's own layout, one word later
+      SpvOp spec_op = (SpvOp)p_words[3];
+      return IsIdOperand(p_parser, spec_op, p_words + 1, word_count - 1, index - 1);
+    }
+
+    case SpvOpExtInst:
+      return index != 4;
+
+    case SpvOpGroupMemberDecorate:
+      return (index == 1) || ((index - 2) % 2 == 0);
+
+    case SpvOpCompositeExtract:
+    case SpvOpArrayLength:
+      return index < 4;
+
+    case SpvOpCompositeInsert:
+    case SpvOpVectorShuffle:
+      return index < 5;
+
+    case SpvOpLoad:
+    case SpvOpCopyMemorySized:
+      return (index < 4) || IsMemoryOperandId(p_words, word_count, 4, index);
+
+    case SpvOpStore:
+    case SpvOpCopyMemory:
+      return (index < 3) || IsMemoryOperandId(p_words, word_count, 3, index);
+
+    case SpvOpSelectionMerge:
+    case SpvOpLifetimeStart:
+    case SpvOpLifetimeStop:
+      return index == 1;
+
+    case SpvOpLoopMerge:
+      return index < 3;
+
+    case SpvOpBranchConditional:
+      return index < 4;
+
+    case SpvOpSwitch: {
+      if (index < 3) {
+        return true;
+      }
+      // Case literals are as wide as the selector
+      Node* p_selector = FindIdNode(p_parser, p_words[1]);
+      Node* p_selector_type = IsNotNull(p_selector) ? FindIdNode(p_parser, p_selector->result_type_id) : NULL;
+      uint32_t literal_word_count = 1;
+      if (IsNotNull(p_selector_type) && (p_selector_type->op == SpvOpTypeInt) &&
+          (p_parser->spirv_code[p_selector_type->word_offset + 2] > 32)) {
+        literal_word_count = 2;
+      }
+      return ((index - 3) % (literal_word_count + 1)) == literal_word_count;
+    }
+
+    // Image operands are a mask followed by ids
+    case SpvOpImageSampleImplicitLod:
+    case SpvOpImageSampleExplicitLod:
+    case SpvOpImageSampleProjImplicitLod:
+    case SpvOpImageSampleProjExplicitLod:
+    case SpvOpImageFetch:
+    case SpvOpImageRead:
+    case SpvOpImageSparseSampleImplicitLod:
+    case SpvOpImageSparseSampleExplicitLod:
+    case SpvOpImageSparseSampleProjImplicitLod:
+    case SpvOpImageSparseSampleProjExplicitLod:
+    case SpvOpImageSparseFetch:
+    case SpvOpImageSparseRead:
+      return index != 5;
+
+    case SpvOpImageSampleDrefImplicitLod:
+    case SpvOpImageSampleDrefExplicitLod:
+    case SpvOpImageSampleProjDrefImplicitLod:
+    case SpvOpImageSampleProjDrefExplicitLod:
+    case SpvOpImageGather:
+    case SpvOpImageDrefGather:
+    case SpvOpImageSparseSampleDrefImplicitLod:
+    case SpvOpImageSparseSampleDrefExplicitLod:
+    case SpvOpImageSparseSampleProjDrefImplicitLod:
+    case SpvOpImageSparseSampleProjDrefExplicitLod:
+    case SpvOpImageSparseGather:
+    case SpvOpImageSparseDrefGather:
+      return index != 6;
+
+    case SpvOpImageWrite:
+      return index != 4;
+
+    // The group operation follows the scope
+    case SpvOpGroupIAdd:
+    case SpvOpGroupFAdd:
+    case SpvOpGroupFMin:
+    case SpvOpGroupUMin:
+    case SpvOpGroupSMin:
+    case SpvOpGroupFMax:
+    case SpvOpGroupUMax:
+    case SpvOpGroupSMax:
+    case SpvOpGroupIAddNonUniformAMD:
+    case SpvOpGroupFAddNonUniformAMD:
+    case SpvOpGroupFMinNonUniformAMD:
+    case SpvOpGroupUMinNonUniformAMD:
+    case SpvOpGroupSMinNonUniformAMD:
+    case SpvOpGroupFMaxNonUniformAMD:
+    case SpvOpGroupUMaxNonUniformAMD:
+    case SpvOpGroupSMaxNonUniformAMD:
+    case SpvOpGroupNonUniformBallotBitCount:
+    case SpvOpGroupNonUniformIAdd:
+    case SpvOpGroupNonUniformFAdd:
+    case SpvOpGroupNonUniformIMul:
+    case SpvOpGroupNonUniformFMul:
+    case SpvOpGroupNonUniformSMin:
+    case SpvOpGroupNonUniformUMin:
+    case SpvOpGroupNonUniformFMin:
+    case SpvOpGroupNonUniformSMax:
+    case SpvOpGroupNonUniformUMax:
+    case SpvOpGroupNonUniformFMax:
+    case SpvOpGroupNonUniformBitwiseAnd:
+    case SpvOpGroupNonUniformBitwiseOr:
+    case SpvOpGroupNonUniformBitwiseXor:
+    case SpvOpGroupNonUniformLogicalAnd:
+    case SpvOpGroupNonUniformLogicalOr:
+    case SpvOpGroupNonUniformLogicalXor:
+      return index != 4;
+  }
+  return true;
+}
+
+static bool IsNonSemanticString(const Parser* p_parser, const Node* p_node, uint32_t first, const char* prefix)
+{
+  if (p_node->word_count <= first) {
+    return false;
+  }
+  const char* p_string = (const char*)(p_parser->spirv_code + p_node->word_offset + first);
+  size_t max_length = (p_node->word_count - first) * SPIRV_WORD_SIZE;
+  size_t prefix_length = strlen(prefix);
+  return (prefix_length <= max_length) && (strncmp(p_string, prefix, prefix_length) == 0);
+}
+
+//
+// False for debug instructions and for non-semantic extended instruction
+// sets and their instructions. Instructions must be passed in module order
+// so that the imports are seen first; p_non_semantic_sets records them.
+//
+static bool IsSemanticInstruction(const Parser* p_parser, const Node* p_node, uint32_t* p_non_semantic_sets)
+{
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  if (IsDebugOp(p_node->op)) {
+    return false;
+  }
+  if ((p_node->op == SpvOpExtension) && IsNonSemanticString(p_parser, p_node, 1, "SPV_KHR_non_semantic_info")) {
+    return false;
+  }
+  if ((p_node->op == SpvOpExtInstImport) && IsNonSemanticString(p_parser, p_node, 2, "NonSemantic.")) {
+    if ((p_node->word_count > 1) && (p_words[1] < p_parser->id_bound)) {
+      SetBit(p_non_semantic_sets, p_words[1]);
+    }
+    return false;
+  }
+  if ((p_node->op == SpvOpExtInst) && (p_node->word_count > 3) && (p_words[3] < p_parser->id_bound) &&
+      TestBit(p_non_semantic_sets, p_words[3])) {
+    return false;
+  }
+  return true;
+}
+
+//
+// Hashes the instruction stream without debug instructions and
+// non-semantic extended instruction sets. Ids are replaced by the order in
+// which they are first referenced, and the header's generator and id bound
+// are left out.
+//
+static SpvReflectResult ParseModuleFingerprint(const SpvReflectShaderModule* p_module, SpvReflectFingerprint* p_fingerprint)
+{
+  Parser parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  uint32_t* p_canonical_ids = (uint32_t*)calloc(parser.id_bound, sizeof(*p_canonical_ids));
+  uint32_t* p_non_semantic_sets = (uint32_t*)calloc((parser.id_bound + 31) / 32, sizeof(*p_non_semantic_sets));
+  if (IsNull(p_canonical_ids) || IsNull(p_non_semantic_sets)) {
+    SafeFree(p_canonical_ids);
+    SafeFree(p_non_semantic_sets);
+    DestroyParser(&parser);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  FingerprintHasher hasher;
+  BeginHash(&hasher, FINGERPRINT_KIND_MODULE);
+  // SPIR-V version
+  HashWord(&hasher, parser.spirv_code[1]);
+
+  uint32_t next_canonical_id = 1;
+  for (size_t i = 0; i < parser.node_count; ++i) {
+    const Node* p_node = &(parser.nodes[i]);
+    const uint32_t* p_words = parser.spirv_code + p_node->word_offset;
+    if (!IsSemanticInstruction(&parser, p_node, p_non_semantic_sets)) {
+      continue;
+    }
+
+    HashWord(&hasher, p_words[0]);
+    for (uint32_t k = 1; k < p_node->word_count; ++k) {
+      uint32_t word = p_words[k];
+      if ((word != 0) && (word < parser.id_bound) &&
+          IsIdOperand(&parser, p_node->op, p_words, p_node->word_count, k)) {
+        if (p_canonical_ids[word] == 0) {
+          p_canonical_ids[word] = next_canonical_id++;
+        }
+        word = p_canonical_ids[word];
+      }
+      HashWord(&hasher, word);
+    }
+  }
+  FinishHash(&hasher, p_fingerprint);
+
+  SafeFree(p_canonical_ids);
+  SafeFree(p_non_semantic_sets);
+  DestroyParser(&parser);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static int SortCompareFingerprintBinding(const void* a, const void* b)
+{
+  const SpvReflectDescriptorBinding* p_elem_a = *(const SpvReflectDescriptorBinding* const*)a;
+  const SpvReflectDescriptorBinding* p_elem_b = *(const SpvReflectDescriptorBinding* const*)b;
+  if (p_elem_a->binding != p_elem_b->binding) {
+    return (p_elem_a->binding < p_elem_b->binding) ? -1 : 1;
+  }
+  if (p_elem_a->descriptor_type != p_elem_b->descriptor_type) {
+    return (p_elem_a->descriptor_type < p_elem_b->descriptor_type) ? -1 : 1;
+  }
+  if (p_elem_a->count != p_elem_b->count) {
+    return (p_elem_a->count < p_elem_b->count) ? -1 : 1;
+  }
+  return 0;
+}
+
+static SpvReflectResult ParseDescriptorSetFingerprint(const SpvReflectDescriptorSet*      p_set,
+                                                      SpvReflectDescriptorSetFingerprint* p_fingerprint)
+{
+  const SpvReflectDescriptorBinding** pp_bindings = NULL;
+  if (p_set->binding_count > 0) {
+    pp_bindings = (const SpvReflectDescriptorBinding**)calloc(p_set->binding_count, sizeof(*pp_bindings));
+    if (IsNull(pp_bindings)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    for (uint32_t i = 0; i < p_set->binding_count; ++i) {
+      pp_bindings[i] = p_set->bindings[i];
+    }
+    qsort(pp_bindings, p_set->binding_count, sizeof(*pp_bindings), SortCompareFingerprintBinding);
+  }
+
+  FingerprintHasher hasher;
+  BeginHash(&hasher, FINGERPRINT_KIND_DESCRIPTOR_SET);
+  for (uint32_t i = 0; i < p_set->binding_count; ++i) {
+    // Aliased variables declare the same layout binding once
+    if ((i > 0) && (SortCompareFingerprintBinding(&pp_bindings[i - 1], &pp_bindings[i]) == 0)) {
+      continue;
+    }
+    HashWord(&hasher, pp_bindings[i]->binding);
+    HashWord(&hasher, (uint32_t)pp_bindings[i]->descriptor_type);
+    HashWord(&hasher, pp_bindings[i]->count);
+  }
+  p_fingerprint->set = p_set->set;
+  FinishHash(&hasher, &p_fingerprint->fingerprint);
+
+  SafeFree(pp_bindings);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static int SortCompareDescriptorSetFingerprint(const void* a, const void* b)
+{
+  const SpvReflectDescriptorSetFingerprint* p_elem_a = (const SpvReflectDescriptorSetFingerprint*)a;
+  const SpvReflectDescriptorSetFingerprint* p_elem_b = (const SpvReflectDescriptorSetFingerprint*)b;
+  if (p_elem_a->set != p_elem_b->set) {
+    return (p_elem_a->set < p_elem_b->set) ? -1 : 1;
+  }
+  return 0;
+}
+
+static void GetPushConstantRange(const SpvReflectBlockVariable* p_block, uint32_t* p_begin, uint32_t* p_end)
+{
+  uint32_t begin = (p_block->member_count > 0) ? UINT32_MAX : 0;
+  uint32_t end = 0;
+  for (uint32_t i = 0; i < p_block->member_count; ++i) {
+    const SpvReflectBlockVariable* p_member = &p_block->members[i];
+    begin = Min(begin, p_member->offset);
+    end = Max(end, p_member->offset + p_member->size);
+  }
+  *p_begin = begin;
+  *p_end = end;
+}
+
+static int SortCompareRange(const void* a, const void* b)
+{
+  const uint32_t* p_elem_a = (const uint32_t*)a;
+  const uint32_t* p_elem_b = (const uint32_t*)b;
+  for (uint32_t i = 0; i < 2; ++i) {
+    if (p_elem_a[i] != p_elem_b[i]) {
+      return (p_elem_a[i] < p_elem_b[i]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+static SpvReflectResult ParsePushConstantFingerprint(const SpvReflectShaderModule* p_module,
+                                                     const SpvReflectEntryPoint*   p_entry,
+                                                     SpvReflectFingerprint*        p_fingerprint)
+{
+  // Pairs of begin and end offsets
+  uint32_t* p_ranges = NULL;
+  uint32_t range_count = 0;
+  if (p_module->push_constant_block_count > 0) {
+    p_ranges = (uint32_t*)calloc(2 * p_module->push_constant_block_count, sizeof(*p_ranges));
+    if (IsNull(p_ranges)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+  for (uint32_t i = 0; i < p_module->push_constant_block_count; ++i) {
+    const SpvReflectBlockVariable* p_block = &p_module->push_constant_blocks[i];
+    bool used = IsNull(p_entry);
+    for (uint32_t j = 0; !used && (j < p_entry->used_push_constant_count); ++j) {
+      used = (p_entry->used_push_constants[j] == p_block->spirv_id);
+    }
+    if (used) {
+      GetPushConstantRange(p_block, &p_ranges[2 * range_count], &p_ranges[2 * range_count + 1]);
+      ++range_count;
+    }
+  }
+  if (range_count > 0) {
+    qsort(p_ranges, range_count, 2 * sizeof(*p_ranges), SortCompareRange);
+  }
+
+  FingerprintHasher hasher;
+  BeginHash(&hasher, FINGERPRINT_KIND_PUSH_CONSTANTS);
+  for (uint32_t i = 0; i < 2 * range_count; ++i) {
+    HashWord(&hasher, p_ranges[i]);
+  }
+  FinishHash(&hasher, p_fingerprint);
+
+  SafeFree(p_ranges);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static int SortCompareFingerprintInput(const void* a, const void* b)
+{
+  const SpvReflectInterfaceVariable* p_elem_a = *(const SpvReflectInterfaceVariable* const*)a;
+  const SpvReflectInterfaceVariable* p_elem_b = *(const SpvReflectInterfaceVariable* const*)b;
+  if (p_elem_a->location != p_elem_b->location) {
+    return (p_elem_a->location < p_elem_b->location) ? -1 : 1;
+  }
+  return 0;
+}
+
+static SpvReflectResult ParseVertexInputFingerprint(SpvReflectShaderStageFlagBits      shader_stage,
+                                                    uint32_t                           input_variable_count,
+                                                    const SpvReflectInterfaceVariable* p_input_variables,
+                                                    SpvReflectFingerprint*             p_fingerprint)
+{
+  const SpvReflectInterfaceVariable** pp_inputs = NULL;
+  uint32_t input_count = 0;
+  if ((shader_stage == SPV_REFLECT_SHADER_STAGE_VERTEX_BIT) && (input_variable_count > 0)) {
+    pp_inputs = (const SpvReflectInterfaceVariable**)calloc(input_variable_count, sizeof(*pp_inputs));
+    if (IsNull(pp_inputs)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    for (uint32_t i = 0; i < input_variable_count; ++i) {
+      const SpvReflectInterfaceVariable* p_var = &p_input_variables[i];
+      if ((p_var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) == 0) {
+        pp_inputs[input_count++] = p_var;
+      }
+    }
+    if (input_count > 0) {
+      qsort(pp_inputs, input_count, sizeof(*pp_inputs), SortCompareFingerprintInput);
+    }
+  }
+
+  FingerprintHasher hasher;
+  BeginHash(&hasher, FINGERPRINT_KIND_VERTEX_INPUTS);
+  for (uint32_t i = 0; i < input_count; ++i) {
+    const SpvReflectInterfaceVariable* p_var = pp_inputs[i];
+    // Matrices take a location per column and arrays one per element
+    uint32_t location_count = 1;
+    if (IsNotNull(p_var->type_description) &&
+        ((p_var->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_MATRIX) != 0)) {
+      location_count = Max(p_var->numeric.matrix.column_count, (uint32_t)1);
+    }
+    for (uint32_t j = 0; j < p_var->array.dims_count; ++j) {
+      location_count *= p_var->array.dims[j];
+    }
+    HashWord(&hasher, p_var->location);
+    HashWord(&hasher, (uint32_t)p_var->format);
+    HashWord(&hasher, location_count);
+  }
+  FinishHash(&hasher, p_fingerprint);
+
+  SafeFree(pp_inputs);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult ParseFingerprints(const SpvReflectShaderModule* p_module,
+                                          const SpvReflectEntryPoint*   p_entry,
+                                          SpvReflectFingerprints*       p_fingerprints)
+{
+  memset(p_fingerprints, 0, sizeof(*p_fingerprints));
+  SpvReflectResult result = ParseModuleFingerprint(p_module, &p_fingerprints->module);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  uint32_t set_count = IsNotNull(p_entry) ? p_entry->descriptor_set_count : p_module->descriptor_set_count;
+  const SpvReflectDescriptorSet* p_sets = IsNotNull(p_entry) ? p_entry->descriptor_sets : p_module->descriptor_sets;
+  if (set_count > SPV_REFLECT_MAX_DESCRIPTOR_SETS) {
+    return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+  }
+  for (uint32_t i = 0; i < set_count; ++i) {
+    result = ParseDescriptorSetFingerprint(&p_sets[i], &p_fingerprints->descriptor_sets[i]);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+  }
+  p_fingerprints->descriptor_set_count = set_count;
+  if (set_count > 0) {
+    qsort(p_fingerprints->descriptor_sets, set_count, sizeof(*(p_fingerprints->descriptor_sets)),
+          SortCompareDescriptorSetFingerprint);
+  }
+
+  result = ParsePushConstantFingerprint(p_module, p_entry, &p_fingerprints->push_constants);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  if (IsNotNull(p_entry)) {
+    result = ParseVertexInputFingerprint(p_entry->shader_stage, p_entry->input_variable_count,
+                                         p_entry->input_variables, &p_fingerprints->vertex_inputs);
+  }
+  else {
+    result = ParseVertexInputFingerprint(p_module->shader_stage, p_module->input_variable_count,
+                                         p_module->input_variables, &p_fingerprints->vertex_inputs);
+  }
+  return result;
+}
+
+SpvReflectResult spvReflectGetFingerprints(
+  const SpvReflectShaderModule*  p_module,
+  SpvReflectFingerprints*        p_fingerprints
+)
+{
+  if (IsNull(p_module) || IsNull(p_fingerprints)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  return ParseFingerprints(p_module, NULL, p_fingerprints);
+}
+
+SpvReflectResult spvReflectGetEntryPointFingerprints(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  SpvReflectFingerprints*        p_fingerprints
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_fingerprints)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+  return ParseFingerprints(p_module, p_entry, p_fingerprints);
+}
+
+enum {
+  DEFAULT_SHINGLE_LENGTH = 4,
+  MAX_SHINGLE_LENGTH     = 16,
+};
+
+//
+// Hash of one instruction with each id operand replaced by the opcode of
+// the instruction that defines it.
+//
+static uint64_t HashNormalizedInstruction(const Parser* p_parser, const Node* p_node)
+{
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  uint64_t hash = MixHash64(p_words[0]);
+  for (uint32_t k = 1; k < p_node->word_count; ++k) {
+    uint64_t word = p_words[k];
+    if (IsIdOperand(p_parser, p_node->op, p_words, p_node->word_count, k)) {
+      Node* p_def = FindIdNode(p_parser, p_words[k]);
+      word = 0x100000000ULL | (IsNotNull(p_def) ? (uint64_t)p_def->op : 0);
+    }
+    hash = MixHash64(hash * kHashC1 + word);
+  }
+  return hash;
+}
+
+//
+// Folds one n-gram into the sketch. The SPV_REFLECT_MINHASH_SIZE hash
+// functions are derived from two base hashes as h1 + i * h2, which keeps
+// the cost per n-gram to an add and a compare per value.
+//
+static void AddMinHashShingle(uint64_t shingle, SpvReflectMinHash* p_minhash)
+{
+  uint64_t h1 = MixHash64(shingle);
+  uint64_t h2 = MixHash64(shingle ^ kHashC2) | 1;
+  uint64_t h = h1;
+  for (uint32_t i = 0; i < SPV_REFLECT_MINHASH_SIZE; ++i) {
+    uint32_t value = (uint32_t)(h >> 32);
+    if (value < p_minhash->values[i]) {
+      p_minhash->values[i] = value;
+    }
+    h += h2;
+  }
+  p_minhash->shingle_count += 1;
+}
+
+SpvReflectResult spvReflectGetMinHash(
+  const SpvReflectShaderModule*  p_module,
+  uint32_t                       shingle_length,
+  SpvReflectMinHash*             p_minhash
+)
+{
+  if (IsNull(p_module) || IsNull(p_minhash)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if (shingle_length == 0) {
+    shingle_length = DEFAULT_SHINGLE_LENGTH;
+  }
+  if (shingle_length > MAX_SHINGLE_LENGTH) {
+    return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+  }
+  p_minhash->shingle_count = 0;
+  memset(p_minhash->values, 0xFF, sizeof(p_minhash->values));
+
+  Parser parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  uint32_t* p_non_semantic_sets = (uint32_t*)calloc((parser.id_bound + 31) / 32, sizeof(*p_non_semantic_sets));
+  if (IsNull(p_non_semantic_sets)) {
+    DestroyParser(&parser);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  // Ring of the last shingle_length instruction hashes
+  uint64_t window[MAX_SHINGLE_LENGTH];
+  uint32_t instruction_count = 0;
+  for (size_t i = 0; i < parser.node_count; ++i) {
+    const Node* p_node = &(parser.nodes[i]);
+    if (!IsSemanticInstruction(&parser, p_node, p_non_semantic_sets)) {
+      continue;
+    }
+    window[instruction_count % shingle_length] = HashNormalizedInstruction(&parser, p_node);
+    instruction_count += 1;
+    if (instruction_count < shingle_length) {
+      continue;
+    }
+    uint64_t shingle = 0;
+    for (uint32_t k = 0; k < shingle_length; ++k) {
+      shingle = MixHash64(shingle * kHashC1 + window[(instruction_count + k) % shingle_length]);
+    }
+    AddMinHashShingle(shingle, p_minhash);
+  }
+  // Modules shorter than an n-gram are one n-gram
+  if ((instruction_count > 0) && (instruction_count < shingle_length)) {
+    uint64_t shingle = 0;
+    for (uint32_t k = 0; k < instruction_count; ++k) {
+      shingle = MixHash64(shingle * kHashC1 + window[k]);
+    }
+    AddMinHashShingle(shingle, p_minhash);
+  }
+
+  SafeFree(p_non_semantic_sets);
+  DestroyParser(&parser);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+float spvReflectGetMinHashSimilarity(
+  const SpvReflectMinHash*  p_a,
+  const SpvReflectMinHash*  p_b
+)
+{
+  if (IsNull(p_a) || IsNull(p_b)) {
+    return 0.0f;
+  }
+  if ((p_a->shingle_count == 0) || (p_b->shingle_count == 0)) {
+    return (p_a->shingle_count == p_b->shingle_count) ? 1.0f : 0.0f;
+  }
+  uint32_t equal_count = 0;
+  for (uint32_t i = 0; i < SPV_REFLECT_MINHASH_SIZE; ++i) {
+    equal_count += (p_a->values[i] == p_b->values[i]) ? 1 : 0;
+  }
+  return (float)equal_count / (float)SPV_REFLECT_MINHASH_SIZE;
+}
+
+//
+// An object being diffed and its position in its parent's array, which
+// identifies block members that have no name.
+//
+typedef struct DiffEntry {
+  const void*                       p_object;
+  uint32_t                          index;
+} DiffEntry;
+
+typedef struct DiffContext {
+  SpvReflectModuleDiff*             p_diff;
+  // Interface variable list being filled in
+  uint32_t*                         p_interface_diff_count;
+  SpvReflectInterfaceVariableDiff*  p_interface_diffs;
+} DiffContext;
+
+static bool HasDiffName(const char* name)
+{
+  return IsNotNull(name) && (name[0] != '\0');
+}
+
+// Unnamed objects sort first and compare equal to each other
+static int CompareDiffNames(const char* a, const char* b)
+{
+  bool has_a = HasDiffName(a);
+  bool has_b = HasDiffName(b);
+  if (has_a != has_b) {
+    return has_a ? 1 : -1;
+  }
+  return has_a ? strcmp(a, b) : 0;
+}
+
+static int CompareDiffBinding(const void* a, const void* b)
+{
+  const SpvReflectDescriptorBinding* p_a = (const SpvReflectDescriptorBinding*)((const DiffEntry*)a)->p_object;
+  const SpvReflectDescriptorBinding* p_b = (const SpvReflectDescriptorBinding*)((const DiffEntry*)b)->p_object;
+  int value = CompareDiffNames(p_a->name, p_b->name);
+  if ((value == 0) && !HasDiffName(p_a->name)) {
+    value = CompareBindingNumbers(p_a, p_b);
+  }
+  return value;
+}
+
+static int CompareDiffBlock(const void* a, const void* b)
+{
+  const DiffEntry* p_a = (const DiffEntry*)a;
+  const DiffEntry* p_b = (const DiffEntry*)b;
+  const char* name_a = ((const SpvReflectBlockVariable*)p_a->p_object)->name;
+  const char* name_b = ((const SpvReflectBlockVariable*)p_b->p_object)->name;
+  int value = CompareDiffNames(name_a, name_b);
+  if ((value == 0) && !HasDiffName(name_a) && (p_a->index != p_b->index)) {
+    value = (p_a->index < p_b->index) ? -1 : 1;
+  }
+  return value;
+}
+
+static int CompareDiffInterfaceVariable(const void* a, const void* b)
+{
+  const SpvReflectInterfaceVariable* p_a = (const SpvReflectInterfaceVariable*)((const DiffEntry*)a)->p_object;
+  const SpvReflectInterfaceVariable* p_b = (const SpvReflectInterfaceVariable*)((const DiffEntry*)b)->p_object;
+  int value = CompareDiffNames(p_a->name, p_b->name);
+  if ((value == 0) && !HasDiffName(p_a->name)) {
+    // Built-ins have no location and are keyed by their built-in instead
+    bool is_built_in_a = (p_a->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) != 0;
+    bool is_built_in_b = (p_b->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) != 0;
+    uint32_t key_a = is_built_in_a ? (uint32_t)p_a->built_in : p_a->location;
+    uint32_t key_b = is_built_in_b ? (uint32_t)p_b->built_in : p_b->location;
+    if (is_built_in_a != is_built_in_b) {
+      value = is_built_in_a ? 1 : -1;
+    }
+    else if (key_a != key_b) {
+      value = (key_a < key_b) ? -1 : 1;
+    }
+  }
+  return value;
+}
+
+// Entries with the same key stay in index order
+static int CompareDiffIndex(const void* a, const void* b)
+{
+  uint32_t index_a = ((const DiffEntry*)a)->index;
+  uint32_t index_b = ((const DiffEntry*)b)->index;
+  return (index_a == index_b) ? 0 : ((index_a < index_b) ? -1 : 1);
+}
+
+static int SortCompareDiffBinding(const void* a, const void* b)
+{
+  int value = CompareDiffBinding(a, b);
+  return (value != 0) ? value : CompareDiffIndex(a, b);
+}
+
+static int SortCompareDiffBlock(const void* a, const void* b)
+{
+  int value = CompareDiffBlock(a, b);
+  return (value != 0) ? value : CompareDiffIndex(a, b);
+}
+
+static int SortCompareDiffInterfaceVariable(const void* a, const void* b)
+{
+  int value = CompareDiffInterfaceVariable(a, b);
+  return (value != 0) ? value : CompareDiffIndex(a, b);
+}
+
+static SpvReflectResult CreateDiffEntries(const void*  p_objects,
+                                          size_t       object_size,
+                                          uint32_t     count,
+                                          int          (*sort_compare)(const void*, const void*),
+                                          DiffEntry**  pp_entries)
+{
+  *pp_entries = NULL;
+  if (count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  DiffEntry* p_entries = (DiffEntry*)calloc(count, sizeof(*p_entries));
+  if (IsNull(p_entries)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    p_entries[i].p_object = (const char*)p_objects + i * object_size;
+    p_entries[i].index = i;
+  }
+  qsort(p_entries, count, sizeof(*p_entries), sort_compare);
+  *pp_entries = p_entries;
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+typedef SpvReflectResult (*DiffVisitor)(DiffContext* p_ctx, const void* p_old, const void* p_new);
+
+//
+// Walks two entry arrays sorted by the same key in lock step and visits
+// each pair of matching objects once. Objects without a match are visited
+// with NULL on the other side.
+//
+static SpvReflectResult DiffSortedEntries(DiffContext*      p_ctx,
+                                          const DiffEntry*  p_old_entries,
+                                          uint32_t          old_count,
+                                          const DiffEntry*  p_new_entries,
+                                          uint32_t          new_count,
+                                          int               (*compare)(const void*, const void*),
+                                          DiffVisitor       visit)
+{
+  uint32_t i = 0;
+  uint32_t j = 0;
+  while ((i < old_count) || (j < new_count)) {
+    int value = 0;
+    if (i == old_count) {
+      value = 1;
+    }
+    else if (j == new_count) {
+      value = -1;
+    }
+    else {
+      value = compare(&p_old_entries[i], &p_new_entries[j]);
+    }
+    const void* p_old = (value <= 0) ? p_old_entries[i].p_object : NULL;
+    const void* p_new = (value >= 0) ? p_new_entries[j].p_object : NULL;
+    SpvReflectResult result = visit(p_ctx, p_old, p_new);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+    if (value <= 0) {
+      ++i;
+    }
+    if (value >= 0) {
+      ++j;
+    }
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult DiffObjects(DiffContext*  p_ctx,
+                                    const void*   p_old_objects,
+                                    uint32_t      old_count,
+                                    const void*   p_new_objects,
+                                    uint32_t      new_count,
+                                    size_t        object_size,
+                                    int           (*compare)(const void*, const void*),
+                                    int           (*sort_compare)(const void*, const void*),
+                                    DiffVisitor   visit)
+{
+  DiffEntry* p_old_entries = NULL;
+  DiffEntry* p_new_entries = NULL;
+  SpvReflectResult result = CreateDiffEntries(p_old_objects, object_size, old_count, sort_compare, &p_old_entries);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = CreateDiffEntries(p_new_objects, object_size, new_count, sort_compare, &p_new_entries);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = DiffSortedEntries(p_ctx, p_old_entries, old_count, p_new_entries, new_count, compare, visit);
+  }
+  SafeFree(p_old_entries);
+  SafeFree(p_new_entries);
+  return result;
+}
+
+static bool HasSameArrayTraits(const SpvReflectArrayTraits* p_a, const SpvReflectArrayTraits* p_b)
+{
+  if ((p_a->dims_count != p_b->dims_count) || (p_a->stride != p_b->stride)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < p_a->dims_count; ++i) {
+    if (p_a->dims[i] != p_b->dims[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool HasSameNumericTraits(const SpvReflectNumericTraits* p_a, const SpvReflectNumericTraits* p_b)
+{
+  return (p_a->scalar.width == p_b->scalar.width) &&
+         (p_a->scalar.signedness == p_b->scalar.signedness) &&
+         (p_a->vector.component_count == p_b->vector.component_count) &&
+         (p_a->matrix.column_count == p_b->matrix.column_count) &&
+         (p_a->matrix.row_count == p_b->matrix.row_count) &&
+         (p_a->matrix.stride == p_b->matrix.stride);
+}
+
+static SpvReflectTypeFlags GetDiffTypeFlags(const SpvReflectTypeDescription* p_type)
+{
+  return IsNotNull(p_type) ? p_type->type_flags : 0;
+}
+
+static SpvReflectResult DiffBlockMembers(DiffContext*                    p_ctx,
+                                         const SpvReflectBlockVariable*  p_old_block,
+                                         const SpvReflectBlockVariable*  p_new_block);
+
+static SpvReflectResult VisitBlockMember(DiffContext* p_ctx, const void* p_old, const void* p_new)
+{
+  const SpvReflectBlockVariable* p_old_member = (const SpvReflectBlockVariable*)p_old;
+  const SpvReflectBlockVariable* p_new_member = (const SpvReflectBlockVariable*)p_new;
+  SpvReflectDiffFlags flags = SPV_REFLECT_DIFF_NONE;
+  if (IsNull(p_old_member)) {
+    flags |= SPV_REFLECT_DIFF_ADDED;
+  }
+  else if (IsNull(p_new_member)) {
+    flags |= SPV_REFLECT_DIFF_REMOVED;
+  }
+  else {
+    if (p_old_member->offset != p_new_member->offset) {
+      flags |= SPV_REFLECT_DIFF_OFFSET;
+    }
+    if ((p_old_member->size != p_new_member->size) || (p_old_member->padded_size != p_new_member->padded_size)) {
+      flags |= SPV_REFLECT_DIFF_SIZE;
+    }
+    bool same_type = HasSameNumericTraits(&p_old_member->numeric, &p_new_member->numeric) &&
+                     HasSameArrayTraits(&p_old_member->array, &p_new_member->array) &&
+                     (p_old_member->decoration_flags == p_new_member->decoration_flags) &&
+                     (GetDiffTypeFlags(p_old_member->type_description) ==
+                      GetDiffTypeFlags(p_new_member->type_description));
+    if (!same_type) {
+      flags |= SPV_REFLECT_DIFF_TYPE;
+    }
+  }
+
+  if (flags != SPV_REFLECT_DIFF_NONE) {
+    SpvReflectModuleDiff* p_diff = p_ctx->p_diff;
+    SpvReflectBlockMemberDiff* p_member_diff = &p_diff->member_diffs[p_diff->member_diff_count++];
+    p_member_diff->p_old = p_old_member;
+    p_member_diff->p_new = p_new_member;
+    p_member_diff->flags = flags;
+  }
+
+  if (IsNotNull(p_old_member) && IsNotNull(p_new_member)) {
+    return DiffBlockMembers(p_ctx, p_old_member, p_new_member);
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult DiffBlockMembers(DiffContext*                    p_ctx,
+                                         const SpvReflectBlockVariable*  p_old_block,
+                                         const SpvReflectBlockVariable*  p_new_block)
+{
+  return DiffObjects(p_ctx,
+                     p_old_block->members, p_old_block->member_count,
+                     p_new_block->members, p_new_block->member_count,
+                     sizeof(SpvReflectBlockVariable),
+                     CompareDiffBlock, SortCompareDiffBlock, VisitBlockMember);
+}
+
+static SpvReflectResult VisitDescriptorBinding(DiffContext* p_ctx, const void* p_old, const void* p_new)
+{
+  const SpvReflectDescriptorBinding* p_old_binding = (const SpvReflectDescriptorBinding*)p_old;
+  const SpvReflectDescriptorBinding* p_new_binding = (const SpvReflectDescriptorBinding*)p_new;
+  SpvReflectModuleDiff* p_diff = p_ctx->p_diff;
+  uint32_t first_member_diff = p_diff->member_diff_count;
+  SpvReflectDiffFlags flags = SPV_REFLECT_DIFF_NONE;
+  if (IsNull(p_old_binding)) {
+    flags |= SPV_REFLECT_DIFF_ADDED;
+  }
+  else if (IsNull(p_new_binding)) {
+    flags |= SPV_REFLECT_DIFF_REMOVED;
+  }
+  else {
+    if (p_old_binding->set != p_new_binding->set) {
+      flags |= SPV_REFLECT_DIFF_SET;
+    }
+    if (p_old_binding->binding != p_new_binding->binding) {
+      flags |= SPV_REFLECT_DIFF_BINDING;
+    }
+    if (p_old_binding->descriptor_type != p_new_binding->descriptor_type) {
+      flags |= SPV_REFLECT_DIFF_DESCRIPTOR_TYPE;
+    }
+    if (p_old_binding->count != p_new_binding->count) {
+      flags |= SPV_REFLECT_DIFF_COUNT;
+    }
+    const SpvReflectImageTraits* p_old_image = &p_old_binding->image;
+    const SpvReflectImageTraits* p_new_image = &p_new_binding->image;
+    bool same_type = (p_old_binding->resource_type == p_new_binding->resource_type) &&
+                     (p_old_image->dim == p_new_image->dim) &&
+                     (p_old_image->depth == p_new_image->depth) &&
+                     (p_old_image->arrayed == p_new_image->arrayed) &&
+                     (p_old_image->ms == p_new_image->ms) &&
+                     (p_old_image->sampled == p_new_image->sampled) &&
+                     (p_old_image->image_format == p_new_image->image_format);
+    if (!same_type) {
+      flags |= SPV_REFLECT_DIFF_TYPE;
+    }
+    SpvReflectResult result = DiffBlockMembers(p_ctx, &p_old_binding->block, &p_new_binding->block);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+    if (p_diff->member_diff_count > first_member_diff) {
+      flags |= SPV_REFLECT_DIFF_BLOCK_LAYOUT;
+    }
+  }
+
+  if (flags != SPV_REFLECT_DIFF_NONE) {
+    SpvReflectDescriptorBindingDiff* p_binding_diff = &p_diff->binding_diffs[p_diff->binding_diff_count++];
+    p_binding_diff->p_old = p_old_binding;
+    p_binding_diff->p_new = p_new_binding;
+    p_binding_diff->flags = flags;
+    p_binding_diff->member_diff_count = p_diff->member_diff_count - first_member_diff;
+    if (p_binding_diff->member_diff_count > 0) {
+      p_binding_diff->member_diffs = &p_diff->member_diffs[first_member_diff];
+    }
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult VisitPushConstantBlock(DiffContext* p_ctx, const void* p_old, const void* p_new)
+{
+  const SpvReflectBlockVariable* p_old_block = (const SpvReflectBlockVariable*)p_old;
+  const SpvReflectBlockVariable* p_new_block = (const SpvReflectBlockVariable*)p_new;
+  SpvReflectModuleDiff* p_diff = p_ctx->p_diff;
+  uint32_t first_member_diff = p_diff->member_diff_count;
+  SpvReflectDiffFlags flags = SPV_REFLECT_DIFF_NONE;
+  if (IsNull(p_old_block)) {
+    flags |= SPV_REFLECT_DIFF_ADDED;
+  }
+  else if (IsNull(p_new_block)) {
+    flags |= SPV_REFLECT_DIFF_REMOVED;
+  }
+  else {
+    uint32_t old_begin = 0;
+    uint32_t old_end = 0;
+    uint32_t new_begin = 0;
+    uint32_t new_end = 0;
+    GetPushConstantRange(p_old_block, &old_begin, &old_end);
+    GetPushConstantRange(p_new_block, &new_begin, &new_end);
+    if (old_begin != new_begin) {
+      flags |= SPV_REFLECT_DIFF_OFFSET;
+    }
+    if ((old_end - old_begin) != (new_end - new_begin)) {
+      flags |= SPV_REFLECT_DIFF_SIZE;
+    }
+    SpvReflectResult result = DiffBlockMembers(p_ctx, p_old_block, p_new_block);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+    if (p_diff->member_diff_count > first_member_diff) {
+      flags |= SPV_REFLECT_DIFF_BLOCK_LAYOUT;
+    }
+  }
+
+  if (flags != SPV_REFLECT_DIFF_NONE) {
+    SpvReflectPushConstantDiff* p_block_diff = &p_diff->push_constant_diffs[p_diff->push_constant_diff_count++];
+    p_block_diff->p_old = p_old_block;
+    p_block_diff->p_new = p_new_block;
+    p_block_diff->flags = flags;
+    p_block_diff->member_diff_count = p_diff->member_diff_count - first_member_diff;
+    if (p_block_diff->member_diff_count > 0) {
+      p_block_diff->member_diffs = &p_diff->member_diffs[first_member_diff];
+    }
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult VisitInterfaceVariable(DiffContext* p_ctx, const void* p_old, const void* p_new)
+{
+  const SpvReflectInterfaceVariable* p_old_var = (const SpvReflectInterfaceVariable*)p_old;
+  const SpvReflectInterfaceVariable* p_new_var = (const SpvReflectInterfaceVariable*)p_new;
+  SpvReflectDiffFlags flags = SPV_REFLECT_DIFF_NONE;
+  if (IsNull(p_old_var)) {
+    flags |= SPV_REFLECT_DIFF_ADDED;
+  }
+  else if (IsNull(p_new_var)) {
+    flags |= SPV_REFLECT_DIFF_REMOVED;
+  }
+  else {
+    bool is_built_in = (p_old_var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) != 0;
+    if (!is_built_in && (p_old_var->location != p_new_var->location)) {
+      flags |= SPV_REFLECT_DIFF_LOCATION;
+    }
+    if (p_old_var->format != p_new_var->format) {
+      flags |= SPV_REFLECT_DIFF_FORMAT;
+    }
+    bool same_type = HasSameNumericTraits(&p_old_var->numeric, &p_new_var->numeric) &&
+                     HasSameArrayTraits(&p_old_var->array, &p_new_var->array) &&
+                     (p_old_var->decoration_flags == p_new_var->decoration_flags) &&
+                     (!is_built_in || (p_old_var->built_in == p_new_var->built_in));
+    if (!same_type) {
+      flags |= SPV_REFLECT_DIFF_TYPE;
+    }
+  }
+
+  if (flags != SPV_REFLECT_DIFF_NONE) {
+    SpvReflectInterfaceVariableDiff* p_var_diff = &p_ctx->p_interface_diffs[(*p_ctx->p_interface_diff_count)++];
+    p_var_diff->p_old = p_old_var;
+    p_var_diff->p_new = p_new_var;
+    p_var_diff->flags = flags;
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static uint32_t CountBlockMembers(const SpvReflectBlockVariable* p_block)
+{
+  uint32_t count = p_block->member_count;
+  for (uint32_t i = 0; i < p_block->member_count; ++i) {
+    count += CountBlockMembers(&p_block->members[i]);
+  }
+  return count;
+}
+
+// Upper bound of the member diffs a module can contribute
+static uint32_t CountDiffMembers(const SpvReflectShaderModule* p_module)
+{
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    count += CountBlockMembers(&p_module->descriptor_bindings[i].block);
+  }
+  for (uint32_t i = 0; i < p_module->push_constant_block_count; ++i) {
+    count += CountBlockMembers(&p_module->push_constant_blocks[i]);
+  }
+  return count;
+}
+
+static SpvReflectRebuildFlags GetRebuildFlags(const SpvReflectShaderModule* p_new_module, const SpvReflectModuleDiff* p_diff)
+{
+  const SpvReflectDiffFlags layout_flags = SPV_REFLECT_DIFF_ADDED | SPV_REFLECT_DIFF_REMOVED |
+                                           SPV_REFLECT_DIFF_SET | SPV_REFLECT_DIFF_BINDING |
+                                           SPV_REFLECT_DIFF_DESCRIPTOR_TYPE | SPV_REFLECT_DIFF_COUNT;
+  const SpvReflectDiffFlags range_flags = SPV_REFLECT_DIFF_ADDED | SPV_REFLECT_DIFF_REMOVED |
+                                          SPV_REFLECT_DIFF_OFFSET | SPV_REFLECT_DIFF_SIZE;
+  SpvReflectRebuildFlags flags = SPV_REFLECT_REBUILD_SHADER_MODULE;
+  for (uint32_t i = 0; i < p_diff->binding_diff_count; ++i) {
+    if ((p_diff->binding_diffs[i].flags & layout_flags) != 0) {
+      flags |= SPV_REFLECT_REBUILD_PIPELINE_LAYOUT;
+    }
+    if ((p_diff->binding_diffs[i].flags & SPV_REFLECT_DIFF_BLOCK_LAYOUT) != 0) {
+      flags |= SPV_REFLECT_REBUILD_HOST_STRUCTS;
+    }
+  }
+  for (uint32_t i = 0; i < p_diff->push_constant_diff_count; ++i) {
+    if ((p_diff->push_constant_diffs[i].flags & range_flags) != 0) {
+      flags |= SPV_REFLECT_REBUILD_PIPELINE_LAYOUT;
+    }
+    if ((p_diff->push_constant_diffs[i].flags & SPV_REFLECT_DIFF_BLOCK_LAYOUT) != 0) {
+      flags |= SPV_REFLECT_REBUILD_HOST_STRUCTS;
+    }
+  }
+  if (p_diff->input_variable_diff_count > 0) {
+    flags |= (p_new_module->shader_stage == SPV_REFLECT_SHADER_STAGE_VERTEX_BIT)
+               ? SPV_REFLECT_REBUILD_VERTEX_INPUT_STATE
+               : SPV_REFLECT_REBUILD_STAGE_INTERFACE;
+  }
+  if (p_diff->output_variable_diff_count > 0) {
+    flags |= SPV_REFLECT_REBUILD_STAGE_INTERFACE;
+  }
+  return flags;
+}
+
+static SpvReflectResult ParseModuleDiff(const SpvReflectShaderModule* p_old_module,
+                                        const SpvReflectShaderModule* p_new_module,
+                                        SpvReflectModuleDiff*         p_diff)
+{
+  uint32_t binding_capacity = p_old_module->descriptor_binding_count + p_new_module->descriptor_binding_count;
+  uint32_t push_constant_capacity = p_old_module->push_constant_block_count + p_new_module->push_constant_block_count;
+  uint32_t input_capacity = p_old_module->input_variable_count + p_new_module->input_variable_count;
+  uint32_t output_capacity = p_old_module->output_variable_count + p_new_module->output_variable_count;
+  uint32_t member_capacity = CountDiffMembers(p_old_module) + CountDiffMembers(p_new_module);
+  if (binding_capacity > 0) {
+    p_diff->binding_diffs = (SpvReflectDescriptorBindingDiff*)calloc(binding_capacity, sizeof(*(p_diff->binding_diffs)));
+  }
+  if (push_constant_capacity > 0) {
+    p_diff->push_constant_diffs = (SpvReflectPushConstantDiff*)calloc(push_constant_capacity, sizeof(*(p_diff->push_constant_diffs)));
+  }
+  if (input_capacity > 0) {
+    p_diff->input_variable_diffs = (SpvReflectInterfaceVariableDiff*)calloc(input_capacity, sizeof(*(p_diff->input_variable_diffs)));
+  }
+  if (output_capacity > 0) {
+    p_diff->output_variable_diffs = (SpvReflectInterfaceVariableDiff*)calloc(output_capacity, sizeof(*(p_diff->output_variable_diffs)));
+  }
+  if (member_capacity > 0) {
+    p_diff->member_diffs = (SpvReflectBlockMemberDiff*)calloc(member_capacity, sizeof(*(p_diff->member_diffs)));
+  }
+  if (((binding_capacity > 0) && IsNull(p_diff->binding_diffs)) ||
+      ((push_constant_capacity > 0) && IsNull(p_diff->push_constant_diffs)) ||
+      ((input_capacity > 0) && IsNull(p_diff->input_variable_diffs)) ||
+      ((output_capacity > 0) && IsNull(p_diff->output_variable_diffs)) ||
+      ((member_capacity > 0) && IsNull(p_diff->member_diffs))) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  DiffContext context;
+  memset(&context, 0, sizeof(context));
+  context.p_diff = p_diff;
+  SpvReflectResult result = DiffObjects(&context,
+                                        p_old_module->descriptor_bindings, p_old_module->descriptor_binding_count,
+                                        p_new_module->descriptor_bindings, p_new_module->descriptor_binding_count,
+                                        sizeof(SpvReflectDescriptorBinding),
+                                        CompareDiffBinding, SortCompareDiffBinding, VisitDescriptorBinding);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = DiffObjects(&context,
+                         p_old_module->push_constant_blocks, p_old_module->push_constant_block_count,
+                         p_new_module->push_constant_blocks, p_new_module->push_constant_block_count,
+                         sizeof(SpvReflectBlockVariable),
+                         CompareDiffBlock, SortCompareDiffBlock, VisitPushConstantBlock);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    context.p_interface_diff_count = &p_diff->input_variable_diff_count;
+    context.p_interface_diffs = p_diff->input_variable_diffs;
+    result = DiffObjects(&context,
+                         p_old_module->input_variables, p_old_module->input_variable_count,
+                         p_new_module->input_variables, p_new_module->input_variable_count,
+                         sizeof(SpvReflectInterfaceVariable),
+                         CompareDiffInterfaceVariable, SortCompareDiffInterfaceVariable, VisitInterfaceVariable);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    context.p_interface_diff_count = &p_diff->output_variable_diff_count;
+    context.p_interface_diffs = p_diff->output_variable_diffs;
+    result = DiffObjects(&context,
+                         p_old_module->output_variables, p_old_module->output_variable_count,
+                         p_new_module->output_variables, p_new_module->output_variable_count,
+                         sizeof(SpvReflectInterfaceVariable),
+                         CompareDiffInterfaceVariable, SortCompareDiffInterfaceVariable, VisitInterfaceVariable);
+  }
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  p_diff->rebuild_flags = GetRebuildFlags(p_new_module, p_diff);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectDiffShaderModules(
+  const SpvReflectShaderModule*  p_old_module,
+  const SpvReflectShaderModule*  p_new_module,
+  SpvReflectModuleDiff*          p_diff
+)
+{
+  if (IsNull(p_old_module) || IsNull(p_new_module) || IsNull(p_diff)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  memset(p_diff, 0, sizeof(*p_diff));
+  SpvReflectResult result = ParseModuleDiff(p_old_module, p_new_module, p_diff);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyModuleDiff(p_diff);
+    return result;
+  }
+
+  // Release the lists that stayed empty
+  if (p_diff->binding_diff_count == 0) {
+    SafeFree(p_diff->binding_diffs);
+  }
+  if (p_diff->push_constant_diff_count == 0) {
+    SafeFree(p_diff->push_constant_diffs);
+  }
+  if (p_diff->input_variable_diff_count == 0) {
+    SafeFree(p_diff->input_variable_diffs);
+  }
+  if (p_diff->output_variable_diff_count == 0) {
+    SafeFree(p_diff->output_variable_diffs);
+  }
+  if (p_diff->member_diff_count == 0) {
+    SafeFree(p_diff->member_diffs);
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+void spvReflectDestroyModuleDiff(SpvReflectModuleDiff* p_diff)
+{
+  if (IsNull(p_diff)) {
+    return;
+  }
+  SafeFree(p_diff->binding_diffs);
+  SafeFree(p_diff->push_constant_diffs);
+  SafeFree(p_diff->input_variable_diffs);
+  SafeFree(p_diff->output_variable_diffs);
+  SafeFree(p_diff->member_diffs);
+  memset(p_diff, 0, sizeof(*p_diff));
+}
+
+static const uint32_t kDefaultFramesInFlight = 2;
+static const uint32_t kDefaultRuntimeArraySize = 1024;
+
+// Runtime arrays only reflect the sizes of their inner dimensions
+static uint32_t GetPoolDescriptorCount(const SpvReflectDescriptorBinding* p_binding, uint32_t runtime_array_size)
+{
+  if (IsNotNull(p_binding->type_description) && (p_binding->type_description->op == SpvOpTypeRuntimeArray)) {
+    return p_binding->count * runtime_array_size;
+  }
+  return p_binding->count;
+}
+
+SpvReflectResult spvReflectPlanDescriptorPools(
+  uint32_t                                demand_count,
+  const SpvReflectDescriptorSetDemand*    p_demands,
+  const SpvReflectDescriptorPoolOptions*  p_options,
+  SpvReflectDescriptorPoolPlan*           p_plan
+)
+{
+  if (IsNull(p_plan)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if ((demand_count > 0) && IsNull(p_demands)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  uint32_t frames_in_flight = kDefaultFramesInFlight;
+  uint32_t sets_per_chunk = 0;
+  uint32_t runtime_array_size = kDefaultRuntimeArraySize;
+  if (IsNotNull(p_options)) {
+    if (p_options->frames_in_flight > 0) {
+      frames_in_flight = p_options->frames_in_flight;
+    }
+    sets_per_chunk = p_options->sets_per_chunk;
+    if (p_options->runtime_array_size > 0) {
+      runtime_array_size = p_options->runtime_array_size;
+    }
+  }
+
+  uint64_t frame_set_count = 0;
+  uint64_t descriptor_counts[SPV_REFLECT_MAX_DESCRIPTOR_TYPES] = { 0 };
+  uint32_t max_set_counts[SPV_REFLECT_MAX_DESCRIPTOR_TYPES] = { 0 };
+  for (uint32_t i = 0; i < demand_count; ++i) {
+    const SpvReflectDescriptorSetDemand* p_demand = &p_demands[i];
+    if (IsNull(p_demand->p_module)) {
+      return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+    }
+    SpvReflectResult result = SPV_REFLECT_RESULT_SUCCESS;
+    const SpvReflectDescriptorSet* p_set = spvReflectGetDescriptorSet(p_demand->p_module, p_demand->set, &result);
+    if (IsNull(p_set)) {
+      return result;
+    }
+
+    uint32_t set_counts[SPV_REFLECT_MAX_DESCRIPTOR_TYPES] = { 0 };
+    for (uint32_t j = 0; j < p_set->binding_count; ++j) {
+      const SpvReflectDescriptorBinding* p_binding = p_set->bindings[j];
+      // Aliased variables share one descriptor, and a set's bindings are
+      // sorted by binding number
+      if ((j > 0) && (p_set->bindings[j - 1]->binding == p_binding->binding)) {
+        continue;
+      }
+      if ((uint32_t)p_binding->descriptor_type >= SPV_REFLECT_MAX_DESCRIPTOR_TYPES) {
+        continue;
+      }
+      set_counts[p_binding->descriptor_type] += GetPoolDescriptorCount(p_binding, runtime_array_size);
+    }
+    for (uint32_t type = 0; type < SPV_REFLECT_MAX_DESCRIPTOR_TYPES; ++type) {
+      descriptor_counts[type] += (uint64_t)set_counts[type] * p_demand->instances_per_frame;
+      if (p_demand->instances_per_frame > 0) {
+        max_set_counts[type] = Max(max_set_counts[type], set_counts[type]);
+      }
+    }
+    frame_set_count += p_demand->instances_per_frame;
+  }
+
+  uint64_t max_sets = frame_set_count * frames_in_flight;
+  if (max_sets > UINT32_MAX) {
+    return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+  }
+  for (uint32_t type = 0; type < SPV_REFLECT_MAX_DESCRIPTOR_TYPES; ++type) {
+    descriptor_counts[type] *= frames_in_flight;
+    if (descriptor_counts[type] > UINT32_MAX) {
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+  }
+
+  memset(p_plan, 0, sizeof(*p_plan));
+  if (max_sets == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  p_plan->max_sets = (uint32_t)max_sets;
+  // One chunk per frame lets each frame's pool be reset on its own
+  p_plan->chunk_max_sets = (sets_per_chunk > 0) ? Min(sets_per_chunk, p_plan->max_sets) : (uint32_t)frame_set_count;
+  p_plan->chunk_count = (p_plan->max_sets + p_plan->chunk_max_sets - 1) / p_plan->chunk_max_sets;
+  for (uint32_t type = 0; type < SPV_REFLECT_MAX_DESCRIPTOR_TYPES; ++type) {
+    if (descriptor_counts[type] == 0) {
+      continue;
+    }
+    SpvReflectDescriptorPoolSize* p_size = &p_plan->pool_sizes[p_plan->pool_size_count];
+    p_size->descriptor_type = (SpvReflectDescriptorType)type;
+    p_size->descriptor_count = (uint32_t)descriptor_counts[type];
+    p_size->max_set_count = max_set_counts[type];
+    uint64_t chunk_share = (descriptor_counts[type] * p_plan->chunk_max_sets + max_sets - 1) / max_sets;
+    p_size->chunk_descriptor_count = Max((uint32_t)chunk_share, max_set_counts[type]);
+    ++(p_plan->pool_size_count);
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static int SortCompareBindlessRange(const void* a, const void* b)
+{
+  const SpvReflectBindlessRange* p_elem_a = (const SpvReflectBindlessRange*)a;
+  const SpvReflectBindlessRange* p_elem_b = (const SpvReflectBindlessRange*)b;
+  if (p_elem_a->descriptor_type != p_elem_b->descriptor_type) {
+    return (p_elem_a->descriptor_type < p_elem_b->descriptor_type) ? -1 : 1;
+  }
+  if (p_elem_a->set != p_elem_b->set) {
+    return (p_elem_a->set < p_elem_b->set) ? -1 : 1;
+  }
+  if (p_elem_a->binding != p_elem_b->binding) {
+    return (p_elem_a->binding < p_elem_b->binding) ? -1 : 1;
+  }
+  return 0;
+}
+
+static bool IsBindlessDescriptorType(SpvReflectDescriptorType descriptor_type)
+{
+  return ((uint32_t)descriptor_type < SPV_REFLECT_MAX_DESCRIPTOR_TYPES) &&
+         (descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_INPUT_ATTACHMENT);
+}
+
+static SpvReflectResult ParseBindlessPlan(uint32_t                              module_count,
+                                          const SpvReflectShaderModule* const*  pp_modules,
+                                          uint32_t                              runtime_array_size,
+                                          SpvReflectBindlessPlan*               p_plan)
+{
+  uint32_t binding_count = 0;
+  for (uint32_t i = 0; i < module_count; ++i) {
+    if (IsNull(pp_modules[i])) {
+      return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+    }
+    binding_count += pp_modules[i]->descriptor_binding_count;
+  }
+  if (binding_count > 0) {
+    p_plan->ranges = (SpvReflectBindlessRange*)calloc(binding_count, sizeof(*(p_plan->ranges)));
+    if (IsNull(p_plan->ranges)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+  if (module_count > 0) {
+    p_plan->module_remaps = (SpvReflectBindlessModuleRemap*)calloc(module_count, sizeof(*(p_plan->module_remaps)));
+    if (IsNull(p_plan->module_remaps)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    p_plan->module_count = module_count;
+  }
+
+  // Distinct bindings, with the largest count any module declares
+  for (uint32_t i = 0; i < module_count; ++i) {
+    const SpvReflectShaderModule* p_module = pp_modules[i];
+    for (uint32_t j = 0; j < p_module->descriptor_binding_count; ++j) {
+      const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[j];
+      if (!IsBindlessDescriptorType(p_binding->descriptor_type)) {
+        continue;
+      }
+      SpvReflectBindlessRange* p_range = &p_plan->ranges[p_plan->range_count++];
+      p_range->descriptor_type = p_binding->descriptor_type;
+      p_range->set = p_binding->set;
+      p_range->binding = p_binding->binding;
+      p_range->count = GetPoolDescriptorCount(p_binding, runtime_array_size);
+    }
+  }
+  if (p_plan->range_count > 0) {
+    qsort(p_plan->ranges, p_plan->range_count, sizeof(*(p_plan->ranges)), SortCompareBindlessRange);
+  }
+  uint32_t range_count = 0;
+  for (uint32_t i = 0; i < p_plan->range_count; ++i) {
+    const SpvReflectBindlessRange* p_range = &p_plan->ranges[i];
+    if ((range_count > 0) && (SortCompareBindlessRange(&p_plan->ranges[range_count - 1], p_range) == 0)) {
+      p_plan->ranges[range_count - 1].count = Max(p_plan->ranges[range_count - 1].count, p_range->count);
+    }
+    else {
+      p_plan->ranges[range_count++] = *p_range;
+    }
+  }
+  p_plan->range_count = range_count;
+
+  // Lay the ranges out back to back, one array per descriptor type
+  for (uint32_t i = 0; i < p_plan->range_count; ++i) {
+    SpvReflectBindlessRange* p_range = &p_plan->ranges[i];
+    if ((p_plan->array_count == 0) ||
+        (p_plan->arrays[p_plan->array_count - 1].descriptor_type != p_range->descriptor_type)) {
+      SpvReflectBindlessArray* p_array = &p_plan->arrays[p_plan->array_count];
+      p_array->descriptor_type = p_range->descriptor_type;
+      p_array->binding = p_plan->array_count;
+      ++(p_plan->array_count);
+    }
+    SpvReflectBindlessArray* p_array = &p_plan->arrays[p_plan->array_count - 1];
+    if (p_range->count > UINT32_MAX - p_array->descriptor_count) {
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+    p_range->array_binding = p_array->binding;
+    p_range->base = p_array->descriptor_count;
+    p_array->descriptor_count += p_range->count;
+  }
+
+  for (uint32_t i = 0; i < module_count; ++i) {
+    const SpvReflectShaderModule* p_module = pp_modules[i];
+    SpvReflectBindlessModuleRemap* p_module_remap = &p_plan->module_remaps[i];
+    if (p_module->descriptor_binding_count == 0) {
+      continue;
+    }
+    p_module_remap->remaps = (SpvReflectBindlessBindingRemap*)calloc(p_module->descriptor_binding_count,
+                                                                     sizeof(*(p_module_remap->remaps)));
+    if (IsNull(p_module_remap->remaps)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    for (uint32_t j = 0; j < p_module->descriptor_binding_count; ++j) {
+      const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[j];
+      if (!IsBindlessDescriptorType(p_binding->descriptor_type)) {
+        continue;
+      }
+      SpvReflectBindlessRange key;
+      memset(&key, 0, sizeof(key));
+      key.descriptor_type = p_binding->descriptor_type;
+      key.set = p_binding->set;
+      key.binding = p_binding->binding;
+      const SpvReflectBindlessRange* p_range = (const SpvReflectBindlessRange*)bsearch(&key, p_plan->ranges,
+                                                                                     p_plan->range_count,
+                                                                                     sizeof(*(p_plan->ranges)),
+                                                                                     SortCompareBindlessRange);
+      if (IsNull(p_range)) {
+        return SPV_REFLECT_RESULT_ERROR_INTERNAL_ERROR;
+      }
+      SpvReflectBindlessBindingRemap* p_remap = &p_module_remap->remaps[p_module_remap->remap_count++];
+      p_remap->spirv_id = p_binding->spirv_id;
+      p_remap->set = p_binding->set;
+      p_remap->binding = p_binding->binding;
+      p_remap->array_binding = p_range->array_binding;
+      p_remap->base = p_range->base;
+      p_remap->count = p_range->count;
+    }
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+SpvReflectResult spvReflectPlanBindlessTable(
+  uint32_t                             module_count,
+  const SpvReflectShaderModule* const* pp_modules,
+  uint32_t                             set,
+  uint32_t                             runtime_array_size,
+  SpvReflectBindlessPlan*              p_plan
+)
+{
+  if (IsNull(p_plan)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if ((module_count > 0) && IsNull(pp_modules)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  memset(p_plan, 0, sizeof(*p_plan));
+  p_plan->set = set;
+  SpvReflectResult result = ParseBindlessPlan(module_count, pp_modules,
+                                              (runtime_array_size > 0) ? runtime_array_size : kDefaultRuntimeArraySize,
+                                              p_plan);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyBindlessPlan(p_plan);
+    return result;
+  }
+  if (p_plan->range_count == 0) {
+    SafeFree(p_plan->ranges);
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+void spvReflectDestroyBindlessPlan(SpvReflectBindlessPlan* p_plan)
+{
+  if (IsNull(p_plan)) {
+    return;
+  }
+  for (uint32_t i = 0; IsNotNull(p_plan->module_remaps) && (i < p_plan->module_count); ++i) {
+    SafeFree(p_plan->module_remaps[i].remaps);
+  }
+  SafeFree(p_plan->module_remaps);
+  SafeFree(p_plan->ranges);
+  p_plan->module_count = 0;
+  p_plan->range_count = 0;
+  p_plan->array_count = 0;
+}
+
+// Not in the bundled spirv.h, which predates SPV_EXT_descriptor_indexing
+static const uint32_t kDecorationNonUniform = 5300;
+
+typedef struct BindlessVariable {
+  const SpvReflectBindlessBindingRemap* p_remap;
+  uint32_t                              variable_id;
+  uint32_t                              storage_class;
+  // Pointer type the variable was declared with
+  uint32_t                              pointer_type_id;
+  uint32_t                              element_type_id;
+  uint32_t                              length_constant_id;
+  uint32_t                              base_constant_id;
+  uint32_t                              array_type_id;
+  uint32_t                              array_pointer_id;
+  // Declares the array and pointer types, which later variables may share
+  bool                                  owns_types;
+  bool                                  is_arrayed;
+} BindlessVariable;
+
+typedef struct BindlessConstant {
+  uint32_t                              type_id;
+  uint32_t                              value;
+  uint32_t                              id;
+  bool                                  is_new;
+} BindlessConstant;
+
+// Index operand replacement of an access chain into an arrayed variable
+typedef struct BindlessChain {
+  uint32_t                              index_id;
+  uint32_t                              sum_id;
+  uint32_t                              index_type_id;
+  uint32_t                              base_constant_id;
+  bool                                  non_uniform;
+} BindlessChain;
+
+typedef struct BindlessRewrite {
+  const Parser*                         p_parser;
+  BindlessVariable*                     p_variables;
+  uint32_t                              variable_count;
+  // Variable index plus one, per id
+  uint32_t*                             variable_indices;
+  BindlessConstant*                     p_constants;
+  uint32_t                              constant_count;
+  // Per node
+  BindlessChain*                        p_chains;
+  uint32_t                              sum_count;
+  uint32_t                              non_uniform_count;
+  // Per function and non-arrayed variable, the access chain replacing it
+  uint32_t*                             element_ids;
+  uint32_t                              function_count;
+  uint32_t                              element_count;
+  uint32_t                              int_type_id;
+  bool                                  is_new_int_type;
+  uint32_t                              id_bound;
+} BindlessRewrite;
+
+static uint32_t GetBindlessConstant(BindlessRewrite* p_rewrite, uint32_t type_id, uint32_t value)
+{
+  for (uint32_t i = 0; i < p_rewrite->constant_count; ++i) {
+    const BindlessConstant* p_constant = &p_rewrite->p_constants[i];
+    if ((p_constant->type_id == type_id) && (p_constant->value == value)) {
+      return p_constant->id;
+    }
+  }
+  BindlessConstant* p_constant = &p_rewrite->p_constants[p_rewrite->constant_count++];
+  p_constant->type_id = type_id;
+  p_constant->value = value;
+  const Parser* p_parser = p_rewrite->p_parser;
+  for (size_t i = 0; (p_constant->id == 0) && (i < p_parser->node_count); ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if ((p_node->op == SpvOpConstant) && (p_node->word_count == 4) && (p_words[1] == type_id) && (p_words[3] == value)) {
+      p_constant->id = p_words[2];
+    }
+  }
+  if (p_constant->id == 0) {
+    p_constant->id = p_rewrite->id_bound++;
+    p_constant->is_new = true;
+  }
+  return p_constant->id;
+}
+
+static uint32_t GetIdTypeId(const Parser* p_parser, uint32_t id)
+{
+  const Node* p_node = FindIdNode(p_parser, id);
+  if (IsNull(p_node) || !HasResultAndType(p_node->op) || (p_node->word_count < 3)) {
+    return 0;
+  }
+  return p_parser->spirv_code[p_node->word_offset + 1];
+}
+
+//
+// Resolves the types of the remapped variables and allocates the ids of
+// the arrays, pointers and constants the rewrite declares.
+//
+static SpvReflectResult ParseBindlessVariables(const SpvReflectShaderModule*         p_module,
+                                               const SpvReflectBindlessPlan*         p_plan,
+                                               const SpvReflectBindlessModuleRemap*  p_module_remap,
+                                               BindlessRewrite*                      p_rewrite)
+{
+  const Parser* p_parser = p_rewrite->p_parser;
+  for (uint32_t i = 0; i < p_module_remap->remap_count; ++i) {
+    const SpvReflectBindlessBindingRemap* p_remap = &p_module_remap->remaps[i];
+    const SpvReflectDescriptorBinding* p_binding = NULL;
+    for (uint32_t j = 0; IsNull(p_binding) && (j < p_module->descriptor_binding_count); ++j) {
+      if (p_module->descriptor_bindings[j].spirv_id == p_remap->spirv_id) {
+        p_binding = &p_module->descriptor_bindings[j];
+      }
+    }
+    if (IsNull(p_binding) || (p_binding->set != p_remap->set) || (p_binding->binding != p_remap->binding) ||
+        (p_remap->spirv_id >= p_parser->id_bound) || (p_rewrite->variable_indices[p_remap->spirv_id] != 0)) {
+      return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+    }
+    if ((p_remap->array_binding >= p_plan->array_count) ||
+        (p_remap->count > p_plan->arrays[p_remap->array_binding].descriptor_count - p_remap->base) ||
+        (p_binding->count > p_remap->count)) {
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+
+    const Node* p_variable = FindIdNode(p_parser, p_remap->spirv_id);
+    const Node* p_pointer = IsNotNull(p_variable) ? FindIdNode(p_parser, p_variable->type_id) : NULL;
+    const Node* p_type = IsNotNull(p_pointer) ? FindIdNode(p_parser, p_pointer->type_id) : NULL;
+    if (IsNull(p_type) || (p_variable->op != SpvOpVariable) || (p_pointer->op != SpvOpTypePointer)) {
+      return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+    }
+    BindlessVariable* p_bindless = &p_rewrite->p_variables[p_rewrite->variable_count++];
+    p_bindless->p_remap = p_remap;
+    p_bindless->variable_id = p_remap->spirv_id;
+    p_bindless->storage_class = p_pointer->storage_class;
+    p_bindless->pointer_type_id = p_pointer->result_id;
+    p_bindless->element_type_id = p_type->result_id;
+    if ((p_type->op == SpvOpTypeArray) || (p_type->op == SpvOpTypeRuntimeArray)) {
+      p_bindless->is_arrayed = true;
+      p_bindless->element_type_id = p_parser->spirv_code[p_type->word_offset + 2];
+      const Node* p_element = FindIdNode(p_parser, p_bindless->element_type_id);
+      // Arrays of arrays would need their indices flattened
+      if (IsNull(p_element) || (p_element->op == SpvOpTypeArray) || (p_element->op == SpvOpTypeRuntimeArray)) {
+        return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+      }
+    }
+    p_rewrite->variable_indices[p_remap->spirv_id] = p_rewrite->variable_count;
+  }
+
+  for (size_t i = 0; (p_rewrite->int_type_id == 0) && (i < p_parser->node_count); ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if ((p_node->op == SpvOpTypeInt) && (p_node->word_count > 3) && (p_words[2] == 32) && (p_words[3] == 0)) {
+      p_rewrite->int_type_id = p_node->result_id;
+    }
+  }
+  if (p_rewrite->int_type_id == 0) {
+    p_rewrite->int_type_id = p_rewrite->id_bound++;
+    p_rewrite->is_new_int_type = true;
+  }
+
+  for (uint32_t i = 0; i < p_rewrite->variable_count; ++i) {
+    BindlessVariable* p_bindless = &p_rewrite->p_variables[i];
+    const SpvReflectBindlessBindingRemap* p_remap = p_bindless->p_remap;
+    p_bindless->length_constant_id = GetBindlessConstant(p_rewrite, p_rewrite->int_type_id,
+                                                         p_plan->arrays[p_remap->array_binding].descriptor_count);
+    if (!p_bindless->is_arrayed) {
+      p_bindless->base_constant_id = GetBindlessConstant(p_rewrite, p_rewrite->int_type_id, p_remap->base);
+    }
+    for (uint32_t j = 0; (p_bindless->array_type_id == 0) && (j < i); ++j) {
+      const BindlessVariable* p_other = &p_rewrite->p_variables[j];
+      if ((p_other->element_type_id == p_bindless->element_type_id) &&
+          (p_other->storage_class == p_bindless->storage_class) &&
+          (p_other->length_constant_id == p_bindless->length_constant_id)) {
+        p_bindless->array_type_id = p_other->array_type_id;
+        p_bindless->array_pointer_id = p_other->array_pointer_id;
+      }
+    }
+    if (p_bindless->array_type_id == 0) {
+      p_bindless->array_type_id = p_rewrite->id_bound++;
+      p_bindless->array_pointer_id = p_rewrite->id_bound++;
+      p_bindless->owns_types = true;
+    }
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+//
+// Finds the functions that use each non-arrayed variable and offsets the
+// index of every access chain into an arrayed one.
+//
+static SpvReflectResult ParseBindlessUses(BindlessRewrite* p_rewrite)
+{
+  const Parser* p_parser = p_rewrite->p_parser;
+  bool* non_uniform = (bool*)calloc(p_parser->id_bound, sizeof(*non_uniform));
+  if (IsNull(non_uniform)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if ((p_node->op == SpvOpDecorate) && (p_node->word_count > 2) && (p_words[2] == kDecorationNonUniform) &&
+        (p_words[1] < p_parser->id_bound)) {
+      non_uniform[p_words[1]] = true;
+    }
+  }
+
+  SpvReflectResult result = SPV_REFLECT_RESULT_SUCCESS;
+  int64_t function_index = -1;
+  bool in_function = false;
+  for (size_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < p_parser->node_count); ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if (p_node->op == SpvOpFunction) {
+      ++function_index;
+      in_function = true;
+    }
+    else if (p_node->op == SpvOpFunctionEnd) {
+      in_function = false;
+    }
+    if (!in_function) {
+      continue;
+    }
+    for (uint32_t k = 1; (result == SPV_REFLECT_RESULT_SUCCESS) && (k < p_node->word_count); ++k) {
+      if ((p_words[k] >= p_parser->id_bound) || (p_rewrite->variable_indices[p_words[k]] == 0) ||
+          !IsIdOperand(p_parser, p_node->op, p_words, p_node->word_count, k)) {
+        continue;
+      }
+      uint32_t variable_index = p_rewrite->variable_indices[p_words[k]] - 1;
+      const BindlessVariable* p_bindless = &p_rewrite->p_variables[variable_index];
+      if (!p_bindless->is_arrayed) {
+        uint32_t* p_element_id = &p_rewrite->element_ids[function_index * p_rewrite->variable_count + variable_index];
+        if (*p_element_id == 0) {
+          *p_element_id = p_rewrite->id_bound++;
+          ++(p_rewrite->element_count);
+        }
+        continue;
+      }
+      // Pointer arithmetic could step outside the variable's range
+      if (((p_node->op != SpvOpAccessChain) && (p_node->op != SpvOpInBoundsAccessChain)) || (k != 3) ||
+          (p_node->word_count < 5)) {
+        result = SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_STORAGE_CLASS;
+        continue;
+      }
+      BindlessChain* p_chain = &p_rewrite->p_chains[i];
+      uint32_t base = p_bindless->p_remap->base;
+      uint32_t index_id = p_words[4];
+      const Node* p_index = FindIdNode(p_parser, index_id);
+      p_chain->index_id = index_id;
+      if (IsNotNull(p_index) && (p_index->op == SpvOpConstant) && (p_index->word_count == 4)) {
+        const uint32_t* p_index_words = p_parser->spirv_code + p_index->word_offset;
+        p_chain->index_id = GetBindlessConstant(p_rewrite, p_index_words[1], p_index_words[3] + base);
+      }
+      else if (base > 0) {
+        p_chain->index_type_id = GetIdTypeId(p_parser, index_id);
+        if (p_chain->index_type_id == 0) {
+          result = SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+          continue;
+        }
+        p_chain->base_constant_id = GetBindlessConstant(p_rewrite, p_chain->index_type_id, base);
+        p_chain->sum_id = p_rewrite->id_bound++;
+        p_chain->index_id = p_chain->sum_id;
+        p_chain->non_uniform = (index_id < p_parser->id_bound) && non_uniform[index_id];
+        p_rewrite->sum_count += 1;
+        p_rewrite->non_uniform_count += p_chain->non_uniform ? 1 : 0;
+      }
+    }
+  }
+  SafeFree(non_uniform);
+  return result;
+}
+
+static uint32_t WriteBindlessDecorations(const BindlessRewrite* p_rewrite, uint32_t* p_code)
+{
+  const Parser* p_parser = p_rewrite->p_parser;
+  uint32_t word_count = 0;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    if (p_rewrite->p_chains[i].non_uniform) {
+      p_code[word_count++] = (3 << 16) | SpvOpDecorate;
+      p_code[word_count++] = p_rewrite->p_chains[i].sum_id;
+      p_code[word_count++] = kDecorationNonUniform;
+    }
+  }
+  return word_count;
+}
+
+//
+// Declares the new types and constants, then the remapped variables with
+// their array types. Written after the last global declaration so every
+// type the arrays refer to is already declared.
+//
+static uint32_t WriteBindlessGlobals(const BindlessRewrite* p_rewrite, uint32_t* p_code)
+{
+  const Parser* p_parser = p_rewrite->p_parser;
+  uint32_t word_count = 0;
+  if (p_rewrite->is_new_int_type) {
+    p_code[word_count++] = (4 << 16) | SpvOpTypeInt;
+    p_code[word_count++] = p_rewrite->int_type_id;
+    p_code[word_count++] = 32;
+    p_code[word_count++] = 0;
+  }
+  for (uint32_t i = 0; i < p_rewrite->constant_count; ++i) {
+    const BindlessConstant* p_constant = &p_rewrite->p_constants[i];
+    if (p_constant->is_new) {
+      p_code[word_count++] = (4 << 16) | SpvOpConstant;
+      p_code[word_count++] = p_constant->type_id;
+      p_code[word_count++] = p_constant->id;
+      p_code[word_count++] = p_constant->value;
+    }
+  }
+  for (uint32_t i = 0; i < p_rewrite->variable_count; ++i) {
+    const BindlessVariable* p_bindless = &p_rewrite->p_variables[i];
+    if (!p_bindless->owns_types) {
+      continue;
+    }
+    p_code[word_count++] = (4 << 16) | SpvOpTypeArray;
+    p_code[word_count++] = p_bindless->array_type_id;
+    p_code[word_count++] = p_bindless->element_type_id;
+    p_code[word_count++] = p_bindless->length_constant_id;
+    p_code[word_count++] = (4 << 16) | SpvOpTypePointer;
+    p_code[word_count++] = p_bindless->array_pointer_id;
+    p_code[word_count++] = p_bindless->storage_class;
+    p_code[word_count++] = p_bindless->array_type_id;
+  }
+  for (uint32_t i = 0; i < p_rewrite->variable_count; ++i) {
+    const BindlessVariable* p_bindless = &p_rewrite->p_variables[i];
+    const Node* p_variable = FindIdNode(p_parser, p_bindless->variable_id);
+    uint32_t* p_copy = p_code + word_count;
+    memcpy(p_copy, p_parser->spirv_code + p_variable->word_offset, p_variable->word_count * SPIRV_WORD_SIZE);
+    p_copy[1] = p_bindless->array_pointer_id;
+    word_count += p_variable->word_count;
+  }
+  return word_count;
+}
+
+static uint32_t WriteBindlessElements(const BindlessRewrite* p_rewrite, uint32_t function_index, uint32_t* p_code)
+{
+  uint32_t word_count = 0;
+  for (uint32_t i = 0; i < p_rewrite->variable_count; ++i) {
+    const BindlessVariable* p_bindless = &p_rewrite->p_variables[i];
+    uint32_t element_id = p_rewrite->element_ids[function_index * p_rewrite->variable_count + i];
+    if (element_id == 0) {
+      continue;
+    }
+    p_code[word_count++] = (5 << 16) | SpvOpAccessChain;
+    p_code[word_count++] = p_bindless->pointer_type_id;
+    p_code[word_count++] = element_id;
+    p_code[word_count++] = p_bindless->variable_id;
+    p_code[word_count++] = p_bindless->base_constant_id;
+  }
+  return word_count;
+}
+
+//
+// Copies the module's instructions into p_code with the remapped variables
+// declared as arrays and their uses addressing the variables' ranges.
+// Returns the new word count.
+//
+static uint32_t WriteBindlessCode(const BindlessRewrite* p_rewrite, uint32_t* p_code)
+{
+  const Parser* p_parser = p_rewrite->p_parser;
+  uint32_t word_count = (p_parser->node_count > 0) ? p_parser->nodes[0].word_offset : 0;
+  memcpy(p_code, p_parser->spirv_code, word_count * SPIRV_WORD_SIZE);
+  p_code[3] = p_rewrite->id_bound;
+
+  bool decorations_written = false;
+  bool globals_written = false;
+  int64_t function_index = -1;
+  bool in_function = false;
+  bool label_seen = false;
+  // Between a function's first OpLabel and its first non-variable instruction
+  bool in_entry_block = false;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    const Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if (!decorations_written && !IsModulePreambleOp(p_node->op) && !IsAnnotationOp(p_node->op)) {
+      word_count += WriteBindlessDecorations(p_rewrite, p_code + word_count);
+      decorations_written = true;
+    }
+    if (!globals_written && (p_node->op == SpvOpFunction)) {
+      word_count += WriteBindlessGlobals(p_rewrite, p_code + word_count);
+      globals_written = true;
+    }
+    if (p_node->op == SpvOpFunction) {
+      ++function_index;
+      in_function = true;
+      label_seen = false;
+    }
+    if (!in_function) {
+      if ((p_node->op == SpvOpVariable) && (p_words[2] < p_parser->id_bound) &&
+          (p_rewrite->variable_indices[p_words[2]] != 0)) {
+        continue;
+      }
+      memcpy(p_code + word_count, p_words, p_node->word_count * SPIRV_WORD_SIZE);
+      word_count += p_node->word_count;
+      continue;
+    }
+
+    if (in_entry_block && (p_node->op != SpvOpVariable) && (p_node->op != SpvOpLine) && (p_node->op != SpvOpNoLine)) {
+      word_count += WriteBindlessElements(p_rewrite, (uint32_t)function_index, p_code + word_count);
+      in_entry_block = false;
+    }
+    const BindlessChain* p_chain = &p_rewrite->p_chains[i];
+    if (p_chain->sum_id != 0) {
+      p_code[word_count++] = (5 << 16) | SpvOpIAdd;
+      p_code[word_count++] = p_chain->index_type_id;
+      p_code[word_count++] = p_chain->sum_id;
+      p_code[word_count++] = p_words[4];
+      p_code[word_count++] = p_chain->base_constant_id;
+    }
+    uint32_t* p_copy = p_code + word_count;
+    memcpy(p_copy, p_words, p_node->word_count * SPIRV_WORD_SIZE);
+    word_count += p_node->word_count;
+    if (p_chain->index_id != 0) {
+      p_copy[4] = p_chain->index_id;
+    }
+    for (uint32_t k = 1; k < p_node->word_count; ++k) {
+      if ((p_words[k] >= p_parser->id_bound) || (p_rewrite->variable_indices[p_words[k]] == 0) ||
+          !IsIdOperand(p_parser, p_node->op, p_words, p_node->word_count, k)) {
+        continue;
+      }
+      uint32_t variable_index = p_rewrite->variable_indices[p_words[k]] - 1;
+      if (!p_rewrite->p_variables[variable_index].is_arrayed) {
+        p_copy[k] = p_rewrite->element_ids[function_index * p_rewrite->variable_count + variable_index];
+      }
+    }
+
+    if (p_node->op == SpvOpFunctionEnd) {
+      in_function = false;
+    }
+    else if ((p_node->op == SpvOpLabel) && !label_seen) {
+      in_entry_block = true;
+      label_seen = true;
+    }
+  }
+  if (!globals_written) {
+    word_count += WriteBindlessGlobals(p_rewrite, p_code + word_count);
+  }
+  return word_count;
+}
+
+SpvReflectResult spvReflectApplyBindlessPlan(
+  SpvReflectShaderModule*        p_module,
+  const SpvReflectBindlessPlan*  p_plan,
+  uint32_t                       module_index
+)
+{
+  if (IsNull(p_module) || IsNull(p_plan)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if (module_index >= p_plan->module_count) {
+    return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+  }
+  if (IsEntryPointFiltered(p_module)) {
+    return SPV_REFLECT_RESULT_NOT_READY;
+  }
+  const SpvReflectBindlessModuleRemap* p_module_remap = &p_plan->module_remaps[module_index];
+  if (p_module_remap->remap_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+
+  Parser parser;
+  BindlessRewrite rewrite;
+  memset(&rewrite, 0, sizeof(rewrite));
+  uint32_t* p_code = NULL;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  uint32_t function_count = 0;
+  for (size_t i = 0; i < parser.node_count; ++i) {
+    function_count += (parser.nodes[i].op == SpvOpFunction) ? 1 : 0;
+  }
+  rewrite.p_parser = &parser;
+  rewrite.id_bound = parser.id_bound;
+  rewrite.function_count = function_count;
+  rewrite.p_variables = (BindlessVariable*)calloc(p_module_remap->remap_count, sizeof(*(rewrite.p_variables)));
+  rewrite.variable_indices = (uint32_t*)calloc(parser.id_bound, sizeof(*(rewrite.variable_indices)));
+  // A length and base per variable, and at most one constant per chain
+  rewrite.p_constants = (BindlessConstant*)calloc(2 * p_module_remap->remap_count + parser.node_count,
+                                                  sizeof(*(rewrite.p_constants)));
+  rewrite.p_chains = (BindlessChain*)calloc(parser.node_count + 1, sizeof(*(rewrite.p_chains)));
+  rewrite.element_ids = (uint32_t*)calloc((size_t)function_count * p_module_remap->remap_count + 1,
+                                          sizeof(*(rewrite.element_ids)));
+  if (IsNull(rewrite.p_variables) || IsNull(rewrite.variable_indices) || IsNull(rewrite.p_constants) ||
+      IsNull(rewrite.p_chains) || IsNull(rewrite.element_ids)) {
+    result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseBindlessVariables(p_module, p_plan, p_module_remap, &rewrite);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseBindlessUses(&rewrite);
+  }
+
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    size_t extra_word_count = 4 + 4 * (size_t)rewrite.constant_count + 8 * (size_t)rewrite.variable_count +
+                              5 * (size_t)rewrite.element_count + 5 * (size_t)rewrite.sum_count +
+                              3 * (size_t)rewrite.non_uniform_count;
+    p_code = (uint32_t*)calloc(parser.spirv_word_count + extra_word_count, sizeof(*p_code));
+    if (IsNull(p_code)) {
+      result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+  }
+  // Re-reflect the rewritten module and move its variables into the
+  // table, keeping the original on failure
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    uint32_t word_count = WriteBindlessCode(&rewrite, p_code);
+    SpvReflectShaderModule module;
+    result = spvReflectCreateShaderModule(word_count * SPIRV_WORD_SIZE, p_code, &module);
+    for (uint32_t i = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (i < rewrite.variable_count); ++i) {
+      const SpvReflectBindlessBindingRemap* p_remap = rewrite.p_variables[i].p_remap;
+      const SpvReflectDescriptorBinding* p_binding = NULL;
+      for (uint32_t j = 0; IsNull(p_binding) && (j < module.descriptor_binding_count); ++j) {
+        if (module.descriptor_bindings[j].spirv_id == p_remap->spirv_id) {
+          p_binding = &module.descriptor_bindings[j];
+        }
+      }
+      result = IsNotNull(p_binding)
+                 ? spvReflectChangeDescriptorBindingNumbers(&module, p_binding, p_remap->array_binding, p_plan->set)
+                 : SPV_REFLECT_RESULT_ERROR_INTERNAL_ERROR;
+      if (result != SPV_REFLECT_RESULT_SUCCESS) {
+        spvReflectDestroyShaderModule(&module);
+      }
+    }
+    if (result == SPV_REFLECT_RESULT_SUCCESS) {
+      spvReflectDestroyShaderModule(p_module);
+      *p_module = module;
+    }
+  }
+
+  SafeFree(rewrite.p_variables);
+  SafeFree(rewrite.variable_indices);
+  SafeFree(rewrite.p_constants);
+  SafeFree(rewrite.p_chains);
+  SafeFree(rewrite.element_ids);
+  SafeFree(p_code);
+  DestroyParser(&parser);
+  return result;
+}
+
+static void HashString(FingerprintHasher* p_hasher, const char* name)
+{
+  size_t length = IsNotNull(name) ? strlen(name) : 0;
+  HashWord(p_hasher, (uint32_t)length);
+  for (size_t i = 0; i < length; i += SPIRV_WORD_SIZE) {
+    uint32_t word = 0;
+    for (size_t j = 0; (j < SPIRV_WORD_SIZE) && (i + j < length); ++j) {
+      word |= (uint32_t)(uint8_t)name[i + j] << (8 * j);
+    }
+    HashWord(p_hasher, word);
+  }
+}
+
+static void HashBlockMembers(FingerprintHasher* p_hasher, const SpvReflectBlockVariable* p_block)
+{
+  const SpvReflectTypeFlags type_mask = SPV_REFLECT_TYPE_FLAG_BOOL | SPV_REFLECT_TYPE_FLAG_INT |
+                                        SPV_REFLECT_TYPE_FLAG_FLOAT | SPV_REFLECT_TYPE_FLAG_VECTOR |
+                                        SPV_REFLECT_TYPE_FLAG_MATRIX | SPV_REFLECT_TYPE_FLAG_STRUCT |
+                                        SPV_REFLECT_TYPE_FLAG_ARRAY;
+  const SpvReflectDecorationFlags decoration_mask = SPV_REFLECT_DECORATION_ROW_MAJOR |
+                                                    SPV_REFLECT_DECORATION_COLUMN_MAJOR;
+  HashWord(p_hasher, p_block->member_count);
+  for (uint32_t i = 0; i < p_block->member_count; ++i) {
+    const SpvReflectBlockVariable* p_member = &p_block->members[i];
+    HashString(p_hasher, p_member->name);
+    HashWord(p_hasher, p_member->offset);
+    HashWord(p_hasher, p_member->size);
+    HashWord(p_hasher, p_member->padded_size);
+    HashWord(p_hasher, p_member->decoration_flags & decoration_mask);
+    HashWord(p_hasher, IsNotNull(p_member->type_description) ? (p_member->type_description->type_flags & type_mask) : 0);
+    HashWord(p_hasher, p_member->numeric.scalar.width);
+    HashWord(p_hasher, p_member->numeric.scalar.signedness);
+    HashWord(p_hasher, p_member->numeric.vector.component_count);
+    HashWord(p_hasher, p_member->numeric.matrix.column_count);
+    HashWord(p_hasher, p_member->numeric.matrix.row_count);
+    HashWord(p_hasher, p_member->numeric.matrix.stride);
+    HashWord(p_hasher, p_member->array.dims_count);
+    for (uint32_t j = 0; j < p_member->array.dims_count; ++j) {
+      HashWord(p_hasher, p_member->array.dims[j]);
+    }
+    HashWord(p_hasher, p_member->array.stride);
+    HashBlockMembers(p_hasher, p_member);
+  }
+}
+
+SpvReflectResult spvReflectGetBlockLayoutFingerprint(
+  const SpvReflectBlockVariable*  p_block,
+  SpvReflectFingerprint*          p_fingerprint
+)
+{
+  if (IsNull(p_block) || IsNull(p_fingerprint)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  FingerprintHasher hasher;
+  BeginHash(&hasher, FINGERPRINT_KIND_BLOCK_LAYOUT);
+  HashWord(&hasher, p_block->size);
+  HashBlockMembers(&hasher, p_block);
+  FinishHash(&hasher, p_fingerprint);
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+typedef struct SharedBlockEntry {
+  SpvReflectFingerprint                 layout;
+  uint32_t                              module_index;
+  const SpvReflectDescriptorBinding*    p_binding;
+} SharedBlockEntry;
+
+// Bindings that can share a buffer compare equal up to module_index
+static int CompareSharedBlockLayout(const SharedBlockEntry* p_a, const SharedBlockEntry* p_b)
+{
+  if (p_a->p_binding->descriptor_type != p_b->p_binding->descriptor_type) {
+    return (p_a->p_binding->descriptor_type < p_b->p_binding->descriptor_type) ? -1 : 1;
+  }
+  if (p_a->p_binding->count != p_b->p_binding->count) {
+    return (p_a->p_binding->count < p_b->p_binding->count) ? -1 : 1;
+  }
+  for (uint32_t i = 0; i < 2; ++i) {
+    if (p_a->layout.value[i] != p_b->layout.value[i]) {
+      return (p_a->layout.value[i] < p_b->layout.value[i]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+static int SortCompareSharedBlockEntry(const void* a, const void* b)
+{
+  const SharedBlockEntry* p_elem_a = (const SharedBlockEntry*)a;
+  const SharedBlockEntry* p_elem_b = (const SharedBlockEntry*)b;
+  int layout_order = CompareSharedBlockLayout(p_elem_a, p_elem_b);
+  if (layout_order != 0) {
+    return layout_order;
+  }
+  if (p_elem_a->module_index != p_elem_b->module_index) {
+    return (p_elem_a->module_index < p_elem_b->module_index) ? -1 : 1;
+  }
+  if (p_elem_a->p_binding->set != p_elem_b->p_binding->set) {
+    return (p_elem_a->p_binding->set < p_elem_b->p_binding->set) ? -1 : 1;
+  }
+  if (p_elem_a->p_binding->binding != p_elem_b->p_binding->binding) {
+    return (p_elem_a->p_binding->binding < p_elem_b->p_binding->binding) ? -1 : 1;
+  }
+  return 0;
+}
+
+static int SortCompareSharedBlock(const void* a, const void* b)
+{
+  const SpvReflectSharedBlock* p_elem_a = (const SpvReflectSharedBlock*)a;
+  const SpvReflectSharedBlock* p_elem_b = (const SpvReflectSharedBlock*)b;
+  if (p_elem_a->module_count != p_elem_b->module_count) {
+    return (p_elem_a->module_count > p_elem_b->module_count) ? -1 : 1;
+  }
+  if (p_elem_a->set != p_elem_b->set) {
+    return (p_elem_a->set < p_elem_b->set) ? -1 : 1;
+  }
+  if (p_elem_a->binding != p_elem_b->binding) {
+    return (p_elem_a->binding < p_elem_b->binding) ? -1 : 1;
+  }
+  for (uint32_t i = 0; i < 2; ++i) {
+    if (p_elem_a->layout.value[i] != p_elem_b->layout.value[i]) {
+      return (p_elem_a->layout.value[i] < p_elem_b->layout.value[i]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// Whether set and binding are unused in the block's modules, other than
+// by the block itself
+static bool IsSharedBlockLocationFree(const SpvReflectShaderModule* const*  pp_modules,
+                                      const SpvReflectSharedBlock*          p_block,
+                                      uint32_t                              set,
+                                      uint32_t                              binding)
+{
+  for (uint32_t i = 0; i < p_block->binding_count; ++i) {
+    uint32_t module_index = p_block->bindings[i].module_index;
+    if ((i > 0) && (p_block->bindings[i - 1].module_index == module_index)) {
+      continue;
+    }
+    const SpvReflectShaderModule* p_module = pp_modules[module_index];
+    for (uint32_t j = 0; j < p_module->descriptor_binding_count; ++j) {
+      const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[j];
+      if ((p_binding->set != set) || (p_binding->binding != binding)) {
+        continue;
+      }
+      bool is_block_binding = false;
+      for (uint32_t k = 0; !is_block_binding && (k < p_block->binding_count); ++k) {
+        is_block_binding = (p_block->bindings[k].module_index == module_index) &&
+                           (p_block->bindings[k].spirv_id == p_binding->spirv_id);
+      }
+      if (!is_block_binding) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//
+// Picks the location most of the block's bindings already use, so the
+// fewest modules change, skipping locations taken by other bindings.
+//
+static void ParseSharedBlockLocation(const SpvReflectShaderModule* const* pp_modules, SpvReflectSharedBlock* p_block)
+{
+  uint32_t best_uses = 0;
+  bool found = false;
+  for (uint32_t i = 0; i < p_block->binding_count; ++i) {
+    const SpvReflectSharedBlockBinding* p_candidate = &p_block->bindings[i];
+    uint32_t uses = 0;
+    for (uint32_t j = 0; j < p_block->binding_count; ++j) {
+      uses += ((p_block->bindings[j].set == p_candidate->set) &&
+               (p_block->bindings[j].binding == p_candidate->binding)) ? 1 : 0;
+    }
+    bool is_better = !found || (uses > best_uses) ||
+                     ((uses == best_uses) &&
+                      ((p_candidate->set < p_block->set) ||
+                       ((p_candidate->set == p_block->set) && (p_candidate->binding < p_block->binding))));
+    if (is_better && IsSharedBlockLocationFree(pp_modules, p_block, p_candidate->set, p_candidate->binding)) {
+      p_block->set = p_candidate->set;
+      p_block->binding = p_candidate->binding;
+      best_uses = uses;
+      found = true;
+    }
+  }
+  if (found) {
+    return;
+  }
+
+  // Past every binding of the most common set
+  uint32_t set_uses = 0;
+  for (uint32_t i = 0; i < p_block->binding_count; ++i) {
+    uint32_t uses = 0;
+    for (uint32_t j = 0; j < p_block->binding_count; ++j) {
+      uses += (p_block->bindings[j].set == p_block->bindings[i].set) ? 1 : 0;
+    }
+    if ((uses > set_uses) || ((uses == set_uses) && (p_block->bindings[i].set < p_block->set))) {
+      p_block->set = p_block->bindings[i].set;
+      set_uses = uses;
+    }
+  }
+  p_block->binding = 0;
+  for (uint32_t i = 0; i < p_block->binding_count; ++i) {
+    const SpvReflectShaderModule* p_module = pp_modules[p_block->bindings[i].module_index];
+    for (uint32_t j = 0; j < p_module->descriptor_binding_count; ++j) {
+      const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[j];
+      if (p_binding->set == p_block->set) {
+        p_block->binding = Max(p_block->binding, p_binding->binding + 1);
+      }
+    }
+  }
+}
+
+static SpvReflectResult ParseSharedBlocks(uint32_t                              module_count,
+                                          const SpvReflectShaderModule* const*  pp_modules,
+                                          SpvReflectSharedBlockReport*          p_report)
+{
+  uint32_t entry_count = 0;
+  for (uint32_t i = 0; i < module_count; ++i) {
+    if (IsNull(pp_modules[i])) {
+      return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+    }
+    entry_count += pp_modules[i]->descriptor_binding_count;
+  }
+  if (entry_count == 0) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  SharedBlockEntry* p_entries = (SharedBlockEntry*)calloc(entry_count, sizeof(*p_entries));
+  if (IsNull(p_entries)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  entry_count = 0;
+  for (uint32_t i = 0; i < module_count; ++i) {
+    const SpvReflectShaderModule* p_module = pp_modules[i];
+    for (uint32_t j = 0; j < p_module->descriptor_binding_count; ++j) {
+      const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[j];
+      switch (p_binding->descriptor_type) {
+        default: continue;
+        case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: break;
+      }
+      SharedBlockEntry* p_entry = &p_entries[entry_count++];
+      p_entry->module_index = i;
+      p_entry->p_binding = p_binding;
+      spvReflectGetBlockLayoutFingerprint(&p_binding->block, &p_entry->layout);
+    }
+  }
+  if (entry_count > 0) {
+    qsort(p_entries, entry_count, sizeof(*p_entries), SortCompareSharedBlockEntry);
+  }
+
+  // Runs of equal layouts that span more than one module
+  uint32_t block_count = 0;
+  for (uint32_t begin = 0, end = 0; begin < entry_count; begin = end) {
+    uint32_t run_module_count = 1;
+    for (end = begin + 1; (end < entry_count) && (CompareSharedBlockLayout(&p_entries[begin], &p_entries[end]) == 0); ++end) {
+      run_module_count += (p_entries[end].module_index != p_entries[end - 1].module_index) ? 1 : 0;
+    }
+    block_count += (run_module_count > 1) ? 1 : 0;
+  }
+  if (block_count == 0) {
+    SafeFree(p_entries);
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  p_report->blocks = (SpvReflectSharedBlock*)calloc(block_count, sizeof(*(p_report->blocks)));
+  if (IsNull(p_report->blocks)) {
+    SafeFree(p_entries);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+
+  SpvReflectResult result = SPV_REFLECT_RESULT_SUCCESS;
+  for (uint32_t begin = 0, end = 0; (result == SPV_REFLECT_RESULT_SUCCESS) && (begin < entry_count); begin = end) {
+    uint32_t run_module_count = 1;
+    for (end = begin + 1; (end < entry_count) && (CompareSharedBlockLayout(&p_entries[begin], &p_entries[end]) == 0); ++end) {
+      run_module_count += (p_entries[end].module_index != p_entries[end - 1].module_index) ? 1 : 0;
+    }
+    if (run_module_count < 2) {
+      continue;
+    }
+    SpvReflectSharedBlock* p_block = &p_report->blocks[p_report->block_count++];
+    const SpvReflectDescriptorBinding* p_first = p_entries[begin].p_binding;
+    p_block->layout = p_entries[begin].layout;
+    p_block->descriptor_type = p_first->descriptor_type;
+    p_block->count = p_first->count;
+    p_block->size = p_first->block.size;
+    p_block->type_name = IsNotNull(p_first->type_description) ? p_first->type_description->type_name : NULL;
+    p_block->module_count = run_module_count;
+    p_block->bindings = (SpvReflectSharedBlockBinding*)calloc(end - begin, sizeof(*(p_block->bindings)));
+    if (IsNull(p_block->bindings)) {
+      result = SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+      continue;
+    }
+    for (uint32_t i = begin; i < end; ++i) {
+      SpvReflectSharedBlockBinding* p_shared = &p_block->bindings[p_block->binding_count++];
+      p_shared->module_index = p_entries[i].module_index;
+      p_shared->spirv_id = p_entries[i].p_binding->spirv_id;
+      p_shared->set = p_entries[i].p_binding->set;
+      p_shared->binding = p_entries[i].p_binding->binding;
+      p_shared->name = p_entries[i].p_binding->name;
+    }
+    ParseSharedBlockLocation(pp_modules, p_block);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    qsort(p_report->blocks, p_report->block_count, sizeof(*(p_report->blocks)), SortCompareSharedBlock);
+  }
+
+  SafeFree(p_entries);
+  return result;
+}
+
+SpvReflectResult spvReflectFindSharedBlocks(
+  uint32_t                             module_count,
+  const SpvReflectShaderModule* const* pp_modules,
+  SpvReflectSharedBlockReport*         p_report
+)
+{
+  if (IsNull(p_report)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if ((module_count > 0) && IsNull(pp_modules)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  memset(p_report, 0, sizeof(*p_report));
+  SpvReflectResult result = ParseSharedBlocks(module_count, pp_modules, p_report);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroySharedBlockReport(p_report);
+  }
+  return result;
+}
+
+SpvReflectResult spvReflectAssignSharedBlockBinding(
+  SpvReflectShaderModule*       p_module,
+  const SpvReflectSharedBlock*  p_block,
+  uint32_t                      module_index,
+  uint32_t                      set,
+  uint32_t                      binding
+)
+{
+  if (IsNull(p_module) || IsNull(p_block)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  if (IsEntryPointFiltered(p_module)) {
+    return SPV_REFLECT_RESULT_NOT_READY;
+  }
+  const SpvReflectSharedBlockBinding* p_shared = NULL;
+  for (uint32_t i = 0; i < p_block->binding_count; ++i) {
+    if (p_block->bindings[i].module_index != module_index) {
+      continue;
+    }
+    if (IsNotNull(p_shared)) {
+      return SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH;
+    }
+    p_shared = &p_block->bindings[i];
+  }
+  if (IsNull(p_shared)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  const SpvReflectDescriptorBinding* p_target = NULL;
+  for (uint32_t i = 0; i < p_module->descriptor_binding_count; ++i) {
+    const SpvReflectDescriptorBinding* p_binding = &p_module->descriptor_bindings[i];
+    if (p_binding->spirv_id == p_shared->spirv_id) {
+      p_target = p_binding;
+    }
+    else if ((p_binding->set == set) && (p_binding->binding == binding)) {
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+  }
+  if (IsNull(p_target) || (p_target->descriptor_type != p_block->descriptor_type)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+  if ((p_target->set == set) && (p_target->binding == binding)) {
+    return SPV_REFLECT_RESULT_SUCCESS;
+  }
+  return spvReflectChangeDescriptorBindingNumbers(p_module, p_target, binding, set);
+}
+
+void spvReflectDestroySharedBlockReport(SpvReflectSharedBlockReport* p_report)
+{
+  if (IsNull(p_report)) {
+    return;
+  }
+  for (uint32_t i = 0; IsNotNull(p_report->blocks) && (i < p_report->block_count); ++i) {
+    SafeFree(p_report->blocks[i].bindings);
+  }
+  SafeFree(p_report->blocks);
+  p_report->block_count = 0;
+}
+
+uint32_t spvReflectInternSemantic(const char* semantic)
+{
+  if (IsNull(semantic) || (semantic[0] == '\0')) {
+    return 0;
+  }
+  size_t length = strlen(semantic);
+  size_t base_length = length;
+  while ((base_length > 0) && (semantic[base_length - 1] >= '0') && (semantic[base_length - 1] <= '9')) {
+    --base_length;
+  }
+  uint32_t index = 0;
+  for (size_t i = base_length; i < length; ++i) {
+    index = 10 * index + (uint32_t)(semantic[i] - '0');
+  }
+
+  // FNV-1a of the upper case name
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < base_length; ++i) {
+    char c = semantic[i];
+    if ((c >= 'a') && (c <= 'z')) {
+      c = (char)(c - 'a' + 'A');
+    }
+    hash = (hash ^ (uint8_t)c) * 16777619u;
+  }
+  uint32_t id = hash + index;
+  return (id != 0) ? id : 1;
+}
+
+static uint8_t GetInputNumericClass(const SpvReflectTypeDescription* p_type)
+{
+  if (IsNull(p_type) || ((p_type->type_flags & SPV_REFLECT_TYPE_FLAG_STRUCT) != 0)) {
+    return SPV_REFLECT_NUMERIC_CLASS_NONE;
+  }
+  bool is_64_bit = p_type->traits.numeric.scalar.width > 32;
+  if ((p_type->type_flags & SPV_REFLECT_TYPE_FLAG_FLOAT) != 0) {
+    return is_64_bit ? SPV_REFLECT_NUMERIC_CLASS_FLOAT64 : SPV_REFLECT_NUMERIC_CLASS_FLOAT;
+  }
+  if ((p_type->type_flags & SPV_REFLECT_TYPE_FLAG_INT) != 0) {
+    if (p_type->traits.numeric.scalar.signedness != 0) {
+      return is_64_bit ? SPV_REFLECT_NUMERIC_CLASS_SINT64 : SPV_REFLECT_NUMERIC_CLASS_SINT;
+    }
+    return is_64_bit ? SPV_REFLECT_NUMERIC_CLASS_UINT64 : SPV_REFLECT_NUMERIC_CLASS_UINT;
+  }
+  return SPV_REFLECT_NUMERIC_CLASS_NONE;
+}
+
+static bool IsNumericClass64Bit(uint8_t numeric_class)
+{
+  return (numeric_class & (SPV_REFLECT_NUMERIC_CLASS_FLOAT64 | SPV_REFLECT_NUMERIC_CLASS_SINT64 |
+                           SPV_REFLECT_NUMERIC_CLASS_UINT64)) != 0;
+}
+
+//
+// Fills locations [first, end) of a signature with one value that has
+// component_count components per location, or per pair of locations for
+// 64-bit values that take two.
+//
+static void SetSignatureLocations(SpvReflectInputSignature* p_signature,
+                                  uint32_t                  first,
+                                  uint32_t                  end,
+                                  uint8_t                   numeric_class,
+                                  uint32_t                  component_count,
+                                  uint32_t                  semantic_id)
+{
+  bool is_split = IsNumericClass64Bit(numeric_class) && (component_count > 2);
+  for (uint32_t location = first; location < end; ++location) {
+    uint32_t count = component_count;
+    if (is_split) {
+      count = (((location - first) % 2) == 0) ? 2 : (component_count - 2);
+    }
+    p_signature->location_mask |= 1u << location;
+    p_signature->numeric_classes[location] |= numeric_class;
+    p_signature->component_counts[location] = (uint8_t)Max(p_signature->component_counts[location], count);
+    if (semantic_id != 0) {
+      p_signature->semantic_mask |= 1u << location;
+      p_signature->semantic_ids[location] = semantic_id + (location - first);
+    }
+  }
+}
+
+SpvReflectResult spvReflectGetEntryPointInputSignature(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  SpvReflectInputSignature*      p_signature
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_signature)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  Parser parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  memset(p_signature, 0, sizeof(*p_signature));
+  for (uint32_t i = 0; i < p_entry->input_variable_count; ++i) {
+    const SpvReflectInterfaceVariable* p_var = &p_entry->input_variables[i];
+    uint32_t first = 0;
+    uint32_t end = 0;
+    if (!GetLocationRange(&parser, p_entry->spirv_execution_model, p_var, &first, &end)) {
+      continue;
+    }
+    if (end > SPV_REFLECT_MAX_SIGNATURE_LOCATIONS) {
+      result = SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+      break;
+    }
+    const SpvReflectTypeDescription* p_type = p_var->type_description;
+    uint32_t component_count = 1;
+    if (IsNotNull(p_type) && ((p_type->type_flags & SPV_REFLECT_TYPE_FLAG_MATRIX) != 0)) {
+      component_count = p_type->traits.numeric.matrix.row_count;
+    }
+    else if (IsNotNull(p_type) && ((p_type->type_flags & SPV_REFLECT_TYPE_FLAG_VECTOR) != 0)) {
+      component_count = p_type->traits.numeric.vector.component_count;
+    }
+    SetSignatureLocations(p_signature, first, end, GetInputNumericClass(p_type), component_count,
+                          spvReflectInternSemantic(p_var->semantic));
+  }
+  DestroyParser(&parser);
+
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    memset(p_signature, 0, sizeof(*p_signature));
+  }
+  return result;
+}
+
+SpvReflectResult spvReflectGetVertexFormatSignature(
+  uint32_t                          attribute_count,
+  const SpvReflectVertexAttribute*  p_attributes,
+  SpvReflectInputSignature*         p_signature
+)
+{
+  if (IsNull(p_signature) || ((attribute_count > 0) && IsNull(p_attributes))) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+
+  memset(p_signature, 0, sizeof(*p_signature));
+  for (uint32_t i = 0; i < attribute_count; ++i) {
+    const SpvReflectVertexAttribute* p_attribute = &p_attributes[i];
+    uint32_t numeric_class = (uint32_t)p_attribute->numeric_class;
+    if ((numeric_class == 0) || ((numeric_class & (numeric_class - 1)) != 0) ||
+        (numeric_class > SPV_REFLECT_NUMERIC_CLASS_UINT64)) {
+      memset(p_signature, 0, sizeof(*p_signature));
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+    uint32_t first = p_attribute->location;
+    uint32_t end = first + ((IsNumericClass64Bit((uint8_t)numeric_class) && (p_attribute->component_count > 2)) ? 2 : 1);
+    if ((first >= SPV_REFLECT_MAX_SIGNATURE_LOCATIONS) || (end > SPV_REFLECT_MAX_SIGNATURE_LOCATIONS)) {
+      memset(p_signature, 0, sizeof(*p_signature));
+      return SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    }
+    uint32_t mask = ((end - first) == 2) ? (3u << first) : (1u << first);
+    if ((p_signature->location_mask & mask) != 0) {
+      memset(p_signature, 0, sizeof(*p_signature));
+      return SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH;
+    }
+    SetSignatureLocations(p_signature, first, end, (uint8_t)numeric_class, p_attribute->component_count,
+                          spvReflectInternSemantic(p_attribute->semantic));
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+uint32_t spvReflectGetInputSignatureMismatch(
+  const SpvReflectInputSignature*  p_shader,
+  const SpvReflectInputSignature*  p_format
+)
+{
+  if (IsNull(p_shader) || IsNull(p_format)) {
+    return UINT32_MAX;
+  }
+  uint32_t mismatch = p_shader->location_mask & ~p_format->location_mask;
+
+  // Each location has at most one class bit, so the format feeds a shader
+  // location when it has every bit the shader has there. Compare eight
+  // locations at a time and only look at single locations on a mismatch.
+  for (uint32_t i = 0; i < SPV_REFLECT_MAX_SIGNATURE_LOCATIONS; i += 8) {
+    uint64_t shader_word = 0;
+    uint64_t format_word = 0;
+    memcpy(&shader_word, &p_shader->numeric_classes[i], sizeof(shader_word));
+    memcpy(&format_word, &p_format->numeric_classes[i], sizeof(format_word));
+    if ((shader_word & ~format_word) == 0) {
+      continue;
+    }
+    for (uint32_t j = i; j < i + 8; ++j) {
+      if ((p_shader->numeric_classes[j] & ~p_format->numeric_classes[j]) != 0) {
+        mismatch |= 1u << j;
+      }
+    }
+  }
+
+  uint32_t named = p_shader->semantic_mask & p_format->semantic_mask;
+  for (uint32_t i = 0; named != 0; ++i, named >>= 1) {
+    if (((named & 1) != 0) && (p_shader->semantic_ids[i] != p_format->semantic_ids[i])) {
+      mismatch |= 1u << i;
+    }
+  }
+  return mismatch;
+}
+
+uint32_t spvReflectFindInputSignatureLocation(
+  const SpvReflectInputSignature*  p_signature,
+  uint32_t                         semantic_id
+)
+{
+  if (IsNull(p_signature) || (semantic_id == 0)) {
+    return UINT32_MAX;
+  }
+  uint32_t named = p_signature->semantic_mask;
+  for (uint32_t i = 0; named != 0; ++i, named >>= 1) {
+    if (((named & 1) != 0) && (p_signature->semantic_ids[i] == semantic_id)) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+// GLSL.std.450 instructions whose results overflow 16-bit floats even for
+// small operands
+enum {
+  GLSL_STD_450_SINH           = 19,
+  GLSL_STD_450_COSH           = 20,
+  GLSL_STD_450_POW            = 26,
+  GLSL_STD_450_EXP            = 27,
+  GLSL_STD_450_EXP2           = 29,
+  GLSL_STD_450_DETERMINANT    = 33,
+  GLSL_STD_450_MATRIX_INVERSE = 34,
+  GLSL_STD_450_LDEXP          = 53,
+};
+
+enum {
+  PRECISION_FLOAT_VALUE  = 0x01,
+  PRECISION_RELAXED      = 0x02,
+  PRECISION_LOW_SOURCES  = 0x04,
+  PRECISION_LOW_SINKS    = 0x08,
+  // Values used, variables loaded
+  PRECISION_USED         = 0x10,
+  PRECISION_STORED       = 0x20,
+  PRECISION_CANDIDATE    = 0x40,
+};
+
+typedef struct PrecisionContext {
+  Parser*                       p_parser;
+  // Per id
+  uint8_t*                      states;
+  const char**                  names;
+  uint32_t*                     chain_roots;
+  uint32_t*                     chain_slots;
+  // [first, end) node ranges of the function bodies the entry point calls
+  size_t                        range_count;
+  size_t*                       ranges;
+} PrecisionContext;
+
+static bool IsFloat32Type(const Parser* p_parser, uint32_t type_id)
+{
+  Node* p_type = FindIdNode(p_parser, type_id);
+  for (uint32_t depth = 0; IsNotNull(p_type) && (depth < 3); ++depth) {
+    if (p_type->op == SpvOpTypeFloat) {
+      return p_parser->spirv_code[p_type->word_offset + 2] == 32;
+    }
+    if ((p_type->op != SpvOpTypeVector) && (p_type->op != SpvOpTypeMatrix)) {
+      break;
+    }
+    p_type = FindIdNode(p_parser, p_parser->spirv_code[p_type->word_offset + 2]);
+  }
+  return false;
+}
+
+static bool IsHalfExactConstant(const Parser* p_parser, uint32_t constant_id, uint32_t depth)
+{
+  Node* p_node = FindIdNode(p_parser, constant_id);
+  if (IsNull(p_node) || (depth > p_parser->type_count)) {
+    return false;
+  }
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  switch (p_node->op) {
+    default: break;
+    case SpvOpConstantNull:
+    case SpvOpUndef: {
+      return true;
+    }
+    case SpvOpConstant: {
+      if ((p_node->word_count < 4) || !IsFloat32Type(p_parser, p_node->result_type_id)) {
+        return false;
+      }
+      int32_t exponent = (int32_t)((p_words[3] >> 23) & 0xFF) - 127;
+      uint32_t mantissa = p_words[3] & 0x7FFFFF;
+      if (exponent == -127) {
+        return mantissa == 0;
+      }
+      if (exponent > 15) {
+        return false;
+      }
+      // Normal 16-bit floats keep 10 of the 23 mantissa bits, subnormals
+      // one less per step below the smallest normal exponent
+      uint32_t dropped_bits = 13 + ((exponent < -14) ? (uint32_t)(-14 - exponent) : 0);
+      if (dropped_bits > 23) {
+        return false;
+      }
+      return (mantissa & ((1u << dropped_bits) - 1)) == 0;
+    }
+    case SpvOpConstantComposite: {
+      for (uint32_t i = 3; i < p_node->word_count; ++i) {
+        if (!IsHalfExactConstant(p_parser, p_words[i], depth + 1)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+// The variable a pointer, image or sampled image value comes from.
+//
+static Node* GetPrecisionRootVariable(const Parser* p_parser, uint32_t id)
+{
+  for (uint32_t depth = 0; depth < p_parser->id_bound; ++depth) {
+    Node* p_node = FindIdNode(p_parser, id);
+    if (IsNull(p_node)) {
+      return NULL;
+    }
+    if (p_node->op == SpvOpVariable) {
+      return p_node;
+    }
+    bool is_forwarded = IsAccessChain(p_node->op) || (p_node->op == SpvOpLoad) ||
+                        (p_node->op == SpvOpSampledImage) || (p_node->op == SpvOpImage) ||
+                        (p_node->op == SpvOpCopyObject);
+    if (!is_forwarded || (p_node->word_count < 4)) {
+      return NULL;
+    }
+    id = p_parser->spirv_code[p_node->word_offset + 3];
+  }
+  return NULL;
+}
+
+static bool IsLowPrecisionImageFormat(SpvImageFormat format)
+{
+  switch (format) {
+    default: break;
+    case SpvImageFormatRgba8:
+    case SpvImageFormatRgba8Snorm:
+    case SpvImageFormatRg8:
+    case SpvImageFormatRg8Snorm:
+    case SpvImageFormatR8:
+    case SpvImageFormatR8Snorm:
+    case SpvImageFormatRgba16f:
+    case SpvImageFormatRg16f:
+    case SpvImageFormatR16f:
+    case SpvImageFormatR11fG11fB10f:
+    case SpvImageFormatRgb10A2: {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool IsPrecisionImageReadOp(SpvOp op)
+{
+  switch (op) {
+    default: break;
+    case SpvOpImageSampleImplicitLod:
+    case SpvOpImageSampleExplicitLod:
+    case SpvOpImageSampleDrefImplicitLod:
+    case SpvOpImageSampleDrefExplicitLod:
+    case SpvOpImageSampleProjImplicitLod:
+    case SpvOpImageSampleProjExplicitLod:
+    case SpvOpImageSampleProjDrefImplicitLod:
+    case SpvOpImageSampleProjDrefExplicitLod:
+    case SpvOpImageFetch:
+    case SpvOpImageGather:
+    case SpvOpImageDrefGather:
+    case SpvOpImageRead: {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool IsLowPrecisionImage(const PrecisionContext* p_ctx, uint32_t image_id)
+{
+  const Parser* p_parser = p_ctx->p_parser;
+  Node* p_var = GetPrecisionRootVariable(p_parser, image_id);
+  if (IsNull(p_var)) {
+    return false;
+  }
+  if ((p_ctx->states[p_var->result_id] & PRECISION_RELAXED) != 0) {
+    return true;
+  }
+  Node* p_pointer = FindIdNode(p_parser, p_var->type_id);
+  Node* p_type = IsNotNull(p_pointer) ? FindIdNode(p_parser, p_pointer->type_id) : NULL;
+  for (uint32_t depth = 0; IsNotNull(p_type) && (depth < 3); ++depth) {
+    const uint32_t* p_words = p_parser->spirv_code + p_type->word_offset;
+    if ((p_type->op == SpvOpTypeImage) && (p_type->word_count > 8)) {
+      return IsLowPrecisionImageFormat((SpvImageFormat)p_words[8]);
+    }
+    if ((p_type->op != SpvOpTypeArray) && (p_type->op != SpvOpTypeRuntimeArray) &&
+        (p_type->op != SpvOpTypeSampledImage)) {
+      break;
+    }
+    p_type = FindIdNode(p_parser, p_words[2]);
+  }
+  return false;
+}
+
+//
+// Arithmetic whose result is as precise as its float operands.
+//
+static bool IsPrecisionAluOp(const Parser* p_parser, const Node* p_node)
+{
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  switch (p_node->op) {
+    default: break;
+    case SpvOpFNegate:
+    case SpvOpFAdd:
+    case SpvOpFSub:
+    case SpvOpFMul:
+    case SpvOpFDiv:
+    case SpvOpFRem:
+    case SpvOpFMod:
+    case SpvOpVectorTimesScalar:
+    case SpvOpMatrixTimesScalar:
+    case SpvOpVectorTimesMatrix:
+    case SpvOpMatrixTimesVector:
+    case SpvOpMatrixTimesMatrix:
+    case SpvOpOuterProduct:
+    case SpvOpDot:
+    case SpvOpTranspose: {
+      return true;
+    }
+    case SpvOpExtInst: {
+      if ((p_node->word_count < 5) || !IsGlslStd450(p_parser, p_words[3])) {
+        return false;
+      }
+      switch (p_words[4]) {
+        default: break;
+        case GLSL_STD_450_SINH:
+        case GLSL_STD_450_COSH:
+        case GLSL_STD_450_POW:
+        case GLSL_STD_450_EXP:
+        case GLSL_STD_450_EXP2:
+        case GLSL_STD_450_DETERMINANT:
+        case GLSL_STD_450_MATRIX_INVERSE:
+        case GLSL_STD_450_LDEXP: {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+  return (p_node->op >= SpvOpDPdx) && (p_node->op <= SpvOpFwidthCoarse);
+}
+
+//
+// Instructions that move float values around without arithmetic.
+//
+static bool IsPrecisionMoveOp(SpvOp op)
+{
+  switch (op) {
+    default: break;
+    case SpvOpCompositeConstruct:
+    case SpvOpCompositeExtract:
+    case SpvOpCompositeInsert:
+    case SpvOpVectorShuffle:
+    case SpvOpVectorExtractDynamic:
+    case SpvOpVectorInsertDynamic:
+    case SpvOpSelect:
+    case SpvOpPhi:
+    case SpvOpCopyObject: {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool IsFunctionVariable(const Node* p_var)
+{
+  return IsNotNull(p_var) && (p_var->storage_class == SpvStorageClassFunction);
+}
+
+static bool ClearPrecisionState(PrecisionContext* p_ctx, uint32_t id, uint8_t flags)
+{
+  if ((id >= p_ctx->p_parser->id_bound) || ((p_ctx->states[id] & flags) == 0)) {
+    return false;
+  }
+  p_ctx->states[id] &= (uint8_t)~flags;
+  return true;
+}
+
+static bool IsLowSourceOperand(const PrecisionContext* p_ctx, uint32_t id)
+{
+  const Parser* p_parser = p_ctx->p_parser;
+  if (id >= p_parser->id_bound) {
+    return false;
+  }
+  uint8_t state = p_ctx->states[id];
+  if ((state & PRECISION_FLOAT_VALUE) != 0) {
+    return (state & PRECISION_LOW_SOURCES) != 0;
+  }
+  // Indices, conditions and other non-float operands carry no precision
+  Node* p_node = FindIdNode(p_parser, id);
+  if (IsNull(p_node) || !IsFloat32Type(p_parser, p_node->result_type_id)) {
+    return true;
+  }
+  return ((state & PRECISION_RELAXED) != 0) || IsHalfExactConstant(p_parser, id, 0);
+}
+
+static bool IsLowSourceValue(const PrecisionContext* p_ctx, const Node* p_node)
+{
+  const Parser* p_parser = p_ctx->p_parser;
+  const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+  if ((p_ctx->states[p_node->result_id] & PRECISION_RELAXED) != 0) {
+    return true;
+  }
+  if (IsPrecisionImageReadOp(p_node->op)) {
+    return (p_node->word_count > 3) && IsLowPrecisionImage(p_ctx, p_words[3]);
+  }
+  switch (p_node->op) {
+    default: break;
+    case SpvOpLoad: {
+      Node* p_var = (p_node->word_count > 3) ? GetPrecisionRootVariable(p_parser, p_words[3]) : NULL;
+      if (IsNull(p_var)) {
+        return false;
+      }
+      uint8_t state = p_ctx->states[p_var->result_id];
+      return ((state & PRECISION_RELAXED) != 0) ||
+             (IsFunctionVariable(p_var) && ((state & PRECISION_LOW_SOURCES) != 0));
+    }
+    case SpvOpFConvert:
+    case SpvOpConvertSToF:
+    case SpvOpConvertUToF: {
+      // 16-bit floats hold every 8-bit integer exactly
+      Node* p_operand = (p_node->word_count > 3) ? FindIdNode(p_parser, p_words[3]) : NULL;
+      uint32_t max_width = (p_node->op == SpvOpFConvert) ? 16 : 8;
+      return IsNotNull(p_operand) && (GetScalarWidth(p_parser, p_operand->result_type_id) <= max_width);
+    }
+    case SpvOpQuantizeToF16: {
+      return true;
+    }
+  }
+  if (!IsPrecisionAluOp(p_parser, p_node) && !IsPrecisionMoveOp(p_node->op)) {
+    return false;
+  }
+  for (uint32_t i = 3; i < p_node->word_count; ++i) {
+    if (IsIdOperand(p_parser, p_node->op, p_words, p_node->word_count, i) &&
+        !IsLowSourceOperand(p_ctx, p_words[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void InitPrecisionStates(PrecisionContext* p_ctx, const SpvReflectEntryPoint* p_entry,
+                                uint32_t unorm_output_mask)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  for (size_t i = 0; i < p_parser->node_count; ++i) {
+    Node* p_node = &(p_parser->nodes[i]);
+    const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+    if ((p_node->op == SpvOpDecorate) && (p_node->word_count > 2) &&
+        (p_words[2] == SpvDecorationRelaxedPrecision) && (p_words[1] < p_parser->id_bound)) {
+      p_ctx->states[p_words[1]] |= PRECISION_RELAXED;
+    }
+    else if ((p_node->op == SpvOpName) && (p_node->word_count > 2) && (p_words[1] < p_parser->id_bound)) {
+      p_ctx->names[p_words[1]] = p_node->name;
+    }
+  }
+
+  // Start optimistic, the fixed point iterations clear what does not hold
+  for (size_t r = 0; r < p_ctx->range_count; ++r) {
+    for (size_t i = p_ctx->ranges[2 * r]; i < p_ctx->ranges[2 * r + 1]; ++i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+      if (p_node->op == SpvOpVariable) {
+        Node* p_pointer = FindIdNode(p_parser, p_node->type_id);
+        if (IsFunctionVariable(p_node) && IsNotNull(p_pointer) && IsFloat32Type(p_parser, p_pointer->type_id)) {
+          p_ctx->states[p_node->result_id] |= PRECISION_LOW_SOURCES | PRECISION_LOW_SINKS;
+          if (p_node->word_count > 4) {
+            p_ctx->states[p_node->result_id] |= PRECISION_STORED;
+          }
+        }
+      }
+      else if ((p_node->result_id != 0) && (p_node->op != SpvOpLabel) &&
+               IsFloat32Type(p_parser, p_node->result_type_id)) {
+        p_ctx->states[p_node->result_id] |= PRECISION_FLOAT_VALUE | PRECISION_LOW_SOURCES | PRECISION_LOW_SINKS;
+      }
+      // Callees and memory copies can write variables behind our back
+      if ((p_node->op == SpvOpFunctionCall) || (p_node->op == SpvOpCopyMemory) ||
+          (p_node->op == SpvOpCopyMemorySized)) {
+        uint32_t first = (p_node->op == SpvOpFunctionCall) ? 4 : 1;
+        for (uint32_t k = first; k < p_node->word_count; ++k) {
+          Node* p_var = GetPrecisionRootVariable(p_parser, p_words[k]);
+          if (IsFunctionVariable(p_var)) {
+            ClearPrecisionState(p_ctx, p_var->result_id, PRECISION_LOW_SOURCES | PRECISION_LOW_SINKS);
+          }
+        }
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < p_entry->input_variable_count; ++i) {
+    const SpvReflectInterfaceVariable* p_var = &p_entry->input_variables[i];
+    if ((p_var->spirv_id < p_parser->id_bound) && ((p_var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) == 0)) {
+      p_ctx->states[p_var->spirv_id] |= PRECISION_LOW_SINKS;
+    }
+  }
+  for (uint32_t i = 0; i < p_entry->output_variable_count; ++i) {
+    const SpvReflectInterfaceVariable* p_var = &p_entry->output_variables[i];
+    if ((p_var->spirv_id >= p_parser->id_bound) || ((p_var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) != 0)) {
+      continue;
+    }
+    uint8_t* p_state = &p_ctx->states[p_var->spirv_id];
+    *p_state |= PRECISION_LOW_SOURCES;
+    if (((*p_state & PRECISION_RELAXED) != 0) ||
+        ((p_var->location < SPV_REFLECT_MAX_SIGNATURE_LOCATIONS) && (((unorm_output_mask >> p_var->location) & 1) != 0))) {
+      *p_state |= PRECISION_LOW_SINKS;
+    }
+  }
+}
+
+//
+// Clears LOW_SOURCES from values with a full precision operand, and from
+// variables and outputs that are stored one, until nothing changes.
+//
+static void PropagateLowSources(PrecisionContext* p_ctx)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t r = 0; r < p_ctx->range_count; ++r) {
+      for (size_t i = p_ctx->ranges[2 * r]; i < p_ctx->ranges[2 * r + 1]; ++i) {
+        Node* p_node = &(p_parser->nodes[i]);
+        const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+        if (p_node->op == SpvOpVariable) {
+          if ((p_node->word_count > 4) && !IsLowSourceOperand(p_ctx, p_words[4])) {
+            changed |= ClearPrecisionState(p_ctx, p_node->result_id, PRECISION_LOW_SOURCES);
+          }
+        }
+        else if ((p_node->op == SpvOpStore) && (p_node->word_count > 2)) {
+          Node* p_var = GetPrecisionRootVariable(p_parser, p_words[1]);
+          if (IsNotNull(p_var)) {
+            p_ctx->states[p_var->result_id] |= PRECISION_STORED;
+            if (!IsLowSourceOperand(p_ctx, p_words[2])) {
+              changed |= ClearPrecisionState(p_ctx, p_var->result_id, PRECISION_LOW_SOURCES);
+            }
+          }
+        }
+        else if (((p_ctx->states[p_node->result_id] & PRECISION_FLOAT_VALUE) != 0) &&
+                 !IsLowSourceValue(p_ctx, p_node)) {
+          changed |= ClearPrecisionState(p_ctx, p_node->result_id, PRECISION_LOW_SOURCES);
+        }
+      }
+    }
+  }
+}
+
+//
+// Clears LOW_SINKS from values with a use that is not a low precision
+// store or arithmetic with a LOW_SINKS result, and from variables and
+// inputs with a load that is not LOW_SINKS, until nothing changes.
+//
+static void PropagateLowSinks(PrecisionContext* p_ctx)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t r = 0; r < p_ctx->range_count; ++r) {
+      for (size_t i = p_ctx->ranges[2 * r]; i < p_ctx->ranges[2 * r + 1]; ++i) {
+        Node* p_node = &(p_parser->nodes[i]);
+        const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+        if ((p_node->op == SpvOpStore) && (p_node->word_count > 2)) {
+          Node* p_var = GetPrecisionRootVariable(p_parser, p_words[1]);
+          bool is_low_sink = IsNotNull(p_var) &&
+                             ((p_var->storage_class == SpvStorageClassFunction) ||
+                              (p_var->storage_class == SpvStorageClassOutput)) &&
+                             ((p_ctx->states[p_var->result_id] & PRECISION_LOW_SINKS) != 0);
+          if (p_words[2] < p_parser->id_bound) {
+            p_ctx->states[p_words[2]] |= PRECISION_USED;
+          }
+          if (!is_low_sink) {
+            changed |= ClearPrecisionState(p_ctx, p_words[2], PRECISION_LOW_SINKS);
+          }
+          continue;
+        }
+        if ((p_node->op == SpvOpLoad) && (p_node->word_count > 3)) {
+          Node* p_var = GetPrecisionRootVariable(p_parser, p_words[3]);
+          if (IsNotNull(p_var) && ((p_var->storage_class == SpvStorageClassFunction) ||
+                                   (p_var->storage_class == SpvStorageClassInput))) {
+            p_ctx->states[p_var->result_id] |= PRECISION_USED;
+            if ((p_ctx->states[p_node->result_id] & PRECISION_LOW_SINKS) == 0) {
+              changed |= ClearPrecisionState(p_ctx, p_var->result_id, PRECISION_LOW_SINKS);
+            }
+          }
+          continue;
+        }
+
+        bool passes = (IsPrecisionAluOp(p_parser, p_node) || IsPrecisionMoveOp(p_node->op)) &&
+                      ((p_ctx->states[p_node->result_id] & PRECISION_LOW_SINKS) != 0);
+        uint32_t first = HasResultAndType(p_node->op) ? 3 : 1;
+        for (uint32_t k = first; k < p_node->word_count; ++k) {
+          uint32_t id = p_words[k];
+          if ((id >= p_parser->id_bound) || ((p_ctx->states[id] & PRECISION_FLOAT_VALUE) == 0) ||
+              !IsIdOperand(p_parser, p_node->op, p_words, p_node->word_count, k)) {
+            continue;
+          }
+          p_ctx->states[id] |= PRECISION_USED;
+          if (!passes) {
+            changed |= ClearPrecisionState(p_ctx, id, PRECISION_LOW_SINKS);
+          }
+        }
+      }
+    }
+  }
+}
+
+static uint32_t FindChainRoot(uint32_t* p_roots, uint32_t id)
+{
+  while (p_roots[id] != id) {
+    p_roots[id] = p_roots[p_roots[id]];
+    id = p_roots[id];
+  }
+  return id;
+}
+
+static uint32_t GetPrecisionFlags(uint8_t state)
+{
+  uint32_t flags = SPV_REFLECT_PRECISION_NONE;
+  if ((state & PRECISION_LOW_SOURCES) != 0) {
+    flags |= SPV_REFLECT_PRECISION_LOW_SOURCES;
+  }
+  if ((state & PRECISION_LOW_SINKS) != 0) {
+    flags |= SPV_REFLECT_PRECISION_LOW_SINKS;
+  }
+  return flags;
+}
+
+static int SortCompareHalfPrecisionCandidate(const void* a, const void* b)
+{
+  const SpvReflectHalfPrecisionCandidate* p_a = (const SpvReflectHalfPrecisionCandidate*)a;
+  const SpvReflectHalfPrecisionCandidate* p_b = (const SpvReflectHalfPrecisionCandidate*)b;
+  if (p_a->kind != p_b->kind) {
+    return (p_a->kind < p_b->kind) ? -1 : 1;
+  }
+  if (p_a->component_count != p_b->component_count) {
+    return (p_a->component_count > p_b->component_count) ? -1 : 1;
+  }
+  return (p_a->spirv_id < p_b->spirv_id) ? -1 : ((p_a->spirv_id > p_b->spirv_id) ? 1 : 0);
+}
+
+static uint32_t GetVariableRegisterCount(const Parser* p_parser, uint32_t var_id)
+{
+  Node* p_var = FindIdNode(p_parser, var_id);
+  Node* p_pointer = IsNotNull(p_var) ? FindIdNode(p_parser, p_var->type_id) : NULL;
+  return IsNotNull(p_pointer) ? GetTypeSize(p_parser, p_pointer->type_id, false, 0) : 0;
+}
+
+static bool IsFloat32Variable(const Parser* p_parser, uint32_t var_id)
+{
+  Node* p_var = FindIdNode(p_parser, var_id);
+  Node* p_pointer = IsNotNull(p_var) ? FindIdNode(p_parser, p_var->type_id) : NULL;
+  return IsNotNull(p_pointer) && IsFloat32Type(p_parser, p_pointer->type_id);
+}
+
+static SpvReflectResult EstimatePeakRegisters(Parser*                      p_parser,
+                                              const SpvReflectEntryPoint*  p_entry,
+                                              const bool*                  half_precision_ids,
+                                              uint32_t*                    p_registers)
+{
+  PressureContext context;
+  memset(&context, 0, sizeof(context));
+  context.p_parser = p_parser;
+  context.half_precision_ids = half_precision_ids;
+  SpvReflectRegisterPressure pressure;
+  memset(&pressure, 0, sizeof(pressure));
+  SpvReflectResult result = ParseRegisterPressure(&context, p_entry, NULL, &pressure);
+  *p_registers = pressure.max_live_registers;
+  DestroyPressureContext(&context);
+  spvReflectDestroyRegisterPressure(&pressure);
+  return result;
+}
+
+static SpvReflectResult AddHalfPrecisionCandidate(SpvReflectHalfPrecisionReport*           p_report,
+                                                  uint32_t*                                p_capacity,
+                                                  const SpvReflectHalfPrecisionCandidate*  p_candidate)
+{
+  if (p_report->candidate_count == *p_capacity) {
+    uint32_t capacity = Max(2 * *p_capacity, 16);
+    SpvReflectHalfPrecisionCandidate* candidates =
+        (SpvReflectHalfPrecisionCandidate*)realloc(p_report->candidates, capacity * sizeof(*candidates));
+    if (IsNull(candidates)) {
+      return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+    }
+    p_report->candidates = candidates;
+    *p_capacity = capacity;
+  }
+  p_report->candidates[p_report->candidate_count++] = *p_candidate;
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult ParseHalfPrecisionInterface(PrecisionContext*                   p_ctx,
+                                                    uint32_t                            variable_count,
+                                                    const SpvReflectInterfaceVariable*  p_variables,
+                                                    SpvReflectHalfPrecisionKind         kind,
+                                                    SpvReflectHalfPrecisionReport*      p_report,
+                                                    uint32_t*                           p_capacity)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  uint8_t required = (kind == SPV_REFLECT_HALF_PRECISION_KIND_INPUT) ? PRECISION_USED : PRECISION_STORED;
+  for (uint32_t i = 0; i < variable_count; ++i) {
+    const SpvReflectInterfaceVariable* p_var = &p_variables[i];
+    if ((p_var->spirv_id >= p_parser->id_bound) || ((p_var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) != 0) ||
+        !IsFloat32Variable(p_parser, p_var->spirv_id)) {
+      continue;
+    }
+    uint8_t state = p_ctx->states[p_var->spirv_id];
+    uint32_t flags = GetPrecisionFlags(state);
+    if (kind == SPV_REFLECT_HALF_PRECISION_KIND_INPUT) {
+      flags &= SPV_REFLECT_PRECISION_LOW_SINKS;
+    }
+    if (((state & PRECISION_RELAXED) != 0) || ((state & required) == 0) || (flags == 0)) {
+      continue;
+    }
+    SpvReflectHalfPrecisionCandidate candidate;
+    memset(&candidate, 0, sizeof(candidate));
+    candidate.kind = kind;
+    candidate.spirv_id = p_var->spirv_id;
+    candidate.name = p_var->name;
+    candidate.location = p_var->location;
+    candidate.flags = flags;
+    candidate.component_count = GetVariableRegisterCount(p_parser, p_var->spirv_id);
+    SpvReflectResult result = AddHalfPrecisionCandidate(p_report, p_capacity, &candidate);
+    if (result != SPV_REFLECT_RESULT_SUCCESS) {
+      return result;
+    }
+    p_ctx->states[p_var->spirv_id] |= PRECISION_CANDIDATE;
+    p_report->interface_bytes_saved += 2 * candidate.component_count;
+  }
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult ParseHalfPrecisionChains(PrecisionContext*               p_ctx,
+                                                 SpvReflectHalfPrecisionReport*  p_report,
+                                                 uint32_t*                       p_capacity)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  for (uint32_t id = 0; id < p_parser->id_bound; ++id) {
+    p_ctx->chain_roots[id] = id;
+    p_ctx->chain_slots[id] = (uint32_t)INVALID_VALUE;
+  }
+
+  // Candidate values and variables, and chains of candidates that feed
+  // each other
+  for (size_t r = 0; r < p_ctx->range_count; ++r) {
+    for (size_t i = p_ctx->ranges[2 * r]; i < p_ctx->ranges[2 * r + 1]; ++i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+      uint8_t* p_state = &p_ctx->states[p_node->result_id];
+      if ((p_node->op == SpvOpVariable) && IsFunctionVariable(p_node)) {
+        bool is_low = (((*p_state & PRECISION_LOW_SOURCES) != 0) && ((*p_state & PRECISION_STORED) != 0)) ||
+                      (((*p_state & PRECISION_LOW_SINKS) != 0) && ((*p_state & PRECISION_USED) != 0));
+        if (is_low && ((*p_state & PRECISION_RELAXED) == 0)) {
+          SpvReflectHalfPrecisionCandidate candidate;
+          memset(&candidate, 0, sizeof(candidate));
+          candidate.kind = SPV_REFLECT_HALF_PRECISION_KIND_VARIABLE;
+          candidate.spirv_id = p_node->result_id;
+          candidate.name = p_ctx->names[p_node->result_id];
+          candidate.location = (uint32_t)INVALID_VALUE;
+          candidate.flags = GetPrecisionFlags(*p_state);
+          candidate.component_count = GetVariableRegisterCount(p_parser, p_node->result_id);
+          SpvReflectResult result = AddHalfPrecisionCandidate(p_report, p_capacity, &candidate);
+          if (result != SPV_REFLECT_RESULT_SUCCESS) {
+            return result;
+          }
+          *p_state |= PRECISION_CANDIDATE;
+        }
+        continue;
+      }
+      if ((p_node->result_id == 0) || ((*p_state & PRECISION_FLOAT_VALUE) == 0)) {
+        continue;
+      }
+
+      bool is_alu = IsPrecisionAluOp(p_parser, p_node);
+      p_report->float_value_count += 1;
+      p_report->alu_instruction_count += is_alu ? 1 : 0;
+      if ((*p_state & PRECISION_RELAXED) != 0) {
+        p_report->relaxed_value_count += 1;
+        continue;
+      }
+      bool is_low = ((*p_state & PRECISION_LOW_SOURCES) != 0) ||
+                    (((*p_state & PRECISION_LOW_SINKS) != 0) && ((*p_state & PRECISION_USED) != 0));
+      if (!is_low) {
+        continue;
+      }
+      *p_state |= PRECISION_CANDIDATE;
+      p_report->candidate_value_count += 1;
+      p_report->candidate_alu_instruction_count += is_alu ? 1 : 0;
+      if (!is_alu && !IsPrecisionMoveOp(p_node->op)) {
+        continue;
+      }
+      for (uint32_t k = 3; k < p_node->word_count; ++k) {
+        uint32_t id = p_words[k];
+        if ((id < p_parser->id_bound) && ((p_ctx->states[id] & PRECISION_CANDIDATE) != 0) &&
+            ((p_ctx->states[id] & PRECISION_FLOAT_VALUE) != 0) &&
+            IsIdOperand(p_parser, p_node->op, p_words, p_node->word_count, k)) {
+          p_ctx->chain_roots[FindChainRoot(p_ctx->chain_roots, id)] = FindChainRoot(p_ctx->chain_roots, p_node->result_id);
+        }
+      }
+    }
+  }
+
+  // One candidate per chain. Its id is the chain's last value and its name
+  // that of the first variable it is stored to.
+  uint32_t first_chain = p_report->candidate_count;
+  for (size_t r = 0; r < p_ctx->range_count; ++r) {
+    for (size_t i = p_ctx->ranges[2 * r]; i < p_ctx->ranges[2 * r + 1]; ++i) {
+      Node* p_node = &(p_parser->nodes[i]);
+      const uint32_t* p_words = p_parser->spirv_code + p_node->word_offset;
+      if ((p_node->op == SpvOpStore) && (p_node->word_count > 2) && (p_words[2] < p_parser->id_bound) &&
+          ((p_ctx->states[p_words[2]] & PRECISION_CANDIDATE) != 0)) {
+        uint32_t slot = p_ctx->chain_slots[FindChainRoot(p_ctx->chain_roots, p_words[2])];
+        Node* p_var = GetPrecisionRootVariable(p_parser, p_words[1]);
+        if ((slot != (uint32_t)INVALID_VALUE) && IsNotNull(p_var) && IsNull(p_report->candidates[slot].name)) {
+          p_report->candidates[slot].name = p_ctx->names[p_var->result_id];
+        }
+        continue;
+      }
+      uint8_t state = p_ctx->states[p_node->result_id];
+      if ((p_node->result_id == 0) || ((state & PRECISION_FLOAT_VALUE) == 0) ||
+          ((state & PRECISION_CANDIDATE) == 0)) {
+        continue;
+      }
+      uint32_t root = FindChainRoot(p_ctx->chain_roots, p_node->result_id);
+      if (p_ctx->chain_slots[root] == (uint32_t)INVALID_VALUE) {
+        SpvReflectHalfPrecisionCandidate candidate;
+        memset(&candidate, 0, sizeof(candidate));
+        candidate.kind = SPV_REFLECT_HALF_PRECISION_KIND_CHAIN;
+        candidate.location = (uint32_t)INVALID_VALUE;
+        SpvReflectResult result = AddHalfPrecisionCandidate(p_report, p_capacity, &candidate);
+        if (result != SPV_REFLECT_RESULT_SUCCESS) {
+          return result;
+        }
+        p_ctx->chain_slots[root] = p_report->candidate_count - 1;
+      }
+      SpvReflectHalfPrecisionCandidate* p_chain = &(p_report->candidates[p_ctx->chain_slots[root]]);
+      p_chain->spirv_id = p_node->result_id;
+      p_chain->flags |= GetPrecisionFlags(state);
+      p_chain->instruction_count += IsPrecisionAluOp(p_parser, p_node) ? 1 : 0;
+      p_chain->component_count += GetTypeSize(p_parser, p_node->result_type_id, false, 0);
+    }
+  }
+
+  // Chains without arithmetic are just loads and moves
+  uint32_t count = first_chain;
+  for (uint32_t i = first_chain; i < p_report->candidate_count; ++i) {
+    if (p_report->candidates[i].instruction_count > 0) {
+      p_report->candidates[count++] = p_report->candidates[i];
+    }
+  }
+  p_report->candidate_count = count;
+  return SPV_REFLECT_RESULT_SUCCESS;
+}
+
+static SpvReflectResult ParseHalfPrecision(PrecisionContext*                      p_ctx,
+                                           const SpvReflectEntryPoint*            p_entry,
+                                           const SpvReflectHalfPrecisionOptions*  p_options,
+                                           SpvReflectHalfPrecisionReport*         p_report)
+{
+  Parser* p_parser = p_ctx->p_parser;
+  Function* p_entry_func = FindFunction(p_parser, p_entry->id);
+  if (IsNull(p_entry_func)) {
+    return SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_ID_REFERENCE;
+  }
+
+  size_t function_count = 0;
+  uint32_t* function_ids = NULL;
+  SpvReflectResult result = EnumerateCalledFunctions(p_parser, p_entry_func, &function_count, &function_ids);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  p_ctx->states = (uint8_t*)calloc(p_parser->id_bound, sizeof(*(p_ctx->states)));
+  p_ctx->names = (const char**)calloc(p_parser->id_bound, sizeof(*(p_ctx->names)));
+  p_ctx->chain_roots = (uint32_t*)calloc(p_parser->id_bound, sizeof(*(p_ctx->chain_roots)));
+  p_ctx->chain_slots = (uint32_t*)calloc(p_parser->id_bound, sizeof(*(p_ctx->chain_slots)));
+  p_ctx->ranges = (size_t*)calloc(2 * function_count + 1, sizeof(*(p_ctx->ranges)));
+  if (IsNull(p_ctx->states) || IsNull(p_ctx->names) || IsNull(p_ctx->chain_roots) ||
+      IsNull(p_ctx->chain_slots) || IsNull(p_ctx->ranges)) {
+    SafeFree(function_ids);
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  for (size_t i = 0; i < function_count; ++i) {
+    Node* p_func_node = FindIdNode(p_parser, function_ids[i]);
+    if (IsNull(p_func_node) || (p_func_node->op != SpvOpFunction)) {
+      continue;
+    }
+    size_t first_node = (size_t)(p_func_node - p_parser->nodes) + 1;
+    size_t end_node = first_node;
+    while ((end_node < p_parser->node_count) && (p_parser->nodes[end_node].op != SpvOpFunctionEnd)) {
+      ++end_node;
+    }
+    p_ctx->ranges[2 * p_ctx->range_count] = first_node;
+    p_ctx->ranges[2 * p_ctx->range_count + 1] = end_node;
+    ++p_ctx->range_count;
+  }
+  SafeFree(function_ids);
+
+  InitPrecisionStates(p_ctx, p_entry, IsNotNull(p_options) ? p_options->unorm_output_mask : 0);
+  PropagateLowSources(p_ctx);
+  PropagateLowSinks(p_ctx);
+
+  uint32_t capacity = 0;
+  result = ParseHalfPrecisionInterface(p_ctx, p_entry->input_variable_count, p_entry->input_variables,
+                                       SPV_REFLECT_HALF_PRECISION_KIND_INPUT, p_report, &capacity);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseHalfPrecisionInterface(p_ctx, p_entry->output_variable_count, p_entry->output_variables,
+                                         SPV_REFLECT_HALF_PRECISION_KIND_OUTPUT, p_report, &capacity);
+  }
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = ParseHalfPrecisionChains(p_ctx, p_report, &capacity);
+  }
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+  if (p_report->candidate_count > 0) {
+    qsort(p_report->candidates, p_report->candidate_count, sizeof(*(p_report->candidates)),
+          SortCompareHalfPrecisionCandidate);
+  }
+
+  // Register savings, from the pressure estimate with and without the
+  // candidates at half size
+  bool* half_precision_ids = (bool*)calloc(p_parser->id_bound, sizeof(*half_precision_ids));
+  if (IsNull(half_precision_ids)) {
+    return SPV_REFLECT_RESULT_ERROR_ALLOC_FAILED;
+  }
+  for (uint32_t id = 0; id < p_parser->id_bound; ++id) {
+    half_precision_ids[id] = (p_ctx->states[id] & PRECISION_CANDIDATE) != 0;
+  }
+  uint32_t full_registers = 0;
+  uint32_t half_registers = 0;
+  result = EstimatePeakRegisters(p_parser, p_entry, NULL, &full_registers);
+  if (result == SPV_REFLECT_RESULT_SUCCESS) {
+    result = EstimatePeakRegisters(p_parser, p_entry, half_precision_ids, &half_registers);
+  }
+  SafeFree(half_precision_ids);
+  if ((result == SPV_REFLECT_RESULT_SUCCESS) && (full_registers > half_registers)) {
+    p_report->register_savings = full_registers - half_registers;
+  }
+
+  p_report->entry_point_name = p_entry->name;
+  p_report->shader_stage = p_entry->shader_stage;
+  return result;
+}
+
+SpvReflectResult spvReflectGetEntryPointHalfPrecision(
+  const SpvReflectShaderModule*          p_module,
+  const char*                            entry_point,
+  const SpvReflectHalfPrecisionOptions*  p_options,
+  SpvReflectHalfPrecisionReport*         p_report
+)
+{
+  if (IsNull(p_module) || IsNull(entry_point) || IsNull(p_report)) {
+    return SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+  }
+  memset(p_report, 0, sizeof(*p_report));
+
+  const SpvReflectEntryPoint* p_entry = spvReflectGetEntryPoint(p_module, entry_point);
+  if (IsNull(p_entry)) {
+    return SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND;
+  }
+
+  Parser parser;
+  SpvReflectResult result = CreateAnalysisParser(p_module, &parser);
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    return result;
+  }
+
+  PrecisionContext context;
+  memset(&context, 0, sizeof(context));
+  context.p_parser = &parser;
+  result = ParseHalfPrecision(&context, p_entry, p_options, p_report);
+
+  SafeFree(context.ranges);
+  SafeFree(context.chain_slots);
+  SafeFree(context.chain_roots);
+  SafeFree(context.names);
+  SafeFree(context.states);
+  DestroyParser(&parser);
+
+  if (result != SPV_REFLECT_RESULT_SUCCESS) {
+    spvReflectDestroyHalfPrecisionReport(p_report);
+  }
+  return result;
+}
+
+void spvReflectDestroyHalfPrecisionReport(SpvReflectHalfPrecisionReport* p_report)
+{
+  if (IsNull(p_report)) {
+    return;
+  }
+  SafeFree(p_report->candidates);
+  p_report->candidate_count = 0;
+}
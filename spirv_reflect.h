@@ -69,6 +69,7 @@ typedef enum SpvReflectResult {
   SPV_REFLECT_RESULT_ERROR_SPIRV_SET_NUMBER_OVERFLOW,
   SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_STORAGE_CLASS,
   SPV_REFLECT_RESULT_ERROR_SPIRV_RECURSION,
+  SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_EXECUTION_MODE,
 } SpvReflectResult;
 
 /*! @enum SpvReflectTypeFlagBits
@@ -110,6 +111,119 @@ typedef enum SpvReflectDecorationFlagBits {
 
 typedef uint32_t SpvReflectDecorationFlags;
 
+/*! @enum SpvReflectDescriptorCompactionFlagBits
+
+*/
+typedef enum SpvReflectDescriptorCompactionFlagBits {
+  SPV_REFLECT_DESCRIPTOR_COMPACTION_NONE          = 0x00000000,
+  SPV_REFLECT_DESCRIPTOR_COMPACTION_COLLAPSE_SETS = 0x00000001,
+} SpvReflectDescriptorCompactionFlagBits;
+
+typedef uint32_t SpvReflectDescriptorCompactionFlags;
+
+/*! @enum SpvReflectDiffFlagBits
+
+ What changed between the old and new version of a binding, block member,
+ push constant block or interface variable.
+
+*/
+typedef enum SpvReflectDiffFlagBits {
+  SPV_REFLECT_DIFF_NONE             = 0x00000000,
+  SPV_REFLECT_DIFF_ADDED            = 0x00000001,
+  SPV_REFLECT_DIFF_REMOVED          = 0x00000002,
+  SPV_REFLECT_DIFF_SET              = 0x00000004,
+  SPV_REFLECT_DIFF_BINDING          = 0x00000008,
+  SPV_REFLECT_DIFF_DESCRIPTOR_TYPE  = 0x00000010,
+  SPV_REFLECT_DIFF_COUNT            = 0x00000020,
+  SPV_REFLECT_DIFF_TYPE             = 0x00000040,
+  SPV_REFLECT_DIFF_BLOCK_LAYOUT     = 0x00000080,
+  SPV_REFLECT_DIFF_OFFSET           = 0x00000100,
+  SPV_REFLECT_DIFF_SIZE             = 0x00000200,
+  SPV_REFLECT_DIFF_LOCATION         = 0x00000400,
+  SPV_REFLECT_DIFF_FORMAT           = 0x00000800,
+} SpvReflectDiffFlagBits;
+
+typedef uint32_t SpvReflectDiffFlags;
+
+/*! @enum SpvReflectRebuildFlagBits
+
+ What a host has to rebuild when it swaps the old shader for the new one.
+ STAGE_INTERFACE means outputs, or inputs of a stage other than vertex,
+ changed and the linked stages need to be checked.
+
+*/
+typedef enum SpvReflectRebuildFlagBits {
+  SPV_REFLECT_REBUILD_SHADER_MODULE       = 0x00000000,
+  SPV_REFLECT_REBUILD_PIPELINE_LAYOUT     = 0x00000001,
+  SPV_REFLECT_REBUILD_VERTEX_INPUT_STATE  = 0x00000002,
+  SPV_REFLECT_REBUILD_HOST_STRUCTS        = 0x00000004,
+  SPV_REFLECT_REBUILD_STAGE_INTERFACE     = 0x00000008,
+} SpvReflectRebuildFlagBits;
+
+typedef uint32_t SpvReflectRebuildFlags;
+
+/*! @enum SpvReflectBindingAccessFlagBits
+
+ How an entry point accesses a storage buffer, storage image or texel
+ buffer binding. NONE means it is never accessed, READ | WRITE that it is
+ read-write, and ATOMIC is set for any atomic access.
+
+*/
+typedef enum SpvReflectBindingAccessFlagBits {
+  SPV_REFLECT_BINDING_ACCESS_NONE    = 0x00000000,
+  SPV_REFLECT_BINDING_ACCESS_READ    = 0x00000001,
+  SPV_REFLECT_BINDING_ACCESS_WRITE   = 0x00000002,
+  SPV_REFLECT_BINDING_ACCESS_ATOMIC  = 0x00000004,
+} SpvReflectBindingAccessFlagBits;
+
+typedef uint32_t SpvReflectBindingAccessFlags;
+
+/*! @enum SpvReflectNumericClassFlagBits
+
+ The numeric type of a vertex attribute or shader input. A vertex format
+ must have the same numeric type as the input it feeds: UNORM, SNORM,
+ SCALED and SRGB formats are FLOAT.
+
+*/
+typedef enum SpvReflectNumericClassFlagBits {
+  SPV_REFLECT_NUMERIC_CLASS_NONE     = 0x00000000,
+  SPV_REFLECT_NUMERIC_CLASS_FLOAT    = 0x00000001,
+  SPV_REFLECT_NUMERIC_CLASS_SINT     = 0x00000002,
+  SPV_REFLECT_NUMERIC_CLASS_UINT     = 0x00000004,
+  SPV_REFLECT_NUMERIC_CLASS_FLOAT64  = 0x00000008,
+  SPV_REFLECT_NUMERIC_CLASS_SINT64   = 0x00000010,
+  SPV_REFLECT_NUMERIC_CLASS_UINT64   = 0x00000020,
+} SpvReflectNumericClassFlagBits;
+
+typedef uint32_t SpvReflectNumericClassFlags;
+
+/*! @enum SpvReflectPrecisionFlagBits
+
+ Why a value could use 16-bit floats. LOW_SOURCES means it is computed only
+ from low precision sources: RelaxedPrecision values, reads of images with
+ 8-bit, 10-bit or 16-bit float formats, and constants that 16-bit floats
+ represent exactly. LOW_SINKS means it only feeds outputs that are stored
+ at low precision.
+
+*/
+typedef enum SpvReflectPrecisionFlagBits {
+  SPV_REFLECT_PRECISION_NONE         = 0x00000000,
+  SPV_REFLECT_PRECISION_LOW_SOURCES  = 0x00000001,
+  SPV_REFLECT_PRECISION_LOW_SINKS    = 0x00000002,
+} SpvReflectPrecisionFlagBits;
+
+typedef uint32_t SpvReflectPrecisionFlags;
+
+/*! @enum SpvReflectHalfPrecisionKind
+
+*/
+typedef enum SpvReflectHalfPrecisionKind {
+  SPV_REFLECT_HALF_PRECISION_KIND_INPUT     = 0,
+  SPV_REFLECT_HALF_PRECISION_KIND_OUTPUT    = 1,
+  SPV_REFLECT_HALF_PRECISION_KIND_VARIABLE  = 2,
+  SPV_REFLECT_HALF_PRECISION_KIND_CHAIN     = 3,
+} SpvReflectHalfPrecisionKind;
+
 /*! @enum SpvReflectResourceType
 
 */
@@ -188,6 +302,10 @@ typedef enum SpvReflectGenerator {
 enum {
   SPV_REFLECT_MAX_ARRAY_DIMS                    = 32,
   SPV_REFLECT_MAX_DESCRIPTOR_SETS               = 64,
+  SPV_REFLECT_MAX_STORAGE_CLASSES               = 13,
+  SPV_REFLECT_MAX_DESCRIPTOR_TYPES              = 11,
+  SPV_REFLECT_MAX_SIGNATURE_LOCATIONS           = 32,
+  SPV_REFLECT_MINHASH_SIZE                      = 64,
 };
 
 enum {
@@ -339,6 +457,29 @@ typedef struct SpvReflectDescriptorSet {
   SpvReflectDescriptorBinding**     bindings;
 } SpvReflectDescriptorSet;
 
+/*! @struct SpvReflectImageSamplerPair
+
+ A separate image and sampler that an entry point combines with
+ OpSampledImage, as HLSL Texture and SamplerState objects compile to.
+
+*/
+typedef struct SpvReflectImageSamplerPair {
+  SpvReflectDescriptorBinding*      p_image;
+  SpvReflectDescriptorBinding*      p_sampler;
+} SpvReflectImageSamplerPair;
+
+/*! @struct SpvReflectDescriptorBindingAccess
+
+ How an entry point accesses one of the module's storage buffer (including
+ UAV counter), storage image, uniform texel buffer or storage texel buffer
+ bindings.
+
+*/
+typedef struct SpvReflectDescriptorBindingAccess {
+  SpvReflectDescriptorBinding*      p_binding;
+  SpvReflectBindingAccessFlags      access;
+} SpvReflectDescriptorBindingAccess;
+
 /*! @struct SpvReflectEntryPoint
 
  */
@@ -361,8 +502,39 @@ typedef struct SpvReflectEntryPoint {
   uint32_t*                         used_uniforms;
   uint32_t                          used_push_constant_count;
   uint32_t*                         used_push_constants;
+
+  uint32_t                          image_sampler_pair_count;
+  SpvReflectImageSamplerPair*       image_sampler_pairs;
+
+  uint32_t                          binding_access_count;
+  SpvReflectDescriptorBindingAccess* binding_accesses;
 } SpvReflectEntryPoint;
 
+/*! @struct SpvReflectSamplerUsage
+
+ How the entry points of a pipeline use one sampler binding. p_image is
+ the only image it is combined with when image_count is 1, and NULL
+ otherwise.
+
+*/
+typedef struct SpvReflectSamplerUsage {
+  const SpvReflectDescriptorBinding*  p_sampler;
+  uint32_t                            stage_flags;
+  uint32_t                            image_count;
+  const SpvReflectDescriptorBinding*  p_image;
+} SpvReflectSamplerUsage;
+
+/*! @struct SpvReflectShaderModuleOptions
+
+ entry_point_names lists entry_point_count entry points to reflect. With
+ none listed, every entry point is reflected.
+
+*/
+typedef struct SpvReflectShaderModuleOptions {
+  uint32_t                          entry_point_count;
+  const char* const*                entry_point_names;
+} SpvReflectShaderModuleOptions;
+
 /*! @struct SpvReflectShaderModule
 
 */
@@ -396,10 +568,647 @@ typedef struct SpvReflectShaderModule {
 
     size_t                          type_description_count;
     SpvReflectTypeDescription*      type_descriptions;
+
+    // Set for clones and the modules they were cloned from: the original
+    // reflection data, freed with its last user. owned_parts tells which
+    // parts this module has since copied.
+    struct SpvReflectShaderModule*  p_shared;
+    uint32_t                        shared_ref_count;
+    uint32_t                        owned_parts;
+
+    // Set when an entry point filter left out entry points, so the bindings
+    // only those entry points use are missing
+    uint32_t                        entry_points_filtered;
   } * _internal;
 
 } SpvReflectShaderModule;
 
+/*! @struct SpvReflectDescriptorBindingRemap
+
+ Where spvReflectCompactDescriptorBindings() moved a descriptor binding.
+ Removed bindings keep their old set and binding numbers.
+
+*/
+typedef struct SpvReflectDescriptorBindingRemap {
+  uint32_t                          spirv_id;
+  uint32_t                          removed;
+  uint32_t                          old_set;
+  uint32_t                          old_binding;
+  uint32_t                          set;
+  uint32_t                          binding;
+} SpvReflectDescriptorBindingRemap;
+
+/*! @struct SpvReflectDescriptorBindingRemapTable
+
+ One entry per descriptor binding of the original module, sorted by old
+ set and binding number.
+
+*/
+typedef struct SpvReflectDescriptorBindingRemapTable {
+  uint32_t                          removed_count;
+  uint32_t                          remap_count;
+  SpvReflectDescriptorBindingRemap* remaps;
+} SpvReflectDescriptorBindingRemapTable;
+
+/*! @struct SpvReflectVaryingAssignment
+
+ Where spvReflectPackVaryings() placed an output and the input it feeds.
+ The variables are identified by their SPIR-V ids, which do not change.
+
+*/
+typedef struct SpvReflectVaryingAssignment {
+  uint32_t                          output_spirv_id;
+  uint32_t                          input_spirv_id;
+  uint32_t                          component_count;
+  uint32_t                          old_location;
+  uint32_t                          location;
+  uint32_t                          component;
+} SpvReflectVaryingAssignment;
+
+/*! @struct SpvReflectVaryingPackingReport
+
+ Location usage of a stage interface before and after packing. The
+ assignments are empty when packing would not free a location, in which
+ case neither module is modified.
+
+*/
+typedef struct SpvReflectVaryingPackingReport {
+  uint32_t                          location_count_before;
+  uint32_t                          location_count_after;
+  uint32_t                          assignment_count;
+  SpvReflectVaryingAssignment*      assignments;
+} SpvReflectVaryingPackingReport;
+
+/*! @struct SpvReflectPushConstantCandidate
+
+ A uniform block member that an entry point reads and that could move to
+ push constant storage. offset is its std430 offset in the proposed push
+ constant block and is only meaningful when promoted is not zero.
+
+*/
+typedef struct SpvReflectPushConstantCandidate {
+  uint32_t                          binding_spirv_id;
+  uint32_t                          set;
+  uint32_t                          binding;
+  uint32_t                          member_index;
+  uint32_t                          uniform_offset;
+  uint32_t                          size;
+  uint32_t                          alignment;
+  uint32_t                          access_count;
+  uint32_t                          promoted;
+  uint32_t                          offset;
+} SpvReflectPushConstantCandidate;
+
+/*! @struct SpvReflectPushConstantPlan
+
+ Candidates are ranked by size, smallest first, then by access count.
+ base_offset is where the entry point's existing push constants end and
+ size is where the promoted members end. Nothing is promoted for an entry
+ point that already uses a push constant block.
+
+*/
+typedef struct SpvReflectPushConstantPlan {
+  uint32_t                          budget;
+  uint32_t                          base_offset;
+  uint32_t                          size;
+  uint32_t                          promoted_count;
+  uint32_t                          candidate_count;
+  SpvReflectPushConstantCandidate*  candidates;
+} SpvReflectPushConstantPlan;
+
+/*! @struct SpvReflectOccupancyBudget
+
+ Per-GPU limits used to turn a register pressure estimate into an occupancy
+ estimate. Zero fields fall back to the defaults, which describe a GCN-class
+ GPU: 256 registers per lane allocated in groups of 4, 10 waves per SIMD,
+ 4 SIMDs per compute unit, 64 lanes per wave and 64KB of shared memory.
+
+*/
+typedef struct SpvReflectOccupancyBudget {
+  uint32_t                          registers_per_lane;
+  uint32_t                          register_granularity;
+  uint32_t                          max_waves_per_simd;
+  uint32_t                          simds_per_compute_unit;
+  uint32_t                          wave_size;
+  uint32_t                          shared_memory_size;
+} SpvReflectOccupancyBudget;
+
+/*! @struct SpvReflectBlockPressure
+
+*/
+typedef struct SpvReflectBlockPressure {
+  uint32_t                          label_id;
+  uint32_t                          max_live_values;
+  uint32_t                          max_live_registers;
+} SpvReflectBlockPressure;
+
+/*! @struct SpvReflectFunctionPressure
+
+*/
+typedef struct SpvReflectFunctionPressure {
+  uint32_t                          function_id;
+  const char*                       name;
+  uint32_t                          max_live_values;
+  uint32_t                          max_live_registers;
+  uint32_t                          block_count;
+  SpvReflectBlockPressure*          blocks;
+} SpvReflectFunctionPressure;
+
+/*! @struct SpvReflectRegisterPressure
+
+ Static register pressure and occupancy estimate for one entry point. Live
+ values count SSA results; live registers weight them by their size in
+ 32-bit components. Function calls add the callee's peak to whatever is live
+ across the call, as if the callee was inlined.
+
+*/
+typedef struct SpvReflectRegisterPressure {
+  const char*                       entry_point_name;
+  SpvReflectShaderStageFlagBits     shader_stage;
+  uint32_t                          local_size[3];
+  uint32_t                          shared_memory_size;
+  uint32_t                          max_live_values;
+  uint32_t                          max_live_registers;
+  uint32_t                          allocated_registers;
+  uint32_t                          spilled_registers;
+  uint32_t                          waves_by_registers;
+  uint32_t                          waves_by_shared_memory;
+  uint32_t                          occupancy;
+  uint32_t                          function_count;
+  SpvReflectFunctionPressure*       functions;
+} SpvReflectRegisterPressure;
+
+/*! @struct SpvReflectInstructionCost
+
+ Instruction histogram. ALU counts are bucketed by the component width of
+ the operation (8, 16, 32 and 64 bits), loads and stores by the storage
+ class of the pointer they access. Counts are 64-bit since loop weighting
+ multiplies them by trip counts.
+
+*/
+typedef struct SpvReflectInstructionCost {
+  uint64_t                          instruction_count;
+  uint64_t                          alu_count[4];
+  uint64_t                          transcendental_count;
+  uint64_t                          sample_count;
+  uint64_t                          fetch_count;
+  uint64_t                          gather_count;
+  uint64_t                          image_write_count;
+  uint64_t                          atomic_count;
+  uint64_t                          barrier_count;
+  uint64_t                          call_count;
+  uint64_t                          load_count[SPV_REFLECT_MAX_STORAGE_CLASSES];
+  uint64_t                          store_count[SPV_REFLECT_MAX_STORAGE_CLASSES];
+} SpvReflectInstructionCost;
+
+/*! @struct SpvReflectFunctionCost
+
+ self counts the function's own instructions, total also includes the
+ callees' totals weighted by the loops around each call site.
+
+*/
+typedef struct SpvReflectFunctionCost {
+  uint32_t                          function_id;
+  const char*                       name;
+  uint32_t                          loop_count;
+  uint32_t                          unknown_trip_count_loop_count;
+  SpvReflectInstructionCost         self;
+  SpvReflectInstructionCost         total;
+} SpvReflectFunctionCost;
+
+/*! @struct SpvReflectInstructionCostReport
+
+ Static instruction cost profile of one entry point. Blocks inside a loop
+ are weighted by its trip count when it can be derived from a constant
+ induction variable, otherwise by the default trip count.
+
+*/
+typedef struct SpvReflectInstructionCostReport {
+  const char*                       entry_point_name;
+  SpvReflectShaderStageFlagBits     shader_stage;
+  SpvReflectInstructionCost         total;
+  uint32_t                          function_count;
+  SpvReflectFunctionCost*           functions;
+} SpvReflectInstructionCostReport;
+
+/*! @struct SpvReflectHalfPrecisionOptions
+
+ unorm_output_mask has a bit for each output location that is written to
+ an 8-bit UNORM attachment or otherwise stored at low precision.
+
+*/
+typedef struct SpvReflectHalfPrecisionOptions {
+  uint32_t                          unorm_output_mask;
+} SpvReflectHalfPrecisionOptions;
+
+/*! @struct SpvReflectHalfPrecisionCandidate
+
+ A 32-bit float input, output or function variable that could be declared
+ RelaxedPrecision, or a chain of arithmetic whose values could. spirv_id is
+ the variable, or the last instruction of a chain. A chain's name is that
+ of a variable its result is stored to, if any. location is only set for
+ inputs and outputs. component_count counts the 32-bit components of the
+ variable, or of all the values of the chain.
+
+*/
+typedef struct SpvReflectHalfPrecisionCandidate {
+  SpvReflectHalfPrecisionKind       kind;
+  uint32_t                          spirv_id;
+  const char*                       name;
+  uint32_t                          location;
+  SpvReflectPrecisionFlags          flags;
+  uint32_t                          instruction_count;
+  uint32_t                          component_count;
+} SpvReflectHalfPrecisionCandidate;
+
+/*! @struct SpvReflectHalfPrecisionReport
+
+ Value counts cover 32-bit float results in the functions the entry point
+ calls. register_savings is the drop in the peak live register estimate
+ of spvReflectGetEntryPointRegisterPressure() when every candidate takes
+ half its registers. interface_bytes_saved is the per vertex or per
+ fragment size reduction of the candidate inputs and outputs. Candidates
+ are sorted by kind, and chains by component count, largest first.
+
+*/
+typedef struct SpvReflectHalfPrecisionReport {
+  const char*                       entry_point_name;
+  SpvReflectShaderStageFlagBits     shader_stage;
+  uint32_t                          float_value_count;
+  uint32_t                          relaxed_value_count;
+  uint32_t                          candidate_value_count;
+  uint32_t                          alu_instruction_count;
+  uint32_t                          candidate_alu_instruction_count;
+  uint32_t                          register_savings;
+  uint32_t                          interface_bytes_saved;
+  uint32_t                          candidate_count;
+  SpvReflectHalfPrecisionCandidate* candidates;
+} SpvReflectHalfPrecisionReport;
+
+/*! @struct SpvReflectSourceLineRange
+
+ Instructions of a function body covered by one OpLine. file points into the
+ module's SPIR-V and is NULL if the OpString cannot be found.
+
+*/
+typedef struct SpvReflectSourceLineRange {
+  uint32_t                          function_id;
+  uint32_t                          word_offset;
+  uint32_t                          word_count;
+  const char*                       file;
+  uint32_t                          line;
+  uint32_t                          column;
+} SpvReflectSourceLineRange;
+
+/*! @struct SpvReflectSourceLineCost
+
+*/
+typedef struct SpvReflectSourceLineCost {
+  const char*                       file;
+  uint32_t                          line;
+  SpvReflectInstructionCost         cost;
+} SpvReflectSourceLineCost;
+
+/*! @struct SpvReflectSourceLineCostReport
+
+ Instruction costs of one entry point attributed to the source lines that
+ produced them, hottest line first. Each function's instructions are
+ weighted by how often the entry point calls it, so a call site is only
+ charged for the call itself. Instructions without an OpLine are counted in
+ unattributed.
+
+*/
+typedef struct SpvReflectSourceLineCostReport {
+  const char*                       entry_point_name;
+  SpvReflectShaderStageFlagBits     shader_stage;
+  SpvReflectInstructionCost         total;
+  SpvReflectInstructionCost         unattributed;
+  uint32_t                          line_count;
+  SpvReflectSourceLineCost*         lines;
+} SpvReflectSourceLineCostReport;
+
+/*! @struct SpvReflectFingerprint
+
+ A 128-bit MurmurHash3 digest. Equal fingerprints can be compared with
+ memcmp().
+
+*/
+typedef struct SpvReflectFingerprint {
+  uint64_t                          value[2];
+} SpvReflectFingerprint;
+
+/*! @struct SpvReflectDescriptorSetFingerprint
+
+*/
+typedef struct SpvReflectDescriptorSetFingerprint {
+  uint32_t                          set;
+  SpvReflectFingerprint             fingerprint;
+} SpvReflectDescriptorSetFingerprint;
+
+/*! @struct SpvReflectFingerprints
+
+ module covers every instruction that is not debug information, with ids
+ renumbered in order of first use, so names, line information and id
+ assignment do not change it. The layout fingerprints cover only what a
+ Vulkan layout object is created from and leave out stage flags, so the
+ same layout used by different stages or shaders gets the same
+ fingerprint. descriptor_sets is sorted by set number.
+
+*/
+typedef struct SpvReflectFingerprints {
+  SpvReflectFingerprint               module;
+  uint32_t                            descriptor_set_count;
+  SpvReflectDescriptorSetFingerprint  descriptor_sets[SPV_REFLECT_MAX_DESCRIPTOR_SETS];
+  SpvReflectFingerprint               push_constants;
+  SpvReflectFingerprint               vertex_inputs;
+} SpvReflectFingerprints;
+
+/*! @struct SpvReflectMinHash
+
+ MinHash sketch of the set of instruction n-grams of a module. The share
+ of equal values between two sketches estimates the Jaccard similarity of
+ their n-gram sets.
+
+*/
+typedef struct SpvReflectMinHash {
+  uint32_t                            shingle_count;
+  uint32_t                            values[SPV_REFLECT_MINHASH_SIZE];
+} SpvReflectMinHash;
+
+/*! @struct SpvReflectBlockMemberDiff
+
+ p_old is NULL for an added member and p_new is NULL for a removed one.
+ Members of nested structs are compared too, and listed after their
+ parent.
+
+*/
+typedef struct SpvReflectBlockMemberDiff {
+  const SpvReflectBlockVariable*    p_old;
+  const SpvReflectBlockVariable*    p_new;
+  SpvReflectDiffFlags               flags;
+} SpvReflectBlockMemberDiff;
+
+/*! @struct SpvReflectDescriptorBindingDiff
+
+ member_diffs points into SpvReflectModuleDiff::member_diffs.
+
+*/
+typedef struct SpvReflectDescriptorBindingDiff {
+  const SpvReflectDescriptorBinding*  p_old;
+  const SpvReflectDescriptorBinding*  p_new;
+  SpvReflectDiffFlags                 flags;
+  uint32_t                            member_diff_count;
+  SpvReflectBlockMemberDiff*          member_diffs;
+} SpvReflectDescriptorBindingDiff;
+
+/*! @struct SpvReflectPushConstantDiff
+
+ OFFSET and SIZE report a change of the byte range the block's members
+ cover, which is what the pipeline layout declares.
+
+*/
+typedef struct SpvReflectPushConstantDiff {
+  const SpvReflectBlockVariable*    p_old;
+  const SpvReflectBlockVariable*    p_new;
+  SpvReflectDiffFlags               flags;
+  uint32_t                          member_diff_count;
+  SpvReflectBlockMemberDiff*        member_diffs;
+} SpvReflectPushConstantDiff;
+
+/*! @struct SpvReflectInterfaceVariableDiff
+
+*/
+typedef struct SpvReflectInterfaceVariableDiff {
+  const SpvReflectInterfaceVariable*  p_old;
+  const SpvReflectInterfaceVariable*  p_new;
+  SpvReflectDiffFlags                 flags;
+} SpvReflectInterfaceVariableDiff;
+
+/*! @struct SpvReflectModuleDiff
+
+ Only objects that changed are listed. The diffs point into the two
+ modules that were compared, which must outlive it.
+
+*/
+typedef struct SpvReflectModuleDiff {
+  SpvReflectRebuildFlags            rebuild_flags;
+  uint32_t                          binding_diff_count;
+  SpvReflectDescriptorBindingDiff*  binding_diffs;
+  uint32_t                          push_constant_diff_count;
+  SpvReflectPushConstantDiff*       push_constant_diffs;
+  uint32_t                          input_variable_diff_count;
+  SpvReflectInterfaceVariableDiff*  input_variable_diffs;
+  uint32_t                          output_variable_diff_count;
+  SpvReflectInterfaceVariableDiff*  output_variable_diffs;
+  uint32_t                          member_diff_count;
+  SpvReflectBlockMemberDiff*        member_diffs;
+} SpvReflectModuleDiff;
+
+/*! @struct SpvReflectDescriptorSetDemand
+
+ One descriptor set of a module and how many instances of it are allocated
+ per frame.
+
+*/
+typedef struct SpvReflectDescriptorSetDemand {
+  const SpvReflectShaderModule*     p_module;
+  uint32_t                          set;
+  uint32_t                          instances_per_frame;
+} SpvReflectDescriptorSetDemand;
+
+/*! @struct SpvReflectDescriptorPoolOptions
+
+ Zero fields fall back to the defaults: 2 frames in flight, one pool chunk
+ per frame, and 1024 descriptors for each runtime array binding.
+
+*/
+typedef struct SpvReflectDescriptorPoolOptions {
+  uint32_t                          frames_in_flight;
+  uint32_t                          sets_per_chunk;
+  uint32_t                          runtime_array_size;
+} SpvReflectDescriptorPoolOptions;
+
+/*! @struct SpvReflectDescriptorPoolSize
+
+ descriptor_count covers all frames in flight. chunk_descriptor_count is
+ the share of one pool chunk, and is never less than max_set_count, the
+ most descriptors of this type a single set needs.
+
+*/
+typedef struct SpvReflectDescriptorPoolSize {
+  SpvReflectDescriptorType          descriptor_type;
+  uint32_t                          descriptor_count;
+  uint32_t                          chunk_descriptor_count;
+  uint32_t                          max_set_count;
+} SpvReflectDescriptorPoolSize;
+
+/*! @struct SpvReflectDescriptorPoolPlan
+
+ max_sets and pool_sizes size a single pool for the whole demand. A chunked
+ allocator creates pools with chunk_max_sets sets and the chunk descriptor
+ counts instead; chunk_count of them hold the whole demand. pool_sizes is
+ sorted by descriptor type and only lists the types in use.
+
+*/
+typedef struct SpvReflectDescriptorPoolPlan {
+  uint32_t                          max_sets;
+  uint32_t                          chunk_max_sets;
+  uint32_t                          chunk_count;
+  uint32_t                          pool_size_count;
+  SpvReflectDescriptorPoolSize      pool_sizes[SPV_REFLECT_MAX_DESCRIPTOR_TYPES];
+} SpvReflectDescriptorPoolPlan;
+
+/*! @struct SpvReflectBindlessArray
+
+ A global descriptor array of a bindless table, which holds the bindings of
+ one descriptor type from every planned module.
+
+*/
+typedef struct SpvReflectBindlessArray {
+  SpvReflectDescriptorType          descriptor_type;
+  uint32_t                          binding;
+  uint32_t                          descriptor_count;
+} SpvReflectBindlessArray;
+
+/*! @struct SpvReflectBindlessRange
+
+ The elements [base, base + count) of the global array at array_binding
+ that hold one distinct binding. Bindings of different modules with the
+ same set and binding number and descriptor type share a range.
+
+*/
+typedef struct SpvReflectBindlessRange {
+  SpvReflectDescriptorType          descriptor_type;
+  uint32_t                          set;
+  uint32_t                          binding;
+  uint32_t                          array_binding;
+  uint32_t                          base;
+  uint32_t                          count;
+} SpvReflectBindlessRange;
+
+/*! @struct SpvReflectBindlessBindingRemap
+
+ Where one descriptor binding of a module moves in the bindless table.
+
+*/
+typedef struct SpvReflectBindlessBindingRemap {
+  uint32_t                          spirv_id;
+  uint32_t                          set;
+  uint32_t                          binding;
+  uint32_t                          array_binding;
+  uint32_t                          base;
+  uint32_t                          count;
+} SpvReflectBindlessBindingRemap;
+
+/*! @struct SpvReflectBindlessModuleRemap
+
+ The remaps of one module's descriptor bindings, in the module's binding
+ order. Input attachments cannot be bindless and are not listed.
+
+*/
+typedef struct SpvReflectBindlessModuleRemap {
+  uint32_t                          remap_count;
+  SpvReflectBindlessBindingRemap*   remaps;
+} SpvReflectBindlessModuleRemap;
+
+/*! @struct SpvReflectBindlessPlan
+
+ All global arrays live in descriptor set set, one per descriptor type in
+ use, with bindings numbered from zero in descriptor type order. Ranges are
+ sorted by descriptor type, then set and binding number.
+
+*/
+typedef struct SpvReflectBindlessPlan {
+  uint32_t                          set;
+  uint32_t                          array_count;
+  SpvReflectBindlessArray           arrays[SPV_REFLECT_MAX_DESCRIPTOR_TYPES];
+  uint32_t                          range_count;
+  SpvReflectBindlessRange*          ranges;
+  uint32_t                          module_count;
+  SpvReflectBindlessModuleRemap*    module_remaps;
+} SpvReflectBindlessPlan;
+
+/*! @struct SpvReflectSharedBlockBinding
+
+ One module's binding of a shared block. name points into the module's
+ reflection data.
+
+*/
+typedef struct SpvReflectSharedBlockBinding {
+  uint32_t                          module_index;
+  uint32_t                          spirv_id;
+  uint32_t                          set;
+  uint32_t                          binding;
+  const char*                       name;
+} SpvReflectSharedBlockBinding;
+
+/*! @struct SpvReflectSharedBlock
+
+ Uniform or storage buffer bindings of two or more modules with the same
+ descriptor type, descriptor count and block layout. layout is the block's
+ layout fingerprint. set and binding are the most common location of the
+ bindings that is free in every module that has one of them, or else the
+ next unused binding number of that set. Bindings are sorted by module
+ index, then set and binding number.
+
+*/
+typedef struct SpvReflectSharedBlock {
+  SpvReflectFingerprint             layout;
+  SpvReflectDescriptorType          descriptor_type;
+  uint32_t                          count;
+  uint32_t                          size;
+  const char*                       type_name;
+  uint32_t                          set;
+  uint32_t                          binding;
+  uint32_t                          module_count;
+  uint32_t                          binding_count;
+  SpvReflectSharedBlockBinding*     bindings;
+} SpvReflectSharedBlock;
+
+/*! @struct SpvReflectSharedBlockReport
+
+ Shared blocks sorted by the number of modules that declare them, most
+ shared first. The report points into the modules it was built from, which
+ must outlive it.
+
+*/
+typedef struct SpvReflectSharedBlockReport {
+  uint32_t                          block_count;
+  SpvReflectSharedBlock*            blocks;
+} SpvReflectSharedBlockReport;
+
+/*! @struct SpvReflectVertexAttribute
+
+ semantic is optional. Three and four component 64-bit attributes occupy
+ location and location + 1.
+
+*/
+typedef struct SpvReflectVertexAttribute {
+  uint32_t                          location;
+  SpvReflectNumericClassFlagBits    numeric_class;
+  uint32_t                          component_count;
+  const char*                       semantic;
+} SpvReflectVertexAttribute;
+
+/*! @struct SpvReflectInputSignature
+
+ The locations of a shader's inputs or of a vertex format, as fixed size
+ arrays indexed by location so two signatures are compared with a few word
+ operations. Each location has a single numeric class bit, or none for
+ locations of a struct input, which take any numeric type. semantic_ids
+ holds spvReflectInternSemantic() values, with a bit set in semantic_mask
+ for each location that has one; the locations of a matrix or array input
+ get consecutive semantic indices.
+
+*/
+typedef struct SpvReflectInputSignature {
+  uint32_t                          location_mask;
+  uint32_t                          semantic_mask;
+  uint8_t                           numeric_classes[SPV_REFLECT_MAX_SIGNATURE_LOCATIONS];
+  uint8_t                           component_counts[SPV_REFLECT_MAX_SIGNATURE_LOCATIONS];
+  uint32_t                          semantic_ids[SPV_REFLECT_MAX_SIGNATURE_LOCATIONS];
+} SpvReflectInputSignature;
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -418,6 +1227,32 @@ SpvReflectResult spvReflectCreateShaderModule(
   SpvReflectShaderModule*  p_module
 );
 
+/*! @fn spvReflectCreateShaderModuleWithOptions
+
+ @param  size       Size in bytes of SPIR-V code.
+ @param  p_code     Pointer to SPIR-V code.
+ @param  p_options  Optional, the entry points to reflect.
+ @param  p_module   Pointer to an instance of SpvReflectShaderModule.
+ @return            SPV_REFLECT_RESULT_SUCCESS on success, or
+                    SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND if a listed
+                    entry point is not in the module.
+
+ @brief  Reflects only the listed entry points of a module with many. The
+         functions the other entry points call alone are not scanned, and
+         the module's descriptor bindings and push constant blocks are
+         limited to those the listed entry points use. Functions that
+         rewrite the descriptor bindings, push constants or varyings of
+         every entry point return SPV_REFLECT_RESULT_NOT_READY if any entry point is
+         left out; reflect the module without a filter to rewrite it.
+
+*/
+SpvReflectResult spvReflectCreateShaderModuleWithOptions(
+  size_t                                size,
+  const void*                           p_code,
+  const SpvReflectShaderModuleOptions*  p_options,
+  SpvReflectShaderModule*               p_module
+);
+
 SPV_REFLECT_DEPRECATED("renamed to spvReflectCreateShaderModule")
 SpvReflectResult spvReflectGetShaderModule(
   size_t                   size,
@@ -426,6 +1261,32 @@ SpvReflectResult spvReflectGetShaderModule(
 );
 
 
+/*! @fn spvReflectCloneShaderModule
+
+ @param  p_module  Pointer to an instance of SpvReflectShaderModule.
+ @param  p_clone   Receives a copy of p_module. Destroy it with
+                   spvReflectDestroyShaderModule().
+ @return           SPV_REFLECT_RESULT_SUCCESS on success.
+
+ @brief  Makes a copy of a module that shares its parsed data instead of
+         parsing the SPIR-V again. The SPIR-V words, the descriptor binding
+         array and the entry point arrays are copied the first time the
+         clone, or p_module, is changed with spvReflectChange*(), so each
+         variant only pays for what it changes. Types, names, block members
+         and push constant blocks stay shared and are freed with the last
+         module that uses them. Parts that p_module has already changed are
+         copied right away.
+         A module's binding, set and interface variable pointers from before
+         its first change do not point at its own data afterwards. Modules
+         that share data must not be cloned or destroyed concurrently.
+
+*/
+SpvReflectResult spvReflectCloneShaderModule(
+  SpvReflectShaderModule*  p_module,
+  SpvReflectShaderModule*  p_clone
+);
+
+
 /*! @fn spvReflectDestroyShaderModule
 
  @param  p_module  Pointer to an instance of SpvReflectShaderModule.
@@ -730,21 +1591,113 @@ SpvReflectResult spvReflectEnumerateEntryPointPushConstantBlocks(
 );
 
 
-/*! @fn spvReflectGetDescriptorBinding
+/*! @fn spvReflectEnumerateEntryPointImageSamplerPairs
+ @brief  Enumerate the (image, sampler) binding pairs that OpSampledImage
+         combines in the static call tree of a given entry point, sorted by
+         image then sampler set and binding numbers. Images and samplers
+         that reach OpSampledImage through function parameters are not
+         traced.
+ @param  p_module     Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point  The entry point to get the pairs for.
+ @param  p_count   If pp_pairs is NULL, the entry point's pair count will be
+                   stored here.
+                   If pp_pairs is not NULL, *p_count must contain the entry
+                   point's pair count.
+ @param  pp_pairs  If NULL, the entry point's pair count will be written to
+                   *p_count.
+                   If non-NULL, pp_pairs must point to an array with
+                   *p_count entries, where pointers to the entry point's
+                   pairs will be written.
+ @return           If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                   Otherwise, the error code indicates the cause of the
+                   failure.
 
- @param  p_module        Pointer to an instance of SpvReflectShaderModule.
- @param  binding_number  The "binding" value of the requested descriptor
-                         binding.
- @param  set_number      The "set" value of the requested descriptor binding.
- @param  p_result        If successful, SPV_REFLECT_RESULT_SUCCESS will be
-                         written to *p_result. Otherwise, a error code
-                         indicating the cause of the failure will be stored
-                         here.
- @return                 If the module contains a descriptor binding that
-                         matches the provided [binding_number, set_number]
-                         values, a pointer to that binding is returned. The
-                         caller must not free this pointer.
-                         If no match can be found, or if an unrelated error
+*/
+SpvReflectResult spvReflectEnumerateEntryPointImageSamplerPairs(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  uint32_t*                      p_count,
+  SpvReflectImageSamplerPair**   pp_pairs
+);
+
+
+/*! @fn spvReflectEnumerateEntryPointBindingAccesses
+ @brief  Enumerate how the static call tree of a given entry point accesses
+         each of the module's storage buffer, storage image and texel
+         buffer bindings, in the module's binding order. Loads, stores,
+         image reads and writes and atomics are traced back to their
+         binding through access chains. A binding whose pointer or image
+         is passed to a function call, OpPhi or OpSelect is conservatively
+         reported as both read and written. Bindings the entry point never
+         accesses are reported with SPV_REFLECT_BINDING_ACCESS_NONE.
+ @param  p_module     Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point  The entry point to get the accesses for.
+ @param  p_count      If pp_accesses is NULL, the entry point's access count
+                      will be stored here.
+                      If pp_accesses is not NULL, *p_count must contain the
+                      entry point's access count.
+ @param  pp_accesses  If NULL, the entry point's access count will be
+                      written to *p_count.
+                      If non-NULL, pp_accesses must point to an array with
+                      *p_count entries, where pointers to the entry point's
+                      accesses will be written.
+ @return              If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                      Otherwise, the error code indicates the cause of the
+                      failure.
+
+*/
+SpvReflectResult spvReflectEnumerateEntryPointBindingAccesses(
+  const SpvReflectShaderModule*       p_module,
+  const char*                         entry_point,
+  uint32_t*                           p_count,
+  SpvReflectDescriptorBindingAccess** pp_accesses
+);
+
+
+/*! @fn spvReflectEnumerateSamplerUsage
+ @brief  Merges the image-sampler pairs of the entry points that make up a
+         pipeline by sampler set and binding number. A sampler that is
+         only ever combined with one image can become an immutable sampler,
+         or be folded into a combined image sampler for that image, which
+         removes its per-draw descriptor update.
+ @param  entry_point_count  Number of entry points in pp_entry_points.
+ @param  pp_entry_points    The pipeline's entry points, typically one per
+                            stage and possibly from different modules.
+ @param  p_count            If p_usages is NULL, the number of distinct
+                            sampler bindings will be stored here.
+                            If p_usages is not NULL, *p_count must contain
+                            that number.
+ @param  p_usages           If non-NULL, must point to an array with
+                            *p_count entries, which are filled in sorted by
+                            set and binding number.
+ @return                    If successful, returns
+                            SPV_REFLECT_RESULT_SUCCESS. Otherwise, the error
+                            code indicates the cause of the failure.
+
+*/
+SpvReflectResult spvReflectEnumerateSamplerUsage(
+  uint32_t                            entry_point_count,
+  const SpvReflectEntryPoint* const*  pp_entry_points,
+  uint32_t*                           p_count,
+  SpvReflectSamplerUsage*             p_usages
+);
+
+
+/*! @fn spvReflectGetDescriptorBinding
+
+ @param  p_module        Pointer to an instance of SpvReflectShaderModule.
+ @param  binding_number  The "binding" value of the requested descriptor
+                         binding.
+ @param  set_number      The "set" value of the requested descriptor binding.
+ @param  p_result        If successful, SPV_REFLECT_RESULT_SUCCESS will be
+                         written to *p_result. Otherwise, a error code
+                         indicating the cause of the failure will be stored
+                         here.
+ @return                 If the module contains a descriptor binding that
+                         matches the provided [binding_number, set_number]
+                         values, a pointer to that binding is returned. The
+                         caller must not free this pointer.
+                         If no match can be found, or if an unrelated error
                          occurs, the return value will be NULL. Detailed
                          error results are written to *pResult.
 @note                    If the module contains multiple desriptor bindings
@@ -1186,57 +2139,796 @@ SpvReflectResult spvReflectChangeDescriptorBindingNumber(
                          Otherwise, the error code indicates the cause of
                          the failure.
 */
-SpvReflectResult spvReflectChangeDescriptorSetNumber(
-  SpvReflectShaderModule*        p_module,
-  const SpvReflectDescriptorSet* p_set,
-  uint32_t                       new_set_number
+SpvReflectResult spvReflectChangeDescriptorSetNumber(
+  SpvReflectShaderModule*        p_module,
+  const SpvReflectDescriptorSet* p_set,
+  uint32_t                       new_set_number
+);
+
+/*! @fn spvReflectChangeInputVariableLocation
+ @brief  Assign a new location to an input interface variable.
+         In addition to updating the reflection data, this function modifies
+         the underlying SPIR-V bytecode. The updated code can be retrieved
+         with spvReflectGetCode().
+         It is the caller's responsibility to avoid assigning the same
+         location to multiple input variables.  If the input variable is used
+         by multiple entry points in the module, it will be changed in all of
+         them.
+ @param  p_module          Pointer to an instance of SpvReflectShaderModule.
+ @param  p_input_variable  Pointer to the input variable to update.
+ @param  new_location      The new location to assign to p_input_variable.
+ @return                   If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                           Otherwise, the error code indicates the cause of
+                           the failure.
+
+*/
+SpvReflectResult spvReflectChangeInputVariableLocation(
+  SpvReflectShaderModule*            p_module,
+  const SpvReflectInterfaceVariable* p_input_variable,
+  uint32_t                           new_location
+);
+
+
+/*! @fn spvReflectChangeOutputVariableLocation
+ @brief  Assign a new location to an output interface variable.
+         In addition to updating the reflection data, this function modifies
+         the underlying SPIR-V bytecode. The updated code can be retrieved
+         with spvReflectGetCode().
+         It is the caller's responsibility to avoid assigning the same
+         location to multiple output variables.  If the output variable is used
+         by multiple entry points in the module, it will be changed in all of
+         them.
+ @param  p_module          Pointer to an instance of SpvReflectShaderModule.
+ @param  p_output_variable  Pointer to the output variable to update.
+ @param  new_location      The new location to assign to p_output_variable.
+ @return                   If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                           Otherwise, the error code indicates the cause of
+                           the failure.
+
+*/
+SpvReflectResult spvReflectChangeOutputVariableLocation(
+  SpvReflectShaderModule*             p_module,
+  const SpvReflectInterfaceVariable*  p_output_variable,
+  uint32_t                            new_location
+);
+
+
+/*! @fn spvReflectCompactDescriptorBindings
+ @brief  Removes the descriptor variables that no entry point accesses,
+         together with their names and decorations, and renumbers the
+         remaining bindings of each set densely from zero in their original
+         order. Variables that share a binding keep sharing it. With
+         SPV_REFLECT_DESCRIPTOR_COMPACTION_COLLAPSE_SETS the remaining sets
+         are renumbered densely too.
+         A variable is only removed if nothing in the code references it,
+         so descriptors passed to functions or only used by unreachable
+         code are kept. p_module is re-reflected from the rewritten SPIR-V,
+         which can be retrieved with spvReflectGetCode(). Pointers into its
+         previous reflection data are invalidated.
+ @param  p_module  Pointer to an instance of SpvReflectShaderModule.
+ @param  flags     SpvReflectDescriptorCompactionFlagBits.
+ @param  p_table   Receives the remap table to apply on the host side.
+                   Release it with
+                   spvReflectDestroyDescriptorBindingRemapTable().
+ @return           If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                   Returns SPV_REFLECT_RESULT_NOT_READY if p_module leaves
+                   out entry points.
+                   Otherwise, the error code indicates the cause of the
+                   failure and p_module is left unchanged.
+
+*/
+SpvReflectResult spvReflectCompactDescriptorBindings(
+  SpvReflectShaderModule*                 p_module,
+  SpvReflectDescriptorCompactionFlags     flags,
+  SpvReflectDescriptorBindingRemapTable*  p_table
+);
+
+
+/*! @fn spvReflectDestroyDescriptorBindingRemapTable
+
+ @param  p_table  Pointer to a table filled in by
+                  spvReflectCompactDescriptorBindings().
+
+*/
+void spvReflectDestroyDescriptorBindingRemapTable(SpvReflectDescriptorBindingRemapTable* p_table);
+
+
+/*! @fn spvReflectEliminateDeadOutputs
+ @brief  Removes the output variables of entry_point that the next pipeline
+         stage never declares as inputs. Each removed variable is deleted
+         together with its stores, access chains, names, decorations and
+         entry point interface operand, and p_module is re-reflected from the
+         rewritten SPIR-V, which can be retrieved with spvReflectGetCode().
+         Pointers into p_module's previous reflection data are invalidated
+         when at least one variable is removed.
+         Built-ins, outputs without a Location and outputs that are read
+         back, copied from, passed to functions or shared with another entry
+         point are always kept. Inputs are matched by overlapping location
+         ranges, ignoring Component decorations.
+ @param  p_module              Pointer to the producing stage's module. Must
+                               be a vertex, tessellation or geometry shader.
+ @param  entry_point           The producing entry point.
+ @param  p_next_stage          Pointer to the module consuming the outputs.
+                               May be the same as p_module.
+ @param  next_entry_point      The consuming entry point.
+ @param  p_removed_count       Optional, receives the number of output
+                               variables removed.
+ @return                       If successful, returns
+                               SPV_REFLECT_RESULT_SUCCESS. Returns
+                               SPV_REFLECT_RESULT_NOT_READY if p_module
+                               leaves out entry points. Otherwise, the
+                               error code indicates the cause of the failure
+                               and p_module is left unchanged.
+
+*/
+SpvReflectResult spvReflectEliminateDeadOutputs(
+  SpvReflectShaderModule*        p_module,
+  const char*                    entry_point,
+  const SpvReflectShaderModule*  p_next_stage,
+  const char*                    next_entry_point,
+  uint32_t*                      p_removed_count
+);
+
+
+/*! @fn spvReflectPackVaryings
+ @brief  Packs the scalar and vector varyings between two stages into fewer
+         locations using Component decorations. Pairs of an output and the
+         input at the same location are grouped by component type and
+         interpolation decorations (Flat, NoPerspective, Centroid, Sample)
+         and assigned first fit, widest first. Arrays, matrices, structs,
+         64-bit types, per-vertex arrayed interfaces, variables that already
+         have a Component decoration and variables shared with another entry
+         point keep their location, as do unpaired variables.
+         Both modules are rewritten and re-reflected together, or neither is.
+         Pointers into their previous reflection data are invalidated when
+         the report has assignments.
+ @param  p_module          Pointer to the producing stage's module. Must be a
+                           vertex, tessellation or geometry shader.
+ @param  entry_point       The producing entry point.
+ @param  p_next_stage      Pointer to the consuming stage's module. May be
+                           the same as p_module.
+ @param  next_entry_point  The consuming entry point.
+ @param  p_report          Receives the location usage and assignments.
+                           Release it with
+                           spvReflectDestroyVaryingPackingReport().
+ @return                   If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                           Returns SPV_REFLECT_RESULT_NOT_READY if either
+                           module leaves out entry points.
+                           Otherwise, the error code indicates the cause of
+                           the failure and both modules are left unchanged.
+
+*/
+SpvReflectResult spvReflectPackVaryings(
+  SpvReflectShaderModule*          p_module,
+  const char*                      entry_point,
+  SpvReflectShaderModule*          p_next_stage,
+  const char*                      next_entry_point,
+  SpvReflectVaryingPackingReport*  p_report
+);
+
+
+/*! @fn spvReflectDestroyVaryingPackingReport
+
+ @param  p_report  Pointer to a report filled in by spvReflectPackVaryings().
+
+*/
+void spvReflectDestroyVaryingPackingReport(SpvReflectVaryingPackingReport* p_report);
+
+
+/*! @fn spvReflectGetPushConstantPlan
+ @brief  Finds the members of uniform buffers that an entry point reads and
+         proposes which of them to move to push constants. Only scalar,
+         vector and matrix members of 32 or 64 bits are candidates; arrays
+         and structs keep std140 strides that a push constant block cannot
+         change. Blocks that are arrayed, passed to functions, loaded whole
+         or indexed dynamically are skipped, as are members that a function
+         reachable from another entry point reads.
+         Candidates are promoted smallest first while the std430 layout of
+         the promoted members fits in the budget. An entry point that
+         already uses a push constant block gets its candidates ranked but
+         none promoted, since spvReflectPromotePushConstants() adds a new
+         block and an entry point can only use one.
+ @param  p_module     Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point  The entry point to plan for.
+ @param  budget       Push constant budget in bytes. Zero selects 128, the
+                      minimum maxPushConstantsSize that Vulkan guarantees.
+ @param  p_plan       Receives the ranked candidates. Release it with
+                      spvReflectDestroyPushConstantPlan().
+ @return              If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                      Otherwise, the error code indicates the cause of the
+                      failure.
+
+*/
+SpvReflectResult spvReflectGetPushConstantPlan(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  uint32_t                       budget,
+  SpvReflectPushConstantPlan*    p_plan
+);
+
+
+/*! @fn spvReflectPromotePushConstants
+ @brief  Rewrites an entry point to read the promoted members of a plan from
+         a new push constant block at their planned offsets. The uniform
+         buffers keep their layout, so the host can keep filling them while
+         it moves the promoted values to vkCmdPushConstants(). Candidates may
+         be demoted, or offsets changed, before calling this. p_module is
+         re-reflected from the rewritten SPIR-V, which invalidates pointers
+         into its previous reflection data.
+ @param  p_module     Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point  The entry point the plan was made for. It must not
+                      already use a push constant block.
+ @param  p_plan       Plan from spvReflectGetPushConstantPlan().
+ @return              If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                      Returns SPV_REFLECT_RESULT_NOT_READY if p_module leaves
+                      out entry points.
+                      Otherwise, the error code indicates the cause of the
+                      failure and p_module is left unchanged.
+
+*/
+SpvReflectResult spvReflectPromotePushConstants(
+  SpvReflectShaderModule*            p_module,
+  const char*                        entry_point,
+  const SpvReflectPushConstantPlan*  p_plan
+);
+
+
+/*! @fn spvReflectDestroyPushConstantPlan
+
+ @param  p_plan  Pointer to a plan filled in by
+                 spvReflectGetPushConstantPlan().
+
+*/
+void spvReflectDestroyPushConstantPlan(SpvReflectPushConstantPlan* p_plan);
+
+
+/*! @fn spvReflectGetEntryPointRegisterPressure
+
+ @param  p_module     Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point  The entry point to analyze.
+ @param  p_budget     Per-GPU limits used for the occupancy estimate, or NULL
+                      to use the defaults.
+ @param  p_pressure   Receives the estimate. Release it with
+                      spvReflectDestroyRegisterPressure().
+ @return              If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                      Otherwise, the error code indicates the cause of the
+                      failure.
+
+ @brief  Estimates the peak number of live SSA values per basic block,
+         function and entry point from a liveness analysis of the function
+         bodies, and combines it with the workgroup size and Workgroup
+         storage class footprint into an occupancy estimate.
+
+*/
+SpvReflectResult spvReflectGetEntryPointRegisterPressure(
+  const SpvReflectShaderModule*     p_module,
+  const char*                       entry_point,
+  const SpvReflectOccupancyBudget*  p_budget,
+  SpvReflectRegisterPressure*       p_pressure
+);
+
+
+/*! @fn spvReflectDestroyRegisterPressure
+
+ @param  p_pressure  Pointer to an estimate filled in by
+                     spvReflectGetEntryPointRegisterPressure().
+
+*/
+void spvReflectDestroyRegisterPressure(SpvReflectRegisterPressure* p_pressure);
+
+
+/*! @fn spvReflectGetEntryPointHalfPrecision
+
+ @param  p_module     Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point  The entry point to analyze.
+ @param  p_options    Output precision, or NULL if no output is known to
+                      be stored at low precision.
+ @param  p_report     Receives the candidates. Release it with
+                      spvReflectDestroyHalfPrecisionReport().
+ @return              If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                      Otherwise, the error code indicates the cause of the
+                      failure.
+
+ @brief  Finds 32-bit float values that could use 16-bit floats without
+         losing precision that matters, by propagating precision forward
+         from low precision sources and backward from low precision
+         outputs through the function bodies. Values, variables and
+         interfaces already decorated RelaxedPrecision count as low
+         precision sources and are not reported. Function calls,
+         parameters and loads from buffers count as full precision.
+
+*/
+SpvReflectResult spvReflectGetEntryPointHalfPrecision(
+  const SpvReflectShaderModule*          p_module,
+  const char*                            entry_point,
+  const SpvReflectHalfPrecisionOptions*  p_options,
+  SpvReflectHalfPrecisionReport*         p_report
+);
+
+
+/*! @fn spvReflectDestroyHalfPrecisionReport
+
+ @param  p_report  Pointer to a report filled in by
+                   spvReflectGetEntryPointHalfPrecision().
+
+*/
+void spvReflectDestroyHalfPrecisionReport(SpvReflectHalfPrecisionReport* p_report);
+
+
+/*! @fn spvReflectGetEntryPointInstructionCost
+
+ @param  p_module            Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point         The entry point to analyze.
+ @param  default_trip_count  Weight of loops whose trip count cannot be
+                             derived statically. Zero selects 16.
+ @param  p_report            Receives the profile. Release it with
+                             spvReflectDestroyInstructionCostReport().
+ @return                     If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                             Otherwise, the error code indicates the cause of
+                             the failure.
+
+ @brief  Builds per-function and per-entry-point instruction histograms
+         without executing the shader. Callee costs are propagated through
+         the call graph and weighted by the loops around each call site.
+
+*/
+SpvReflectResult spvReflectGetEntryPointInstructionCost(
+  const SpvReflectShaderModule*     p_module,
+  const char*                       entry_point,
+  uint32_t                          default_trip_count,
+  SpvReflectInstructionCostReport*  p_report
+);
+
+
+/*! @fn spvReflectDestroyInstructionCostReport
+
+ @param  p_report  Pointer to a profile filled in by
+                   spvReflectGetEntryPointInstructionCost().
+
+*/
+void spvReflectDestroyInstructionCostReport(SpvReflectInstructionCostReport* p_report);
+
+
+/*! @fn spvReflectEnumerateSourceLineRanges
+
+ @param  p_module  Pointer to an instance of SpvReflectShaderModule.
+ @param  p_count   If p_ranges is NULL, the module's range count will be
+                   stored here. If p_ranges is not NULL, *p_count must
+                   contain the module's range count.
+ @param  p_ranges  If NULL, the module's range count will be written to
+                   *p_count. If non-NULL, the ranges are copied into this
+                   array, which must hold *p_count entries.
+ @return           If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                   Otherwise, the error code indicates the cause of the
+                   failure.
+
+ @brief  Maps the instructions of every function body to the file, line
+         and column of the OpLine that covers them. Modules without debug
+         line information have no ranges.
+
+*/
+SpvReflectResult spvReflectEnumerateSourceLineRanges(
+  const SpvReflectShaderModule*  p_module,
+  uint32_t*                      p_count,
+  SpvReflectSourceLineRange*     p_ranges
+);
+
+
+/*! @fn spvReflectGetEntryPointSourceLineCost
+
+ @param  p_module            Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point         The entry point to analyze.
+ @param  default_trip_count  Weight of loops whose trip count cannot be
+                             derived statically. Zero selects 16.
+ @param  p_report            Receives the per line costs. Release it with
+                             spvReflectDestroySourceLineCostReport().
+ @return                     If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                             Otherwise, the error code indicates the cause of
+                             the failure.
+
+ @brief  Aggregates the loop weighted instruction histograms of
+         spvReflectGetEntryPointInstructionCost() per source line.
+
+*/
+SpvReflectResult spvReflectGetEntryPointSourceLineCost(
+  const SpvReflectShaderModule*     p_module,
+  const char*                       entry_point,
+  uint32_t                          default_trip_count,
+  SpvReflectSourceLineCostReport*   p_report
+);
+
+
+/*! @fn spvReflectDestroySourceLineCostReport
+
+ @param  p_report  Pointer to a report filled in by
+                   spvReflectGetEntryPointSourceLineCost().
+
+*/
+void spvReflectDestroySourceLineCostReport(SpvReflectSourceLineCostReport* p_report);
+
+
+/*! @fn spvReflectGetFingerprints
+
+ @param  p_module        Pointer to an instance of SpvReflectShaderModule.
+ @param  p_fingerprints  Receives the fingerprints of the module's
+                         descriptor sets, push constant blocks and, for a
+                         vertex shader, input variables.
+ @return                 If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                         Otherwise, the error code indicates the cause of
+                         the failure.
+
+ @brief  Computes stable cache keys for the module and its layouts.
+         Descriptor sets hash the binding number, descriptor type and count
+         of each binding. Push constants hash the byte range of each block.
+         Vertex inputs hash the location, format and location count of each
+         input that is not a built-in.
+
+*/
+SpvReflectResult spvReflectGetFingerprints(
+  const SpvReflectShaderModule*  p_module,
+  SpvReflectFingerprints*        p_fingerprints
+);
+
+
+/*! @fn spvReflectGetEntryPointFingerprints
+
+ @param  p_module        Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point     The entry point to get the layout fingerprints of.
+ @param  p_fingerprints  Receives the fingerprints. The module fingerprint
+                         is the same for every entry point.
+ @return                 If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                         Otherwise, the error code indicates the cause of
+                         the failure.
+
+*/
+SpvReflectResult spvReflectGetEntryPointFingerprints(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  SpvReflectFingerprints*        p_fingerprints
+);
+
+
+/*! @fn spvReflectGetMinHash
+
+ @param  p_module        Pointer to an instance of SpvReflectShaderModule.
+ @param  shingle_length  Number of consecutive instructions in each n-gram.
+                         0 uses 4.
+ @param  p_minhash       Receives the sketch.
+ @return                 If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                         Otherwise, the error code indicates the cause of
+                         the failure.
+
+ @brief  Sketches a module for near-duplicate detection across large
+         variant sets. Instructions are normalized like the module
+         fingerprint: debug and non-semantic instructions are skipped, and
+         each id operand is replaced by the opcode that defines it, so
+         names and id numbering do not change the sketch while a few
+         changed instructions only change the n-grams that contain them.
+
+*/
+SpvReflectResult spvReflectGetMinHash(
+  const SpvReflectShaderModule*  p_module,
+  uint32_t                       shingle_length,
+  SpvReflectMinHash*             p_minhash
+);
+
+
+/*! @fn spvReflectGetMinHashSimilarity
+
+ @param  p_a  Sketch of the first module.
+ @param  p_b  Sketch of the second module.
+ @return      The estimated Jaccard similarity of the modules' n-gram sets,
+              from 0 to 1, or 0 if either pointer is NULL.
+
+*/
+float spvReflectGetMinHashSimilarity(
+  const SpvReflectMinHash*  p_a,
+  const SpvReflectMinHash*  p_b
+);
+
+
+/*! @fn spvReflectDiffShaderModules
+
+ @param  p_old_module  The reflection of the shader currently in use.
+ @param  p_new_module  The reflection of its replacement.
+ @param  p_diff        Receives the differences. Release it with
+                       spvReflectDestroyModuleDiff().
+ @return               If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                       Otherwise, the error code indicates the cause of the
+                       failure.
+
+ @brief  Compares the descriptor bindings, push constant blocks and
+         interface variables of two versions of a shader, for example
+         before and after a hot reload. Objects are matched by name, or by
+         set and binding number or location when they have none, by merging
+         sorted arrays. rebuild_flags summarizes which host objects the
+         differences invalidate.
+
+*/
+SpvReflectResult spvReflectDiffShaderModules(
+  const SpvReflectShaderModule*  p_old_module,
+  const SpvReflectShaderModule*  p_new_module,
+  SpvReflectModuleDiff*          p_diff
+);
+
+
+/*! @fn spvReflectDestroyModuleDiff
+
+ @param  p_diff  Pointer to a diff filled in by
+                 spvReflectDiffShaderModules().
+
+*/
+void spvReflectDestroyModuleDiff(SpvReflectModuleDiff* p_diff);
+
+
+/*! @fn spvReflectPlanDescriptorPools
+
+ @param  demand_count  Number of entries in p_demands.
+ @param  p_demands     The descriptor sets allocated each frame, possibly
+                       from many modules.
+ @param  p_options     Frame and chunk settings, or NULL for the defaults.
+ @param  p_plan        Receives the pool capacities.
+ @return               If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                       Returns SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND if
+                       a module does not have a demanded set. Otherwise, the
+                       error code indicates the cause of the failure.
+
+ @brief  Adds up the descriptors of each type that the demanded set
+         instances need over all frames in flight, so descriptor pools can
+         be created at their final size up front. Chunk capacities keep
+         each type's share of the total demand, so chunks run out of all
+         types at about the same time.
+
+*/
+SpvReflectResult spvReflectPlanDescriptorPools(
+  uint32_t                                demand_count,
+  const SpvReflectDescriptorSetDemand*    p_demands,
+  const SpvReflectDescriptorPoolOptions*  p_options,
+  SpvReflectDescriptorPoolPlan*           p_plan
+);
+
+
+/*! @fn spvReflectPlanBindlessTable
+
+ @param  module_count        Number of modules in pp_modules.
+ @param  pp_modules          The modules that share the bindless table.
+ @param  set                 Descriptor set number of the global arrays.
+ @param  runtime_array_size  Elements reserved for each runtime array
+                             binding. Zero selects 1024.
+ @param  p_plan              Receives the table layout and the remap of
+                             each module. Release it with
+                             spvReflectDestroyBindlessPlan().
+ @return                     If successful, returns
+                             SPV_REFLECT_RESULT_SUCCESS. Otherwise, the
+                             error code indicates the cause of the failure.
+
+ @brief  Gives every distinct binding of the modules a range of elements in
+         one global descriptor array per descriptor type, so a renderer
+         can bind a single descriptor set once and select resources by
+         index instead of binding sets per draw.
+
+*/
+SpvReflectResult spvReflectPlanBindlessTable(
+  uint32_t                             module_count,
+  const SpvReflectShaderModule* const* pp_modules,
+  uint32_t                             set,
+  uint32_t                             runtime_array_size,
+  SpvReflectBindlessPlan*              p_plan
+);
+
+
+/*! @fn spvReflectApplyBindlessPlan
+
+ @param  p_module      The module at module_index of the plan.
+ @param  p_plan        Plan from spvReflectPlanBindlessTable().
+ @param  module_index  Index of p_module in the planned modules.
+ @return               If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                       Returns SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND if
+                       p_module does not have the planned bindings, and
+                       SPV_REFLECT_RESULT_NOT_READY if it leaves out entry
+                       points.
+                       Otherwise, the error code indicates the cause of the
+                       failure and p_module is left unchanged.
+
+ @brief  Rewrites a module to read its bindings from the global arrays.
+         Each remapped variable becomes an array the size of its global
+         array. Uses of a variable that was not an array go through an
+         access chain to the first element of its range, and indices into
+         arrayed variables are offset by the range base. The variables are
+         then moved to the table's set and array bindings with
+         spvReflectChangeDescriptorBindingNumbers(). Arrayed variables must
+         only be used through access chains. p_module is re-reflected from
+         the rewritten SPIR-V, which invalidates pointers into its previous
+         reflection data.
+
+*/
+SpvReflectResult spvReflectApplyBindlessPlan(
+  SpvReflectShaderModule*        p_module,
+  const SpvReflectBindlessPlan*  p_plan,
+  uint32_t                       module_index
+);
+
+
+/*! @fn spvReflectDestroyBindlessPlan
+
+ @param  p_plan  Pointer to a plan filled in by
+                 spvReflectPlanBindlessTable().
+
+*/
+void spvReflectDestroyBindlessPlan(SpvReflectBindlessPlan* p_plan);
+
+
+/*! @fn spvReflectGetBlockLayoutFingerprint
+
+ @param  p_block        A uniform buffer, storage buffer or push constant
+                        block.
+ @param  p_fingerprint  Receives the fingerprint of the block's layout.
+ @return                If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                        Otherwise, the error code indicates the cause of
+                        the failure.
+
+ @brief  Hashes the block's size and the names, offsets, sizes, types and
+         matrix layouts of its members, recursively. Block and variable
+         names, bindings and ids are left out, so the same block declared
+         by different shaders gets the same fingerprint.
+
+*/
+SpvReflectResult spvReflectGetBlockLayoutFingerprint(
+  const SpvReflectBlockVariable*  p_block,
+  SpvReflectFingerprint*          p_fingerprint
+);
+
+
+/*! @fn spvReflectFindSharedBlocks
+
+ @param  module_count  Number of modules in pp_modules.
+ @param  pp_modules    The modules of a shader library.
+ @param  p_report      Receives the blocks that more than one module
+                       declares. Release it with
+                       spvReflectDestroySharedBlockReport().
+ @return               If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                       Otherwise, the error code indicates the cause of the
+                       failure.
+
+ @brief  Finds uniform and storage buffer blocks with identical layouts
+         across modules, such as per-frame camera or lighting data, so one
+         buffer and one descriptor can serve every pipeline.
+
+*/
+SpvReflectResult spvReflectFindSharedBlocks(
+  uint32_t                             module_count,
+  const SpvReflectShaderModule* const* pp_modules,
+  SpvReflectSharedBlockReport*         p_report
+);
+
+
+/*! @fn spvReflectAssignSharedBlockBinding
+
+ @param  p_module      The module at module_index of the report.
+ @param  p_block       A block of a report from spvReflectFindSharedBlocks().
+ @param  module_index  Index of p_module in the modules of the report.
+ @param  set           New descriptor set number of the block's binding.
+ @param  binding       New binding number of the block's binding.
+ @return               If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                       Returns SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND if
+                       p_module has no binding of the block,
+                       SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH if it has
+                       several, which hold different data and cannot share
+                       one buffer, and
+                       SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED if another
+                       binding of p_module uses the new location.
+                       Returns SPV_REFLECT_RESULT_NOT_READY if p_module leaves
+                       out entry points.
+
+ @brief  Moves the module's binding of a shared block to a common location
+         with spvReflectChangeDescriptorBindingNumbers(). Call it for every
+         module of the block with the same location, such as the block's
+         suggested set and binding.
+
+*/
+SpvReflectResult spvReflectAssignSharedBlockBinding(
+  SpvReflectShaderModule*       p_module,
+  const SpvReflectSharedBlock*  p_block,
+  uint32_t                      module_index,
+  uint32_t                      set,
+  uint32_t                      binding
+);
+
+
+/*! @fn spvReflectDestroySharedBlockReport
+
+ @param  p_report  Pointer to a report filled in by
+                   spvReflectFindSharedBlocks().
+
+*/
+void spvReflectDestroySharedBlockReport(SpvReflectSharedBlockReport* p_report);
+
+
+/*! @fn spvReflectInternSemantic
+
+ @param  semantic  An HLSL semantic, such as "TEXCOORD1", or NULL.
+ @return           A non-zero id for the semantic, or 0 if semantic is NULL
+                   or empty.
+
+ @brief  Semantics are case insensitive and a missing index is 0, so
+         "texcoord" and "TEXCOORD0" get the same id. The id of a semantic
+         with index n is the id of index 0 plus n.
+
+*/
+uint32_t spvReflectInternSemantic(const char* semantic);
+
+
+/*! @fn spvReflectGetEntryPointInputSignature
+
+ @param  p_module     Pointer to an instance of SpvReflectShaderModule.
+ @param  entry_point  The entry point to get the input signature of.
+ @param  p_signature  Receives the signature. Built-in inputs are left out.
+ @return              If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                      Returns SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED if an
+                      input uses a location past
+                      SPV_REFLECT_MAX_SIGNATURE_LOCATIONS. Otherwise, the
+                      error code indicates the cause of the failure.
+
+*/
+SpvReflectResult spvReflectGetEntryPointInputSignature(
+  const SpvReflectShaderModule*  p_module,
+  const char*                    entry_point,
+  SpvReflectInputSignature*      p_signature
 );
 
-/*! @fn spvReflectChangeInputVariableLocation
- @brief  Assign a new location to an input interface variable.
-         In addition to updating the reflection data, this function modifies
-         the underlying SPIR-V bytecode. The updated code can be retrieved
-         with spvReflectGetCode().
-         It is the caller's responsibility to avoid assigning the same
-         location to multiple input variables.  If the input variable is used
-         by multiple entry points in the module, it will be changed in all of
-         them.
- @param  p_module          Pointer to an instance of SpvReflectShaderModule.
- @param  p_input_variable  Pointer to the input variable to update.
- @param  new_location      The new location to assign to p_input_variable.
- @return                   If successful, returns SPV_REFLECT_RESULT_SUCCESS.
-                           Otherwise, the error code indicates the cause of
-                           the failure.
+
+/*! @fn spvReflectGetVertexFormatSignature
+
+ @param  attribute_count  The number of attributes in p_attributes.
+ @param  p_attributes     The attributes of a vertex format.
+ @param  p_signature      Receives the signature.
+ @return                  If successful, returns SPV_REFLECT_RESULT_SUCCESS.
+                          Returns SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED
+                          if an attribute uses a location past
+                          SPV_REFLECT_MAX_SIGNATURE_LOCATIONS or has more
+                          than one numeric class bit, and
+                          SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH if two
+                          attributes use the same location.
 
 */
-SpvReflectResult spvReflectChangeInputVariableLocation(
-  SpvReflectShaderModule*            p_module,
-  const SpvReflectInterfaceVariable* p_input_variable,
-  uint32_t                           new_location
+SpvReflectResult spvReflectGetVertexFormatSignature(
+  uint32_t                          attribute_count,
+  const SpvReflectVertexAttribute*  p_attributes,
+  SpvReflectInputSignature*         p_signature
 );
 
 
-/*! @fn spvReflectChangeOutputVariableLocation
- @brief  Assign a new location to an output interface variable.
-         In addition to updating the reflection data, this function modifies
-         the underlying SPIR-V bytecode. The updated code can be retrieved
-         with spvReflectGetCode().
-         It is the caller's responsibility to avoid assigning the same
-         location to multiple output variables.  If the output variable is used
-         by multiple entry points in the module, it will be changed in all of
-         them.
- @param  p_module          Pointer to an instance of SpvReflectShaderModule.
- @param  p_output_variable  Pointer to the output variable to update.
- @param  new_location      The new location to assign to p_output_variable.
- @return                   If successful, returns SPV_REFLECT_RESULT_SUCCESS.
-                           Otherwise, the error code indicates the cause of
-                           the failure.
+/*! @fn spvReflectGetInputSignatureMismatch
+
+ @param  p_shader  The input signature of a shader.
+ @param  p_format  The signature of a vertex format.
+ @return           A mask of the shader's input locations that p_format does
+                   not feed: locations it lacks, has with another numeric
+                   type, or has with another semantic when both signatures
+                   name one. Returns 0 if the format is compatible, and
+                   ~0 if either pointer is NULL.
+
+ @brief  Extra attributes of the format and component count differences
+         do not matter; missing components read as 0, or 1 for alpha.
 
 */
-SpvReflectResult spvReflectChangeOutputVariableLocation(
-  SpvReflectShaderModule*             p_module,
-  const SpvReflectInterfaceVariable*  p_output_variable,
-  uint32_t                            new_location
+uint32_t spvReflectGetInputSignatureMismatch(
+  const SpvReflectInputSignature*  p_shader,
+  const SpvReflectInputSignature*  p_format
+);
+
+
+/*! @fn spvReflectFindInputSignatureLocation
+
+ @param  p_signature  The signature to search.
+ @param  semantic_id  A value returned by spvReflectInternSemantic().
+ @return              The location with the semantic, or UINT32_MAX if
+                      there is none.
+
+*/
+uint32_t spvReflectFindInputSignatureLocation(
+  const SpvReflectInputSignature*  p_signature,
+  uint32_t                         semantic_id
 );
 
 
@@ -1268,8 +2960,11 @@ public:
   ShaderModule(size_t size, const void* p_code);
   ShaderModule(const std::vector<uint8_t>& code);
   ShaderModule(const std::vector<uint32_t>& code);
+  ShaderModule(size_t size, const void* p_code, const SpvReflectShaderModuleOptions& options);
   ~ShaderModule();
 
+  SpvReflectResult Clone(ShaderModule* p_clone);
+
   SpvReflectResult GetResult() const;
 
   const SpvReflectShaderModule& GetShaderModule() const;
@@ -1300,6 +2995,8 @@ public:
   SpvReflectResult  EnumerateEntryPointOutputVariables(const char* entry_point, uint32_t* p_count,SpvReflectInterfaceVariable** pp_variables) const;
   SpvReflectResult  EnumeratePushConstantBlocks(uint32_t* p_count, SpvReflectBlockVariable** pp_blocks) const;
   SpvReflectResult  EnumerateEntryPointPushConstantBlocks(const char* entry_point, uint32_t* p_count, SpvReflectBlockVariable** pp_blocks) const;
+  SpvReflectResult  EnumerateEntryPointImageSamplerPairs(const char* entry_point, uint32_t* p_count, SpvReflectImageSamplerPair** pp_pairs) const;
+  SpvReflectResult  EnumerateEntryPointBindingAccesses(const char* entry_point, uint32_t* p_count, SpvReflectDescriptorBindingAccess** pp_accesses) const;
   SPV_REFLECT_DEPRECATED("Renamed to EnumeratePushConstantBlocks")
   SpvReflectResult  EnumeratePushConstants(uint32_t* p_count, SpvReflectBlockVariable** pp_blocks) const {
     return EnumeratePushConstantBlocks(p_count, pp_blocks);
@@ -1343,6 +3040,24 @@ public:
   SpvReflectResult ChangeDescriptorSetNumber(const SpvReflectDescriptorSet* p_set, uint32_t new_set_number = SPV_REFLECT_SET_NUMBER_DONT_CHANGE);
   SpvReflectResult ChangeInputVariableLocation(const SpvReflectInterfaceVariable* p_input_variable, uint32_t new_location);
   SpvReflectResult ChangeOutputVariableLocation(const SpvReflectInterfaceVariable* p_output_variable, uint32_t new_location);
+  SpvReflectResult CompactDescriptorBindings(SpvReflectDescriptorCompactionFlags flags, SpvReflectDescriptorBindingRemapTable* p_table);
+  SpvReflectResult EliminateDeadOutputs(const char* entry_point, const ShaderModule& next_stage, const char* next_entry_point, uint32_t* p_removed_count = nullptr);
+  SpvReflectResult PackVaryings(const char* entry_point, ShaderModule& next_stage, const char* next_entry_point, SpvReflectVaryingPackingReport* p_report);
+  SpvReflectResult GetPushConstantPlan(const char* entry_point, uint32_t budget, SpvReflectPushConstantPlan* p_plan) const;
+  SpvReflectResult PromotePushConstants(const char* entry_point, const SpvReflectPushConstantPlan* p_plan);
+
+  SpvReflectResult GetEntryPointRegisterPressure(const char* entry_point, const SpvReflectOccupancyBudget* p_budget, SpvReflectRegisterPressure* p_pressure) const;
+  SpvReflectResult GetEntryPointHalfPrecision(const char* entry_point, const SpvReflectHalfPrecisionOptions* p_options, SpvReflectHalfPrecisionReport* p_report) const;
+  SpvReflectResult GetEntryPointInstructionCost(const char* entry_point, uint32_t default_trip_count, SpvReflectInstructionCostReport* p_report) const;
+  SpvReflectResult EnumerateSourceLineRanges(uint32_t* p_count, SpvReflectSourceLineRange* p_ranges) const;
+  SpvReflectResult GetEntryPointSourceLineCost(const char* entry_point, uint32_t default_trip_count, SpvReflectSourceLineCostReport* p_report) const;
+  SpvReflectResult GetFingerprints(SpvReflectFingerprints* p_fingerprints) const;
+  SpvReflectResult GetEntryPointFingerprints(const char* entry_point, SpvReflectFingerprints* p_fingerprints) const;
+  SpvReflectResult GetMinHash(uint32_t shingle_length, SpvReflectMinHash* p_minhash) const;
+  SpvReflectResult DiffShaderModules(const ShaderModule& new_module, SpvReflectModuleDiff* p_diff) const;
+  SpvReflectResult ApplyBindlessPlan(const SpvReflectBindlessPlan* p_plan, uint32_t module_index);
+  SpvReflectResult AssignSharedBlockBinding(const SpvReflectSharedBlock* p_block, uint32_t module_index, uint32_t set, uint32_t binding);
+  SpvReflectResult GetEntryPointInputSignature(const char* entry_point, SpvReflectInputSignature* p_signature) const;
 
 private:
   mutable SpvReflectResult  m_result = SPV_REFLECT_RESULT_NOT_READY;
@@ -1394,6 +3109,20 @@ inline ShaderModule::ShaderModule(const std::vector<uint32_t>& code) {
                                           &m_module);
 }
 
+/*! @fn ShaderModule
+
+  @param  size
+  @param  p_code
+  @param  options
+
+*/
+inline ShaderModule::ShaderModule(size_t size, const void* p_code, const SpvReflectShaderModuleOptions& options) {
+  m_result = spvReflectCreateShaderModuleWithOptions(size,
+                                                     p_code,
+                                                     &options,
+                                                     &m_module);
+}
+
 /*! @fn  ~ShaderModule
 
 */
@@ -1401,6 +3130,19 @@ inline ShaderModule::~ShaderModule() {
   spvReflectDestroyShaderModule(&m_module);
 }
 
+/*! @fn Clone
+
+  @param  p_clone
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::Clone(ShaderModule* p_clone) {
+  spvReflectDestroyShaderModule(&p_clone->m_module);
+  p_clone->m_result = spvReflectCloneShaderModule(&m_module,
+                                                  &p_clone->m_module);
+  return p_clone->m_result;
+}
+
 
 /*! @fn GetResult
 
@@ -1693,6 +3435,52 @@ inline SpvReflectResult ShaderModule::EnumerateEntryPointPushConstantBlocks(
 }
 
 
+/*! @fn EnumerateEntryPointImageSamplerPairs
+
+  @param  entry_point
+  @param  p_count
+  @param  pp_pairs
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::EnumerateEntryPointImageSamplerPairs(
+  const char*                  entry_point,
+  uint32_t*                    p_count,
+  SpvReflectImageSamplerPair** pp_pairs
+) const
+{
+  m_result = spvReflectEnumerateEntryPointImageSamplerPairs(
+      &m_module,
+      entry_point,
+      p_count,
+      pp_pairs);
+  return m_result;
+}
+
+
+/*! @fn EnumerateEntryPointBindingAccesses
+
+  @param  entry_point
+  @param  p_count
+  @param  pp_accesses
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::EnumerateEntryPointBindingAccesses(
+  const char*                         entry_point,
+  uint32_t*                           p_count,
+  SpvReflectDescriptorBindingAccess** pp_accesses
+) const
+{
+  m_result = spvReflectEnumerateEntryPointBindingAccesses(
+      &m_module,
+      entry_point,
+      p_count,
+      pp_accesses);
+  return m_result;
+}
+
+
 /*! @fn GetDescriptorBinding
 
   @param  binding_number
@@ -2002,6 +3790,330 @@ inline SpvReflectResult ShaderModule::ChangeOutputVariableLocation(
                                                 new_location);
 }
 
+/*! @fn CompactDescriptorBindings
+
+  @param  flags
+  @param  p_table
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::CompactDescriptorBindings(
+  SpvReflectDescriptorCompactionFlags     flags,
+  SpvReflectDescriptorBindingRemapTable*  p_table)
+{
+  return spvReflectCompactDescriptorBindings(&m_module,
+                                             flags,
+                                             p_table);
+}
+
+/*! @fn EliminateDeadOutputs
+
+  @param  entry_point
+  @param  next_stage
+  @param  next_entry_point
+  @param  p_removed_count
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::EliminateDeadOutputs(
+  const char*         entry_point,
+  const ShaderModule& next_stage,
+  const char*         next_entry_point,
+  uint32_t*           p_removed_count)
+{
+  return spvReflectEliminateDeadOutputs(&m_module,
+                                        entry_point,
+                                        &next_stage.m_module,
+                                        next_entry_point,
+                                        p_removed_count);
+}
+
+/*! @fn PackVaryings
+
+  @param  entry_point
+  @param  next_stage
+  @param  next_entry_point
+  @param  p_report
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::PackVaryings(
+  const char*                      entry_point,
+  ShaderModule&                    next_stage,
+  const char*                      next_entry_point,
+  SpvReflectVaryingPackingReport*  p_report)
+{
+  return spvReflectPackVaryings(&m_module,
+                                entry_point,
+                                &next_stage.m_module,
+                                next_entry_point,
+                                p_report);
+}
+
+/*! @fn GetPushConstantPlan
+
+  @param  entry_point
+  @param  budget
+  @param  p_plan
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetPushConstantPlan(
+  const char*                  entry_point,
+  uint32_t                     budget,
+  SpvReflectPushConstantPlan*  p_plan
+) const
+{
+  m_result = spvReflectGetPushConstantPlan(&m_module,
+                                           entry_point,
+                                           budget,
+                                           p_plan);
+  return m_result;
+}
+
+/*! @fn PromotePushConstants
+
+  @param  entry_point
+  @param  p_plan
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::PromotePushConstants(
+  const char*                        entry_point,
+  const SpvReflectPushConstantPlan*  p_plan)
+{
+  return spvReflectPromotePushConstants(&m_module,
+                                        entry_point,
+                                        p_plan);
+}
+
+/*! @fn GetEntryPointRegisterPressure
+
+  @param  entry_point
+  @param  p_budget
+  @param  p_pressure
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetEntryPointRegisterPressure(
+  const char*                       entry_point,
+  const SpvReflectOccupancyBudget*  p_budget,
+  SpvReflectRegisterPressure*       p_pressure
+) const
+{
+  m_result = spvReflectGetEntryPointRegisterPressure(&m_module,
+                                                     entry_point,
+                                                     p_budget,
+                                                     p_pressure);
+  return m_result;
+}
+
+/*! @fn GetEntryPointHalfPrecision
+
+  @param  entry_point
+  @param  p_options
+  @param  p_report
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetEntryPointHalfPrecision(
+  const char*                            entry_point,
+  const SpvReflectHalfPrecisionOptions*  p_options,
+  SpvReflectHalfPrecisionReport*         p_report
+) const
+{
+  m_result = spvReflectGetEntryPointHalfPrecision(&m_module,
+                                                  entry_point,
+                                                  p_options,
+                                                  p_report);
+  return m_result;
+}
+
+/*! @fn GetEntryPointInstructionCost
+
+  @param  entry_point
+  @param  default_trip_count
+  @param  p_report
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetEntryPointInstructionCost(
+  const char*                       entry_point,
+  uint32_t                          default_trip_count,
+  SpvReflectInstructionCostReport*  p_report
+) const
+{
+  m_result = spvReflectGetEntryPointInstructionCost(&m_module,
+                                                    entry_point,
+                                                    default_trip_count,
+                                                    p_report);
+  return m_result;
+}
+
+/*! @fn EnumerateSourceLineRanges
+
+  @param  p_count
+  @param  p_ranges
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::EnumerateSourceLineRanges(
+  uint32_t*                   p_count,
+  SpvReflectSourceLineRange*  p_ranges
+) const
+{
+  m_result = spvReflectEnumerateSourceLineRanges(&m_module,
+                                                 p_count,
+                                                 p_ranges);
+  return m_result;
+}
+
+/*! @fn GetEntryPointSourceLineCost
+
+  @param  entry_point
+  @param  default_trip_count
+  @param  p_report
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetEntryPointSourceLineCost(
+  const char*                       entry_point,
+  uint32_t                          default_trip_count,
+  SpvReflectSourceLineCostReport*   p_report
+) const
+{
+  m_result = spvReflectGetEntryPointSourceLineCost(&m_module,
+                                                   entry_point,
+                                                   default_trip_count,
+                                                   p_report);
+  return m_result;
+}
+
+/*! @fn GetFingerprints
+
+  @param  p_fingerprints
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetFingerprints(
+  SpvReflectFingerprints*  p_fingerprints
+) const
+{
+  m_result = spvReflectGetFingerprints(&m_module,
+                                       p_fingerprints);
+  return m_result;
+}
+
+/*! @fn GetEntryPointFingerprints
+
+  @param  entry_point
+  @param  p_fingerprints
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetEntryPointFingerprints(
+  const char*              entry_point,
+  SpvReflectFingerprints*  p_fingerprints
+) const
+{
+  m_result = spvReflectGetEntryPointFingerprints(&m_module,
+                                                 entry_point,
+                                                 p_fingerprints);
+  return m_result;
+}
+
+/*! @fn GetMinHash
+
+  @param  shingle_length
+  @param  p_minhash
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetMinHash(
+  uint32_t            shingle_length,
+  SpvReflectMinHash*  p_minhash
+) const
+{
+  m_result = spvReflectGetMinHash(&m_module,
+                                  shingle_length,
+                                  p_minhash);
+  return m_result;
+}
+
+/*! @fn DiffShaderModules
+
+  @param  new_module
+  @param  p_diff
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::DiffShaderModules(
+  const ShaderModule&    new_module,
+  SpvReflectModuleDiff*  p_diff
+) const
+{
+  m_result = spvReflectDiffShaderModules(&m_module,
+                                         &new_module.GetShaderModule(),
+                                         p_diff);
+  return m_result;
+}
+
+/*! @fn ApplyBindlessPlan
+
+  @param  p_plan
+  @param  module_index
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::ApplyBindlessPlan(
+  const SpvReflectBindlessPlan*  p_plan,
+  uint32_t                       module_index)
+{
+  return spvReflectApplyBindlessPlan(&m_module,
+                                     p_plan,
+                                     module_index);
+}
+
+/*! @fn AssignSharedBlockBinding
+
+  @param  p_block
+  @param  module_index
+  @param  set
+  @param  binding
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::AssignSharedBlockBinding(
+  const SpvReflectSharedBlock*  p_block,
+  uint32_t                      module_index,
+  uint32_t                      set,
+  uint32_t                      binding)
+{
+  return spvReflectAssignSharedBlockBinding(&m_module,
+                                            p_block,
+                                            module_index,
+                                            set,
+                                            binding);
+}
+
+/*! @fn GetEntryPointInputSignature
+
+  @param  entry_point
+  @param  p_signature
+  @return
+
+*/
+inline SpvReflectResult ShaderModule::GetEntryPointInputSignature(
+  const char*                entry_point,
+  SpvReflectInputSignature*  p_signature
+) const
+{
+  m_result = spvReflectGetEntryPointInputSignature(&m_module,
+                                                   entry_point,
+                                                   p_signature);
+  return m_result;
+}
+
 } // namespace spv_reflect
 #endif // defined(__cplusplus)
 #endif // SPIRV_REFLECT_H
@@ -1,14 +1,17 @@
 #include "../common/output_stream.h"
 #include "spirv_reflect.h"
+#include "util/uniform_ring/uniform_ring.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #if defined(_MSC_VER)
 #include <direct.h>
@@ -727,6 +730,113 @@ TEST_P(SpirvReflectTest, ChangeOutputVariableLocation_Errors) {
   EXPECT_EQ(spvReflectChangeOutputVariableLocation(&module_, nullptr, 0), SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
 }
 
+TEST_P(SpirvReflectTest, GetEntryPointRegisterPressure) {
+  SpvReflectRegisterPressure pressure;
+  SpvReflectResult result = spvReflectGetEntryPointRegisterPressure(
+      &module_, module_.entry_point_name, nullptr, &pressure);
+  ASSERT_EQ(result, SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_GE(pressure.function_count, 1);
+  EXPECT_EQ(pressure.functions[0].function_id, module_.entry_point_id);
+  EXPECT_EQ(pressure.max_live_values, pressure.functions[0].max_live_values);
+  for (uint32_t i = 0; i < pressure.function_count; ++i) {
+    EXPECT_LE(pressure.functions[i].max_live_values, pressure.max_live_values);
+    EXPECT_GE(pressure.functions[i].block_count, 1);
+  }
+  EXPECT_GT(pressure.occupancy, 0);
+  EXPECT_LE(pressure.occupancy, 10);
+  EXPECT_EQ(pressure.allocated_registers % 4, 0);
+  spvReflectDestroyRegisterPressure(&pressure);
+}
+TEST_P(SpirvReflectTest, GetEntryPointRegisterPressure_Errors) {
+  SpvReflectRegisterPressure pressure;
+  // NULL module
+  EXPECT_EQ(spvReflectGetEntryPointRegisterPressure(
+                nullptr, module_.entry_point_name, nullptr, &pressure),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  // NULL output
+  EXPECT_EQ(spvReflectGetEntryPointRegisterPressure(
+                &module_, module_.entry_point_name, nullptr, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  // Unknown entry point
+  EXPECT_EQ(spvReflectGetEntryPointRegisterPressure(
+                &module_, "__minimal__", nullptr, &pressure),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+}
+
+TEST_P(SpirvReflectTest, GetEntryPointInstructionCost) {
+  SpvReflectInstructionCostReport report;
+  SpvReflectResult result = spvReflectGetEntryPointInstructionCost(
+      &module_, module_.entry_point_name, 0, &report);
+  ASSERT_EQ(result, SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_GE(report.function_count, 1);
+  EXPECT_EQ(report.functions[0].function_id, module_.entry_point_id);
+  EXPECT_EQ(report.total.instruction_count,
+            report.functions[0].total.instruction_count);
+  for (uint32_t i = 0; i < report.function_count; ++i) {
+    const SpvReflectFunctionCost& cost = report.functions[i];
+    EXPECT_GE(cost.total.instruction_count, cost.self.instruction_count);
+    // Every function ends with a return
+    EXPECT_GE(cost.self.instruction_count, 1);
+  }
+  spvReflectDestroyInstructionCostReport(&report);
+}
+TEST_P(SpirvReflectTest, GetEntryPointInstructionCost_Errors) {
+  SpvReflectInstructionCostReport report;
+  // NULL module
+  EXPECT_EQ(spvReflectGetEntryPointInstructionCost(
+                nullptr, module_.entry_point_name, 0, &report),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  // NULL output
+  EXPECT_EQ(spvReflectGetEntryPointInstructionCost(
+                &module_, module_.entry_point_name, 0, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  // Unknown entry point
+  EXPECT_EQ(spvReflectGetEntryPointInstructionCost(
+                &module_, "__minimal__", 0, &report),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+}
+
+TEST_P(SpirvReflectTest, GetEntryPointSourceLineCost) {
+  SpvReflectSourceLineCostReport report;
+  SpvReflectResult result = spvReflectGetEntryPointSourceLineCost(
+      &module_, module_.entry_point_name, 0, &report);
+  ASSERT_EQ(result, SPV_REFLECT_RESULT_SUCCESS);
+  SpvReflectInstructionCostReport cost;
+  ASSERT_EQ(spvReflectGetEntryPointInstructionCost(
+                &module_, module_.entry_point_name, 0, &cost),
+            SPV_REFLECT_RESULT_SUCCESS);
+  uint64_t attributed = report.unattributed.instruction_count;
+  for (uint32_t i = 0; i < report.line_count; ++i) {
+    attributed += report.lines[i].cost.instruction_count;
+    if (i > 0) {
+      EXPECT_GE(report.lines[i - 1].cost.instruction_count,
+                report.lines[i].cost.instruction_count);
+    }
+  }
+  EXPECT_EQ(attributed, cost.total.instruction_count);
+  EXPECT_EQ(report.total.instruction_count, cost.total.instruction_count);
+  spvReflectDestroyInstructionCostReport(&cost);
+  spvReflectDestroySourceLineCostReport(&report);
+}
+TEST_P(SpirvReflectTest, GetEntryPointSourceLineCost_Errors) {
+  SpvReflectSourceLineCostReport report;
+  // NULL module
+  EXPECT_EQ(spvReflectGetEntryPointSourceLineCost(
+                nullptr, module_.entry_point_name, 0, &report),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  // NULL output
+  EXPECT_EQ(spvReflectGetEntryPointSourceLineCost(
+                &module_, module_.entry_point_name, 0, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  // Unknown entry point
+  EXPECT_EQ(spvReflectGetEntryPointSourceLineCost(
+                &module_, "__minimal__", 0, &report),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  // NULL count
+  EXPECT_EQ(spvReflectEnumerateSourceLineRanges(&module_, nullptr, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+}
+
 TEST_P(SpirvReflectTest, CheckYamlOutput) {
   const uint32_t yaml_verbosity = 1;
   SpvReflectToYaml yamlizer(module_, yaml_verbosity);
@@ -1145,3 +1255,1848 @@ TEST_F(SpirvReflectMultiEntryPointTest, ChangeDescriptorSetNumber) {
   ASSERT_EQ(set0->bindings[0], set1->bindings[1]);
   ASSERT_EQ(set0->bindings[0]->set, 1);
 }
+
+TEST_F(SpirvReflectMultiEntryPointTest, GetRegisterPressure) {
+  // A register file that only fits a single wave of either entry point
+  SpvReflectOccupancyBudget budget = {};
+  budget.registers_per_lane = 8;
+  for (const char* ep : eps_) {
+    SpvReflectRegisterPressure pressure;
+    ASSERT_EQ(SPV_REFLECT_RESULT_SUCCESS,
+              spvReflectGetEntryPointRegisterPressure(&module_, ep, &budget,
+                                                      &pressure));
+    EXPECT_STREQ(pressure.entry_point_name, ep);
+    // Both entry points call getData()
+    ASSERT_EQ(pressure.function_count, 2);
+    EXPECT_EQ(pressure.functions[0].function_id,
+              spvReflectGetEntryPoint(&module_, ep)->id);
+    EXPECT_GT(pressure.max_live_registers,
+              pressure.functions[1].max_live_registers);
+    EXPECT_EQ(pressure.allocated_registers, 8);
+    EXPECT_EQ(pressure.spilled_registers, 0);
+    EXPECT_EQ(pressure.occupancy, 1);
+    spvReflectDestroyRegisterPressure(&pressure);
+  }
+}
+
+TEST(SpirvReflectInstructionCostTest, LoopWeights) {
+  std::ifstream spirv_file("../tests/cost/loop_cost.spv",
+                           std::ios::binary | std::ios::ate);
+  std::vector<uint8_t> spirv(spirv_file.tellg());
+  spirv_file.seekg(0);
+  spirv_file.read(reinterpret_cast<char*>(spirv.data()), spirv.size());
+
+  spv_reflect::ShaderModule module(spirv);
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectInstructionCostReport report;
+  ASSERT_EQ(module.GetEntryPointInstructionCost("main", 10, &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(report.function_count, 2);
+  const SpvReflectFunctionCost& main_cost = report.functions[0];
+  const SpvReflectFunctionCost& scale_cost = report.functions[1];
+  EXPECT_STREQ(main_cost.name, "main");
+  EXPECT_EQ(main_cost.loop_count, 3);
+  // Only the loop bounded by a push constant needs the default trip count
+  EXPECT_EQ(main_cost.unknown_trip_count_loop_count, 1);
+  // i = 0; i < 4; ++i
+  EXPECT_EQ(main_cost.self.sample_count, 4);
+  EXPECT_EQ(main_cost.self.load_count[SpvStorageClassUniformConstant], 4);
+  // j = 8; j > 0; j -= 2
+  EXPECT_EQ(main_cost.self.call_count, 4);
+  EXPECT_EQ(scale_cost.self.transcendental_count, 1);
+  EXPECT_EQ(main_cost.total.transcendental_count, 4);
+  EXPECT_EQ(main_cost.total.instruction_count,
+            main_cost.self.instruction_count +
+                4 * scale_cost.total.instruction_count);
+  // k < params.count, one load of the bound per iteration
+  EXPECT_EQ(main_cost.self.load_count[SpvStorageClassPushConstant], 10);
+  EXPECT_EQ(main_cost.self.store_count[SpvStorageClassOutput], 1);
+  spvReflectDestroyInstructionCostReport(&report);
+
+  // Only the unknown loop scales with the default trip count
+  ASSERT_EQ(module.GetEntryPointInstructionCost("main", 20, &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(report.functions[0].self.sample_count, 4);
+  EXPECT_EQ(report.functions[0].self.load_count[SpvStorageClassPushConstant],
+            20);
+  spvReflectDestroyInstructionCostReport(&report);
+}
+
+TEST(SpirvReflectSourceLineCostTest, HotLines) {
+  std::ifstream spirv_file("../tests/cost/line_cost.spv",
+                           std::ios::binary | std::ios::ate);
+  std::vector<uint8_t> spirv(spirv_file.tellg());
+  spirv_file.seekg(0);
+  spirv_file.read(reinterpret_cast<char*>(spirv.data()), spirv.size());
+
+  spv_reflect::ShaderModule module(spirv);
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_STREQ(module.GetShaderModule().source_file, "line_cost.frag");
+  ASSERT_NE(module.GetShaderModule().source_source, nullptr);
+  EXPECT_NE(std::string(module.GetShaderModule().source_source)
+                .find("vec4 blur(vec2 p)"),
+            std::string::npos);
+
+  uint32_t range_count = 0;
+  ASSERT_EQ(module.EnumerateSourceLineRanges(&range_count, nullptr),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_GT(range_count, 0);
+  std::vector<SpvReflectSourceLineRange> ranges(range_count);
+  ASSERT_EQ(module.EnumerateSourceLineRanges(&range_count, ranges.data()),
+            SPV_REFLECT_RESULT_SUCCESS);
+  for (const auto& range : ranges) {
+    EXPECT_STREQ(range.file, "line_cost.frag");
+    EXPECT_GT(range.word_count, 0);
+  }
+  uint32_t short_count = range_count - 1;
+  EXPECT_EQ(module.EnumerateSourceLineRanges(&short_count, ranges.data()),
+            SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH);
+
+  SpvReflectSourceLineCostReport report;
+  ASSERT_EQ(module.GetEntryPointSourceLineCost("main", 0, &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_GT(report.line_count, 0);
+  // texture() inside the 8 iteration loop of blur(), which main calls twice
+  EXPECT_STREQ(report.lines[0].file, "line_cost.frag");
+  EXPECT_EQ(report.lines[0].line, 9);
+  EXPECT_EQ(report.lines[0].cost.sample_count, 16);
+  EXPECT_EQ(report.total.sample_count, 16);
+  bool found_call_line = false;
+  for (uint32_t i = 0; i < report.line_count; ++i) {
+    if (report.lines[i].line == 15) {
+      found_call_line = true;
+      EXPECT_EQ(report.lines[i].cost.call_count, 2);
+    }
+  }
+  EXPECT_TRUE(found_call_line);
+  spvReflectDestroySourceLineCostReport(&report);
+}
+
+namespace {
+std::vector<uint8_t> ReadSpirvFile(const char* path) {
+  std::ifstream spirv_file(path, std::ios::binary | std::ios::ate);
+  std::vector<uint8_t> spirv(spirv_file.tellg());
+  spirv_file.seekg(0);
+  spirv_file.read(reinterpret_cast<char*>(spirv.data()), spirv.size());
+  return spirv;
+}
+}  // namespace
+
+TEST(SpirvReflectDeadOutputTest, EliminateDeadOutputs) {
+  spv_reflect::ShaderModule vs(
+      ReadSpirvFile("../tests/interface/dead_outputs_vs.spv"));
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/interface/dead_outputs_fs.spv"));
+  ASSERT_EQ(vs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(vs.GetShaderModule().output_variable_count, 6);
+  const uint32_t original_size = vs.GetCodeSize();
+
+  uint32_t removed_count = 0;
+  ASSERT_EQ(vs.EliminateDeadOutputs("main", fs, "main", &removed_count),
+            SPV_REFLECT_RESULT_SUCCESS);
+  // Locations 1 and 2; location 4 is read back, 5-6 overlaps an input
+  EXPECT_EQ(removed_count, 2);
+  EXPECT_LT(vs.GetCodeSize(), original_size);
+  const SpvReflectShaderModule& module = vs.GetShaderModule();
+  EXPECT_EQ(module.output_variable_count, 4);
+  EXPECT_EQ(module.entry_points[0].output_variable_count, 4);
+  SpvReflectResult result;
+  EXPECT_EQ(vs.GetOutputVariableByLocation(1, &result), nullptr);
+  EXPECT_EQ(vs.GetOutputVariableByLocation(2, &result), nullptr);
+  EXPECT_NE(vs.GetOutputVariableByLocation(0, &result), nullptr);
+  EXPECT_NE(vs.GetOutputVariableByLocation(4, &result), nullptr);
+  EXPECT_NE(vs.GetOutputVariableByLocation(5, &result), nullptr);
+
+  // The rewritten code must reflect on its own
+  std::vector<uint8_t> code(
+      reinterpret_cast<const uint8_t*>(vs.GetCode()),
+      reinterpret_cast<const uint8_t*>(vs.GetCode()) + vs.GetCodeSize());
+  spv_reflect::ShaderModule reparsed(code);
+  ASSERT_EQ(reparsed.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(reparsed.GetShaderModule().output_variable_count, 4);
+  SpvReflectInstructionCostReport cost;
+  ASSERT_EQ(reparsed.GetEntryPointInstructionCost("main", 0, &cost),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(cost.total.store_count[SpvStorageClassOutput], 5);
+  spvReflectDestroyInstructionCostReport(&cost);
+
+  // Nothing left to remove
+  ASSERT_EQ(vs.EliminateDeadOutputs("main", fs, "main", &removed_count),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(removed_count, 0);
+}
+
+TEST(SpirvReflectDeadOutputTest, EliminateDeadOutputs_Errors) {
+  SpvReflectShaderModule vs;
+  SpvReflectShaderModule fs;
+  std::vector<uint8_t> vs_code =
+      ReadSpirvFile("../tests/interface/dead_outputs_vs.spv");
+  std::vector<uint8_t> fs_code =
+      ReadSpirvFile("../tests/interface/dead_outputs_fs.spv");
+  ASSERT_EQ(spvReflectCreateShaderModule(vs_code.size(), vs_code.data(), &vs),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(spvReflectCreateShaderModule(fs_code.size(), fs_code.data(), &fs),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(spvReflectEliminateDeadOutputs(nullptr, "main", &fs, "main",
+                                           nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(spvReflectEliminateDeadOutputs(&vs, "main", nullptr, "main",
+                                           nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(spvReflectEliminateDeadOutputs(&vs, "__minimal__", &fs, "main",
+                                           nullptr),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  // Fragment outputs are not varyings
+  EXPECT_EQ(spvReflectEliminateDeadOutputs(&fs, "main", &vs, "main", nullptr),
+            SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_EXECUTION_MODE);
+  EXPECT_EQ(vs.output_variable_count, 6);
+  spvReflectDestroyShaderModule(&vs);
+  spvReflectDestroyShaderModule(&fs);
+}
+
+TEST(SpirvReflectDeadOutputTest, SharedOutputsUnderEntryPointFilter) {
+  std::vector<uint8_t> vs_code =
+      ReadSpirvFile("../tests/interface/shared_outputs_vs.spv");
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/interface/dead_outputs_fs.spv"));
+  ASSERT_EQ(fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  // vs_a alone does not know that vs_b writes out0 too
+  const char* vs_a_names[] = {"vs_a"};
+  SpvReflectShaderModuleOptions options = {1, vs_a_names};
+  spv_reflect::ShaderModule vs_a(vs_code.size(), vs_code.data(), options);
+  ASSERT_EQ(vs_a.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  uint32_t removed_count = 0;
+  EXPECT_EQ(vs_a.EliminateDeadOutputs("vs_a", fs, "main", &removed_count),
+            SPV_REFLECT_RESULT_NOT_READY);
+  SpvReflectVaryingPackingReport report;
+  EXPECT_EQ(vs_a.PackVaryings("vs_a", fs, "main", &report),
+            SPV_REFLECT_RESULT_NOT_READY);
+  EXPECT_EQ(vs_a.GetCodeSize(), vs_code.size());
+  EXPECT_EQ(memcmp(vs_a.GetCode(), vs_code.data(), vs_code.size()), 0);
+
+  // Reflecting both entry points keeps the shared output
+  spv_reflect::ShaderModule vs(vs_code);
+  ASSERT_EQ(vs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(vs.EliminateDeadOutputs("vs_a", fs, "main", &removed_count),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(removed_count, 0);
+  EXPECT_EQ(vs.GetCodeSize(), vs_code.size());
+}
+
+namespace {
+uint32_t CountComponentDecorations(const spv_reflect::ShaderModule& module,
+                                   uint32_t id) {
+  const uint32_t* code = module.GetCode();
+  uint32_t word_count = module.GetCodeSize() / sizeof(uint32_t);
+  uint32_t count = 0;
+  for (uint32_t i = 5; i < word_count; i += code[i] >> 16) {
+    if (((code[i] & 0xFFFF) == SpvOpDecorate) && (code[i + 1] == id) &&
+        (code[i + 2] == SpvDecorationComponent)) {
+      ++count;
+    }
+    if ((code[i] >> 16) == 0) {
+      break;
+    }
+  }
+  return count;
+}
+}  // namespace
+
+TEST(SpirvReflectVaryingPackingTest, PackVaryings) {
+  spv_reflect::ShaderModule vs(
+      ReadSpirvFile("../tests/interface/packing_vs.spv"));
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/interface/packing_fs.spv"));
+  ASSERT_EQ(vs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectVaryingPackingReport report;
+  ASSERT_EQ(vs.PackVaryings("main", fs, "main", &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  // Locations 0-6 plus the two element array at 7-8
+  EXPECT_EQ(report.location_count_before, 9);
+  // color | normal + fog | uv | screen | id + material | weights
+  EXPECT_EQ(report.location_count_after, 7);
+  ASSERT_EQ(report.assignment_count, 7);
+
+  SpvReflectResult result;
+  const SpvReflectInterfaceVariable* p_fog_in =
+      fs.GetInputVariableByLocation(1, &result);
+  ASSERT_NE(p_fog_in, nullptr);
+  for (uint32_t i = 0; i < report.assignment_count; ++i) {
+    const SpvReflectVaryingAssignment& assignment = report.assignments[i];
+    EXPECT_LE(assignment.component + assignment.component_count, 4);
+    EXPECT_NE(assignment.location, 7);
+    EXPECT_NE(assignment.location, 8);
+    // Both stages agree on the new location and component
+    const SpvReflectInterfaceVariable* p_output = nullptr;
+    const SpvReflectInterfaceVariable* p_input = nullptr;
+    for (uint32_t j = 0; j < vs.GetShaderModule().output_variable_count; ++j) {
+      if (vs.GetShaderModule().output_variables[j].spirv_id ==
+          assignment.output_spirv_id) {
+        p_output = &vs.GetShaderModule().output_variables[j];
+      }
+    }
+    for (uint32_t j = 0; j < fs.GetShaderModule().input_variable_count; ++j) {
+      if (fs.GetShaderModule().input_variables[j].spirv_id ==
+          assignment.input_spirv_id) {
+        p_input = &fs.GetShaderModule().input_variables[j];
+      }
+    }
+    ASSERT_NE(p_output, nullptr);
+    ASSERT_NE(p_input, nullptr);
+    EXPECT_EQ(p_output->location, assignment.location);
+    EXPECT_EQ(p_input->location, assignment.location);
+    uint32_t expected = (assignment.component != 0) ? 1 : 0;
+    EXPECT_EQ(CountComponentDecorations(vs, assignment.output_spirv_id),
+              expected);
+    EXPECT_EQ(CountComponentDecorations(fs, assignment.input_spirv_id),
+              expected);
+    if (p_input->name != nullptr && std::string(p_input->name) == "fog") {
+      // The scalar fills the fourth component next to the vec3
+      EXPECT_EQ(assignment.component, 3);
+    }
+  }
+  EXPECT_NE(vs.GetOutputVariableByLocation(7, &result), nullptr);
+  spvReflectDestroyVaryingPackingReport(&report);
+
+  // Packed interfaces are left alone
+  ASSERT_EQ(vs.PackVaryings("main", fs, "main", &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(report.location_count_before, 7);
+  EXPECT_EQ(report.location_count_after, 7);
+  EXPECT_EQ(report.assignment_count, 0);
+  spvReflectDestroyVaryingPackingReport(&report);
+}
+
+TEST(SpirvReflectVaryingPackingTest, PackVaryings_Errors) {
+  spv_reflect::ShaderModule vs(
+      ReadSpirvFile("../tests/interface/packing_vs.spv"));
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/interface/packing_fs.spv"));
+  SpvReflectVaryingPackingReport report;
+  EXPECT_EQ(vs.PackVaryings("main", fs, "main", nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(vs.PackVaryings("__minimal__", fs, "main", &report),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  EXPECT_EQ(fs.PackVaryings("main", vs, "main", &report),
+            SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_EXECUTION_MODE);
+  EXPECT_EQ(vs.GetShaderModule().output_variable_count, 9);
+}
+
+namespace {
+const SpvReflectDescriptorBindingRemap* FindRemap(
+    const SpvReflectDescriptorBindingRemapTable& table,
+    const spv_reflect::ShaderModule& module, const char* name) {
+  for (uint32_t i = 0; i < table.remap_count; ++i) {
+    const SpvReflectDescriptorBindingRemap* p_remap = &table.remaps[i];
+    for (uint32_t j = 0; j < module.GetShaderModule().descriptor_binding_count;
+         ++j) {
+      const SpvReflectDescriptorBinding& binding =
+          module.GetShaderModule().descriptor_bindings[j];
+      if (binding.spirv_id == p_remap->spirv_id &&
+          std::string(binding.name) == name) {
+        return p_remap;
+      }
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+TEST(SpirvReflectDescriptorCompactionTest, CompactDescriptorBindings) {
+  const std::vector<uint8_t> spirv =
+      ReadSpirvFile("../tests/descriptors/compaction_fs.spv");
+  spv_reflect::ShaderModule original(spirv);
+  spv_reflect::ShaderModule module(spirv);
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(module.GetShaderModule().descriptor_binding_count, 7);
+
+  SpvReflectDescriptorBindingRemapTable table;
+  ASSERT_EQ(module.CompactDescriptorBindings(
+                SPV_REFLECT_DESCRIPTOR_COMPACTION_NONE, &table),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(table.removed_count, 2);
+  ASSERT_EQ(table.remap_count, 7);
+  for (uint32_t i = 1; i < table.remap_count; ++i) {
+    EXPECT_LE(table.remaps[i - 1].old_set, table.remaps[i].old_set);
+  }
+
+  struct Expected {
+    const char* name;
+    uint32_t removed;
+    uint32_t set;
+    uint32_t binding;
+  };
+  const Expected expected[] = {
+      {"ubo", 0, 0, 0},        {"unused_sampler", 1, 0, 2},
+      {"tex", 0, 0, 1},        {"tex_alias", 0, 0, 1},
+      {"unused_ubo", 1, 1, 0}, {"ssbo", 0, 2, 0},
+      {"image", 0, 4, 0},
+  };
+  for (const Expected& e : expected) {
+    SCOPED_TRACE(e.name);
+    const SpvReflectDescriptorBindingRemap* p_remap =
+        FindRemap(table, original, e.name);
+    ASSERT_NE(p_remap, nullptr);
+    EXPECT_EQ(p_remap->removed, e.removed);
+    EXPECT_EQ(p_remap->set, e.set);
+    EXPECT_EQ(p_remap->binding, e.binding);
+  }
+
+  // The module is re-reflected from the rewritten code
+  ASSERT_EQ(module.GetShaderModule().descriptor_binding_count, 5);
+  for (uint32_t i = 0; i < module.GetShaderModule().descriptor_binding_count;
+       ++i) {
+    const SpvReflectDescriptorBinding& binding =
+        module.GetShaderModule().descriptor_bindings[i];
+    const SpvReflectDescriptorBindingRemap* p_remap =
+        FindRemap(table, original, binding.name);
+    ASSERT_NE(p_remap, nullptr);
+    EXPECT_EQ(binding.spirv_id, p_remap->spirv_id);
+    EXPECT_EQ(binding.set, p_remap->set);
+    EXPECT_EQ(binding.binding, p_remap->binding);
+  }
+  EXPECT_LT(module.GetCodeSize(), original.GetCodeSize());
+  spvReflectDestroyDescriptorBindingRemapTable(&table);
+  EXPECT_EQ(table.remaps, nullptr);
+
+  // Dense bindings are left alone
+  ASSERT_EQ(module.CompactDescriptorBindings(
+                SPV_REFLECT_DESCRIPTOR_COMPACTION_NONE, &table),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(table.removed_count, 0);
+  EXPECT_EQ(table.remap_count, 5);
+  for (uint32_t i = 0; i < table.remap_count; ++i) {
+    EXPECT_EQ(table.remaps[i].set, table.remaps[i].old_set);
+    EXPECT_EQ(table.remaps[i].binding, table.remaps[i].old_binding);
+  }
+  spvReflectDestroyDescriptorBindingRemapTable(&table);
+}
+
+TEST(SpirvReflectDescriptorCompactionTest, CollapseSets) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/compaction_fs.spv"));
+  SpvReflectDescriptorBindingRemapTable table;
+  ASSERT_EQ(module.CompactDescriptorBindings(
+                SPV_REFLECT_DESCRIPTOR_COMPACTION_COLLAPSE_SETS, &table),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(table.removed_count, 2);
+  spvReflectDestroyDescriptorBindingRemapTable(&table);
+
+  uint32_t set_count = 0;
+  ASSERT_EQ(module.EnumerateDescriptorSets(&set_count, nullptr),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(set_count, 3);
+  std::vector<SpvReflectDescriptorSet*> sets(set_count);
+  ASSERT_EQ(module.EnumerateDescriptorSets(&set_count, sets.data()),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(sets[0]->set, 0);
+  EXPECT_EQ(sets[0]->binding_count, 3);
+  EXPECT_EQ(sets[1]->set, 1);
+  EXPECT_EQ(sets[1]->binding_count, 1);
+  EXPECT_EQ(sets[2]->set, 2);
+  EXPECT_EQ(sets[2]->binding_count, 1);
+  SpvReflectResult result;
+  const SpvReflectDescriptorBinding* p_image =
+      module.GetDescriptorBinding(0, 2, &result);
+  ASSERT_NE(p_image, nullptr);
+  EXPECT_EQ(std::string(p_image->name), "image");
+}
+
+TEST(SpirvReflectDescriptorCompactionTest, CompactDescriptorBindings_Errors) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/compaction_fs.spv"));
+  EXPECT_EQ(module.CompactDescriptorBindings(
+                SPV_REFLECT_DESCRIPTOR_COMPACTION_NONE, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(spvReflectCompactDescriptorBindings(
+                nullptr, SPV_REFLECT_DESCRIPTOR_COMPACTION_NONE, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(module.GetShaderModule().descriptor_binding_count, 7);
+}
+
+TEST(SpirvReflectPushConstantPlanTest, GetPushConstantPlan) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/push_constant_promotion_fs.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectPushConstantPlan plan;
+  ASSERT_EQ(module.GetPushConstantPlan("main", 0, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(plan.budget, 128);
+  EXPECT_EQ(plan.base_offset, 0);
+  // The array, the unused members and the block loaded whole are skipped
+  ASSERT_EQ(plan.candidate_count, 4);
+  EXPECT_EQ(plan.promoted_count, 4);
+  EXPECT_EQ(plan.size, 52);
+
+  struct Expected {
+    uint32_t member_index;
+    uint32_t uniform_offset;
+    uint32_t size;
+    uint32_t alignment;
+    uint32_t access_count;
+    uint32_t offset;
+  };
+  // Ranked by size, then by access count
+  const Expected expected[] = {
+      {2, 80, 4, 4, 1, 48},    // exposure
+      {3, 96, 12, 16, 1, 16},  // light_dir
+      {1, 64, 16, 16, 2, 0},   // tint
+      {6, 176, 16, 8, 1, 32},  // uv_transform, std430 column stride 8
+  };
+  for (uint32_t i = 0; i < plan.candidate_count; ++i) {
+    const SpvReflectPushConstantCandidate& candidate = plan.candidates[i];
+    EXPECT_EQ(candidate.set, 0);
+    EXPECT_EQ(candidate.binding, 0);
+    EXPECT_EQ(candidate.member_index, expected[i].member_index);
+    EXPECT_EQ(candidate.uniform_offset, expected[i].uniform_offset);
+    EXPECT_EQ(candidate.size, expected[i].size);
+    EXPECT_EQ(candidate.alignment, expected[i].alignment);
+    EXPECT_EQ(candidate.access_count, expected[i].access_count);
+    EXPECT_EQ(candidate.promoted, 1);
+    EXPECT_EQ(candidate.offset, expected[i].offset);
+  }
+  spvReflectDestroyPushConstantPlan(&plan);
+
+  // The matrix no longer fits
+  ASSERT_EQ(module.GetPushConstantPlan("main", 32, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(plan.candidate_count, 4);
+  EXPECT_EQ(plan.promoted_count, 3);
+  EXPECT_EQ(plan.size, 32);
+  EXPECT_EQ(plan.candidates[3].member_index, 6);
+  EXPECT_EQ(plan.candidates[3].promoted, 0);
+  spvReflectDestroyPushConstantPlan(&plan);
+
+  EXPECT_EQ(module.GetPushConstantPlan("main", 0, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(module.GetPushConstantPlan("__minimal__", 0, &plan),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+}
+
+TEST(SpirvReflectPushConstantPlanTest, PromotePushConstants) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/push_constant_promotion_fs.spv"));
+  SpvReflectPushConstantPlan plan;
+  ASSERT_EQ(module.GetPushConstantPlan("main", 32, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(module.PromotePushConstants("main", &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  spvReflectDestroyPushConstantPlan(&plan);
+
+  ASSERT_EQ(module.GetShaderModule().push_constant_block_count, 1);
+  const SpvReflectEntryPoint* p_entry =
+      spvReflectGetEntryPoint(&module.GetShaderModule(), "main");
+  ASSERT_NE(p_entry, nullptr);
+  EXPECT_EQ(p_entry->used_push_constant_count, 1);
+  const SpvReflectBlockVariable& block =
+      module.GetShaderModule().push_constant_blocks[0];
+  ASSERT_EQ(block.member_count, 3);
+  EXPECT_EQ(std::string(block.members[0].name), "tint");
+  EXPECT_EQ(block.members[0].offset, 0);
+  EXPECT_EQ(std::string(block.members[1].name), "light_dir");
+  EXPECT_EQ(block.members[1].offset, 16);
+  EXPECT_EQ(std::string(block.members[2].name), "exposure");
+  EXPECT_EQ(block.members[2].offset, 28);
+
+  // The uniform buffer keeps its layout and only the matrix is left
+  const SpvReflectDescriptorBinding* p_material =
+      module.GetDescriptorBinding(0, 0);
+  ASSERT_NE(p_material, nullptr);
+  EXPECT_EQ(p_material->block.member_count, 7);
+  EXPECT_EQ(p_material->block.members[1].offset, 64);
+  ASSERT_EQ(module.GetPushConstantPlan("main", 0, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(plan.candidate_count, 1);
+  EXPECT_EQ(plan.candidates[0].member_index, 6);
+  EXPECT_EQ(plan.base_offset, 32);
+  // Only one push constant block per entry point
+  EXPECT_EQ(plan.promoted_count, 0);
+  EXPECT_EQ(plan.candidates[0].promoted, 0);
+  plan.candidates[0].promoted = 1;
+  plan.candidates[0].offset = 32;
+  EXPECT_EQ(module.PromotePushConstants("main", &plan),
+            SPV_REFLECT_RESULT_ERROR_SPIRV_INVALID_STORAGE_CLASS);
+  spvReflectDestroyPushConstantPlan(&plan);
+}
+
+TEST(SpirvReflectPushConstantPlanTest, ExistingPushConstantBlock) {
+  std::vector<uint8_t> spirv =
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv");
+  spv_reflect::ShaderModule module(spirv);
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  const SpvReflectEntryPoint* p_entry =
+      spvReflectGetEntryPoint(&module.GetShaderModule(), "main");
+  ASSERT_NE(p_entry, nullptr);
+  ASSERT_EQ(p_entry->used_push_constant_count, 1);
+
+  // The plan ranks the uniform members but promotes none of them, so
+  // applying it leaves the module as it was
+  SpvReflectPushConstantPlan plan;
+  ASSERT_EQ(module.GetPushConstantPlan("main", 0, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_GT(plan.candidate_count, 0);
+  EXPECT_GT(plan.base_offset, 0);
+  EXPECT_EQ(plan.promoted_count, 0);
+  EXPECT_EQ(plan.size, plan.base_offset);
+  for (uint32_t i = 0; i < plan.candidate_count; ++i) {
+    EXPECT_EQ(plan.candidates[i].promoted, 0);
+  }
+  EXPECT_EQ(module.PromotePushConstants("main", &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(module.GetCodeSize(), spirv.size());
+  EXPECT_EQ(memcmp(module.GetCode(), spirv.data(), spirv.size()), 0);
+  spvReflectDestroyPushConstantPlan(&plan);
+}
+
+TEST(SpirvReflectPushConstantPlanTest, PromotePushConstants_Errors) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/push_constant_promotion_fs.spv"));
+  SpvReflectPushConstantPlan plan;
+  ASSERT_EQ(module.GetPushConstantPlan("main", 0, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(module.PromotePushConstants("main", nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(module.PromotePushConstants("__minimal__", &plan),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+
+  // Misaligned and overlapping offsets
+  plan.candidates[0].offset = 2;
+  EXPECT_EQ(module.PromotePushConstants("main", &plan),
+            SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+  plan.candidates[0].offset = 16;
+  EXPECT_EQ(module.PromotePushConstants("main", &plan),
+            SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+  plan.candidates[0].offset = 48;
+  plan.candidates[0].member_index = 5;
+  EXPECT_EQ(module.PromotePushConstants("main", &plan),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  EXPECT_EQ(module.GetShaderModule().push_constant_block_count, 0);
+  spvReflectDestroyPushConstantPlan(&plan);
+}
+
+TEST(SpirvReflectImageSamplerPairTest, EnumerateEntryPointImageSamplerPairs) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/separate_samplers.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  uint32_t count = 0;
+  ASSERT_EQ(
+      module.EnumerateEntryPointImageSamplerPairs("ps_main", &count, nullptr),
+      SPV_REFLECT_RESULT_SUCCESS);
+  // The repeated tex_a sample is reported once
+  ASSERT_EQ(count, 3);
+  std::vector<SpvReflectImageSamplerPair*> pairs(count);
+  ASSERT_EQ(module.EnumerateEntryPointImageSamplerPairs("ps_main", &count,
+                                                        pairs.data()),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(std::string(pairs[0]->p_image->name), "tex_a");
+  EXPECT_EQ(std::string(pairs[0]->p_sampler->name), "samp_linear");
+  EXPECT_EQ(std::string(pairs[1]->p_image->name), "tex_b");
+  EXPECT_EQ(std::string(pairs[1]->p_sampler->name), "samp_linear");
+  // Traced through the helper function and the array access chain
+  EXPECT_EQ(std::string(pairs[2]->p_image->name), "tex_arr");
+  EXPECT_EQ(std::string(pairs[2]->p_sampler->name), "samp_point");
+
+  ASSERT_EQ(
+      module.EnumerateEntryPointImageSamplerPairs("vs_main", &count, nullptr),
+      SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(count, 1);
+  count = 2;
+  EXPECT_EQ(module.EnumerateEntryPointImageSamplerPairs("vs_main", &count,
+                                                        pairs.data()),
+            SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH);
+  EXPECT_EQ(
+      module.EnumerateEntryPointImageSamplerPairs("__minimal__", &count,
+                                                  nullptr),
+      SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  EXPECT_EQ(module.EnumerateEntryPointImageSamplerPairs("ps_main", nullptr,
+                                                        nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+}
+
+TEST(SpirvReflectImageSamplerPairTest, EnumerateSamplerUsage) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/separate_samplers.spv"));
+  const SpvReflectEntryPoint* entry_points[] = {
+      spvReflectGetEntryPoint(&module.GetShaderModule(), "vs_main"),
+      spvReflectGetEntryPoint(&module.GetShaderModule(), "ps_main"),
+  };
+  ASSERT_NE(entry_points[0], nullptr);
+  ASSERT_NE(entry_points[1], nullptr);
+
+  uint32_t count = 0;
+  ASSERT_EQ(spvReflectEnumerateSamplerUsage(2, entry_points, &count, nullptr),
+            SPV_REFLECT_RESULT_SUCCESS);
+  // samp_unused is never combined with an image
+  ASSERT_EQ(count, 2);
+  std::vector<SpvReflectSamplerUsage> usages(count);
+  ASSERT_EQ(
+      spvReflectEnumerateSamplerUsage(2, entry_points, &count, usages.data()),
+      SPV_REFLECT_RESULT_SUCCESS);
+
+  EXPECT_EQ(std::string(usages[0].p_sampler->name), "samp_linear");
+  EXPECT_EQ(usages[0].stage_flags, SPV_REFLECT_SHADER_STAGE_FRAGMENT_BIT);
+  EXPECT_EQ(usages[0].image_count, 2);
+  EXPECT_EQ(usages[0].p_image, nullptr);
+
+  // The same image in both stages, so an immutable sampler can replace it
+  EXPECT_EQ(std::string(usages[1].p_sampler->name), "samp_point");
+  EXPECT_EQ(usages[1].stage_flags, SPV_REFLECT_SHADER_STAGE_VERTEX_BIT |
+                                       SPV_REFLECT_SHADER_STAGE_FRAGMENT_BIT);
+  EXPECT_EQ(usages[1].image_count, 1);
+  ASSERT_NE(usages[1].p_image, nullptr);
+  EXPECT_EQ(std::string(usages[1].p_image->name), "tex_arr");
+
+  count = 1;
+  EXPECT_EQ(
+      spvReflectEnumerateSamplerUsage(2, entry_points, &count, usages.data()),
+      SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH);
+  EXPECT_EQ(spvReflectEnumerateSamplerUsage(2, nullptr, &count, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  ASSERT_EQ(spvReflectEnumerateSamplerUsage(0, nullptr, &count, nullptr),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(count, 0);
+}
+
+namespace {
+bool operator==(const SpvReflectFingerprint& a, const SpvReflectFingerprint& b) {
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+}  // namespace
+
+TEST(SpirvReflectFingerprintTest, IgnoresDebugInfoAndIds) {
+  spv_reflect::ShaderModule original(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  spv_reflect::ShaderModule stripped(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs_stripped.spv"));
+  ASSERT_EQ(original.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(stripped.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectFingerprints a = {};
+  SpvReflectFingerprints b = {};
+  ASSERT_EQ(original.GetFingerprints(&a), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(stripped.GetFingerprints(&b), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_TRUE(a.module == b.module);
+  EXPECT_TRUE(a.push_constants == b.push_constants);
+  EXPECT_TRUE(a.vertex_inputs == b.vertex_inputs);
+  ASSERT_EQ(a.descriptor_set_count, 1);
+  ASSERT_EQ(b.descriptor_set_count, 1);
+  EXPECT_EQ(a.descriptor_sets[0].set, 0);
+  EXPECT_TRUE(a.descriptor_sets[0].fingerprint ==
+              b.descriptor_sets[0].fingerprint);
+
+  // Fingerprints are persisted as cache keys, so the digest must not change
+  // between releases
+  EXPECT_EQ(a.module.value[0], 0xec84d7860e75acbcULL);
+  EXPECT_EQ(a.module.value[1], 0x446db19fd21a0ba6ULL);
+}
+
+TEST(SpirvReflectFingerprintTest, SemanticChanges) {
+  spv_reflect::ShaderModule stripped(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs_stripped.spv"));
+  spv_reflect::ShaderModule changed(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs_changed.spv"));
+  SpvReflectFingerprints a = {};
+  SpvReflectFingerprints b = {};
+  ASSERT_EQ(stripped.GetFingerprints(&a), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(changed.GetFingerprints(&b), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_FALSE(a.module == b.module);
+  // Only the uniform buffer moved
+  EXPECT_FALSE(a.descriptor_sets[0].fingerprint ==
+               b.descriptor_sets[0].fingerprint);
+  EXPECT_TRUE(a.push_constants == b.push_constants);
+  EXPECT_TRUE(a.vertex_inputs == b.vertex_inputs);
+}
+
+TEST(SpirvReflectFingerprintTest, EntryPointFingerprints) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/descriptors/separate_samplers.spv"));
+  SpvReflectFingerprints vs = {};
+  SpvReflectFingerprints ps = {};
+  ASSERT_EQ(module.GetEntryPointFingerprints("vs_main", &vs),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(module.GetEntryPointFingerprints("ps_main", &ps),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_TRUE(vs.module == ps.module);
+  // Neither stage has push constants or vertex inputs
+  EXPECT_TRUE(vs.push_constants == ps.push_constants);
+  EXPECT_TRUE(vs.vertex_inputs == ps.vertex_inputs);
+  EXPECT_FALSE(vs.push_constants == vs.vertex_inputs);
+  // vs_main only uses tex_arr and samp_point
+  ASSERT_EQ(vs.descriptor_set_count, 1);
+  ASSERT_EQ(ps.descriptor_set_count, 1);
+  EXPECT_FALSE(vs.descriptor_sets[0].fingerprint ==
+               ps.descriptor_sets[0].fingerprint);
+
+  SpvReflectFingerprints whole = {};
+  ASSERT_EQ(module.GetFingerprints(&whole), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_TRUE(whole.module == vs.module);
+
+  EXPECT_EQ(module.GetEntryPointFingerprints("__minimal__", &vs),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  EXPECT_EQ(module.GetEntryPointFingerprints("vs_main", nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(spvReflectGetFingerprints(nullptr, &whole),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+}
+
+TEST(SpirvReflectModuleDiffTest, HotReloadEdit) {
+  spv_reflect::ShaderModule old_module(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  spv_reflect::ShaderModule new_module(
+      ReadSpirvFile("../tests/diff/diff_vs_new.spv"));
+  ASSERT_EQ(old_module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(new_module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectModuleDiff diff = {};
+  ASSERT_EQ(old_module.DiffShaderModules(new_module, &diff),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(diff.rebuild_flags, SPV_REFLECT_REBUILD_PIPELINE_LAYOUT |
+                                    SPV_REFLECT_REBUILD_VERTEX_INPUT_STATE |
+                                    SPV_REFLECT_REBUILD_HOST_STRUCTS);
+
+  // Unnamed and named objects sort by name, so albedo comes first
+  ASSERT_EQ(diff.binding_diff_count, 2);
+  const SpvReflectDescriptorBindingDiff& albedo = diff.binding_diffs[0];
+  EXPECT_EQ(albedo.p_old, nullptr);
+  ASSERT_NE(albedo.p_new, nullptr);
+  EXPECT_EQ(std::string(albedo.p_new->name), "albedo");
+  EXPECT_EQ(albedo.flags, SPV_REFLECT_DIFF_ADDED);
+
+  const SpvReflectDescriptorBindingDiff& transforms = diff.binding_diffs[1];
+  EXPECT_EQ(std::string(transforms.p_old->name), "transforms");
+  EXPECT_EQ(transforms.flags, SPV_REFLECT_DIFF_BLOCK_LAYOUT);
+  ASSERT_EQ(transforms.member_diff_count, 2);
+  EXPECT_EQ(transforms.member_diffs[0].p_old, nullptr);
+  EXPECT_EQ(std::string(transforms.member_diffs[0].p_new->name), "bias");
+  EXPECT_EQ(transforms.member_diffs[0].flags, SPV_REFLECT_DIFF_ADDED);
+  EXPECT_EQ(std::string(transforms.member_diffs[1].p_new->name), "scale");
+  EXPECT_TRUE(transforms.member_diffs[1].flags & SPV_REFLECT_DIFF_OFFSET);
+  EXPECT_EQ(transforms.member_diffs[1].p_old->offset, 64);
+  EXPECT_EQ(transforms.member_diffs[1].p_new->offset, 68);
+
+  ASSERT_EQ(diff.push_constant_diff_count, 1);
+  EXPECT_EQ(diff.push_constant_diffs[0].flags,
+            SPV_REFLECT_DIFF_OFFSET | SPV_REFLECT_DIFF_BLOCK_LAYOUT);
+  EXPECT_EQ(diff.push_constant_diffs[0].member_diff_count, 1);
+
+  ASSERT_EQ(diff.input_variable_diff_count, 1);
+  EXPECT_EQ(std::string(diff.input_variable_diffs[0].p_new->name), "in_uv");
+  EXPECT_EQ(diff.input_variable_diffs[0].flags, SPV_REFLECT_DIFF_LOCATION);
+  EXPECT_EQ(diff.output_variable_diff_count, 0);
+  EXPECT_EQ(diff.output_variable_diffs, nullptr);
+  EXPECT_EQ(diff.member_diff_count, 3);
+
+  spvReflectDestroyModuleDiff(&diff);
+  EXPECT_EQ(diff.binding_diffs, nullptr);
+  EXPECT_EQ(diff.member_diffs, nullptr);
+}
+
+TEST(SpirvReflectModuleDiffTest, Unchanged) {
+  spv_reflect::ShaderModule old_module(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  spv_reflect::ShaderModule new_module(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  SpvReflectModuleDiff diff = {};
+  ASSERT_EQ(old_module.DiffShaderModules(new_module, &diff),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(diff.rebuild_flags, SPV_REFLECT_REBUILD_SHADER_MODULE);
+  EXPECT_EQ(diff.binding_diff_count, 0);
+  EXPECT_EQ(diff.push_constant_diff_count, 0);
+  EXPECT_EQ(diff.input_variable_diff_count, 0);
+  EXPECT_EQ(diff.output_variable_diff_count, 0);
+  EXPECT_EQ(diff.member_diff_count, 0);
+  spvReflectDestroyModuleDiff(&diff);
+
+  EXPECT_EQ(spvReflectDiffShaderModules(&old_module.GetShaderModule(), nullptr,
+                                        &diff),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+}
+
+TEST(SpirvReflectModuleDiffTest, UnnamedBindings) {
+  // Without names bindings are matched by set and binding number, so moving
+  // one is reported as a removal and an addition
+  spv_reflect::ShaderModule old_module(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs_stripped.spv"));
+  spv_reflect::ShaderModule new_module(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs_changed.spv"));
+  SpvReflectModuleDiff diff = {};
+  ASSERT_EQ(old_module.DiffShaderModules(new_module, &diff),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(diff.rebuild_flags, SPV_REFLECT_REBUILD_PIPELINE_LAYOUT);
+  ASSERT_EQ(diff.binding_diff_count, 2);
+  EXPECT_EQ(diff.binding_diffs[0].flags, SPV_REFLECT_DIFF_REMOVED);
+  EXPECT_EQ(diff.binding_diffs[0].p_old->binding, 0);
+  EXPECT_EQ(diff.binding_diffs[1].flags, SPV_REFLECT_DIFF_ADDED);
+  EXPECT_EQ(diff.binding_diffs[1].p_new->binding, 2);
+  spvReflectDestroyModuleDiff(&diff);
+}
+
+namespace {
+SpvReflectBindingAccessFlags FindBindingAccess(
+    const spv_reflect::ShaderModule& module, const char* entry_point,
+    const char* name) {
+  uint32_t count = 0;
+  EXPECT_EQ(module.EnumerateEntryPointBindingAccesses(entry_point, &count,
+                                                      nullptr),
+            SPV_REFLECT_RESULT_SUCCESS);
+  std::vector<SpvReflectDescriptorBindingAccess*> accesses(count);
+  EXPECT_EQ(module.EnumerateEntryPointBindingAccesses(entry_point, &count,
+                                                      accesses.data()),
+            SPV_REFLECT_RESULT_SUCCESS);
+  for (const SpvReflectDescriptorBindingAccess* p_access : accesses) {
+    if (std::string(p_access->p_binding->name) == name) {
+      return p_access->access;
+    }
+  }
+  ADD_FAILURE() << "no access entry for " << name;
+  return SPV_REFLECT_BINDING_ACCESS_NONE;
+}
+}  // namespace
+
+TEST(SpirvReflectBindingAccessTest, ClassifiesAccesses) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/access/binding_access.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  // The uniform buffer is not classified
+  uint32_t count = 0;
+  ASSERT_EQ(module.EnumerateEntryPointBindingAccesses("main", &count, nullptr),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(count, 8);
+
+  EXPECT_EQ(FindBindingAccess(module, "main", "read_buf"),
+            SPV_REFLECT_BINDING_ACCESS_READ);
+  EXPECT_EQ(FindBindingAccess(module, "main", "write_buf"),
+            SPV_REFLECT_BINDING_ACCESS_WRITE);
+  EXPECT_EQ(FindBindingAccess(module, "main", "rw_buf"),
+            SPV_REFLECT_BINDING_ACCESS_READ | SPV_REFLECT_BINDING_ACCESS_WRITE);
+  EXPECT_EQ(FindBindingAccess(module, "main", "counter"),
+            SPV_REFLECT_BINDING_ACCESS_ATOMIC);
+  EXPECT_EQ(FindBindingAccess(module, "main", "unused"),
+            SPV_REFLECT_BINDING_ACCESS_NONE);
+  EXPECT_EQ(FindBindingAccess(module, "main", "image"),
+            SPV_REFLECT_BINDING_ACCESS_READ | SPV_REFLECT_BINDING_ACCESS_WRITE);
+  EXPECT_EQ(FindBindingAccess(module, "main", "texels"),
+            SPV_REFLECT_BINDING_ACCESS_READ);
+  EXPECT_EQ(FindBindingAccess(module, "main", "atomic_texels"),
+            SPV_REFLECT_BINDING_ACCESS_ATOMIC);
+
+  EXPECT_EQ(FindBindingAccess(module, "read_only", "read_buf"),
+            SPV_REFLECT_BINDING_ACCESS_READ);
+  EXPECT_EQ(FindBindingAccess(module, "read_only", "texels"),
+            SPV_REFLECT_BINDING_ACCESS_READ);
+  EXPECT_EQ(FindBindingAccess(module, "read_only", "write_buf"),
+            SPV_REFLECT_BINDING_ACCESS_NONE);
+  EXPECT_EQ(FindBindingAccess(module, "read_only", "image"),
+            SPV_REFLECT_BINDING_ACCESS_NONE);
+
+  EXPECT_EQ(module.EnumerateEntryPointBindingAccesses("missing", &count,
+                                                      nullptr),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+}
+
+TEST(SpirvReflectBindingAccessTest, UntracedPointersAreReadWrite) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/access/binding_access_call.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  const SpvReflectBindingAccessFlags read_write =
+      SPV_REFLECT_BINDING_ACCESS_READ | SPV_REFLECT_BINDING_ACCESS_WRITE;
+  EXPECT_EQ(FindBindingAccess(module, "main", "image"), read_write);
+  EXPECT_EQ(FindBindingAccess(module, "main", "sel_a"), read_write);
+  EXPECT_EQ(FindBindingAccess(module, "main", "sel_b"), read_write);
+  EXPECT_EQ(FindBindingAccess(module, "main", "phi_a"), read_write);
+  EXPECT_EQ(FindBindingAccess(module, "main", "phi_b"), read_write);
+  // Only a loaded value reaches the helper
+  EXPECT_EQ(FindBindingAccess(module, "main", "read_buf"),
+            SPV_REFLECT_BINDING_ACCESS_READ);
+}
+
+TEST(SpirvReflectBindingAccessTest, CounterBuffers) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/hlsl/counter_buffers.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  uint32_t count = 0;
+  ASSERT_EQ(module.EnumerateEntryPointBindingAccesses("main", &count, nullptr),
+            SPV_REFLECT_RESULT_SUCCESS);
+  std::vector<SpvReflectDescriptorBindingAccess*> accesses(count);
+  ASSERT_EQ(module.EnumerateEntryPointBindingAccesses("main", &count,
+                                                      accesses.data()),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(count, 4);
+  for (const SpvReflectDescriptorBindingAccess* p_access : accesses) {
+    const SpvReflectDescriptorBinding* p_binding = p_access->p_binding;
+    bool is_counter = false;
+    for (uint32_t i = 0; i < module.GetShaderModule().descriptor_binding_count;
+         ++i) {
+      if (module.GetShaderModule().descriptor_bindings[i].uav_counter_binding ==
+          p_binding) {
+        is_counter = true;
+      }
+    }
+    if (is_counter) {
+      EXPECT_EQ(p_access->access, SPV_REFLECT_BINDING_ACCESS_ATOMIC);
+    } else if (std::string(p_binding->name) == "MyBufferIn") {
+      EXPECT_EQ(p_access->access, SPV_REFLECT_BINDING_ACCESS_READ);
+    } else {
+      EXPECT_EQ(std::string(p_binding->name), "MyBufferOut");
+      EXPECT_EQ(p_access->access, SPV_REFLECT_BINDING_ACCESS_WRITE);
+    }
+  }
+}
+
+TEST(SpirvReflectDescriptorPoolTest, PlanAcrossModules) {
+  spv_reflect::ShaderModule vs(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  spv_reflect::ShaderModule cs(
+      ReadSpirvFile("../tests/access/binding_access.spv"));
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/descriptors/runtime_array_fs.spv"));
+  ASSERT_EQ(vs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(cs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  const SpvReflectDescriptorSetDemand demands[] = {
+      {&vs.GetShaderModule(), 0, 100},
+      {&cs.GetShaderModule(), 0, 10},
+      {&fs.GetShaderModule(), 1, 4},
+  };
+  SpvReflectDescriptorPoolOptions options = {};
+  options.frames_in_flight = 2;
+  options.sets_per_chunk = 64;
+  options.runtime_array_size = 256;
+  SpvReflectDescriptorPoolPlan plan = {};
+  ASSERT_EQ(spvReflectPlanDescriptorPools(3, demands, &options, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(plan.max_sets, 228);
+  EXPECT_EQ(plan.chunk_max_sets, 64);
+  EXPECT_EQ(plan.chunk_count, 4);
+
+  struct Expected {
+    SpvReflectDescriptorType type;
+    uint32_t count;
+    uint32_t chunk_count;
+    uint32_t max_set_count;
+  };
+  const Expected expected[] = {
+      {SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLER, 32, 9, 4},
+      {SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2048, 575, 256},
+      {SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE, 20, 6, 1},
+      {SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 20, 6, 1},
+      {SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 20, 6, 1},
+      {SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 220, 62, 1},
+      {SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER, 100, 29, 5},
+  };
+  ASSERT_EQ(plan.pool_size_count, 7);
+  for (uint32_t i = 0; i < plan.pool_size_count; ++i) {
+    EXPECT_EQ(plan.pool_sizes[i].descriptor_type, expected[i].type);
+    EXPECT_EQ(plan.pool_sizes[i].descriptor_count, expected[i].count);
+    EXPECT_EQ(plan.pool_sizes[i].chunk_descriptor_count,
+              expected[i].chunk_count);
+    EXPECT_EQ(plan.pool_sizes[i].max_set_count, expected[i].max_set_count);
+    // The chunks together hold the whole demand
+    EXPECT_GE(plan.pool_sizes[i].chunk_descriptor_count * plan.chunk_count,
+              plan.pool_sizes[i].descriptor_count);
+  }
+}
+
+TEST(SpirvReflectDescriptorPoolTest, Defaults) {
+  spv_reflect::ShaderModule vs(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/descriptors/runtime_array_fs.spv"));
+  const SpvReflectDescriptorSetDemand demands[] = {
+      {&vs.GetShaderModule(), 0, 110},
+      {&fs.GetShaderModule(), 1, 4},
+  };
+  SpvReflectDescriptorPoolPlan plan = {};
+  ASSERT_EQ(spvReflectPlanDescriptorPools(2, demands, nullptr, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  // One chunk per frame in flight
+  EXPECT_EQ(plan.max_sets, 228);
+  EXPECT_EQ(plan.chunk_max_sets, 114);
+  EXPECT_EQ(plan.chunk_count, 2);
+  ASSERT_EQ(plan.pool_size_count, 3);
+  EXPECT_EQ(plan.pool_sizes[1].descriptor_type,
+            SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+  EXPECT_EQ(plan.pool_sizes[1].descriptor_count, 8192);
+  EXPECT_EQ(plan.pool_sizes[1].chunk_descriptor_count, 4096);
+
+  const SpvReflectDescriptorSetDemand missing = {&vs.GetShaderModule(), 3, 1};
+  EXPECT_EQ(spvReflectPlanDescriptorPools(1, &missing, nullptr, &plan),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  EXPECT_EQ(spvReflectPlanDescriptorPools(1, demands, nullptr, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+}
+
+TEST(SpirvReflectBindlessTest, PlanBindlessTable) {
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/descriptors/bindless_fs.spv"));
+  spv_reflect::ShaderModule runtime_fs(
+      ReadSpirvFile("../tests/descriptors/runtime_array_fs.spv"));
+  ASSERT_EQ(fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(runtime_fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  // The runtime array module twice, so its bindings share ranges
+  const SpvReflectShaderModule* modules[] = {
+      &fs.GetShaderModule(), &runtime_fs.GetShaderModule(),
+      &runtime_fs.GetShaderModule()};
+  SpvReflectBindlessPlan plan;
+  ASSERT_EQ(spvReflectPlanBindlessTable(3, modules, 2, 8, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(plan.set, 2);
+  ASSERT_EQ(plan.array_count, 3);
+  EXPECT_EQ(plan.arrays[0].descriptor_type,
+            SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLER);
+  EXPECT_EQ(plan.arrays[0].binding, 0);
+  EXPECT_EQ(plan.arrays[0].descriptor_count, 5);
+  EXPECT_EQ(plan.arrays[1].descriptor_type,
+            SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+  EXPECT_EQ(plan.arrays[1].binding, 1);
+  EXPECT_EQ(plan.arrays[1].descriptor_count, 12);
+  EXPECT_EQ(plan.arrays[2].descriptor_type,
+            SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+  EXPECT_EQ(plan.arrays[2].descriptor_count, 1);
+
+  struct Expected {
+    uint32_t set;
+    uint32_t binding;
+    uint32_t array_binding;
+    uint32_t base;
+    uint32_t count;
+  };
+  const Expected expected[] = {
+      {0, 1, 0, 0, 1}, {1, 1, 0, 1, 4}, {0, 0, 1, 0, 1},
+      {0, 2, 1, 1, 3}, {1, 0, 1, 4, 8}, {0, 3, 2, 0, 1},
+  };
+  ASSERT_EQ(plan.range_count, 6);
+  for (uint32_t i = 0; i < plan.range_count; ++i) {
+    EXPECT_EQ(plan.ranges[i].set, expected[i].set);
+    EXPECT_EQ(plan.ranges[i].binding, expected[i].binding);
+    EXPECT_EQ(plan.ranges[i].array_binding, expected[i].array_binding);
+    EXPECT_EQ(plan.ranges[i].base, expected[i].base);
+    EXPECT_EQ(plan.ranges[i].count, expected[i].count);
+  }
+
+  // The input attachment stays where it is
+  ASSERT_EQ(plan.module_count, 3);
+  EXPECT_EQ(plan.module_remaps[0].remap_count, 4);
+  ASSERT_EQ(plan.module_remaps[1].remap_count, 2);
+  ASSERT_EQ(plan.module_remaps[2].remap_count, 2);
+  for (uint32_t i = 0; i < 2; ++i) {
+    EXPECT_EQ(plan.module_remaps[1].remaps[i].base,
+              plan.module_remaps[2].remaps[i].base);
+  }
+  spvReflectDestroyBindlessPlan(&plan);
+  EXPECT_EQ(plan.module_count, 0);
+  EXPECT_EQ(plan.module_remaps, nullptr);
+
+  EXPECT_EQ(spvReflectPlanBindlessTable(1, modules, 0, 0, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  const SpvReflectShaderModule* missing[] = {nullptr};
+  EXPECT_EQ(spvReflectPlanBindlessTable(1, missing, 0, 0, &plan),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+}
+
+TEST(SpirvReflectBindlessTest, ApplyBindlessPlan) {
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/descriptors/bindless_fs.spv"));
+  spv_reflect::ShaderModule runtime_fs(
+      ReadSpirvFile("../tests/descriptors/runtime_array_fs.spv"));
+  const SpvReflectShaderModule* modules[] = {&fs.GetShaderModule(),
+                                             &runtime_fs.GetShaderModule()};
+  SpvReflectBindlessPlan plan;
+  ASSERT_EQ(spvReflectPlanBindlessTable(2, modules, 2, 8, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(fs.ApplyBindlessPlan(&plan, 0), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(runtime_fs.ApplyBindlessPlan(&plan, 1),
+            SPV_REFLECT_RESULT_SUCCESS);
+
+  struct Expected {
+    const char* name;
+    uint32_t set;
+    uint32_t binding;
+    uint32_t count;
+  };
+  const Expected expected[] = {
+      {"albedo", 2, 1, 12}, {"smp", 2, 0, 5},      {"layers", 2, 1, 12},
+      {"params", 2, 2, 1},  {"gbuffer", 0, 4, 1},
+  };
+  const SpvReflectShaderModule& module = fs.GetShaderModule();
+  ASSERT_EQ(module.descriptor_binding_count, 5);
+  for (const Expected& e : expected) {
+    const SpvReflectDescriptorBinding* p_binding = nullptr;
+    for (uint32_t i = 0; i < module.descriptor_binding_count; ++i) {
+      if (std::string(module.descriptor_bindings[i].name) == e.name) {
+        p_binding = &module.descriptor_bindings[i];
+      }
+    }
+    ASSERT_NE(p_binding, nullptr) << e.name;
+    EXPECT_EQ(p_binding->set, e.set) << e.name;
+    EXPECT_EQ(p_binding->binding, e.binding) << e.name;
+    EXPECT_EQ(p_binding->count, e.count) << e.name;
+    EXPECT_TRUE(p_binding->accessed) << e.name;
+  }
+  const SpvReflectDescriptorBinding* p_textures =
+      runtime_fs.GetDescriptorBinding(1, 2);
+  ASSERT_NE(p_textures, nullptr);
+  EXPECT_EQ(p_textures->count, 12);
+  EXPECT_EQ(p_textures->type_description->op, SpvOpTypeArray);
+
+  // Element selection: a chain per function for albedo and smp, one for
+  // params, and an offset non-uniform index into layers
+  const uint32_t* p_code = fs.GetCode();
+  const uint32_t word_count = fs.GetCodeSize() / sizeof(uint32_t);
+  uint32_t chain_count = 0;
+  uint32_t sum_id = 0;
+  bool sum_non_uniform = false;
+  for (uint32_t i = 5; i < word_count; i += p_code[i] >> 16) {
+    SpvOp op = (SpvOp)(p_code[i] & 0xFFFF);
+    chain_count += (op == SpvOpAccessChain) ? 1 : 0;
+    if (op == SpvOpIAdd) {
+      sum_id = p_code[i + 2];
+    }
+  }
+  ASSERT_NE(sum_id, 0);
+  for (uint32_t i = 5; i < word_count; i += p_code[i] >> 16) {
+    if (((p_code[i] & 0xFFFF) == SpvOpDecorate) && (p_code[i + 1] == sum_id)) {
+      sum_non_uniform = (p_code[i + 2] == 5300);
+    }
+  }
+  EXPECT_EQ(chain_count, 8);
+  EXPECT_TRUE(sum_non_uniform);
+  spvReflectDestroyBindlessPlan(&plan);
+}
+
+TEST(SpirvReflectBindlessTest, ApplyBindlessPlan_Errors) {
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/descriptors/bindless_fs.spv"));
+  spv_reflect::ShaderModule cs(
+      ReadSpirvFile("../tests/access/binding_access.spv"));
+  const SpvReflectShaderModule* modules[] = {&fs.GetShaderModule()};
+  SpvReflectBindlessPlan plan;
+  ASSERT_EQ(spvReflectPlanBindlessTable(1, modules, 2, 0, &plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(fs.ApplyBindlessPlan(nullptr, 0),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+  EXPECT_EQ(fs.ApplyBindlessPlan(&plan, 1),
+            SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+  // Another module does not have the planned bindings
+  EXPECT_EQ(cs.ApplyBindlessPlan(&plan, 0),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  EXPECT_EQ(cs.GetDescriptorBinding(0, 0)->set, 0);
+  spvReflectDestroyBindlessPlan(&plan);
+}
+
+TEST(SpirvReflectSharedBlockTest, FindSharedBlocks) {
+  spv_reflect::ShaderModule vs(
+      ReadSpirvFile("../tests/descriptors/shared_blocks_vs.spv"));
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/descriptors/shared_blocks_fs.spv"));
+  ASSERT_EQ(vs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  // Block names do not matter, member names do
+  const SpvReflectDescriptorBinding* p_camera = vs.GetDescriptorBinding(0, 0);
+  const SpvReflectDescriptorBinding* p_view = fs.GetDescriptorBinding(0, 1);
+  const SpvReflectDescriptorBinding* p_vs_frame = vs.GetDescriptorBinding(1, 0);
+  const SpvReflectDescriptorBinding* p_fs_frame = fs.GetDescriptorBinding(1, 1);
+  ASSERT_NE(p_camera, nullptr);
+  ASSERT_NE(p_view, nullptr);
+  ASSERT_NE(p_vs_frame, nullptr);
+  ASSERT_NE(p_fs_frame, nullptr);
+  SpvReflectFingerprint a = {};
+  SpvReflectFingerprint b = {};
+  ASSERT_EQ(spvReflectGetBlockLayoutFingerprint(&p_camera->block, &a),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(spvReflectGetBlockLayoutFingerprint(&p_view->block, &b),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(memcmp(&a, &b, sizeof(a)), 0);
+  ASSERT_EQ(spvReflectGetBlockLayoutFingerprint(&p_vs_frame->block, &a),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(spvReflectGetBlockLayoutFingerprint(&p_fs_frame->block, &b),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_NE(memcmp(&a, &b, sizeof(a)), 0);
+
+  const SpvReflectShaderModule* modules[] = {&vs.GetShaderModule(),
+                                             &fs.GetShaderModule()};
+  SpvReflectSharedBlockReport report;
+  ASSERT_EQ(spvReflectFindSharedBlocks(2, modules, &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(report.block_count, 2);
+
+  const SpvReflectSharedBlock& lighting = report.blocks[0];
+  EXPECT_EQ(std::string(lighting.type_name), "Lighting");
+  EXPECT_EQ(lighting.size, 16);
+  EXPECT_EQ(lighting.module_count, 2);
+  EXPECT_EQ(lighting.binding_count, 3);
+  EXPECT_EQ(lighting.set, 0);
+  EXPECT_EQ(lighting.binding, 2);
+
+  // The camera's set 0 location is taken by a texture in the fragment
+  // shader, so the fragment shader's location is suggested
+  const SpvReflectSharedBlock& camera = report.blocks[1];
+  EXPECT_EQ(std::string(camera.type_name), "Camera");
+  EXPECT_EQ(camera.descriptor_type, SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+  EXPECT_EQ(camera.size, 80);
+  ASSERT_EQ(camera.binding_count, 2);
+  EXPECT_EQ(camera.bindings[0].module_index, 0);
+  EXPECT_EQ(std::string(camera.bindings[0].name), "camera");
+  EXPECT_EQ(camera.bindings[1].module_index, 1);
+  EXPECT_EQ(std::string(camera.bindings[1].name), "view");
+  EXPECT_EQ(camera.set, 1);
+  EXPECT_EQ(camera.binding, 0);
+
+  ASSERT_EQ(vs.AssignSharedBlockBinding(&camera, 0, camera.set, camera.binding),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(fs.AssignSharedBlockBinding(&camera, 1, camera.set, camera.binding),
+            SPV_REFLECT_RESULT_SUCCESS);
+  p_camera = vs.GetDescriptorBinding(0, 1);
+  ASSERT_NE(p_camera, nullptr);
+  EXPECT_EQ(std::string(p_camera->name), "camera");
+  EXPECT_EQ(vs.GetDescriptorBinding(0, 0), nullptr);
+
+  // Two fragment shader bindings hold different lighting data
+  EXPECT_EQ(vs.AssignSharedBlockBinding(&lighting, 0, 0, 2),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(fs.AssignSharedBlockBinding(&lighting, 1, 0, 2),
+            SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH);
+  EXPECT_EQ(fs.AssignSharedBlockBinding(&camera, 1, 0, 0),
+            SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+  EXPECT_EQ(fs.AssignSharedBlockBinding(&camera, 2, 1, 0),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+
+  // The rewritten bytecode reflects the new locations
+  spv_reflect::ShaderModule reloaded(vs.GetCodeSize(), vs.GetCode());
+  p_camera = reloaded.GetDescriptorBinding(0, 1);
+  ASSERT_NE(p_camera, nullptr);
+  EXPECT_EQ(std::string(p_camera->name), "camera");
+  spvReflectDestroySharedBlockReport(&report);
+  EXPECT_EQ(report.blocks, nullptr);
+}
+
+TEST(SpirvReflectUniformRingTest, UniformFootprint) {
+  spv_reflect::ShaderModule vs(
+      ReadSpirvFile("../tests/descriptors/shared_blocks_vs.spv"));
+  spv_reflect::ShaderModule fs(
+      ReadSpirvFile("../tests/descriptors/shared_blocks_fs.spv"));
+  ASSERT_EQ(vs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(fs.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  const SpvReflectShaderModule* modules[2] = {&vs.GetShaderModule(),
+                                              &fs.GetShaderModule()};
+
+  spv_reflect::UniformFootprint bad(2, modules, 48);
+  EXPECT_EQ(bad.GetResult(), SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+
+  // The sampler is skipped; the uniform buffers each take an aligned slot
+  spv_reflect::UniformFootprint footprint(2, modules, 256);
+  ASSERT_EQ(footprint.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(footprint.GetSlotCount(), 7);
+  EXPECT_EQ(footprint.GetSize(), 7 * 256);
+  for (uint32_t i = 0; i < footprint.GetSlotCount(); ++i) {
+    const spv_reflect::UniformFootprint::Slot& slot = footprint.GetSlot(i);
+    EXPECT_EQ(slot.set, (i < 3) ? 0 : 1);
+    EXPECT_EQ(slot.binding, (i < 3) ? i : i - 3);
+    EXPECT_EQ(slot.offset, i * 256);
+  }
+  EXPECT_EQ(footprint.FindSlot(1, 3), 6);
+  EXPECT_EQ(footprint.FindSlot(0, 3), UINT32_MAX);
+
+  uint32_t offsets[7] = {};
+  footprint.GetDynamicOffsets(4096, offsets);
+  EXPECT_EQ(offsets[0], 4096);
+  EXPECT_EQ(offsets[6], 4096 + 6 * 256);
+
+  const spv_reflect::UniformBlockLayout& camera = footprint.GetSlot(0).layout;
+  EXPECT_EQ(camera.GetSize(), 80);
+  ASSERT_EQ(camera.GetMemberCount(), 3);
+  uint32_t time = camera.FindMember("time");
+  ASSERT_NE(time, UINT32_MAX);
+  EXPECT_EQ(camera.GetMember(time).offset, 76);
+  EXPECT_EQ(camera.GetMember(camera.FindMember("position")).offset, 64);
+  EXPECT_EQ(camera.FindMember("missing"), UINT32_MAX);
+
+  std::vector<uint8_t> block(camera.GetSize(), 0);
+  camera.Write(block.data(), time, 2.5f);
+  float value = 0.0f;
+  memcpy(&value, block.data() + 76, sizeof(value));
+  EXPECT_EQ(value, 2.5f);
+}
+
+TEST(SpirvReflectUniformRingTest, Allocate) {
+  std::vector<uint8_t> buffer(4096);
+  spv_reflect::UniformRing invalid(buffer.data(), 4096, 2, 256, 4096);
+  EXPECT_EQ(invalid.GetResult(), SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+
+  spv_reflect::UniformRing ring(buffer.data(), 4096, 2, 256, 1000);
+  ASSERT_EQ(ring.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(ring.GetRegionSize(), 2048);
+
+  spv_reflect::UniformRing::ThreadAllocator allocator(ring);
+  spv_reflect::UniformRing::Allocation a = allocator.Allocate(16);
+  spv_reflect::UniformRing::Allocation b = allocator.Allocate(80);
+  ASSERT_NE(a.p_data, nullptr);
+  ASSERT_NE(b.p_data, nullptr);
+  EXPECT_EQ(a.offset, 0);
+  EXPECT_EQ(b.offset, 256);
+  EXPECT_EQ(static_cast<uint8_t*>(b.p_data), buffer.data() + 256);
+  // One chunk, rounded up to the alignment, has been taken from the region
+  EXPECT_EQ(ring.GetUsedSize(), 1024);
+
+  // Large allocations take their own range and leave the chunk alone
+  spv_reflect::UniformRing::Allocation large = allocator.Allocate(768);
+  ASSERT_NE(large.p_data, nullptr);
+  EXPECT_EQ(large.offset, 1024);
+  EXPECT_EQ(allocator.Allocate(1).offset, 512);
+  EXPECT_EQ(allocator.Allocate(2048).p_data, nullptr);
+
+  // The next frame allocates from the second region
+  ring.BeginFrame();
+  EXPECT_EQ(ring.GetFrameIndex(), 1);
+  EXPECT_EQ(ring.GetUsedSize(), 0);
+  a = allocator.Allocate(16);
+  EXPECT_EQ(a.offset, 2048);
+  b = allocator.Allocate(1024);
+  EXPECT_EQ(b.offset, 3072);
+  EXPECT_EQ(allocator.Allocate(1024).p_data, nullptr);
+
+  ring.BeginFrame();
+  EXPECT_EQ(ring.GetFrameIndex(), 0);
+  EXPECT_EQ(allocator.Allocate(16).offset, 0);
+}
+
+TEST(SpirvReflectUniformRingTest, AllocateFromThreads) {
+  const uint32_t kThreadCount = 4;
+  const uint32_t kAllocationCount = 64;
+  std::vector<uint8_t> buffer(kThreadCount * kAllocationCount * 64 * 2);
+  spv_reflect::UniformRing ring(buffer.data(),
+                                static_cast<uint32_t>(buffer.size()), 1, 64,
+                                256);
+  ASSERT_EQ(ring.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  std::vector<std::vector<uint32_t>> offsets(kThreadCount);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < kThreadCount; ++i) {
+    threads.push_back(std::thread([&ring, &offsets, i]() {
+      spv_reflect::UniformRing::ThreadAllocator allocator(ring);
+      for (uint32_t j = 0; j < kAllocationCount; ++j) {
+        spv_reflect::UniformRing::Allocation allocation =
+            allocator.Allocate(48);
+        if (allocation.p_data != nullptr) {
+          memset(allocation.p_data, static_cast<int>(i + 1), 48);
+          offsets[i].push_back(allocation.offset);
+        }
+      }
+    }));
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // Every allocation fits and no two threads were handed the same bytes
+  std::vector<uint32_t> all;
+  for (uint32_t i = 0; i < kThreadCount; ++i) {
+    ASSERT_EQ(offsets[i].size(), kAllocationCount);
+    for (uint32_t offset : offsets[i]) {
+      EXPECT_EQ(offset % 64, 0);
+      EXPECT_EQ(buffer[offset], i + 1);
+      EXPECT_EQ(buffer[offset + 47], i + 1);
+      all.push_back(offset);
+    }
+  }
+  std::sort(all.begin(), all.end());
+  EXPECT_EQ(std::unique(all.begin(), all.end()), all.end());
+}
+
+TEST(SpirvReflectInputSignatureTest, InternSemantic) {
+  EXPECT_EQ(spvReflectInternSemantic(nullptr), 0);
+  EXPECT_EQ(spvReflectInternSemantic(""), 0);
+  EXPECT_NE(spvReflectInternSemantic("NORMAL"), 0);
+  EXPECT_EQ(spvReflectInternSemantic("texcoord"),
+            spvReflectInternSemantic("TEXCOORD0"));
+  EXPECT_EQ(spvReflectInternSemantic("TEXCOORD2"),
+            spvReflectInternSemantic("TEXCOORD") + 2);
+  EXPECT_NE(spvReflectInternSemantic("NORMAL"),
+            spvReflectInternSemantic("COLOR"));
+}
+
+TEST(SpirvReflectInputSignatureTest, VertexInputs) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/interface/vertex_signature_vs.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectInputSignature shader = {};
+  ASSERT_EQ(module.GetEntryPointInputSignature("main", &shader),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(module.GetEntryPointInputSignature("missing", &shader),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  ASSERT_EQ(module.GetEntryPointInputSignature("main", &shader),
+            SPV_REFLECT_RESULT_SUCCESS);
+  // The matrix takes a location per column and the dvec4 takes two
+  EXPECT_EQ(shader.location_mask, 0xFF);
+  EXPECT_EQ(shader.semantic_mask, 0);
+  EXPECT_EQ(shader.numeric_classes[0], SPV_REFLECT_NUMERIC_CLASS_FLOAT);
+  EXPECT_EQ(shader.numeric_classes[1], SPV_REFLECT_NUMERIC_CLASS_SINT);
+  EXPECT_EQ(shader.numeric_classes[2], SPV_REFLECT_NUMERIC_CLASS_UINT);
+  EXPECT_EQ(shader.numeric_classes[5], SPV_REFLECT_NUMERIC_CLASS_FLOAT);
+  EXPECT_EQ(shader.numeric_classes[7], SPV_REFLECT_NUMERIC_CLASS_FLOAT64);
+  EXPECT_EQ(shader.component_counts[0], 3);
+  EXPECT_EQ(shader.component_counts[2], 2);
+  EXPECT_EQ(shader.component_counts[4], 3);
+  EXPECT_EQ(shader.component_counts[6], 2);
+  EXPECT_EQ(shader.component_counts[7], 2);
+
+  SpvReflectVertexAttribute attributes[] = {
+      {0, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 4, nullptr},
+      {1, SPV_REFLECT_NUMERIC_CLASS_SINT, 4, nullptr},
+      {2, SPV_REFLECT_NUMERIC_CLASS_UINT, 2, nullptr},
+      {3, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 3, nullptr},
+      {4, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 3, nullptr},
+      {5, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 3, nullptr},
+      {6, SPV_REFLECT_NUMERIC_CLASS_FLOAT64, 4, nullptr},
+      {8, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 2, nullptr},
+  };
+  SpvReflectInputSignature format = {};
+  ASSERT_EQ(spvReflectGetVertexFormatSignature(8, attributes, &format),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(format.location_mask, 0x1FF);
+  // Extra attributes and extra components are fine
+  EXPECT_EQ(spvReflectGetInputSignatureMismatch(&shader, &format), 0);
+
+  // Joints as normalized bytes, and only part of the instance transform
+  attributes[1].numeric_class = SPV_REFLECT_NUMERIC_CLASS_FLOAT;
+  ASSERT_EQ(spvReflectGetVertexFormatSignature(5, attributes, &format),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(spvReflectGetInputSignatureMismatch(&shader, &format), 0xE2);
+  EXPECT_EQ(spvReflectGetInputSignatureMismatch(nullptr, &format),
+            UINT32_MAX);
+
+  attributes[1].location = 0;
+  EXPECT_EQ(spvReflectGetVertexFormatSignature(2, attributes, &format),
+            SPV_REFLECT_RESULT_ERROR_COUNT_MISMATCH);
+  attributes[1].location = 32;
+  EXPECT_EQ(spvReflectGetVertexFormatSignature(2, attributes, &format),
+            SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+  attributes[1].location = 1;
+  attributes[1].numeric_class = SPV_REFLECT_NUMERIC_CLASS_NONE;
+  EXPECT_EQ(spvReflectGetVertexFormatSignature(2, attributes, &format),
+            SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+}
+
+TEST(SpirvReflectInputSignatureTest, Semantics) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/hlsl/semantics.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectInputSignature shader = {};
+  ASSERT_EQ(module.GetEntryPointInputSignature("main", &shader),
+            SPV_REFLECT_RESULT_SUCCESS);
+  // SV_POSITION and SV_PRIMITIVEID are built-ins
+  EXPECT_EQ(shader.location_mask, 0x7F);
+  EXPECT_EQ(shader.semantic_mask, 0x7F);
+  EXPECT_EQ(spvReflectFindInputSignatureLocation(
+                &shader, spvReflectInternSemantic("texcoord1")),
+            5);
+  EXPECT_EQ(spvReflectFindInputSignatureLocation(
+                &shader, spvReflectInternSemantic("COLOR_1")),
+            1);
+  EXPECT_EQ(spvReflectFindInputSignatureLocation(
+                &shader, spvReflectInternSemantic("TANGENT")),
+            UINT32_MAX);
+
+  SpvReflectVertexAttribute attributes[] = {
+      {0, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 3, "NORMAL"},
+      {1, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 4, "COLOR_1"},
+      {2, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 1, "OPACITY_512"},
+      {3, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 4, "SCALE_987654321"},
+      {4, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 2, "TEXCOORD0"},
+      {5, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 2, "TEXCOORD2"},
+      {6, SPV_REFLECT_NUMERIC_CLASS_FLOAT, 2, nullptr},
+  };
+  SpvReflectInputSignature format = {};
+  ASSERT_EQ(spvReflectGetVertexFormatSignature(7, attributes, &format),
+            SPV_REFLECT_RESULT_SUCCESS);
+  // Location 5 holds another semantic; location 6 has none to compare
+  EXPECT_EQ(spvReflectGetInputSignatureMismatch(&shader, &format), 0x20);
+}
+
+TEST(SpirvReflectHalfPrecisionTest, Candidates) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/interface/half_precision_fs.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  SpvReflectHalfPrecisionReport report = {};
+  ASSERT_EQ(module.GetEntryPointHalfPrecision("main", nullptr, &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_STREQ(report.entry_point_name, "main");
+  EXPECT_EQ(report.float_value_count, 11);
+  EXPECT_EQ(report.relaxed_value_count, 0);
+  // The two image reads, their sum and its half, and the tint computed
+  // from it; the uniform exposure keeps the scaled color at full precision
+  EXPECT_EQ(report.candidate_value_count, 6);
+  EXPECT_EQ(report.alu_instruction_count, 4);
+  EXPECT_EQ(report.candidate_alu_instruction_count, 3);
+  EXPECT_GT(report.register_savings, 0);
+  EXPECT_EQ(report.interface_bytes_saved, 8);
+
+  ASSERT_EQ(report.candidate_count, 4);
+  EXPECT_EQ(report.candidates[0].kind, SPV_REFLECT_HALF_PRECISION_KIND_OUTPUT);
+  EXPECT_STREQ(report.candidates[0].name, "out_tint");
+  EXPECT_EQ(report.candidates[0].location, 0);
+  EXPECT_EQ(report.candidates[0].flags, SPV_REFLECT_PRECISION_LOW_SOURCES);
+  EXPECT_EQ(report.candidates[1].kind,
+            SPV_REFLECT_HALF_PRECISION_KIND_VARIABLE);
+  EXPECT_STREQ(report.candidates[1].name, "tmp");
+  EXPECT_EQ(report.candidates[1].component_count, 4);
+  // Largest chain first
+  EXPECT_EQ(report.candidates[2].kind, SPV_REFLECT_HALF_PRECISION_KIND_CHAIN);
+  EXPECT_STREQ(report.candidates[2].name, "tmp");
+  EXPECT_EQ(report.candidates[2].instruction_count, 2);
+  EXPECT_EQ(report.candidates[2].component_count, 16);
+  EXPECT_EQ(report.candidates[3].kind, SPV_REFLECT_HALF_PRECISION_KIND_CHAIN);
+  EXPECT_STREQ(report.candidates[3].name, "out_tint");
+  EXPECT_EQ(report.candidates[3].instruction_count, 1);
+  spvReflectDestroyHalfPrecisionReport(&report);
+
+  EXPECT_EQ(module.GetEntryPointHalfPrecision("missing", nullptr, &report),
+            SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+  EXPECT_EQ(module.GetEntryPointHalfPrecision("main", nullptr, nullptr),
+            SPV_REFLECT_RESULT_ERROR_NULL_POINTER);
+}
+
+TEST(SpirvReflectHalfPrecisionTest, UnormOutputs) {
+  spv_reflect::ShaderModule module(
+      ReadSpirvFile("../tests/interface/half_precision_fs.spv"));
+  ASSERT_EQ(module.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  // Location 1 is written to an 8-bit UNORM attachment, so the color input
+  // and its product with the exposure only need half precision
+  SpvReflectHalfPrecisionOptions options = {};
+  options.unorm_output_mask = 0x2;
+  SpvReflectHalfPrecisionReport report = {};
+  ASSERT_EQ(module.GetEntryPointHalfPrecision("main", &options, &report),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(report.candidate_value_count, 8);
+  EXPECT_EQ(report.candidate_alu_instruction_count, 4);
+  EXPECT_EQ(report.interface_bytes_saved, 24);
+
+  ASSERT_EQ(report.candidate_count, 7);
+  EXPECT_EQ(report.candidates[0].kind, SPV_REFLECT_HALF_PRECISION_KIND_INPUT);
+  EXPECT_STREQ(report.candidates[0].name, "in_color");
+  EXPECT_EQ(report.candidates[0].flags, SPV_REFLECT_PRECISION_LOW_SINKS);
+  EXPECT_STREQ(report.candidates[2].name, "out_scaled");
+  EXPECT_EQ(report.candidates[2].location, 1);
+  EXPECT_EQ(report.candidates[2].flags, SPV_REFLECT_PRECISION_LOW_SINKS);
+  EXPECT_EQ(report.candidates[6].kind, SPV_REFLECT_HALF_PRECISION_KIND_CHAIN);
+  EXPECT_STREQ(report.candidates[6].name, "out_scaled");
+  EXPECT_EQ(report.candidates[6].flags, SPV_REFLECT_PRECISION_LOW_SINKS);
+  // The exposure is also written to location 2 at full precision
+  for (uint32_t i = 0; i < report.candidate_count; ++i) {
+    EXPECT_STRNE(report.candidates[i].name, "out_exposure");
+  }
+  spvReflectDestroyHalfPrecisionReport(&report);
+}
+
+TEST(SpirvReflectMinHashTest, Similarity) {
+  spv_reflect::ShaderModule original(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  spv_reflect::ShaderModule stripped(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs_stripped.spv"));
+  spv_reflect::ShaderModule changed(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs_changed.spv"));
+  spv_reflect::ShaderModule other(
+      ReadSpirvFile("../tests/interface/packing_vs.spv"));
+  SpvReflectMinHash minhashes[4];
+  ASSERT_EQ(original.GetMinHash(0, &minhashes[0]), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(stripped.GetMinHash(0, &minhashes[1]), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(changed.GetMinHash(0, &minhashes[2]), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(other.GetMinHash(0, &minhashes[3]), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_GT(minhashes[0].shingle_count, 0);
+
+  // Names and id numbering are ignored
+  EXPECT_EQ(spvReflectGetMinHashSimilarity(&minhashes[0], &minhashes[1]), 1.0f);
+  // A changed binding and constant only touch the n-grams around them
+  float changed_similarity =
+      spvReflectGetMinHashSimilarity(&minhashes[0], &minhashes[2]);
+  EXPECT_GT(changed_similarity, 0.5f);
+  EXPECT_LT(changed_similarity, 1.0f);
+  EXPECT_LT(spvReflectGetMinHashSimilarity(&minhashes[0], &minhashes[3]),
+            0.2f);
+  EXPECT_EQ(spvReflectGetMinHashSimilarity(&minhashes[0], nullptr), 0.0f);
+
+  // Longer n-grams are more sensitive to small changes
+  SpvReflectMinHash long_minhashes[2];
+  ASSERT_EQ(original.GetMinHash(8, &long_minhashes[0]),
+            SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(changed.GetMinHash(8, &long_minhashes[1]),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_LT(
+      spvReflectGetMinHashSimilarity(&long_minhashes[0], &long_minhashes[1]),
+      changed_similarity);
+  EXPECT_EQ(original.GetMinHash(17, &long_minhashes[0]),
+            SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED);
+}
+
+TEST(SpirvReflectCloneTest, ChangesStayInClone) {
+  // Declared first so the original is destroyed before its clones
+  spv_reflect::ShaderModule clone;
+  spv_reflect::ShaderModule second;
+  spv_reflect::ShaderModule original(
+      ReadSpirvFile("../tests/fingerprint/fingerprint_vs.spv"));
+  std::vector<uint32_t> code(
+      original.GetCode(), original.GetCode() + original.GetCodeSize() / 4);
+  ASSERT_EQ(original.Clone(&clone), SPV_REFLECT_RESULT_SUCCESS);
+  // Until changed, a clone shares the original's data
+  EXPECT_EQ(clone.GetCode(), original.GetCode());
+  EXPECT_EQ(clone.GetShaderModule().descriptor_bindings,
+            original.GetShaderModule().descriptor_bindings);
+
+  const SpvReflectDescriptorBinding* p_binding =
+      clone.GetDescriptorBinding(0, 0);
+  ASSERT_NE(p_binding, nullptr);
+  ASSERT_EQ(clone.ChangeDescriptorBindingNumbers(p_binding, 3, 2),
+            SPV_REFLECT_RESULT_SUCCESS);
+  const SpvReflectInterfaceVariable* p_input =
+      clone.GetInputVariableByLocation(1);
+  ASSERT_NE(p_input, nullptr);
+  ASSERT_EQ(clone.ChangeInputVariableLocation(p_input, 5),
+            SPV_REFLECT_RESULT_SUCCESS);
+
+  EXPECT_NE(clone.GetDescriptorBinding(3, 2), nullptr);
+  EXPECT_EQ(clone.GetDescriptorBinding(0, 0), nullptr);
+  EXPECT_NE(clone.GetEntryPointDescriptorSet(
+                clone.GetEntryPointName(), 2), nullptr);
+  EXPECT_NE(clone.GetInputVariableByLocation(5), nullptr);
+  EXPECT_NE(clone.GetCode(), original.GetCode());
+
+  EXPECT_NE(original.GetDescriptorBinding(0, 0), nullptr);
+  EXPECT_EQ(original.GetDescriptorBinding(3, 2), nullptr);
+  EXPECT_NE(original.GetEntryPointDescriptorSet(
+                original.GetEntryPointName(), 0), nullptr);
+  EXPECT_NE(original.GetInputVariableByLocation(1), nullptr);
+  EXPECT_TRUE(std::equal(code.begin(), code.end(), original.GetCode()));
+
+  // A clone of a changed module starts from its changes
+  ASSERT_EQ(clone.Clone(&second), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_NE(second.GetCode(), clone.GetCode());
+  const SpvReflectDescriptorSet* p_set = second.GetDescriptorSet(2);
+  ASSERT_NE(p_set, nullptr);
+  ASSERT_EQ(second.ChangeDescriptorSetNumber(p_set, 1),
+            SPV_REFLECT_RESULT_SUCCESS);
+  const SpvReflectInterfaceVariable* p_output =
+      second.GetOutputVariableByLocation(0);
+  ASSERT_NE(p_output, nullptr);
+  ASSERT_EQ(second.ChangeOutputVariableLocation(p_output, 4),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_NE(second.GetDescriptorBinding(3, 1), nullptr);
+  EXPECT_NE(second.GetInputVariableByLocation(5), nullptr);
+  EXPECT_NE(second.GetOutputVariableByLocation(4), nullptr);
+  EXPECT_NE(clone.GetDescriptorBinding(3, 2), nullptr);
+  EXPECT_NE(clone.GetOutputVariableByLocation(0), nullptr);
+
+  // The changed code reflects the same as the changed clone
+  spv_reflect::ShaderModule reparsed(second.GetCodeSize(), second.GetCode());
+  EXPECT_NE(reparsed.GetDescriptorBinding(3, 1), nullptr);
+  EXPECT_NE(reparsed.GetInputVariableByLocation(5), nullptr);
+  EXPECT_NE(reparsed.GetOutputVariableByLocation(4), nullptr);
+}
+
+TEST(SpirvReflectEntryPointFilterTest, SelectedEntryPoints) {
+  std::vector<uint8_t> spirv =
+      ReadSpirvFile("../tests/multi_entrypoint/multi_entrypoint.spv");
+  const char* vert_names[] = {"entry_vert"};
+  SpvReflectShaderModuleOptions options = {1, vert_names};
+  spv_reflect::ShaderModule vert(spirv.size(), spirv.data(), options);
+  ASSERT_EQ(vert.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(vert.GetEntryPointCount(), 1);
+  EXPECT_STREQ(vert.GetEntryPointName(), "entry_vert");
+  EXPECT_EQ(vert.GetShaderStage(), SPV_REFLECT_SHADER_STAGE_VERTEX_BIT);
+  // The sampler is only used by entry_frag
+  const SpvReflectShaderModule& vert_module = vert.GetShaderModule();
+  ASSERT_EQ(vert_module.descriptor_binding_count, 1);
+  EXPECT_STREQ(vert_module.descriptor_bindings[0].name, "ubo");
+  EXPECT_EQ(vert_module.push_constant_block_count, 1);
+  EXPECT_EQ(vert.GetDescriptorBinding(0, 0), nullptr);
+
+  const char* frag_names[] = {"entry_frag"};
+  options.entry_point_names = frag_names;
+  spv_reflect::ShaderModule frag(spirv.size(), spirv.data(), options);
+  ASSERT_EQ(frag.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(frag.GetEntryPointCount(), 1);
+  EXPECT_STREQ(frag.GetEntryPointName(), "entry_frag");
+  EXPECT_EQ(frag.GetShaderModule().descriptor_binding_count, 2);
+  EXPECT_EQ(frag.GetEntryPointDescriptorBinding("entry_vert", 1, 0),
+            nullptr);
+  EXPECT_NE(frag.GetEntryPointDescriptorBinding("entry_frag", 1, 0),
+            nullptr);
+
+  // Listing every entry point reflects the same as no filter
+  const char* all_names[] = {"entry_frag", "entry_vert"};
+  options.entry_point_count = 2;
+  options.entry_point_names = all_names;
+  spv_reflect::ShaderModule all(spirv.size(), spirv.data(), options);
+  spv_reflect::ShaderModule unfiltered(spirv);
+  ASSERT_EQ(all.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(all.GetEntryPointCount(), unfiltered.GetEntryPointCount());
+  EXPECT_EQ(all.GetShaderModule().descriptor_binding_count,
+            unfiltered.GetShaderModule().descriptor_binding_count);
+
+  const char* missing_names[] = {"entry_vert", "entry_tess"};
+  options.entry_point_names = missing_names;
+  spv_reflect::ShaderModule missing(spirv.size(), spirv.data(), options);
+  EXPECT_EQ(missing.GetResult(), SPV_REFLECT_RESULT_ERROR_ELEMENT_NOT_FOUND);
+}
+
+TEST(SpirvReflectEntryPointFilterTest, RewritesNeedEveryEntryPoint) {
+  std::vector<uint8_t> spirv =
+      ReadSpirvFile("../tests/multi_entrypoint/multi_entrypoint.spv");
+  const char* vert_names[] = {"entry_vert"};
+  SpvReflectShaderModuleOptions options = {1, vert_names};
+  spv_reflect::ShaderModule vert(spirv.size(), spirv.data(), options);
+  ASSERT_EQ(vert.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+
+  // Compacting would move ubo onto the binding of tex, which the filtered
+  // module does not know about
+  SpvReflectDescriptorBindingRemapTable table;
+  EXPECT_EQ(vert.CompactDescriptorBindings(0, &table),
+            SPV_REFLECT_RESULT_NOT_READY);
+  EXPECT_EQ(table.remap_count, 0);
+  EXPECT_EQ(vert.GetCodeSize(), spirv.size());
+  EXPECT_EQ(memcmp(vert.GetCode(), spirv.data(), spirv.size()), 0);
+  ASSERT_NE(vert.GetDescriptorBinding(1, 0), nullptr);
+
+  SpvReflectPushConstantPlan push_plan = {};
+  EXPECT_EQ(vert.PromotePushConstants("entry_vert", &push_plan),
+            SPV_REFLECT_RESULT_NOT_READY);
+
+  const SpvReflectShaderModule* modules[] = {&vert.GetShaderModule()};
+  SpvReflectBindlessPlan bindless_plan;
+  ASSERT_EQ(spvReflectPlanBindlessTable(1, modules, 2, 8, &bindless_plan),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(vert.ApplyBindlessPlan(&bindless_plan, 0),
+            SPV_REFLECT_RESULT_NOT_READY);
+  spvReflectDestroyBindlessPlan(&bindless_plan);
+
+  SpvReflectSharedBlock block = {};
+  EXPECT_EQ(vert.AssignSharedBlockBinding(&block, 0, 3, 0),
+            SPV_REFLECT_RESULT_NOT_READY);
+
+  // Listing every entry point leaves nothing out
+  const char* all_names[] = {"entry_frag", "entry_vert"};
+  options.entry_point_count = 2;
+  options.entry_point_names = all_names;
+  spv_reflect::ShaderModule all(spirv.size(), spirv.data(), options);
+  ASSERT_EQ(all.GetResult(), SPV_REFLECT_RESULT_SUCCESS);
+  ASSERT_EQ(all.CompactDescriptorBindings(0, &table),
+            SPV_REFLECT_RESULT_SUCCESS);
+  EXPECT_EQ(table.remap_count, 2);
+  spvReflectDestroyDescriptorBindingRemapTable(&table);
+}
@@ -4,6 +4,7 @@
 int main(int argc, char** argv) {
   const char* inFile = nullptr;
   const char* outFile = nullptr;
+  bool keepLineInfo = false;
   for (int argi = 1; argi < argc; ++argi) {
     if ('-' == argv[argi][0]) {
       switch (argv[argi][1]) {
@@ -15,6 +16,9 @@ int main(int argc, char** argv) {
             return 1;
           }
         } break;
+        case 'g': {
+          keepLineInfo = true;
+        } break;
         case 0: {
           // Setting a filename of "-" to indicate stdin.
           if (!inFile) {
@@ -26,7 +30,7 @@ int main(int argc, char** argv) {
         } break;
         default:
           fprintf(stderr,
-                  "error: unrecognized option: %s (only -o supported)\n\n",
+                  "error: unrecognized option: %s (only -o and -g supported)\n\n",
                   argv[argi]);
           return 1;
       }
@@ -50,7 +54,7 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  const auto size = SpvStripReflect(contents.data(), contents.size());
+  const auto size = SpvStripReflect(contents.data(), contents.size(), keepLineInfo);
   if (size < 0) {
     fprintf(stderr, "error: failed to strip\n");
     return -1;
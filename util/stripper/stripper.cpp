@@ -4,7 +4,7 @@
 #include <cstring>
 #include <vector>
 
-int SpvStripReflect(uint32_t *data, size_t len) {
+int SpvStripReflect(uint32_t *data, size_t len, bool keep_line_info) {
   const uint32_t kHeaderLength = 5;
   const uint32_t kMagicNumber = 0x07230203u;
   const uint32_t kExtensionOpcode = 10;
@@ -35,12 +35,13 @@ int SpvStripReflect(uint32_t *data, size_t len) {
     bool skip = false;
     if (opcode == kDecorateStringOpcode ||
         opcode == kMemberDecorateStringOpcode ||
-        opcode == kSourceContinuedOpcode ||
-        opcode == kSourceOpcode ||
-        opcode == kStringOpcode ||
-        opcode == kLineOpcode ||
         opcode == kModuleProcessedOpcode) {
       skip = true;
+    } else if (opcode == kSourceContinuedOpcode ||
+               opcode == kSourceOpcode ||
+               opcode == kStringOpcode ||
+               opcode == kLineOpcode) {
+      skip = !keep_line_info;
     } else if (opcode == kDecorateIdOpcode) {
       if (pos + 2 >= len)
         return -1;
@@ -7,7 +7,9 @@
 // Strips SPIR-V reflection decorations in the SPIR-V binary module pointed by
 // |spirv|, which contains |len| words, and writes the stripped binary module
 // back to |spirv|. Returns the size (in words) of the processed binary module
-// on success; returns -1 on failure.
-int SpvStripReflect(uint32_t *spirv, size_t len);
+// on success; returns -1 on failure. If |keep_line_info| is true, OpSource,
+// OpSourceContinued, OpString and OpLine are kept so that source line
+// attribution still works on the stripped module.
+int SpvStripReflect(uint32_t *spirv, size_t len, bool keep_line_info = false);
 
 #endif // LIBSPIRV_SPV_STRIP_REFLECT_
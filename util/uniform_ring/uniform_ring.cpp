@@ -0,0 +1,197 @@
+#include "uniform_ring.h"
+
+#include <algorithm>
+
+namespace spv_reflect {
+
+static bool IsPowerOfTwo(uint32_t value) {
+  return (value != 0) && ((value & (value - 1)) == 0);
+}
+
+static uint64_t AlignUp(uint64_t value, uint32_t alignment) {
+  return (value + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+}
+
+UniformBlockLayout::UniformBlockLayout(const SpvReflectBlockVariable& block)
+    : m_size(std::max(block.size, block.padded_size)) {
+  AddMembers(block, std::string(), 0);
+}
+
+void UniformBlockLayout::AddMembers(const SpvReflectBlockVariable& block, const std::string& prefix,
+                                    uint32_t base_offset) {
+  for (uint32_t i = 0; i < block.member_count; ++i) {
+    const SpvReflectBlockVariable& member = block.members[i];
+    Member entry;
+    entry.name = prefix + ((member.name != nullptr) ? member.name : "");
+    entry.offset = base_offset + member.offset;
+    entry.size = member.size;
+    entry.array_stride = member.array.stride;
+    m_members.push_back(entry);
+    if (member.member_count > 0) {
+      AddMembers(member, entry.name + ".", entry.offset);
+    }
+  }
+}
+
+uint32_t UniformBlockLayout::FindMember(const char* name) const {
+  for (uint32_t i = 0; i < m_members.size(); ++i) {
+    if (m_members[i].name == name) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+UniformFootprint::UniformFootprint(uint32_t module_count, const SpvReflectShaderModule* const* pp_modules,
+                                   uint32_t alignment) {
+  if ((module_count > 0) && (pp_modules == nullptr)) {
+    m_result = SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+    return;
+  }
+  if (!IsPowerOfTwo(alignment)) {
+    m_result = SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    return;
+  }
+
+  for (uint32_t i = 0; i < module_count; ++i) {
+    if (pp_modules[i] == nullptr) {
+      m_result = SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+      return;
+    }
+    const SpvReflectShaderModule& module = *pp_modules[i];
+    for (uint32_t j = 0; j < module.descriptor_binding_count; ++j) {
+      const SpvReflectDescriptorBinding& binding = module.descriptor_bindings[j];
+      // Arrays of buffers take one dynamic offset per element; leave them
+      // to the caller
+      if ((binding.descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER) &&
+          (binding.descriptor_type != SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)) {
+        continue;
+      }
+      if (binding.count != 1) {
+        continue;
+      }
+      UniformBlockLayout layout(binding.block);
+      uint32_t index = FindSlot(binding.set, binding.binding);
+      if (index == UINT32_MAX) {
+        Slot slot = {binding.set, binding.binding, 0, layout};
+        m_slots.push_back(slot);
+      }
+      else if (layout.GetSize() > m_slots[index].layout.GetSize()) {
+        m_slots[index].layout = layout;
+      }
+    }
+  }
+  std::sort(m_slots.begin(), m_slots.end(), [](const Slot& a, const Slot& b) {
+    return (a.set != b.set) ? (a.set < b.set) : (a.binding < b.binding);
+  });
+
+  uint64_t size = 0;
+  for (Slot& slot : m_slots) {
+    size = AlignUp(size, alignment);
+    slot.offset = static_cast<uint32_t>(size);
+    size += slot.layout.GetSize();
+  }
+  size = AlignUp(size, alignment);
+  if (size > UINT32_MAX) {
+    m_slots.clear();
+    m_result = SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    return;
+  }
+  m_size = static_cast<uint32_t>(size);
+  m_result = SPV_REFLECT_RESULT_SUCCESS;
+}
+
+uint32_t UniformFootprint::FindSlot(uint32_t set, uint32_t binding) const {
+  for (uint32_t i = 0; i < m_slots.size(); ++i) {
+    if ((m_slots[i].set == set) && (m_slots[i].binding == binding)) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+void UniformFootprint::GetDynamicOffsets(uint32_t base_offset, uint32_t* p_offsets) const {
+  for (uint32_t i = 0; i < m_slots.size(); ++i) {
+    p_offsets[i] = base_offset + m_slots[i].offset;
+  }
+}
+
+UniformRing::UniformRing(void* p_mapped_data, uint32_t size, uint32_t frame_count, uint32_t alignment,
+                         uint32_t chunk_size)
+    : m_head(0), m_serial(1) {
+  if (p_mapped_data == nullptr) {
+    m_result = SPV_REFLECT_RESULT_ERROR_NULL_POINTER;
+    return;
+  }
+  if ((frame_count == 0) || !IsPowerOfTwo(alignment) || (chunk_size == 0)) {
+    m_result = SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    return;
+  }
+  m_p_mapped_data = static_cast<uint8_t*>(p_mapped_data);
+  m_frame_count = frame_count;
+  m_alignment = alignment;
+  m_region_size = (size / frame_count) & ~(alignment - 1);
+  uint64_t chunk = AlignUp(chunk_size, alignment);
+  if (chunk > m_region_size) {
+    m_result = SPV_REFLECT_RESULT_ERROR_RANGE_EXCEEDED;
+    return;
+  }
+  m_chunk_size = static_cast<uint32_t>(chunk);
+  m_result = SPV_REFLECT_RESULT_SUCCESS;
+}
+
+uint32_t UniformRing::GetUsedSize() const {
+  return static_cast<uint32_t>(std::min<uint64_t>(m_head.load(std::memory_order_relaxed), m_region_size));
+}
+
+void UniformRing::BeginFrame() {
+  m_frame_index = (m_frame_index + 1) % m_frame_count;
+  m_head.store(0, std::memory_order_relaxed);
+  m_serial.fetch_add(1, std::memory_order_release);
+}
+
+bool UniformRing::AcquireRange(uint32_t size, uint32_t* p_begin) {
+  uint64_t begin = m_head.fetch_add(size, std::memory_order_relaxed);
+  if (begin + size > m_region_size) {
+    return false;
+  }
+  *p_begin = m_frame_index * m_region_size + static_cast<uint32_t>(begin);
+  return true;
+}
+
+UniformRing::Allocation UniformRing::ThreadAllocator::Allocate(uint32_t size) {
+  Allocation allocation = {0, nullptr};
+  if ((m_ring.m_result != SPV_REFLECT_RESULT_SUCCESS) || (size > m_ring.m_region_size)) {
+    return allocation;
+  }
+  uint64_t serial = m_ring.m_serial.load(std::memory_order_acquire);
+  if (serial != m_serial) {
+    m_serial = serial;
+    m_begin = 0;
+    m_end = 0;
+  }
+
+  uint32_t aligned_size = static_cast<uint32_t>(AlignUp(size, m_ring.m_alignment));
+  if (aligned_size > m_end - m_begin) {
+    // Large allocations bypass the chunk so it is not wasted
+    if (aligned_size > m_ring.m_chunk_size / 2) {
+      if (!m_ring.AcquireRange(aligned_size, &allocation.offset)) {
+        return allocation;
+      }
+      allocation.p_data = m_ring.m_p_mapped_data + allocation.offset;
+      return allocation;
+    }
+    if (!m_ring.AcquireRange(m_ring.m_chunk_size, &m_begin)) {
+      m_begin = 0;
+      m_end = 0;
+      return allocation;
+    }
+    m_end = m_begin + m_ring.m_chunk_size;
+  }
+  allocation.offset = m_begin;
+  allocation.p_data = m_ring.m_p_mapped_data + m_begin;
+  m_begin += aligned_size;
+  return allocation;
+}
+
+} // namespace spv_reflect
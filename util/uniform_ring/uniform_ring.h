@@ -0,0 +1,150 @@
+#ifndef SPIRV_REFLECT_UNIFORM_RING_H
+#define SPIRV_REFLECT_UNIFORM_RING_H
+
+#include "spirv_reflect.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace spv_reflect {
+
+// Byte offsets of a uniform block's members, flattened depth first with
+// dotted names ("light.color"). Members of arrays of structs are listed at
+// their offsets in element 0; add i * array_stride for element i. Look a
+// member up once with FindMember() and write through its index.
+class UniformBlockLayout {
+public:
+  struct Member {
+    std::string name;
+    uint32_t    offset;
+    uint32_t    size;
+    uint32_t    array_stride;
+  };
+
+  UniformBlockLayout() = default;
+  explicit UniformBlockLayout(const SpvReflectBlockVariable& block);
+
+  // Bytes to allocate for one instance of the block
+  uint32_t      GetSize() const { return m_size; }
+  uint32_t      GetMemberCount() const { return static_cast<uint32_t>(m_members.size()); }
+  const Member& GetMember(uint32_t index) const { return m_members[index]; }
+  // Returns UINT32_MAX if the block has no such member
+  uint32_t      FindMember(const char* name) const;
+
+  // Copies at most the member's size from p_value into p_block_data
+  void Write(void* p_block_data, uint32_t member_index, const void* p_value, uint32_t size) const {
+    const Member& member = m_members[member_index];
+    memcpy(static_cast<uint8_t*>(p_block_data) + member.offset, p_value, (size < member.size) ? size : member.size);
+  }
+  template <typename T>
+  void Write(void* p_block_data, uint32_t member_index, const T& value) const {
+    Write(p_block_data, member_index, &value, static_cast<uint32_t>(sizeof(T)));
+  }
+
+private:
+  void AddMembers(const SpvReflectBlockVariable& block, const std::string& prefix, uint32_t base_offset);
+
+  uint32_t            m_size = 0;
+  std::vector<Member> m_members;
+};
+
+// The uniform buffers of a pipeline laid out back to back, each at an
+// offset aligned for dynamic uniform buffers, so one allocation per draw
+// covers every stage. Bindings that several stages declare share a slot.
+class UniformFootprint {
+public:
+  struct Slot {
+    uint32_t           set;
+    uint32_t           binding;
+    uint32_t           offset;
+    UniformBlockLayout layout;
+  };
+
+  // alignment is minUniformBufferOffsetAlignment and must be a power of two
+  UniformFootprint(uint32_t module_count, const SpvReflectShaderModule* const* pp_modules, uint32_t alignment);
+
+  SpvReflectResult GetResult() const { return m_result; }
+  uint32_t         GetSize() const { return m_size; }
+  uint32_t         GetSlotCount() const { return static_cast<uint32_t>(m_slots.size()); }
+  // Slots are sorted by set, then binding number
+  const Slot&      GetSlot(uint32_t index) const { return m_slots[index]; }
+  // Returns UINT32_MAX if the pipeline has no such uniform buffer
+  uint32_t         FindSlot(uint32_t set, uint32_t binding) const;
+  // Writes one dynamic offset per slot, in the order vkCmdBindDescriptorSets
+  // takes them, for an allocation at base_offset
+  void             GetDynamicOffsets(uint32_t base_offset, uint32_t* p_offsets) const;
+
+private:
+  SpvReflectResult  m_result = SPV_REFLECT_RESULT_NOT_READY;
+  uint32_t          m_size = 0;
+  std::vector<Slot> m_slots;
+};
+
+// Linear per-frame allocator over a persistently mapped uniform buffer that
+// is split into one region per frame in flight. Threads take chunks of a
+// region with a single atomic add and sub-allocate from them without
+// synchronization.
+class UniformRing {
+public:
+  struct Allocation {
+    // Offset in the buffer, for use as a dynamic offset
+    uint32_t offset;
+    // Host address of the allocation, or nullptr if the region is full
+    void*    p_data;
+  };
+
+  // Per-thread view of the ring. Not thread safe itself; give each thread
+  // its own.
+  class ThreadAllocator {
+  public:
+    explicit ThreadAllocator(UniformRing& ring) : m_ring(ring) {}
+
+    Allocation Allocate(uint32_t size);
+    Allocation Allocate(const UniformFootprint& footprint) { return Allocate(footprint.GetSize()); }
+
+  private:
+    UniformRing& m_ring;
+    uint64_t     m_serial = 0;
+    uint32_t     m_begin = 0;
+    uint32_t     m_end = 0;
+  };
+
+  // alignment is minUniformBufferOffsetAlignment and must be a power of
+  // two. chunk_size is rounded up to it.
+  UniformRing(void* p_mapped_data, uint32_t size, uint32_t frame_count, uint32_t alignment, uint32_t chunk_size);
+
+  SpvReflectResult GetResult() const { return m_result; }
+  uint32_t         GetFrameIndex() const { return m_frame_index; }
+  uint32_t         GetRegionSize() const { return m_region_size; }
+  // Bytes of the current region handed out to threads so far
+  uint32_t         GetUsedSize() const;
+
+  // Moves to the next frame's region and discards what it held. Must not
+  // run concurrently with allocation, and the GPU must be done reading the
+  // region.
+  void BeginFrame();
+
+private:
+  friend class ThreadAllocator;
+
+  // Takes size bytes of the current region, returning false if it is full
+  bool AcquireRange(uint32_t size, uint32_t* p_begin);
+
+  SpvReflectResult      m_result = SPV_REFLECT_RESULT_NOT_READY;
+  uint8_t*              m_p_mapped_data = nullptr;
+  uint32_t              m_frame_count = 0;
+  uint32_t              m_alignment = 0;
+  uint32_t              m_chunk_size = 0;
+  uint32_t              m_region_size = 0;
+  uint32_t              m_frame_index = 0;
+  std::atomic<uint64_t> m_head;
+  // Bumped by BeginFrame() so threads drop chunks of the previous frame
+  std::atomic<uint64_t> m_serial;
+};
+
+} // namespace spv_reflect
+
+#endif // SPIRV_REFLECT_UNIFORM_RING_H
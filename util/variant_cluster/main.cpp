@@ -0,0 +1,327 @@
+#include "../stripper/io.h"
+#include "spirv_reflect.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// One shader variant: its SPIR-V file and the macros it was compiled with
+struct Variant {
+  std::string path;
+  std::map<std::string, std::string> defines;
+  SpvReflectMinHash minhash;
+  SpvReflectFingerprint fingerprint;
+  bool valid;
+};
+
+struct MacroStats {
+  uint32_t pairCount = 0;
+  uint32_t similarPairCount = 0;
+  float similaritySum = 0.0f;
+  float minSimilarity = 1.0f;
+};
+
+// Lines are "path [NAME[=VALUE] ...]"; '#' starts a comment
+static bool ReadManifest(const char* path, std::vector<Variant>* variants) {
+  std::ifstream ifs(path);
+  if (!ifs.is_open()) {
+    fprintf(stderr, "error: file does not exist '%s'\n", path);
+    return false;
+  }
+  std::string line;
+  while (std::getline(ifs, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream tokens(line);
+    Variant variant = {};
+    if (!(tokens >> variant.path)) {
+      continue;
+    }
+    std::string define;
+    while (tokens >> define) {
+      size_t equals = define.find('=');
+      if (equals == std::string::npos) {
+        variant.defines[define] = "1";
+      } else {
+        variant.defines[define.substr(0, equals)] = define.substr(equals + 1);
+      }
+    }
+    variants->push_back(variant);
+  }
+  return true;
+}
+
+// Reads and sketches every variant, taking the next unclaimed one until
+// none are left
+static void SketchVariants(std::vector<Variant>* variants, uint32_t shingleLength,
+                           std::atomic<size_t>* nextIndex) {
+  for (size_t i = (*nextIndex)++; i < variants->size(); i = (*nextIndex)++) {
+    Variant& variant = (*variants)[i];
+    std::vector<uint32_t> contents;
+    if (!ReadFile<uint32_t>(variant.path.c_str(), "rb", &contents)) {
+      continue;
+    }
+    spv_reflect::ShaderModule module(contents);
+    SpvReflectFingerprints fingerprints;
+    variant.valid = (module.GetResult() == SPV_REFLECT_RESULT_SUCCESS) &&
+                    (module.GetMinHash(shingleLength, &variant.minhash) == SPV_REFLECT_RESULT_SUCCESS) &&
+                    (module.GetFingerprints(&fingerprints) == SPV_REFLECT_RESULT_SUCCESS);
+    variant.fingerprint = fingerprints.module;
+  }
+}
+
+static uint32_t FindRoot(std::vector<uint32_t>& roots, uint32_t index) {
+  while (roots[index] != index) {
+    roots[index] = roots[roots[index]];
+    index = roots[index];
+  }
+  return index;
+}
+
+// Single linkage clustering of variants whose estimated similarity reaches
+// the threshold. Candidate pairs come from locality sensitive hashing: the
+// sketch is cut into bands, and variants that agree on a whole band share a
+// bucket, so near-duplicates meet without comparing every pair.
+static std::vector<uint32_t> ClusterVariants(const std::vector<Variant>& variants, float threshold) {
+  const uint32_t kBandCount = 16;
+  const uint32_t kRowCount = SPV_REFLECT_MINHASH_SIZE / kBandCount;
+  std::vector<uint32_t> roots(variants.size());
+  for (uint32_t i = 0; i < roots.size(); ++i) {
+    roots[i] = i;
+  }
+  for (uint32_t band = 0; band < kBandCount; ++band) {
+    std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+    for (uint32_t i = 0; i < variants.size(); ++i) {
+      if (!variants[i].valid) {
+        continue;
+      }
+      uint64_t key = band;
+      for (uint32_t row = 0; row < kRowCount; ++row) {
+        key = key * 0x100000001B3ULL ^ variants[i].minhash.values[band * kRowCount + row];
+      }
+      buckets[key].push_back(i);
+    }
+    for (const auto& bucket : buckets) {
+      const std::vector<uint32_t>& members = bucket.second;
+      for (size_t j = 1; j < members.size(); ++j) {
+        // One link per member is enough for single linkage
+        for (size_t i = 0; i < j; ++i) {
+          uint32_t rootI = FindRoot(roots, members[i]);
+          uint32_t rootJ = FindRoot(roots, members[j]);
+          if (rootI == rootJ) {
+            break;
+          }
+          if (spvReflectGetMinHashSimilarity(&variants[members[i]].minhash,
+                                             &variants[members[j]].minhash) >= threshold) {
+            roots[std::max(rootI, rootJ)] = std::min(rootI, rootJ);
+            break;
+          }
+        }
+      }
+    }
+  }
+  for (uint32_t i = 0; i < roots.size(); ++i) {
+    FindRoot(roots, i);
+  }
+  return roots;
+}
+
+// Value of a macro in a variant, empty if it is not defined
+static std::string GetDefine(const Variant& variant, const std::string& macro) {
+  auto it = variant.defines.find(macro);
+  return (it != variant.defines.end()) ? it->second : std::string();
+}
+
+// Compares the variants that differ in the value of a single macro. A
+// macro whose pairs are all near-duplicates barely changes the code and
+// its variants are candidates for collapsing.
+static std::map<std::string, MacroStats> AnalyzeMacros(const std::vector<Variant>& variants, float threshold) {
+  std::map<std::string, MacroStats> stats;
+  std::vector<std::string> macros;
+  for (const Variant& variant : variants) {
+    for (const auto& define : variant.defines) {
+      macros.push_back(define.first);
+    }
+  }
+  std::sort(macros.begin(), macros.end());
+  macros.erase(std::unique(macros.begin(), macros.end()), macros.end());
+
+  for (const std::string& macro : macros) {
+    // Variants with the same defines apart from this macro
+    std::unordered_map<std::string, std::vector<uint32_t>> groups;
+    for (uint32_t i = 0; i < variants.size(); ++i) {
+      if (!variants[i].valid) {
+        continue;
+      }
+      std::string key;
+      for (const auto& define : variants[i].defines) {
+        if (define.first != macro) {
+          key += define.first + "=" + define.second + " ";
+        }
+      }
+      groups[key].push_back(i);
+    }
+    MacroStats& macroStats = stats[macro];
+    for (const auto& group : groups) {
+      const std::vector<uint32_t>& members = group.second;
+      for (size_t j = 1; j < members.size(); ++j) {
+        for (size_t i = 0; i < j; ++i) {
+          if (GetDefine(variants[members[i]], macro) == GetDefine(variants[members[j]], macro)) {
+            continue;
+          }
+          float similarity = spvReflectGetMinHashSimilarity(&variants[members[i]].minhash,
+                                                            &variants[members[j]].minhash);
+          macroStats.pairCount += 1;
+          macroStats.similarPairCount += (similarity >= threshold) ? 1 : 0;
+          macroStats.similaritySum += similarity;
+          macroStats.minSimilarity = std::min(macroStats.minSimilarity, similarity);
+        }
+      }
+    }
+  }
+  return stats;
+}
+
+static void PrintUsage() {
+  fprintf(stderr,
+          "usage: variant_cluster [-t SIMILARITY] [-n LENGTH] [-j THREADS] [-m MANIFEST] [file.spv ...]\n"
+          "\n"
+          "Clusters near-duplicate shader variants by MinHash similarity of their\n"
+          "instruction n-grams and reports which macros only cause small differences.\n"
+          "\n"
+          "  -t SIMILARITY  Estimated similarity for two variants to be near-duplicates. [default: 0.9]\n"
+          "  -n LENGTH      Instructions per n-gram. [default: 4]\n"
+          "  -j THREADS     Threads reading and sketching modules. [default: all cores]\n"
+          "  -m MANIFEST    File with one variant per line: path [NAME[=VALUE] ...]\n");
+}
+
+int main(int argc, char** argv) {
+  float threshold = 0.9f;
+  uint32_t shingleLength = 0;
+  uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<Variant> variants;
+  for (int argi = 1; argi < argc; ++argi) {
+    if ('-' == argv[argi][0]) {
+      if ((argi + 1 >= argc) || (argv[argi][1] == '\0') || (argv[argi][2] != '\0')) {
+        fprintf(stderr, "error: %s option error\n", argv[argi]);
+        PrintUsage();
+        return 1;
+      }
+      const char* value = argv[++argi];
+      switch (argv[argi - 1][1]) {
+        case 't': {
+          threshold = static_cast<float>(atof(value));
+        } break;
+        case 'n': {
+          shingleLength = static_cast<uint32_t>(atoi(value));
+        } break;
+        case 'j': {
+          threadCount = static_cast<uint32_t>(std::max(atoi(value), 1));
+        } break;
+        case 'm': {
+          if (!ReadManifest(value, &variants)) {
+            return 1;
+          }
+        } break;
+        default:
+          fprintf(stderr, "error: unrecognized option: %s\n\n", argv[argi - 1]);
+          PrintUsage();
+          return 1;
+      }
+    } else {
+      Variant variant = {};
+      variant.path = argv[argi];
+      variants.push_back(variant);
+    }
+  }
+  if (variants.empty()) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::atomic<size_t> nextIndex(0);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < std::min<size_t>(threadCount, variants.size()); ++i) {
+    threads.emplace_back(SketchVariants, &variants, shingleLength, &nextIndex);
+  }
+  SketchVariants(&variants, shingleLength, &nextIndex);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const Variant& variant : variants) {
+    if (!variant.valid) {
+      fprintf(stderr, "warning: skipped '%s', it could not be reflected\n", variant.path.c_str());
+    }
+  }
+
+  std::vector<uint32_t> roots = ClusterVariants(variants, threshold);
+  std::map<uint32_t, std::vector<uint32_t>> clusters;
+  for (uint32_t i = 0; i < variants.size(); ++i) {
+    if (variants[i].valid) {
+      clusters[roots[i]].push_back(i);
+    }
+  }
+  uint32_t clusteredCount = 0;
+  uint32_t duplicateClusterCount = 0;
+  for (const auto& cluster : clusters) {
+    if (cluster.second.size() > 1) {
+      clusteredCount += static_cast<uint32_t>(cluster.second.size());
+      ++duplicateClusterCount;
+    }
+  }
+  printf("variants        : %zu\n", variants.size());
+  printf("clusters        : %zu (%u with near-duplicates, covering %u variants)\n", clusters.size(),
+         duplicateClusterCount, clusteredCount);
+
+  for (const auto& cluster : clusters) {
+    const std::vector<uint32_t>& members = cluster.second;
+    if (members.size() < 2) {
+      continue;
+    }
+    // The first variant stands for the cluster; similarities are to it
+    const Variant& representative = variants[members[0]];
+    uint32_t identicalCount = 0;
+    printf("\n  cluster of %zu: %s\n", members.size(), representative.path.c_str());
+    for (size_t i = 1; i < members.size(); ++i) {
+      const Variant& variant = variants[members[i]];
+      bool identical = (memcmp(&variant.fingerprint, &representative.fingerprint, sizeof(variant.fingerprint)) == 0);
+      identicalCount += identical ? 1 : 0;
+      printf("    %-40s %.3f%s\n", variant.path.c_str(),
+             spvReflectGetMinHashSimilarity(&representative.minhash, &variant.minhash),
+             identical ? " identical" : "");
+    }
+    if (identicalCount > 0) {
+      printf("    %u identical to the first\n", identicalCount);
+    }
+  }
+
+  std::map<std::string, MacroStats> macroStats = AnalyzeMacros(variants, threshold);
+  std::vector<std::pair<std::string, MacroStats>> macros(macroStats.begin(), macroStats.end());
+  std::stable_sort(macros.begin(), macros.end(),
+                   [](const std::pair<std::string, MacroStats>& a, const std::pair<std::string, MacroStats>& b) {
+                     float meanA = (a.second.pairCount > 0) ? a.second.similaritySum / a.second.pairCount : -1.0f;
+                     float meanB = (b.second.pairCount > 0) ? b.second.similaritySum / b.second.pairCount : -1.0f;
+                     return meanA > meanB;
+                   });
+  if (!macros.empty()) {
+    printf("\n  macros (variant pairs differing only in the macro, mean and min similarity):\n");
+  }
+  for (const auto& macro : macros) {
+    const MacroStats& stats = macro.second;
+    if (stats.pairCount == 0) {
+      printf("    %-24s no pairs\n", macro.first.c_str());
+      continue;
+    }
+    printf("    %-24s %6u pairs, %.3f mean, %.3f min, %u near-duplicates%s\n", macro.first.c_str(),
+           stats.pairCount, stats.similaritySum / stats.pairCount, stats.minSimilarity,
+           stats.similarPairCount, (stats.similarPairCount == stats.pairCount) ? "  [trivial]" : "");
+  }
+  return 0;
+}
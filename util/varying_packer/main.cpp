@@ -0,0 +1,136 @@
+#include "../stripper/io.h"
+#include "spirv_reflect.h"
+#include "spirv-tools/libspirv.h"
+
+#include <cstdio>
+
+static bool WriteModule(const char* path, const spv_reflect::ShaderModule& module) {
+  return WriteFile<uint32_t>(path, "wb", module.GetCode(), module.GetCodeSize() / sizeof(uint32_t));
+}
+
+// Picks the universal environment matching the SPIR-V version in the module
+// header, so instructions newer than the module's version are rejected.
+static spv_target_env GetTargetEnv(const spv_reflect::ShaderModule& module) {
+  switch (module.GetCode()[1]) {
+    case 0x00010000: return SPV_ENV_UNIVERSAL_1_0;
+    case 0x00010100: return SPV_ENV_UNIVERSAL_1_1;
+    case 0x00010200: return SPV_ENV_UNIVERSAL_1_2;
+    default: break;
+  }
+  return SPV_ENV_UNIVERSAL_1_3;
+}
+
+// Runs the SPIR-V validator on a rewritten module and prints its diagnostic.
+static bool ValidateModule(const char* name, const spv_reflect::ShaderModule& module) {
+  spv_context context = spvContextCreate(GetTargetEnv(module));
+  spv_const_binary_t binary = {module.GetCode(), module.GetCodeSize() / sizeof(uint32_t)};
+  spv_diagnostic diagnostic = nullptr;
+  spv_result_t result = spvValidate(context, &binary, &diagnostic);
+  if (result != SPV_SUCCESS) {
+    fprintf(stderr, "error: packed %s module fails validation: %s\n", name,
+            (diagnostic != nullptr) ? diagnostic->error : "unknown error");
+  }
+  spvDiagnosticDestroy(diagnostic);
+  spvContextDestroy(context);
+  return result == SPV_SUCCESS;
+}
+
+// Packs the varyings between two pipeline stages into fewer locations,
+// validates both rewritten modules and writes them. Nothing is written if
+// either module fails validation.
+int main(int argc, char** argv) {
+  const char* inFiles[2] = {nullptr, nullptr};
+  const char* outFiles[2] = {"out.producer.spv", "out.consumer.spv"};
+  bool removeDeadOutputs = false;
+  int inFileCount = 0;
+  for (int argi = 1; argi < argc; ++argi) {
+    if ('-' == argv[argi][0]) {
+      switch (argv[argi][1]) {
+        case 'o':
+        case 'n': {
+          const int index = ('o' == argv[argi][1]) ? 0 : 1;
+          if (argi + 1 < argc) {
+            outFiles[index] = argv[++argi];
+          } else {
+            fprintf(stderr, "error: %s option error\n", argv[argi]);
+            return 1;
+          }
+        } break;
+        case 'd': {
+          removeDeadOutputs = true;
+        } break;
+        default:
+          fprintf(stderr,
+                  "error: unrecognized option: %s (only -o, -n and -d supported)\n\n",
+                  argv[argi]);
+          return 1;
+      }
+    } else if (inFileCount < 2) {
+      inFiles[inFileCount++] = argv[argi];
+    } else {
+      fprintf(stderr, "error: more than two input files specified\n");
+      return 1;
+    }
+  }
+
+  if (inFileCount != 2) {
+    fprintf(stderr,
+            "usage: varying_packer [-d] [-o producer_out.spv] [-n consumer_out.spv] producer.spv consumer.spv\n");
+    return 1;
+  }
+
+  std::vector<uint32_t> contents[2];
+  for (int i = 0; i < 2; ++i) {
+    if (!ReadFile<uint32_t>(inFiles[i], "rb", &contents[i])) {
+      fprintf(stderr, "error: failed to read %s\n", inFiles[i]);
+      return 1;
+    }
+  }
+
+  spv_reflect::ShaderModule producer(contents[0]);
+  spv_reflect::ShaderModule consumer(contents[1]);
+  if ((producer.GetResult() != SPV_REFLECT_RESULT_SUCCESS) ||
+      (consumer.GetResult() != SPV_REFLECT_RESULT_SUCCESS)) {
+    fprintf(stderr, "error: failed to reflect\n");
+    return 1;
+  }
+
+  if (removeDeadOutputs) {
+    uint32_t removedCount = 0;
+    if (producer.EliminateDeadOutputs(producer.GetEntryPointName(), consumer,
+                                      consumer.GetEntryPointName(), &removedCount) !=
+        SPV_REFLECT_RESULT_SUCCESS) {
+      fprintf(stderr, "error: failed to remove dead outputs\n");
+      return 1;
+    }
+    printf("removed outputs : %u\n", removedCount);
+  }
+
+  SpvReflectVaryingPackingReport report;
+  if (producer.PackVaryings(producer.GetEntryPointName(), consumer,
+                            consumer.GetEntryPointName(), &report) !=
+      SPV_REFLECT_RESULT_SUCCESS) {
+    fprintf(stderr, "error: failed to pack varyings\n");
+    return 1;
+  }
+  printf("locations       : %u -> %u\n", report.location_count_before, report.location_count_after);
+  for (uint32_t i = 0; i < report.assignment_count; ++i) {
+    const SpvReflectVaryingAssignment& assignment = report.assignments[i];
+    printf("  %%%u -> %%%u : location %u -> location %u, components %u-%u\n",
+           assignment.output_spirv_id, assignment.input_spirv_id, assignment.old_location,
+           assignment.location, assignment.component,
+           assignment.component + assignment.component_count - 1);
+  }
+  spvReflectDestroyVaryingPackingReport(&report);
+
+  if (!ValidateModule("producer", producer) || !ValidateModule("consumer", consumer)) {
+    return 1;
+  }
+
+  if (!WriteModule(outFiles[0], producer) || !WriteModule(outFiles[1], consumer)) {
+    fprintf(stderr, "error: failed to write\n");
+    return 1;
+  }
+
+  return 0;
+}